@@ -0,0 +1 @@
+slang.h
\ No newline at end of file
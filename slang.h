@@ -130,6 +130,18 @@ extern "C"
 
     /*!
     @brief Initialize an instance of the Slang library.
+
+    A session may be shared by compile requests on multiple threads,
+    as long as each request is only used by one thread at a time.
+
+    When a cache directory is given, the output of each successful
+    compile that produced no diagnostics is saved there, and later
+    compiles with the same inputs and options (in this or any other
+    process) reuse it, as long as the files it included or imported
+    haven't changed. Reflection data for a cached compile is rebuilt
+    when it is first asked for. The directory also holds the checked
+    standard library, so that sessions in a new process don't have to
+    compile it from source.
     @param cacheDir The directory used to store cached compilation results. Pass NULL to disable caching.
     */
     SLANG_API SlangSession* spCreateSession(const char * cacheDir);
@@ -143,12 +155,99 @@ extern "C"
 
     /*!
     @brief Add new builtin declarations to be used in subsequent compiles.
+
+    This must not be called while other threads are compiling with the session.
     */
     SLANG_API void spAddBuiltins(
         SlangSession*   session,
         char const*     sourcePath,
         char const*     sourceString);
 
+    /*!
+    @brief Get the time spent loading part of the standard library.
+
+    The library for each language is only loaded once a translation unit
+    in that language needs it, so this can be used to see what the library
+    code used by a session cost.
+
+    @param moduleName One of "core", "hlsl" or "glsl".
+    @param outDeserialized If non-NULL, receives whether the module was loaded
+        from a serialized copy of the library (rather than compiled from source).
+    @return The time spent (in seconds), or a negative value if the module hasn't been loaded.
+    */
+    SLANG_API double spGetStdlibModuleInitTime(
+        SlangSession*   session,
+        char const*     moduleName,
+        int*            outDeserialized);
+
+    /*!
+    @brief Get statistics for the modules shared between compile requests.
+
+    A module loaded with `import` can be reused by later compile requests
+    in the same session, as long as none of the files it was built from
+    have changed and the request uses the same preprocessor definitions
+    and search paths.
+
+    @param outHitCount If non-NULL, receives the number of imports that reused a module.
+    @param outMissCount If non-NULL, receives the number of imports that had to load a module from source.
+    */
+    SLANG_API void spGetModuleCacheStats(
+        SlangSession*   session,
+        unsigned int*   outHitCount,
+        unsigned int*   outMissCount);
+
+    /*!
+    @brief Get statistics for the cache of files read by `#include`.
+
+    A file that is included more than once (in the same compile request, or
+    in later requests in the same session) is only read and lexed again if
+    its modification time or size has changed.
+
+    An `#include` of a file whose include guard is already defined, or that
+    used `#pragma once`, is skipped without even looking at the file again.
+
+    @param outBytesSaved If non-NULL, receives the number of bytes that didn't need to be read again.
+    @param outTokensSaved If non-NULL, receives the number of tokens that didn't need to be lexed again.
+    @param outIncludesSkipped If non-NULL, receives the number of `#include`s that were skipped.
+    */
+    SLANG_API void spGetIncludeCacheStats(
+        SlangSession*   session,
+        size_t*         outBytesSaved,
+        size_t*         outTokensSaved,
+        size_t*         outIncludesSkipped);
+
+    /*!
+    @brief Get statistics for the cache of implicit type conversions.
+
+    During semantic checking, the compiler often asks whether one type can be
+    converted to another (e.g., for each argument of each candidate in overload
+    resolution). The answers are cached for the whole session, and shared
+    between compile requests.
+
+    @param outHitCount If non-NULL, receives the number of checks answered from the cache.
+    @param outMissCount If non-NULL, receives the number of checks that had to be computed.
+    */
+    SLANG_API void spGetCoercionCacheStats(
+        SlangSession*   session,
+        unsigned int*   outHitCount,
+        unsigned int*   outMissCount);
+
+    /*!
+    @brief Get statistics for the source locations used by a session.
+
+    Every source file that a compile request loads is given a range of
+    locations in a single 32-bit space shared by the whole session. The
+    range is reused by later files once nothing refers to the file anymore
+    (e.g., once the compile request that loaded it has been destroyed).
+
+    @param outLocationsInUse If non-NULL, receives the number of locations held by files that are still alive.
+    @param outLocationSpaceUsed If non-NULL, receives how much of the location space is taken up, including gaps that haven't been reused yet.
+    */
+    SLANG_API void spGetSourceLocationStats(
+        SlangSession*   session,
+        size_t*         outLocationsInUse,
+        size_t*         outLocationSpaceUsed);
+
     /*!
     @brief Create a compile request.
     */
@@ -278,6 +377,39 @@ extern "C"
         char const*             name,
         SlangProfileID          profile);
 
+    /** Add a permutation to the compilation request.
+
+    A request with permutations compiles its translation units once for
+    each permutation, using the preprocessor definitions of the permutation
+    along with its own. This is cheaper than a separate request for each
+    permutation: included files are only lexed once, and permutations for
+    which the translation units preprocess to the same tokens are only
+    checked and compiled once.
+
+    The definitions of a permutation apply to the translation units only,
+    and not to modules loaded with `import`.
+
+    The results of each permutation can be retrieved with the
+    `spGetPermutation*()` functions, while the ordinary results of
+    the request are those of the first permutation.
+
+    Returns the zero-based index of the permutation created.
+    */
+    SLANG_API int spAddPermutation(
+        SlangCompileRequest*    request);
+
+    /** Add a preprocessor definition to a permutation.
+
+    @param permutationIndex The index of the permutation to get the definition.
+    @param key The name of the macro to define.
+    @param value The value of the macro to define.
+    */
+    SLANG_API void spPermutation_addPreprocessorDefine(
+        SlangCompileRequest*    request,
+        int                     permutationIndex,
+        const char*             key,
+        const char*             value);
+
     /** Execute the compilation request.
 
     Returns zero on success, non-zero on failure.
@@ -339,6 +471,57 @@ extern "C"
         int                     entryPointIndex,
         size_t*                 outSize);
 
+    /** Get the number of permutations added to the compilation request
+    */
+    SLANG_API int spGetPermutationCount(
+        SlangCompileRequest*    request);
+
+    /** Get the output code associated with a translation unit, for one permutation.
+
+    Permutations that produced identical output share the same pointer.
+    The lifetime of the output pointer is the same as `request`.
+    */
+    SLANG_API char const* spGetPermutationTranslationUnitSource(
+        SlangCompileRequest*    request,
+        int                     permutationIndex,
+        int                     translationUnitIndex);
+
+    /** Get the output source code associated with an entry point, for one permutation.
+
+    Permutations that produced identical output share the same pointer.
+    The lifetime of the output pointer is the same as `request`.
+    */
+    SLANG_API char const* spGetPermutationEntryPointSource(
+        SlangCompileRequest*    request,
+        int                     permutationIndex,
+        int                     entryPointIndex);
+
+    /** Get the output bytecode associated with an entry point, for one permutation.
+
+    Permutations that produced identical output share the same pointer.
+    The lifetime of the output pointer is the same as `request`.
+    */
+    SLANG_API void const* spGetPermutationEntryPointCode(
+        SlangCompileRequest*    request,
+        int                     permutationIndex,
+        int                     entryPointIndex,
+        size_t*                 outSize);
+
+    /*!
+    @brief Get statistics for the cache of name lookups in a compile request.
+
+    When semantic checking looks up the same name from the same scope more
+    than once, the later lookups reuse the first result, until something
+    happens (like an `import`) that could change it.
+
+    @param outLookupCount If non-NULL, receives the number of lookups performed.
+    @param outHitCount If non-NULL, receives the number of lookups answered from the cache.
+    */
+    SLANG_API void spGetLookupCacheStats(
+        SlangCompileRequest*    request,
+        unsigned int*           outLookupCount,
+        unsigned int*           outHitCount);
+
 
     /* Note(tfoley): working on new reflection interface...
     */
@@ -354,6 +537,11 @@ extern "C"
     SLANG_API SlangReflection* spGetReflection(
         SlangCompileRequest*    request);
 
+    // get reflection data for one permutation of a compilation request
+    SLANG_API SlangReflection* spGetPermutationReflection(
+        SlangCompileRequest*    request,
+        int                     permutationIndex);
+
     // type reflection
 
     typedef unsigned int SlangTypeKind;
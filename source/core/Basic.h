@@ -0,0 +1 @@
+basic.h
\ No newline at end of file
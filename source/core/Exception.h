@@ -0,0 +1 @@
+exception.h
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "slang-math.h"
 #include <string.h>
+#include <stdint.h>
 
 namespace Slang
 {
@@ -33,6 +34,33 @@ namespace Slang
 	{
 		return GetHashCode(const_cast<const char *>(buffer));
 	}
+	// Hash a buffer of known length; produces the same value as the
+	// null-terminated version above for the same characters.
+	inline int GetHashCode(const char * buffer, size_t length)
+	{
+		if (!buffer)
+			return 0;
+		int hash = 0;
+		for (size_t i = 0; i < length; i++)
+		{
+			int c = buffer[i];
+			hash = c + (hash << 6) + (hash << 16) - hash;
+		}
+		return hash;
+	}
+
+	// A 64-bit hash of a buffer (FNV-1a), for when we use the hash to
+	// identify content (e.g., to tell if a file has changed), and
+	// not just to pick a bucket.
+	inline uint64_t GetHashCode64(const char * buffer, size_t length, uint64_t hash = 14695981039346656037ULL)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (unsigned char)buffer[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
 
 	template<int IsInt>
 	class Hash
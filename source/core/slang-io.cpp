@@ -4,6 +4,7 @@
 #define __STDC__ 1
 #endif
 #include <sys/stat.h>
+#include <stdlib.h>
 #ifdef _WIN32
 #include <direct.h>
 #endif
@@ -21,6 +22,22 @@ namespace Slang
 #endif
 	}
 
+	bool File::GetTimeAndSize(const String & fileName, int64_t * outModifiedTime, int64_t * outSize)
+	{
+#ifdef _WIN32
+		struct _stat64 statVar;
+		if (::_wstat64(((String)fileName).ToWString(), &statVar) == -1)
+			return false;
+#else
+		struct stat statVar;
+		if (::stat(fileName.Buffer(), &statVar) != 0)
+			return false;
+#endif
+		*outModifiedTime = (int64_t)statVar.st_mtime;
+		*outSize = (int64_t)statVar.st_size;
+		return true;
+	}
+
 	String Path::TruncateExt(const String & path)
 	{
 		UInt dotPos = path.LastIndexOf('.');
@@ -125,6 +142,23 @@ namespace Slang
 #endif
 	}
 
+	String Path::GetCanonical(const String & path)
+	{
+#if defined(_WIN32)
+		wchar_t buffer[_MAX_PATH];
+		if (!_wfullpath(buffer, path.ToWString(), _MAX_PATH))
+			return path;
+		return String::FromWString(buffer);
+#else
+		char* result = realpath(path.Buffer(), nullptr);
+		if (!result)
+			return path;
+		String canonicalPath(result);
+		free(result);
+		return canonicalPath;
+#endif
+	}
+
 	Slang::String File::ReadAllText(const Slang::String & fileName)
 	{
 		StreamReader reader(new FileStream(fileName, FileMode::Open, FileAccess::Read, FileShare::ReadWrite));
@@ -12,6 +12,11 @@ namespace Slang
 	{
 	public:
 		static bool Exists(const Slang::String & fileName);
+
+		// Get when the file was last modified (in seconds), and its size
+		// in bytes. Returns false if the file doesn't exist.
+		static bool GetTimeAndSize(const Slang::String & fileName, int64_t * outModifiedTime, int64_t * outSize);
+
 		static Slang::String ReadAllText(const Slang::String & fileName);
 		static Slang::List<unsigned char> ReadAllBytes(const Slang::String & fileName);
 		static void WriteAllText(const Slang::String & fileName, const Slang::String & text);
@@ -31,6 +36,11 @@ namespace Slang
 		static String Combine(const String & path1, const String & path2);
 		static String Combine(const String & path1, const String & path2, const String & path3);
 		static bool CreateDir(const String & path);
+
+		// Get an absolute path for the given file, with any `.` and `..`
+		// steps resolved, so that different ways of naming a file can be
+		// compared. Returns the path unchanged if this isn't possible.
+		static String GetCanonical(const String & path);
 	};
 }
 
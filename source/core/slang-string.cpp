@@ -252,6 +252,14 @@ namespace Slang
         append(slice.begin(), slice.end());
     }
 
+    void String::append(UnownedStringSlice const& slice)
+    {
+        if (slice.begin() == slice.end())
+            return;
+
+        append(slice.begin(), slice.end());
+    }
+
     void String::append(int value, int radix)
     {
         enum { kCount = 33 };
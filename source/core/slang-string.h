@@ -129,9 +129,22 @@ namespace Slang
 
     class String;
 
+    // A `UnownedStringSlice` is a view of a range of characters
+    // that are owned by somebody else (e.g., the contents of a
+    // source file). It does not retain its storage, so it is
+    // up to the user to ensure the storage outlives the slice.
     struct UnownedStringSlice
     {
     public:
+        UnownedStringSlice()
+            : beginData(0)
+            , endData(0)
+        {}
+
+        UnownedStringSlice(char const* b, char const* e)
+            : beginData(b)
+            , endData(e)
+        {}
 
         char const* begin() const
         {
@@ -143,6 +156,40 @@ namespace Slang
             return endData;
         }
 
+        UInt getLength() const
+        {
+            return endData - beginData;
+        }
+
+        bool operator==(UnownedStringSlice const& other) const
+        {
+            UInt length = getLength();
+            return length == other.getLength()
+                && memcmp(beginData, other.beginData, length) == 0;
+        }
+
+        bool operator==(char const* str) const
+        {
+            UInt length = getLength();
+            return strncmp(beginData ? beginData : "", str, length) == 0
+                && str[length] == 0;
+        }
+
+        bool operator!=(UnownedStringSlice const& other) const
+        {
+            return !(*this == other);
+        }
+
+        bool operator!=(char const* str) const
+        {
+            return !(*this == str);
+        }
+
+        int GetHashCode() const
+        {
+            return Slang::GetHashCode(beginData, getLength());
+        }
+
     private:
         char const* beginData;
         char const* endData;
@@ -244,6 +291,14 @@ namespace Slang
 		{
 		}
 
+		// Let other threads copy the string at the same time as this
+		// one (see `RefObject::markShared()`)
+		void markShared() const
+		{
+			if (buffer)
+				buffer->markShared();
+		}
+
 		const char * begin() const
 		{
 			return getData();
@@ -253,6 +308,11 @@ namespace Slang
 			return getData() + getLength();
 		}
 
+        UnownedStringSlice getUnownedSlice() const
+        {
+            return UnownedStringSlice(begin(), end());
+        }
+
         void append(int value, int radix = 10);
         void append(unsigned int value, int radix = 10);
         void append(long long value, int radix = 10);
@@ -264,6 +324,7 @@ namespace Slang
         void append(char chr);
         void append(String const& str);
         void append(StringSlice const& slice);
+        void append(UnownedStringSlice const& slice);
 
 		String(int val, int radix = 10)
 		{
@@ -358,6 +419,11 @@ namespace Slang
 		}
 
         String(StringSlice const& slice)
+        {
+            append(slice);
+        }
+
+        String(UnownedStringSlice const& slice)
         {
             append(slice);
         }
@@ -686,6 +752,11 @@ namespace Slang
 			Append(str);
 			return *this;
 		}
+		StringBuilder & operator << (UnownedStringSlice const& slice)
+		{
+			append(slice);
+			return *this;
+		}
 		StringBuilder & operator << (const _EndLine)
 		{
 			Append('\n');
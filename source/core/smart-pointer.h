@@ -5,51 +5,162 @@
 
 #include <assert.h>
 
+#include <atomic>
+
 namespace Slang
 {
     // TODO: Need to centralize these typedefs
     typedef uintptr_t UInt;
     typedef intptr_t Int;
 
+    // Whether objects created on the current thread start out
+    // shared (see `SharedRefObjectScope`)
+    inline bool& createsSharedRefObjects()
+    {
+        static thread_local bool value = false;
+        return value;
+    }
+
     // Base class for all reference-counted objects
+    //
+    // Most objects are only ever used by the thread that created them
+    // (e.g., the strings of a single compile request), so their reference
+    // count is updated with plain loads and stores. An object that other
+    // threads may refer to at the same time (e.g., something that belongs
+    // to a session) must be marked as shared before any other thread can
+    // see it, after which its count is updated with atomic operations.
     class RefObject
     {
     private:
-        UInt referenceCount;
+        // The top bits of `referenceCount` are flags
+        static const UInt kSharedFlag = UInt(1) << (sizeof(UInt) * 8 - 1);
+        static const UInt kImmortalFlag = UInt(1) << (sizeof(UInt) * 8 - 2);
+        static const UInt kCountMask = kImmortalFlag - 1;
+
+        std::atomic<UInt> referenceCount;
 
     public:
         RefObject()
-            : referenceCount(0)
+            : referenceCount(createsSharedRefObjects() ? kSharedFlag : 0)
         {}
 
         RefObject(const RefObject &)
-            : referenceCount(0)
+            : referenceCount(createsSharedRefObjects() ? kSharedFlag : 0)
         {}
 
+        // Assigning to an object doesn't change how many references there are to it
+        RefObject& operator=(const RefObject &)
+        {
+            return *this;
+        }
+
         virtual ~RefObject()
         {}
 
         void addReference()
         {
-            referenceCount++;
+            UInt count = referenceCount.load(std::memory_order_relaxed);
+            if(count & kImmortalFlag)
+                return;
+            if(count & kSharedFlag)
+                referenceCount.fetch_add(1, std::memory_order_relaxed);
+            else
+                referenceCount.store(count + 1, std::memory_order_relaxed);
         }
 
         void releaseReference()
         {
-            assert(referenceCount != 0);
-            if(--referenceCount == 0)
+            UInt count = referenceCount.load(std::memory_order_relaxed);
+            if(count & kImmortalFlag)
+                return;
+            assert((count & kCountMask) != 0);
+            if(count & kSharedFlag)
+                count = referenceCount.fetch_sub(1, std::memory_order_acq_rel);
+            else
+                referenceCount.store(count - 1, std::memory_order_relaxed);
+            if((count & kCountMask) == 1)
             {
                 delete this;
             }
         }
 
+        // Add a reference, unless the count has already dropped to
+        // zero (i.e., the object is being destroyed). This is for
+        // tables that refer to objects without keeping them alive.
+        bool tryAddReference()
+        {
+            UInt count = referenceCount.load(std::memory_order_relaxed);
+            if(count & kImmortalFlag)
+                return true;
+            if(!(count & kSharedFlag))
+            {
+                if((count & kCountMask) == 0)
+                    return false;
+                referenceCount.store(count + 1, std::memory_order_relaxed);
+                return true;
+            }
+            while((count & kCountMask) != 0)
+            {
+                if(referenceCount.compare_exchange_weak(count, count + 1, std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        }
+
+        bool hasReferences()
+        {
+            UInt count = referenceCount.load(std::memory_order_relaxed);
+            return (count & kImmortalFlag) || (count & kCountMask) != 0;
+        }
+
         bool isUniquelyReferenced()
         {
-            assert(referenceCount != 0);
-            return referenceCount == 1;
+            UInt count = referenceCount.load(std::memory_order_relaxed);
+            assert((count & kImmortalFlag) || (count & kCountMask) != 0);
+            return (count & ~kSharedFlag) == 1;
+        }
+
+        // Let other threads refer to the object. This must be done while
+        // only the current thread can see the object (e.g., before adding
+        // it to a table that other threads look in).
+        void markShared()
+        {
+            UInt count = referenceCount.load(std::memory_order_relaxed);
+            if(!(count & kSharedFlag))
+                referenceCount.store(count | kSharedFlag, std::memory_order_relaxed);
+        }
+
+        // Stop counting references to the object, because something
+        // else decides when it is destroyed (e.g., the arena it was
+        // allocated from). This must be done while only the current
+        // thread can see the object.
+        void markImmortal()
+        {
+            UInt count = referenceCount.load(std::memory_order_relaxed);
+            referenceCount.store(count | kImmortalFlag, std::memory_order_relaxed);
         }
     };
 
+    // Objects created on the current thread start out shared (see
+    // `RefObject::markShared()`), or not, for the lifetime of the
+    // scope object. This is for code that builds things that
+    // other threads will use, like a session's standard library.
+    struct SharedRefObjectScope
+    {
+        SharedRefObjectScope(bool shared = true)
+            : savedShared(createsSharedRefObjects())
+        {
+            createsSharedRefObjects() = shared;
+        }
+
+        ~SharedRefObjectScope()
+        {
+            createsSharedRefObjects() = savedShared;
+        }
+
+        bool savedShared;
+    };
+
     inline void addReference(RefObject* obj)
     {
         if(obj) obj->addReference();
@@ -60,6 +171,19 @@ namespace Slang
         if(obj) obj->releaseReference();
     }
 
+    // How `RefPtr<T>::As<U>()` checks whether an object is a `U`.
+    // Class hierarchies that have a cheaper way to do this than
+    // `dynamic_cast` can specialize this for their classes.
+    template<typename T, typename Enable = void>
+    struct DynamicCastTraits
+    {
+        template<typename U>
+        static U* cast(T* obj)
+        {
+            return dynamic_cast<U*>(obj);
+        }
+    };
+
     // "Smart" pointer to a reference-counted object
     template<typename T>
     struct RefPtr
@@ -157,7 +281,7 @@ namespace Slang
         template<typename U>
         RefPtr<U> As() const
         {
-            RefPtr<U> result(dynamic_cast<U*>(pointer));
+            RefPtr<U> result(DynamicCastTraits<T>::template cast<U>(pointer));
             return result;
         }
 
@@ -0,0 +1 @@
+diagnostics.h
\ No newline at end of file
@@ -0,0 +1 @@
+lexer.h
\ No newline at end of file
@@ -0,0 +1 @@
+parser.h
\ No newline at end of file
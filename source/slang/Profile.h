@@ -0,0 +1 @@
+profile.h
\ No newline at end of file
@@ -0,0 +1 @@
+syntax.h
\ No newline at end of file
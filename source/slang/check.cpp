@@ -107,7 +107,7 @@ namespace Slang
             {
                 return typeType->type;
             }
-            return ExpressionType::Error;
+            return ExpressionType::GetError();
         }
         RefPtr<ExpressionType> TranslateTypeNode(const RefPtr<ExpressionSyntaxNode> & node)
         {
@@ -145,7 +145,7 @@ namespace Slang
                 auto expr = new MemberExpressionSyntaxNode();
                 expr->Position = originalExpr->Position;
                 expr->BaseExpression = baseExpr;
-                expr->name = declRef.GetName();
+                expr->name = declRef.getInternedName();
                 expr->Type = GetTypeForDeclRef(declRef);
                 expr->declRef = declRef;
                 return expr;
@@ -154,7 +154,7 @@ namespace Slang
             {
                 auto expr = new VarExpressionSyntaxNode();
                 expr->Position = originalExpr->Position;
-                expr->name = declRef.GetName();
+                expr->name = declRef.getInternedName();
                 expr->Type = GetTypeForDeclRef(declRef);
                 expr->declRef = declRef;
                 return expr;
@@ -214,7 +214,7 @@ namespace Slang
             {
                 auto overloadedExpr = new OverloadedExpr();
                 overloadedExpr->Position = originalExpr->Position;
-                overloadedExpr->Type = QualType(ExpressionType::Overloaded);
+                overloadedExpr->Type = QualType(ExpressionType::getOverloadedType());
                 overloadedExpr->base = baseExpr;
                 overloadedExpr->lookupResult2 = lookupResult;
                 return overloadedExpr;
@@ -254,7 +254,7 @@ namespace Slang
                     }
                 }
                 // TODO(tfoley): should we construct a new ErrorExpr here?
-                overloadedExpr->Type = QualType(ExpressionType::Error);
+                overloadedExpr->Type = QualType(ExpressionType::GetError());
                 return overloadedExpr;
             }
 
@@ -273,7 +273,7 @@ namespace Slang
             {
                 return expr;
             }
-            else if (expr->Type.type->Equals(ExpressionType::Error))
+            else if (expr->Type.type->Equals(ExpressionType::GetError()))
             {
                 return expr;
             }
@@ -292,7 +292,7 @@ namespace Slang
             {
                 return typeType->type;
             }
-            return ExpressionType::Error;
+            return ExpressionType::GetError();
         }
 
         RefPtr<ExpressionType> ExtractGenericArgType(RefPtr<ExpressionSyntaxNode> exp)
@@ -317,7 +317,7 @@ namespace Slang
             {
                 return typeType->type;
             }
-            else if (exp->Type->Equals(ExpressionType::Error))
+            else if (exp->Type->Equals(ExpressionType::GetError()))
             {
                 return exp->Type.type;
             }
@@ -343,6 +343,7 @@ namespace Slang
             {
                 subst->args.Add(ExtractGenericArgVal(argExpr));
             }
+            subst = internSubstitutions(subst);
 
             DeclRef<Decl> innerDeclRef;
             innerDeclRef.decl = GetInner(genericDeclRef);
@@ -432,7 +433,7 @@ namespace Slang
                                 {
                                     getSink()->diagnose(typeExp.exp.Ptr(), Diagnostics::unimplemented, "can't fill in default for generic type parameter");
                                 }
-                                *outProperType = ExpressionType::Error;
+                                *outProperType = ExpressionType::GetError();
                             }
                             return false;
                         }
@@ -451,7 +452,7 @@ namespace Slang
                                 {
                                     getSink()->diagnose(typeExp.exp.Ptr(), Diagnostics::unimplemented, "can't fill in default for generic type parameter");
                                 }
-                                *outProperType = ExpressionType::Error;
+                                *outProperType = ExpressionType::GetError();
                             }
                             return false;
                         }
@@ -525,7 +526,7 @@ namespace Slang
                     {
                         getSink()->diagnose(result.exp.Ptr(), Diagnostics::invalidTypeVoid);
                     }
-                    result.type = ExpressionType::Error;
+                    result.type = ExpressionType::GetError();
                     return result;
                 }
             }
@@ -546,7 +547,7 @@ namespace Slang
 
         RefPtr<ExpressionSyntaxNode> CreateErrorExpr(ExpressionSyntaxNode* expr)
         {
-            expr->Type = QualType(ExpressionType::Error);
+            expr->Type = QualType(ExpressionType::GetError());
             return expr;
         }
 
@@ -554,7 +555,7 @@ namespace Slang
         {
             // TODO: we may want other cases here...
 
-            if (expr->Type->Equals(ExpressionType::Error))
+            if (expr->Type->Equals(ExpressionType::GetError()))
                 return true;
 
             return false;
@@ -969,18 +970,90 @@ namespace Slang
             return false;
         }
 
+        // Does `val` refer to a generic parameter anywhere?
+        static bool dependsOnGenericParam(Val* val)
+        {
+            if (dynamicCast<GenericParamIntVal>(val))
+                return true;
+
+            auto type = dynamicCast<ExpressionType>(val);
+            if (!type)
+                return false;
+
+            type = type->GetCanonicalType();
+            if (auto arrayType = dynamicCast<ArrayExpressionType>(type))
+            {
+                return dependsOnGenericParam(arrayType->BaseType.Ptr())
+                    || dependsOnGenericParam(arrayType->ArrayLength.Ptr());
+            }
+            else if (auto declRefType = dynamicCast<DeclRefType>(type))
+            {
+                if (declRefType->declRef.As<GenericTypeParamDecl>())
+                    return true;
+
+                for (auto subst = declRefType->declRef.substitutions.Ptr(); subst; subst = subst->outer.Ptr())
+                {
+                    for (auto& arg : subst->args)
+                    {
+                        if (dependsOnGenericParam(arg.Ptr()))
+                            return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Can the result of `CanCoerce()` for these types be shared across
+        // the session? We can't share conversions to an interface, since
+        // the code being checked might add conformances with an `extension`,
+        // or conversions that involve generic parameters.
+        static bool canCacheCoercion(
+            ExpressionType* toType,
+            ExpressionType* fromType)
+        {
+            if (auto toDeclRefType = toType->As<DeclRefType>())
+            {
+                if (toDeclRefType->declRef.As<InterfaceDecl>())
+                    return false;
+            }
+
+            return !dependsOnGenericParam(toType) && !dependsOnGenericParam(fromType);
+        }
+
         // Check whether a type coercion is possible
         bool CanCoerce(
             RefPtr<ExpressionType>			toType,			// the target type for conversion
             RefPtr<ExpressionType>			fromType,		// the source type for the conversion
             ConversionCost*					outCost = 0)	// (optional) a place to stuff the conversion cost
         {
-            return TryCoerceImpl(
-                toType,
-                nullptr,
-                fromType,
-                nullptr,
-                outCost);
+            auto session = getCompileRequest()->mSession;
+
+            // Only interned types have IDs. We only add an entry if
+            // `canCacheCoercion()` says so, which is slower to check
+            // than the lookup, so we do that on a miss.
+            Session::CoercionKey key;
+            key.toTypeId = toType->GetCanonicalTypeId();
+            key.fromTypeId = fromType->GetCanonicalTypeId();
+            bool hasKey = key.toTypeId && key.fromTypeId;
+
+            Session::CoercionResult result;
+            if (!hasKey || !session->tryGetCachedCoercion(key, &result))
+            {
+                result.cost = kConversionCost_None;
+                result.canCoerce = TryCoerceImpl(
+                    toType,
+                    nullptr,
+                    fromType,
+                    nullptr,
+                    &result.cost);
+
+                if (hasKey && canCacheCoercion(toType.Ptr(), fromType.Ptr()))
+                    session->cacheCoercion(key, result);
+            }
+
+            if (result.canCoerce && outCost)
+                *outCost = result.cost;
+            return result.canCoerce;
         }
 
         RefPtr<ExpressionSyntaxNode> CreateImplicitCastExpr(
@@ -1042,7 +1115,7 @@ namespace Slang
                 // clobber the type on `fromExpr`, and an invariant here is that coercion
                 // really shouldn't *change* the expression that is passed in, but should
                 // introduce new AST nodes to coerce its value to a different type...
-                return CreateImplicitCastExpr(ExpressionType::Error, fromExpr);
+                return CreateImplicitCastExpr(ExpressionType::GetError(), fromExpr);
             }
             return expr;
         }
@@ -1225,7 +1298,7 @@ namespace Slang
                 // For now we will do this in a completely ad hoc fashion,
                 // but it would be nice to have some generic routine to
                 // do the needed type checking/coercion.
-                if(hlslUncheckedAttribute->nameToken.Content == "numthreads")
+                if(hlslUncheckedAttribute->nameToken.getContent() == "numthreads")
                 {
                     if(hlslUncheckedAttribute->args.Count() != 3)
                         return m;
@@ -1312,28 +1385,13 @@ namespace Slang
             // Whether we actually re-wrote anything or note, lets
             // install the new list of modifiers on the declaration
             decl->modifiers.first = resultModifiers;
+            decl->modifiers.updateClasses();
         }
 
         void visitProgramSyntaxNode(ProgramSyntaxNode* programNode)
         {
             // Try to register all the builtin decls
-            for (auto decl : programNode->Members)
-            {
-                auto inner = decl;
-                if (auto genericDecl = decl.As<GenericDecl>())
-                {
-                    inner = genericDecl->inner;
-                }
-
-                if (auto builtinMod = inner->FindModifier<BuiltinTypeModifier>())
-                {
-                    RegisterBuiltinDecl(decl, builtinMod);
-                }
-                if (auto magicMod = inner->FindModifier<MagicTypeModifier>())
-                {
-                    RegisterMagicDecl(decl, magicMod);
-                }
-            }
+            registerBuiltinDecls(programNode);
 
             // We need/want to visit any `import` declarations before
             // anything else, to make sure that scoping works.
@@ -1522,14 +1580,14 @@ namespace Slang
             for (auto prevDecl = funcDecl->nextInContainerWithSameName; prevDecl; prevDecl = prevDecl->nextInContainerWithSameName)
             {
                 // Look through generics to the declaration underneath
-                auto prevGenericDecl = dynamic_cast<GenericDecl*>(prevDecl);
+                auto prevGenericDecl = dynamicCast<GenericDecl>(prevDecl);
                 if (prevGenericDecl)
                     prevDecl = prevGenericDecl->inner.Ptr();
 
                 // We only care about previously-declared functions
                 // Note(tfoley): although we should really error out if the
                 // name is already in use for something else, like a variable...
-                auto prevFuncDecl = dynamic_cast<FunctionSyntaxNode*>(prevDecl);
+                auto prevFuncDecl = dynamicCast<FunctionSyntaxNode>(prevDecl);
                 if (!prevFuncDecl)
                     continue;
 
@@ -1610,7 +1668,7 @@ namespace Slang
             {
                 checkDecl(para);
 
-                if (paraNames.Contains(para->Name.Content))
+                if (paraNames.Contains(para->getName()))
                 {
                     if (!isRewriteMode())
                     {
@@ -1618,7 +1676,7 @@ namespace Slang
                     }
                 }
                 else
-                    paraNames.Add(para->Name.Content);
+                    paraNames.Add(para->getName());
             }
             this->function = NULL;
             functionNode->SetCheckState(DeclCheckState::CheckedHeader);
@@ -1661,7 +1719,7 @@ namespace Slang
             for (UInt ii = outerStmtCount; ii > 0; --ii)
             {
                 auto outerStmt = outerStmts[ii-1];
-                auto found = dynamic_cast<T*>(outerStmt);
+                auto found = dynamicCast<T>(outerStmt);
                 if (found)
                     return found;
             }
@@ -1820,7 +1878,7 @@ namespace Slang
             else
             {
                 stmt->Expression = CheckTerm(stmt->Expression);
-                if (!stmt->Expression->Type->Equals(ExpressionType::Error.Ptr()))
+                if (!stmt->Expression->Type->Equals(ExpressionType::GetError()))
                 {
                     if (function)
                     {
@@ -1924,7 +1982,7 @@ namespace Slang
             {
                 // We don't want to allow bindable resource types as local variables (at least for now).
                 auto parentDecl = varDecl->ParentDecl;
-                if (auto parentScopeDecl = dynamic_cast<ScopeDecl*>(parentDecl))
+                if (auto parentScopeDecl = dynamicCast<ScopeDecl>(parentDecl))
                 {
                     getSink()->diagnose(varDecl->Type, Diagnostics::invalidTypeForLocalVariable);
                 }
@@ -2001,7 +2059,7 @@ namespace Slang
                 expr->Type = ExpressionType::GetFloat();
                 break;
             default:
-                expr->Type = QualType(ExpressionType::Error);
+                expr->Type = QualType(ExpressionType::GetError());
                 throw "Invalid constant type.";
                 break;
             }
@@ -2129,19 +2187,19 @@ namespace Slang
             ExpressionSyntaxNode* expr)
         {
             // Unwrap any "identity" expressions
-            while (auto parenExpr = dynamic_cast<ParenExpr*>(expr))
+            while (auto parenExpr = dynamicCast<ParenExpr>(expr))
             {
                 expr = parenExpr->base;
             }
 
             // TODO(tfoley): more serious constant folding here
-            if (auto constExp = dynamic_cast<ConstantExpressionSyntaxNode*>(expr))
+            if (auto constExp = dynamicCast<ConstantExpressionSyntaxNode>(expr))
             {
                 return GetIntVal(constExp);
             }
 
             // it is possible that we are referring to a generic value param
-            if (auto declRefExpr = dynamic_cast<DeclRefExpr*>(expr))
+            if (auto declRefExpr = dynamicCast<DeclRefExpr>(expr))
             {
                 auto declRef = declRefExpr->declRef;
 
@@ -2211,13 +2269,13 @@ namespace Slang
                 }
             }
 
-            if (auto invokeExpr = dynamic_cast<InvokeExpressionSyntaxNode*>(expr))
+            if (auto invokeExpr = dynamicCast<InvokeExpressionSyntaxNode>(expr))
             {
                 auto val = TryConstantFoldExpr(invokeExpr);
                 if (val)
                     return val;
             }
-            else if(auto castExpr = dynamic_cast<TypeCastExpressionSyntaxNode*>(expr))
+            else if(auto castExpr = dynamicCast<TypeCastExpressionSyntaxNode>(expr))
             {
                 auto val = TryConstantFoldExpr(castExpr->Expression.Ptr());
                 if(val)
@@ -2302,10 +2360,11 @@ namespace Slang
             auto vectorGenericDecl = findMagicDecl("Vector").As<GenericDecl>();
             auto vectorTypeDecl = vectorGenericDecl->inner;
                
-            auto substitutions = new Substitutions();
+            RefPtr<Substitutions> substitutions = new Substitutions();
             substitutions->genericDecl = vectorGenericDecl.Ptr();
             substitutions->args.Add(elementType);
             substitutions->args.Add(elementCount);
+            substitutions = internSubstitutions(substitutions);
 
             auto declRef = DeclRef<Decl>(vectorTypeDecl.Ptr(), substitutions);
 
@@ -2391,7 +2450,7 @@ namespace Slang
 
                     // Note(tfoley): The name used for lookup here is a bit magical, since
                     // it must match what the parser installed in subscript declarations.
-                    LookupResult lookupResult = LookUpLocal(this, "operator[]", aggTypeDeclRef);
+                    LookupResult lookupResult = LookUpLocal(this, request->namePool->getName("operator[]"), aggTypeDeclRef);
                     if (!lookupResult.isValid())
                     {
                         goto fail;
@@ -2485,7 +2544,7 @@ namespace Slang
             if (argCount != paramCount)
             {
                 getSink()->diagnose(appExpr, Diagnostics::unimplemented, "wrong number of arguments for call");
-                appExpr->Type = ExpressionType::Error;
+                appExpr->Type = ExpressionType::GetError();
                 return appExpr;
             }
 
@@ -2566,9 +2625,21 @@ namespace Slang
                 // Attach our extension to that type as a candidate...
                 if (auto aggTypeDeclRef = targetDeclRefType->declRef.As<AggTypeDecl>())
                 {
+                    // The extensions in the standard library are linked
+                    // into the type itself, but the type might be shared
+                    // with requests on other threads, so any other
+                    // extension is only visible to this request.
                     auto aggTypeDecl = aggTypeDeclRef.getDecl();
-                    decl->nextCandidateExtension = aggTypeDecl->candidateExtensions;
-                    aggTypeDecl->candidateExtensions = decl;
+                    if (request->compilingBuiltins)
+                    {
+                        decl->nextCandidateExtension = aggTypeDecl->candidateExtensions;
+                        aggTypeDecl->candidateExtensions = decl;
+                        request->invalidateLookupCache();
+                    }
+                    else
+                    {
+                        request->addCandidateExtension(aggTypeDecl, decl);
+                    }
                 }
                 else
                 {
@@ -2578,7 +2649,7 @@ namespace Slang
                     }
                 }
             }
-            else if (decl->targetType->Equals(ExpressionType::Error))
+            else if (decl->targetType->Equals(ExpressionType::GetError()))
             {
                 // there was an error, so ignore
             }
@@ -2935,7 +3006,7 @@ namespace Slang
             solvedSubst->outer = genericDeclRef.substitutions;
             solvedSubst->args = args;
 
-            return solvedSubst;
+            return internSubstitutions(solvedSubst);
 
 
 #if 0
@@ -3418,6 +3489,7 @@ namespace Slang
             {
                 subst->args.Add(ExtractGenericArgVal(arg));
             }
+            subst = internSubstitutions(subst);
 
             DeclRef<Decl> innerDeclRef(GetInner(baseGenericRef), subst);
 
@@ -3455,7 +3527,7 @@ namespace Slang
             }
 
             context.mode = OverloadResolveContext::Mode::ForReal;
-            context.appExpr->Type = QualType(ExpressionType::Error);
+            context.appExpr->Type = QualType(ExpressionType::GetError());
 
             if (!TryCheckOverloadCandidateArity(context, candidate))
                 goto error;
@@ -3690,7 +3762,7 @@ namespace Slang
         {
             auto parentDecl = decl->ParentDecl;
             if (!parentDecl) return nullptr;
-            auto parentGeneric = dynamic_cast<GenericDecl*>(parentDecl);
+            auto parentGeneric = dynamicCast<GenericDecl>(parentDecl);
             return parentGeneric;
         }
 
@@ -3826,14 +3898,14 @@ namespace Slang
             {
                 auto fstDeclRef = fstDeclRefType->declRef;
 
-                if (auto typeParamDecl = dynamic_cast<GenericTypeParamDecl*>(fstDeclRef.getDecl()))
+                if (auto typeParamDecl = dynamicCast<GenericTypeParamDecl>(fstDeclRef.getDecl()))
                     return TryUnifyTypeParam(constraints, typeParamDecl, snd);
 
                 if (auto sndDeclRefType = snd->As<DeclRefType>())
                 {
                     auto sndDeclRef = sndDeclRefType->declRef;
 
-                    if (auto typeParamDecl = dynamic_cast<GenericTypeParamDecl*>(sndDeclRef.getDecl()))
+                    if (auto typeParamDecl = dynamicCast<GenericTypeParamDecl>(sndDeclRef.getDecl()))
                         return TryUnifyTypeParam(constraints, typeParamDecl, fst);
 
                     // can't be unified if they refer to differnt declarations.
@@ -3879,7 +3951,7 @@ namespace Slang
             {
                 auto fstDeclRef = fstDeclRefType->declRef;
 
-                if (auto typeParamDecl = dynamic_cast<GenericTypeParamDecl*>(fstDeclRef.getDecl()))
+                if (auto typeParamDecl = dynamicCast<GenericTypeParamDecl>(fstDeclRef.getDecl()))
                     return TryUnifyTypeParam(constraints, typeParamDecl, snd);
             }
 
@@ -3887,7 +3959,7 @@ namespace Slang
             {
                 auto sndDeclRef = sndDeclRefType->declRef;
 
-                if (auto typeParamDecl = dynamic_cast<GenericTypeParamDecl*>(sndDeclRef.getDecl()))
+                if (auto typeParamDecl = dynamicCast<GenericTypeParamDecl>(sndDeclRef.getDecl()))
                     return TryUnifyTypeParam(constraints, typeParamDecl, fst);
             }
 
@@ -3976,12 +4048,77 @@ namespace Slang
             return TryUnifyTypes(system, argExpr->Type, GetType(paramDeclRef));
         }
 
+        // Get the key for caching the arguments inferred for a call
+        // to `genericDeclRef` in `context`. Returns false if the
+        // result can't be cached (e.g., because an argument is an
+        // overload group, or an initializer list).
+        bool getGenericInferenceKey(
+            DeclRef<GenericDecl>                    genericDeclRef,
+            OverloadResolveContext&                 context,
+            CompileRequest::GenericInferenceKey*    outKey)
+        {
+            auto outer = genericDeclRef.substitutions.Ptr();
+            if (outer && (!getSubstitutionCache()
+                || outer->internedIn.load(std::memory_order_acquire) != getSubstitutionCache()))
+            {
+                return false;
+            }
+
+            outKey->genericDecl = genericDeclRef.getDecl();
+            outKey->outer = outer;
+            for (auto& arg : context.appExpr->Arguments)
+            {
+                auto argType = arg->Type.type;
+                if (!argType)
+                    return false;
+                uint64_t id = argType->GetCanonicalTypeId();
+                if (!id)
+                    return false;
+                outKey->argTypeIds.Add(id);
+            }
+            return true;
+        }
+
         // Take a generic declaration and try to specialize its parameters
         // so that the resulting inner declaration can be applicable in
         // a particular context...
+        //
+        // The result only depends on the generic and the types of the
+        // arguments, so it is cached on the request. Nothing is diagnosed
+        // here; a failed inference just means the candidate isn't
+        // applicable, which the caller reports at each call site.
         DeclRef<Decl> SpecializeGenericForOverload(
             DeclRef<GenericDecl>			genericDeclRef,
             OverloadResolveContext&	context)
+        {
+            CompileRequest::GenericInferenceKey key;
+            bool canCache = getGenericInferenceKey(genericDeclRef, context, &key);
+            if (canCache)
+            {
+                if (auto entry = request->genericInferenceCache.TryGetValue(key))
+                {
+                    if (!entry->solvedSubst)
+                        return DeclRef<Decl>(nullptr, nullptr);
+                    return DeclRef<Decl>(GetInner(genericDeclRef), entry->solvedSubst);
+                }
+            }
+
+            DeclRef<Decl> result = SpecializeGenericForOverloadImpl(genericDeclRef, context);
+
+            if (canCache)
+            {
+                CompileRequest::GenericInferenceEntry entry;
+                entry.outer = genericDeclRef.substitutions;
+                if (result)
+                    entry.solvedSubst = result.substitutions;
+                request->genericInferenceCache.Add(key, entry);
+            }
+            return result;
+        }
+
+        DeclRef<Decl> SpecializeGenericForOverloadImpl(
+            DeclRef<GenericDecl>			genericDeclRef,
+            OverloadResolveContext&	context)
         {
             ConstraintSystem constraints;
 
@@ -4067,12 +4204,9 @@ namespace Slang
             }
 
             // Now walk through any extensions we can find for this types
-            for (auto ext = GetCandidateExtensions(aggTypeDeclRef); ext; ext = ext->nextCandidateExtension)
+            auto extensionTable = getExtensionMemberTable(this, aggTypeDeclRef);
+            for (auto extDeclRef : extensionTable->extensions)
             {
-                auto extDeclRef = ApplyExtensionToType(ext, type);
-                if (!extDeclRef)
-                    continue;
-
                 for (auto ctorDeclRef : getMembersOfType<ConstructorDecl>(extDeclRef))
                 {
                     // TODO(tfoley): `typeItem` here should really reference the extension...
@@ -4167,6 +4301,226 @@ namespace Slang
             }
         }
 
+        // Find the index for the overload group that starts with
+        // the given item, if there is one.
+        OverloadGroupIndex* FindOverloadGroupIndex(LookupResultItem const& item)
+        {
+            auto decl = item.declRef.getDecl();
+            auto containerDecl = dynamicCast<ContainerDecl>(decl->ParentDecl);
+            if (!containerDecl || containerDecl->overloadGroupIndices.Count() == 0)
+                return nullptr;
+
+            auto index = containerDecl->overloadGroupIndices.TryGetValue(decl->getInternedName());
+            if (!index || (*index)->candidates[0].decl != decl)
+                return nullptr;
+            return index->Ptr();
+        }
+
+        // Add the candidates from `lookupResult`, leaving out those
+        // that an overload group index says can't apply to the call.
+        // Returns false if there were no indexed groups, and so
+        // every candidate got added.
+        bool AddIndexedOverloadCandidates(
+            LookupResult const&		lookupResult,
+            OverloadResolveContext&	context)
+        {
+            auto& items = lookupResult.items;
+            UInt itemCount = items.Count();
+
+            bool usedIndex = false;
+            List<OverloadGroupIndex::TypeShape> argShapes;
+            List<UInt> positions;
+
+            UInt ii = 0;
+            while (ii < itemCount)
+            {
+                auto index = FindOverloadGroupIndex(items[ii]);
+                UInt groupSize = index ? index->candidates.Count() : 0;
+
+                // The group is contiguous in the lookup result, so if we
+                // find its last member where we expect, the whole group
+                // is there.
+                if (!index
+                    || ii + groupSize > itemCount
+                    || items[ii + groupSize - 1].declRef.getDecl() != index->candidates.Last().decl)
+                {
+                    AddDeclRefOverloadCandidates(items[ii], context);
+                    ii++;
+                    continue;
+                }
+
+                if (!usedIndex)
+                {
+                    for (auto arg : context.appExpr->Arguments)
+                        argShapes.Add(getOverloadTypeShape(arg->Type.type.Ptr()));
+                    usedIndex = true;
+                }
+
+                positions.Clear();
+                index->findCandidates(argShapes, positions);
+                for (auto pp : positions)
+                {
+                    AddDeclRefOverloadCandidates(items[ii + pp], context);
+                }
+                ii += groupSize;
+            }
+            return usedIndex;
+        }
+
+        bool HasApplicableCandidate(OverloadResolveContext const& context)
+        {
+            if (context.bestCandidate)
+                return context.bestCandidate->status == OverloadCandidate::Status::Appicable;
+            if (context.bestCandidates.Count() != 0)
+                return context.bestCandidates[0].status == OverloadCandidate::Status::Appicable;
+            return false;
+        }
+
+        void ClearOverloadCandidates(OverloadResolveContext& context)
+        {
+            context.bestCandidate = nullptr;
+            context.bestCandidates.Clear();
+        }
+
+        // Get the key under which we remember how a call was resolved.
+        // We can only do this when lookup found a single indexed overload
+        // group, and every argument has a builtin scalar, vector, or
+        // matrix type, since then nothing else can affect the result.
+        bool GetResolvedCallKey(
+            LookupResult const&						lookupResult,
+            OverloadResolveContext&					context,
+            OverloadGroupIndex**					outIndex,
+            OverloadGroupIndex::ResolvedCallKey*	outKey)
+        {
+            typedef OverloadGroupIndex::ResolvedCallKey ResolvedCallKey;
+            typedef OverloadGroupIndex::TypeShape TypeShape;
+
+            auto& items = lookupResult.items;
+            auto index = FindOverloadGroupIndex(items[0]);
+            if (!index
+                || index->hasInterfaceParams
+                || items.Count() != index->candidates.Count()
+                || items.Last().declRef.getDecl() != index->candidates.Last().decl)
+            {
+                return false;
+            }
+
+            // If the group is in a generic, the parameter types
+            // depend on how it was specialized.
+            if (items[0].declRef.substitutions)
+                return false;
+
+            auto& args = context.appExpr->Arguments;
+            if (args.Count() > ResolvedCallKey::kMaxArgCount)
+                return false;
+
+            outKey->fixity = ResolvedCallKey::Fixity::None;
+            if (context.appExpr.As<PrefixExpr>())
+                outKey->fixity = ResolvedCallKey::Fixity::Prefix;
+            else if (context.appExpr.As<PostfixExpr>())
+                outKey->fixity = ResolvedCallKey::Fixity::Postfix;
+
+            outKey->argCount = args.Count();
+            for (UInt aa = 0; aa < args.Count(); ++aa)
+            {
+                auto argType = args[aa]->Type.type.Ptr();
+                auto shape = getOverloadTypeShape(argType);
+                switch (shape.kind)
+                {
+                case TypeShape::Kind::Scalar:
+                    break;
+
+                case TypeShape::Kind::Vector:
+                    if (!shape.rowCount || !argType->AsVectorType()->elementType->AsBasicType())
+                        return false;
+                    break;
+
+                case TypeShape::Kind::Matrix:
+                    if (!shape.rowCount || !shape.columnCount || shape.elementType == BaseType::Void)
+                        return false;
+                    break;
+
+                default:
+                    return false;
+                }
+
+                outKey->argTypeIds[aa] = argType->GetCanonicalTypeId();
+                if (!outKey->argTypeIds[aa])
+                    return false;
+            }
+
+            *outIndex = index;
+            return true;
+        }
+
+        // Find the position in `index` of the group member that
+        // a (possibly specialized) candidate declaration came from.
+        bool FindOverloadGroupPosition(
+            OverloadGroupIndex*	index,
+            Decl*				decl,
+            UInt*				outPosition)
+        {
+            for (UInt cc = 0; cc < index->candidates.Count(); ++cc)
+            {
+                auto candidateDecl = index->candidates[cc].decl;
+                if (candidateDecl == decl || candidateDecl == decl->ParentDecl)
+                {
+                    *outPosition = cc;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void AddLookupResultOverloadCandidates(
+            LookupResult const&		lookupResult,
+            OverloadResolveContext&	context)
+        {
+            // A call to an operator or intrinsic on builtin types resolves
+            // the same way every time we see the same argument types, so
+            // once we've seen one we can go straight to the candidate
+            // that was chosen.
+            OverloadGroupIndex* index = nullptr;
+            OverloadGroupIndex::ResolvedCallKey key;
+            bool canRemember = GetResolvedCallKey(lookupResult, context, &index, &key);
+            if (canRemember)
+            {
+                UInt position;
+                if (index->tryGetResolvedCall(key, &position))
+                {
+                    AddDeclRefOverloadCandidates(lookupResult.items[position], context);
+                    if (HasApplicableCandidate(context))
+                        return;
+                    ClearOverloadCandidates(context);
+                }
+            }
+
+            // Overload groups with an index only need the candidates
+            // it picks out to be checked. If none of those turn out to
+            // be applicable, we start over and check everything, so
+            // that we report the same errors as we would without it.
+            if (AddIndexedOverloadCandidates(lookupResult, context)
+                && !HasApplicableCandidate(context))
+            {
+                ClearOverloadCandidates(context);
+                for (auto item : lookupResult.items)
+                {
+                    AddDeclRefOverloadCandidates(item, context);
+                }
+            }
+
+            // Only a single best candidate is worth remembering, since
+            // anything else leads to an error.
+            UInt position;
+            if (canRemember
+                && context.bestCandidate
+                && context.bestCandidate->status == OverloadCandidate::Status::Appicable
+                && FindOverloadGroupPosition(index, context.bestCandidate->item.declRef.getDecl(), &position))
+            {
+                index->addResolvedCall(key, position);
+            }
+        }
+
         void AddOverloadCandidates(
             RefPtr<ExpressionSyntaxNode>	funcExpr,
             OverloadResolveContext&			context)
@@ -4187,10 +4541,7 @@ namespace Slang
             {
                 auto lookupResult = overloadedExpr->lookupResult2;
                 assert(lookupResult.isOverloaded());
-                for(auto item : lookupResult.items)
-                {
-                    AddDeclRefOverloadCandidates(item, context);
-                }
+                AddLookupResultOverloadCandidates(lookupResult, context);
             }
             else if (auto typeType = funcExprType->As<TypeType>())
             {
@@ -4397,9 +4748,9 @@ namespace Slang
 
                 String funcName;
                 if (auto baseVar = funcExpr.As<VarExpressionSyntaxNode>())
-                    funcName = baseVar->name;
+                    funcName = getText(baseVar->name);
                 else if(auto baseMemberRef = funcExpr.As<MemberExpressionSyntaxNode>())
-                    funcName = baseMemberRef->name;
+                    funcName = getText(baseMemberRef->name);
 
                 String argsList = GetCallSignatureString(expr);
 
@@ -4482,7 +4833,7 @@ namespace Slang
                 {
                     getSink()->diagnose(expr->FunctionExpr, Diagnostics::expectedFunction);
                 }
-                expr->Type = QualType(ExpressionType::Error);
+                expr->Type = QualType(ExpressionType::GetError());
                 return expr;
             }
         }
@@ -4645,7 +4996,7 @@ namespace Slang
         {
 
             auto rs = ResolveInvoke(expr);
-            if (auto invoke = dynamic_cast<InvokeExpressionSyntaxNode*>(rs.Ptr()))
+            if (auto invoke = dynamicCast<InvokeExpressionSyntaxNode>(rs.Ptr()))
             {
                 // if this is still an invoke expression, test arguments passed to inout/out parameter are LValues
                 if(auto funcType = invoke->FunctionExpr->Type->As<FuncType>())
@@ -4694,15 +5045,40 @@ namespace Slang
         }
 
 
+        // Look up `name` from `scope`, reusing the result of an earlier
+        // lookup of the same name from the same scope if nothing that
+        // could change it has happened since.
+        LookupResult LookUpCached(Name* name, Scope* scope)
+        {
+            request->lookupCount++;
+
+            CompileRequest::LookupCacheKey key;
+            key.scope = scope;
+            key.name = name;
+            key.mask = LookupMask::All;
+
+            if (auto entry = request->lookupCache.TryGetValue(key))
+            {
+                request->lookupCacheHitCount++;
+                return entry->result;
+            }
+
+            CompileRequest::LookupCacheEntry entry;
+            entry.scope = scope;
+            entry.result = LookUp(this, name, scope);
+            request->lookupCache.Add(key, entry);
+            return entry.result;
+        }
+
         RefPtr<ExpressionSyntaxNode> visitVarExpressionSyntaxNode(VarExpressionSyntaxNode *expr)
         {
             // If we've already resolved this expression, don't try again.
             if (expr->declRef)
                 return expr;
 
-            expr->Type = QualType(ExpressionType::Error);
+            expr->Type = QualType(ExpressionType::GetError());
 
-            auto lookupResult = LookUp(this, expr->name, expr->scope);
+            auto lookupResult = LookUpCached(expr->name, expr->scope);
             if (lookupResult.isValid())
             {
                 return createLookupResultExpr(
@@ -4726,7 +5102,7 @@ namespace Slang
             expr->TargetType = targetType;
 
             // The way to perform casting depends on the types involved
-            if (expr->Expression->Type->Equals(ExpressionType::Error.Ptr()))
+            if (expr->Expression->Type->Equals(ExpressionType::GetError()))
             {
                 // If the expression being casted has an error type, then just silently succeed
                 expr->Type = targetType.Ptr();
@@ -4759,7 +5135,7 @@ namespace Slang
             {
                 getSink()->diagnose(expr, Diagnostics::invalidTypeCast, expr->Expression->Type, targetType->ToString());
             }
-            expr->Type = QualType(ExpressionType::Error);
+            expr->Type = QualType(ExpressionType::GetError());
             return expr;
         }
 
@@ -4844,9 +5220,10 @@ namespace Slang
             bool anyDuplicates = false;
             bool anyError = false;
 
-            for (UInt i = 0; i < memberRefExpr->name.Length(); i++)
+            String swizzleText = getText(memberRefExpr->name);
+            for (UInt i = 0; i < swizzleText.Length(); i++)
             {
-                auto ch = memberRefExpr->name[i];
+                auto ch = swizzleText[i];
                 int elementIndex = -1;
                 switch (ch)
                 {
@@ -5026,16 +5403,16 @@ namespace Slang
                 {
                     getSink()->diagnose(expr, Diagnostics::noMemberOfNameInType, expr->name, baseType);
                 }
-                expr->Type = QualType(ExpressionType::Error);
+                expr->Type = QualType(ExpressionType::GetError());
                 return expr;
             }
             // All remaining cases assume we have a `BasicType`
             else if (!baseType->AsBasicType())
-                expr->Type = QualType(ExpressionType::Error);
+                expr->Type = QualType(ExpressionType::GetError());
             else
-                expr->Type = QualType(ExpressionType::Error);
-            if (!baseType->Equals(ExpressionType::Error.Ptr()) &&
-                expr->Type->Equals(ExpressionType::Error.Ptr()))
+                expr->Type = QualType(ExpressionType::GetError());
+            if (!baseType->Equals(ExpressionType::GetError()) &&
+                expr->Type->Equals(ExpressionType::GetError()))
             {
                 if (!isRewriteMode())
                 {
@@ -5083,6 +5460,7 @@ namespace Slang
 
             subScope->nextSibling = scope->nextSibling;
             scope->nextSibling = subScope;
+            request->invalidateLookupCache();
 
             // Also import any modules from nested `import` declarations
             // with the `__exported` modifier
@@ -5110,7 +5488,7 @@ namespace Slang
             // be loaded), and then put its declarations into
             // the current scope.
 
-            auto name = decl->nameToken.Content;
+            String name = decl->nameToken.getContent();
             auto scope = decl->scope;
 
             // Try to load a module matching the name
@@ -5199,7 +5577,7 @@ namespace Slang
         {
             sink->diagnose(declRef, Diagnostics::unimplemented, "cannot form reference to this kind of declaration");
         }
-        return QualType(ExpressionType::Error);
+        return QualType(ExpressionType::GetError());
     }
 
     QualType getTypeForDeclRef(
@@ -5209,15 +5587,83 @@ namespace Slang
         return getTypeForDeclRef(nullptr, nullptr, declRef, &typeResult);
     }
 
-    DeclRef<ExtensionDecl> ApplyExtensionToType(
+    CandidateExtensionList GetCandidateExtensions(
         SemanticsVisitor*       semantics,
-        ExtensionDecl*          extDecl,
+        DeclRef<AggTypeDecl>    declRef)
+    {
+        auto aggTypeDecl = declRef.getDecl();
+
+        CandidateExtensionList result;
+        result.shared = aggTypeDecl->candidateExtensions;
+        if (semantics)
+            result.local = semantics->request->candidateExtensions.TryGetValue(aggTypeDecl);
+        return result;
+    }
+
+    static RefPtr<ExtensionMemberTable> buildExtensionMemberTable(
+        SemanticsVisitor*       semantics,
+        DeclRef<AggTypeDecl>    declRef,
         RefPtr<ExpressionType>  type)
     {
-        if(!semantics)
-            return DeclRef<ExtensionDecl>();
+        RefPtr<ExtensionMemberTable> table = new ExtensionMemberTable();
+        for (auto ext : GetCandidateExtensions(semantics, declRef))
+        {
+            auto extDeclRef = semantics->ApplyExtensionToType(ext, type);
+            if (!extDeclRef)
+                continue;
+
+            UInt extensionIndex = table->extensions.Count();
+            table->extensions.Add(extDeclRef);
+
+            buildMemberDictionary(ext);
+            if (ext->transparentMembers.Count())
+                table->hasTransparentMembers = true;
+
+            // Follow the same chains of members that lookup in the
+            // extension itself would, so the order is the same.
+            for (auto entry : ext->memberDictionary)
+            {
+                auto members = table->membersByName.TryGetValue(entry.Key);
+                if (!members)
+                {
+                    table->membersByName.Add(entry.Key, List<ExtensionMemberTable::Member>());
+                    members = table->membersByName.TryGetValue(entry.Key);
+                }
+
+                for (auto m = entry.Value; m; m = m->nextInContainerWithSameName)
+                {
+                    ExtensionMemberTable::Member member;
+                    member.decl = m;
+                    member.extensionIndex = extensionIndex;
+                    members->Add(member);
+                }
+            }
+        }
+        return table;
+    }
+
+    RefPtr<ExtensionMemberTable> getExtensionMemberTable(
+        SemanticsVisitor*       semantics,
+        DeclRef<AggTypeDecl>    declRef)
+    {
+        if (!semantics)
+            return nullptr;
+
+        RefPtr<ExpressionType> type = DeclRefType::Create(declRef);
+
+        // Types that aren't interned don't have an ID to remember
+        // the table by, so we just build it each time.
+        auto typeId = type->GetCanonicalTypeId();
+        if (!typeId)
+            return buildExtensionMemberTable(semantics, declRef, type);
+
+        auto request = semantics->request;
+        if (auto table = request->extensionMemberTables.TryGetValue(typeId))
+            return *table;
 
-        return semantics->ApplyExtensionToType(extDecl, type);
+        auto table = buildExtensionMemberTable(semantics, declRef, type);
+        request->extensionMemberTables[typeId] = table;
+        return table;
     }
 
 }
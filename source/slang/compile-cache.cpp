@@ -0,0 +1,800 @@
+// compile-cache.cpp
+#include "compile-cache.h"
+
+#include "../core/slang-io.h"
+#include "parameter-binding.h"
+#include "syntax-serialize.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <sys/utime.h>
+#undef WIN32_LEAN_AND_MEAN
+#undef NOMINMAX
+#else
+#include <dirent.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace Slang
+{
+    static const uint32_t kCompileCacheMagic = 0x43434c53; // 'SLCC'
+
+    // Bump this whenever the layout of an entry changes. Entries also
+    // get keyed on the build of the compiler (see `getCompilerBuildID()`),
+    // so that a new compiler doesn't pick up the output of an old one.
+    static const uint32_t kCompileCacheVersion = 2;
+
+    static char const* const kCompileCacheExtension = ".slang-cache";
+
+    // The serialized standard library is kept in the same directory,
+    // with an extension of its own so that it never gets evicted.
+    // Instead, storing the library for one build of the compiler
+    // removes the files left by other builds.
+    static const uint32_t kStdlibFileMagic = 0x4c534c53; // 'SLSL'
+    static const uint32_t kStdlibFileVersion = 1;
+    static char const* const kStdlibFileExtension = ".slang-stdlib";
+
+    // How many entries we store between checks of the total size
+    static const int kStoresPerEvict = 32;
+
+    // Temporary files (see `writeFileAtomically()`) that are older than
+    // this many seconds were left by a process that didn't get to finish
+    // writing them, e.g., because it crashed.
+    static char const* const kTempFileExtension = ".tmp";
+    static const uint64_t kStaleTempFileAge = 10 * 60;
+
+    // When we evict, we go a bit under the limit, so that we
+    // don't have to evict again on the very next store.
+    static uint64_t getEvictTargetSize(uint64_t maxSize)
+    {
+        return maxSize - maxSize / 4;
+    }
+
+    // Writing entries
+
+    struct CacheWriter
+    {
+        List<unsigned char> data;
+
+        void writeBytes(void const* bytes, UInt size)
+        {
+            data.AddRange((unsigned char const*)bytes, size);
+        }
+
+        void writeUInt32(uint32_t value)
+        {
+            writeBytes(&value, sizeof(value));
+        }
+
+        void writeUInt64(uint64_t value)
+        {
+            writeBytes(&value, sizeof(value));
+        }
+
+        void writeString(String const& value)
+        {
+            writeUInt32((uint32_t)value.Length());
+            writeBytes(value.Buffer(), value.Length());
+        }
+
+        void writeBlob(List<unsigned char> const& blob)
+        {
+            writeUInt32((uint32_t)blob.Count());
+            writeBytes(blob.Buffer(), blob.Count());
+        }
+
+        void writeResult(CompileResult const& result)
+        {
+            writeUInt32((uint32_t)result.format);
+            writeString(result.outputString);
+            writeBlob(result.outputBinary);
+        }
+    };
+
+    // Reading entries
+    //
+    // An entry might have been cut short or damaged (e.g., by a full
+    // disk), so every read is checked, and a bad entry is just a miss.
+
+    struct CacheReader
+    {
+        unsigned char const*    cursor;
+        unsigned char const*    end;
+        bool                    valid = true;
+
+        bool readBytes(void* bytes, UInt size)
+        {
+            if (!valid || UInt(end - cursor) < size)
+            {
+                valid = false;
+                return false;
+            }
+            memcpy(bytes, cursor, size);
+            cursor += size;
+            return true;
+        }
+
+        uint32_t readUInt32()
+        {
+            uint32_t value = 0;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        uint64_t readUInt64()
+        {
+            uint64_t value = 0;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        String readString()
+        {
+            UInt length = readUInt32();
+            if (!valid || UInt(end - cursor) < length)
+            {
+                valid = false;
+                return String();
+            }
+            StringBuilder sb;
+            sb.Append((char const*)cursor, length);
+            cursor += length;
+            return sb.ProduceString();
+        }
+
+        void readBlob(List<unsigned char>& outBlob)
+        {
+            UInt size = readUInt32();
+            if (!valid || UInt(end - cursor) < size)
+            {
+                valid = false;
+                return;
+            }
+            outBlob.AddRange(cursor, size);
+            cursor += size;
+        }
+
+        CompileResult readResult()
+        {
+            CompileResult result;
+            result.format = (ResultFormat)readUInt32();
+            result.outputString = readString();
+            readBlob(result.outputBinary);
+            return result;
+        }
+    };
+
+    // File system helpers
+
+    static bool readFile(String const& path, List<unsigned char>& outData)
+    {
+        FILE* file = nullptr;
+        fopen_s(&file, path.Buffer(), "rb");
+        if (!file)
+            return false;
+
+        bool result = true;
+        unsigned char buffer[4096];
+        for (;;)
+        {
+            size_t readCount = fread(buffer, 1, sizeof(buffer), file);
+            outData.AddRange(buffer, readCount);
+            if (readCount < sizeof(buffer))
+            {
+                result = ferror(file) == 0;
+                break;
+            }
+        }
+        fclose(file);
+        return result;
+    }
+
+    static bool writeFile(String const& path, List<unsigned char> const& data)
+    {
+        FILE* file = nullptr;
+        fopen_s(&file, path.Buffer(), "wb");
+        if (!file)
+            return false;
+
+        bool result = fwrite(data.Buffer(), 1, data.Count(), file) == data.Count();
+        if (fclose(file) != 0)
+            result = false;
+        return result;
+    }
+
+    // Move `fromPath` to `toPath`, replacing any file that is already
+    // there, such that a reader sees either the old file or the new one.
+    static bool replaceFile(String const& fromPath, String const& toPath)
+    {
+#ifdef _WIN32
+        return MoveFileExW(fromPath.ToWString(), toPath.ToWString(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return rename(fromPath.Buffer(), toPath.Buffer()) == 0;
+#endif
+    }
+
+    static void deleteFile(String const& path)
+    {
+#ifdef _WIN32
+        _wremove(path.ToWString());
+#else
+        remove(path.Buffer());
+#endif
+    }
+
+    // Mark a file as recently used
+    static void touchFile(String const& path)
+    {
+#ifdef _WIN32
+        _wutime(path.ToWString(), nullptr);
+#else
+        utime(path.Buffer(), nullptr);
+#endif
+    }
+
+    // Get the path of the binary (executable or library) that
+    // the compiler's code was loaded from
+    static bool getCompilerBinaryPath(String& outPath)
+    {
+#ifdef _WIN32
+        HMODULE module = nullptr;
+        if (!GetModuleHandleExW(
+            GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+            (LPCWSTR) &getCompilerBinaryPath,
+            &module))
+        {
+            return false;
+        }
+
+        wchar_t path[MAX_PATH];
+        DWORD length = GetModuleFileNameW(module, path, MAX_PATH);
+        if (length == 0 || length >= MAX_PATH)
+            return false;
+        outPath = String::FromWString(path);
+        return true;
+#else
+        Dl_info info;
+        if (!dladdr((void*) &getCompilerBinaryPath, &info) || !info.dli_fname)
+            return false;
+        outPath = info.dli_fname;
+        return true;
+#endif
+    }
+
+    static unsigned int getProcessID()
+    {
+#ifdef _WIN32
+        return (unsigned int)GetCurrentProcessId();
+#else
+        return (unsigned int)getpid();
+#endif
+    }
+
+    // Write `data` to `path`, such that other threads and processes
+    // reading or writing the same file see either the old contents or
+    // the new ones. We write to a file of our own first (named after
+    // `tempName`), and then move it into place in one step.
+    static bool writeFileAtomically(
+        String const&               directory,
+        String const&               tempName,
+        String const&               path,
+        List<unsigned char> const&  data)
+    {
+        static std::atomic<unsigned int> tempFileCounter(0);
+        StringBuilder sb;
+        sb << tempName << "." << (int)getProcessID() << "." << (int)tempFileCounter++ << kTempFileExtension;
+        String tempPath = Path::Combine(directory, sb.ProduceString());
+
+        if (!writeFile(tempPath, data) || !replaceFile(tempPath, path))
+        {
+            deleteFile(tempPath);
+            return false;
+        }
+        return true;
+    }
+
+    struct CacheFileInfo
+    {
+        String      path;
+        uint64_t    size;
+
+        // When the file was last written (or used, for an entry),
+        // in seconds since the Unix epoch
+        uint64_t    lastUsedTime;
+    };
+
+    // Find all of the files in `directory` with the given extension
+    static List<CacheFileInfo> findCacheFiles(
+        String const&   directory,
+        char const*     extension)
+    {
+        List<CacheFileInfo> files;
+#ifdef _WIN32
+        WIN32_FIND_DATAW findData;
+        String pattern = Path::Combine(directory, String("*") + extension);
+        HANDLE findHandle = FindFirstFileW(pattern.ToWString(), &findData);
+        if (findHandle == INVALID_HANDLE_VALUE)
+            return files;
+        do
+        {
+            if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                continue;
+
+            CacheFileInfo file;
+            file.path = Path::Combine(directory, String::FromWString(findData.cFileName));
+            file.size = (uint64_t(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+            // A `FILETIME` counts 100ns intervals since 1601
+            uint64_t fileTime = (uint64_t(findData.ftLastWriteTime.dwHighDateTime) << 32) | findData.ftLastWriteTime.dwLowDateTime;
+            file.lastUsedTime = fileTime / 10000000 - 11644473600ULL;
+            files.Add(file);
+        } while (FindNextFileW(findHandle, &findData));
+        FindClose(findHandle);
+#else
+        DIR* dir = opendir(directory.Buffer());
+        if (!dir)
+            return files;
+        while (auto entry = readdir(dir))
+        {
+            String name = entry->d_name;
+            if (!name.EndsWith(extension))
+                continue;
+
+            CacheFileInfo file;
+            file.path = Path::Combine(directory, name);
+
+            struct stat statVar;
+            if (stat(file.path.Buffer(), &statVar) != 0 || !S_ISREG(statVar.st_mode))
+                continue;
+            file.size = (uint64_t)statVar.st_size;
+            file.lastUsedTime = (uint64_t)statVar.st_mtime;
+            files.Add(file);
+        }
+        closedir(dir);
+#endif
+        return files;
+    }
+
+    static void appendHex(StringBuilder& sb, uint64_t value)
+    {
+        static char const kHexDigits[] = "0123456789abcdef";
+        for (int shift = 60; shift >= 0; shift -= 4)
+            sb.Append(kHexDigits[(value >> shift) & 0xF]);
+    }
+
+    // Save the checked syntax of `request`, for `CompileCache::loadLayout()`.
+    // Leaves the blob empty if there is nothing we can save.
+    static void saveSyntax(CompileRequest* request, CachedSyntax& outSyntax)
+    {
+        // Pass-through compiles don't produce any syntax
+        if (request->passThrough != PassThroughMode::None || !request->layout)
+            return;
+
+        List<RefPtr<ProgramSyntaxNode>> modules;
+        for (auto& module : request->loadedModulesList)
+            modules.Add(module);
+        for (auto& translationUnit : request->translationUnits)
+            modules.Add(translationUnit->SyntaxNode);
+
+        // The builtin modules are shared by every request in the session,
+        // so we refer to them, rather than saving copies.
+        List<RefObject*> builtinObjects = request->mSession->getBuiltinObjects(&outSyntax.builtinModuleCount);
+        if (!serializeModules(
+            modules,
+            builtinObjects,
+            request->sourceManager,
+            outSyntax.blob))
+        {
+            return;
+        }
+        outSyntax.builtinObjectCount = builtinObjects.Count();
+        outSyntax.importedModuleCount = request->loadedModulesList.Count();
+    }
+
+    // CompileCache
+
+    static uint64_t computeCompilerBuildID()
+    {
+        // Any change to the compiler's code changes its binary, so we use
+        // a hash of that, unless the build gives us an identifier of its
+        // own (e.g., the revision it was built from).
+#ifdef SLANG_BUILD_ID
+        char const* id = SLANG_BUILD_ID;
+        uint64_t hash = GetHashCode64(id, strlen(id));
+#else
+        String path;
+        List<unsigned char> data;
+        if (!getCompilerBinaryPath(path) || !readFile(path, data))
+            return 0;
+        uint64_t hash = GetHashCode64((char const*)data.Buffer(), data.Count());
+#endif
+        return hash ? hash : 1;
+    }
+
+    uint64_t CompileCache::getCompilerBuildID()
+    {
+        // This is only worked out once for the whole process
+        static const uint64_t buildID = computeCompilerBuildID();
+        return buildID;
+    }
+
+    CompileCache::CompileCache(String const& directory)
+        : directory(directory)
+    {
+        // This fails if the directory already exists, which is fine;
+        // if we really can't create it, every lookup will just miss.
+        Path::CreateDir(directory);
+    }
+
+    String CompileCache::computeKey(CompileRequest* request)
+    {
+        // Gather everything that affects the output into one
+        // string, and then hash that.
+        StringBuilder sb;
+        sb << "slang compile cache " << (int)kCompileCacheVersion << " ";
+        appendHex(sb, getCompilerBuildID());
+        sb << "\n";
+        sb << "builtins " << (long long)request->mSession->addedBuiltinsHash << "\n";
+
+        sb << "target " << (int)request->Target << " " << (int)request->extraTarget << "\n";
+        sb << "profile " << (int)request->profile.raw << "\n";
+        sb << "pass-through " << (int)request->passThrough << "\n";
+        sb << "flags " << (int)request->compileFlags << "\n";
+        sb << request->getModuleOptionsKey();
+
+        for (auto& translationUnit : request->translationUnits)
+        {
+            sb << "translation unit " << (int)translationUnit->sourceLanguage
+                << " " << (int)translationUnit->compileFlags << "\n";
+            for (auto& def : translationUnit->preprocessorDefinitions)
+                sb << "-D" << def.Key << "=" << def.Value << "\n";
+            for (auto& sourceFile : translationUnit->sourceFiles)
+            {
+                sb << "source " << sourceFile->path << "\n";
+                sb << (int)sourceFile->content.Length() << "\n";
+                sb << sourceFile->content << "\n";
+            }
+        }
+
+        for (auto& entryPoint : request->entryPoints)
+        {
+            sb << "entry point " << entryPoint->name
+                << " " << (int)entryPoint->profile.raw
+                << " " << entryPoint->translationUnitIndex << "\n";
+        }
+
+        // Two hashes with different seeds, to make collisions
+        // between entries vanishingly unlikely.
+        String keyData = sb.ProduceString();
+        StringBuilder keySB;
+        appendHex(keySB, GetHashCode64(keyData.Buffer(), keyData.Length()));
+        appendHex(keySB, GetHashCode64(keyData.Buffer(), keyData.Length(), 0x736c616e67636163ULL));
+        return keySB.ProduceString();
+    }
+
+    String CompileCache::getEntryPath(String const& key)
+    {
+        return Path::Combine(directory, key + kCompileCacheExtension);
+    }
+
+    bool CompileCache::tryLoad(String const& key, CompileRequest* request)
+    {
+        String path = getEntryPath(key);
+
+        List<unsigned char> data;
+        if (!readFile(path, data))
+            return false;
+
+        CacheReader reader;
+        reader.cursor = data.Buffer();
+        reader.end = data.Buffer() + data.Count();
+
+        if (reader.readUInt32() != kCompileCacheMagic)
+            return false;
+        if (reader.readUInt32() != kCompileCacheVersion)
+            return false;
+
+        // The entry is only good if the files that the code included
+        // or imported still hold what they did when it was compiled.
+        List<SourceDependency> dependencyFiles;
+        UInt dependencyCount = reader.readUInt32();
+        for (UInt ii = 0; ii < dependencyCount && reader.valid; ++ii)
+        {
+            SourceDependency file;
+            file.path = reader.readString();
+            file.contentHash = reader.readUInt64();
+            if (!reader.valid)
+                return false;
+
+            try
+            {
+                if (getContentHash(File::ReadAllText(file.path)) != file.contentHash)
+                    return false;
+            }
+            catch (...)
+            {
+                return false;
+            }
+
+            dependencyFiles.Add(file);
+        }
+
+        // A file added earlier in the search path (or next to the file
+        // that includes it) would hide the one the entry was compiled
+        // with, without any of the files above changing.
+        List<IncludeLookup> includeLookups;
+        UInt includeLookupCount = reader.readUInt32();
+        for (UInt ii = 0; ii < includeLookupCount && reader.valid; ++ii)
+        {
+            IncludeLookup lookup;
+            lookup.pathToInclude = reader.readString();
+            lookup.pathIncludedFrom = reader.readString();
+            lookup.foundPath = reader.readString();
+            if (!reader.valid)
+                return false;
+
+            if (request->findIncludedFile(lookup) != lookup.foundPath)
+                return false;
+
+            includeLookups.Add(lookup);
+        }
+
+        List<CompileResult> translationUnitResults;
+        UInt translationUnitCount = reader.readUInt32();
+        if (translationUnitCount != request->translationUnits.Count())
+            return false;
+        for (UInt ii = 0; ii < translationUnitCount; ++ii)
+            translationUnitResults.Add(reader.readResult());
+
+        List<CompileResult> entryPointResults;
+        UInt entryPointCount = reader.readUInt32();
+        if (entryPointCount != request->entryPoints.Count())
+            return false;
+        for (UInt ii = 0; ii < entryPointCount; ++ii)
+            entryPointResults.Add(reader.readResult());
+
+        CachedSyntax cachedSyntax;
+        cachedSyntax.builtinModuleCount = reader.readUInt32();
+        cachedSyntax.builtinObjectCount = reader.readUInt32();
+        cachedSyntax.importedModuleCount = reader.readUInt32();
+        reader.readBlob(cachedSyntax.blob);
+
+        if (!reader.valid)
+            return false;
+
+        // Everything checked out, so we can fill in the request
+        for (UInt ii = 0; ii < translationUnitCount; ++ii)
+            request->translationUnits[ii]->result = translationUnitResults[ii];
+        for (UInt ii = 0; ii < entryPointCount; ++ii)
+            request->entryPoints[ii]->result = entryPointResults[ii];
+        request->mDependencyFiles = dependencyFiles;
+        request->mIncludeLookups = includeLookups;
+        request->cachedSyntax = cachedSyntax;
+
+        touchFile(path);
+        return true;
+    }
+
+    void CompileCache::store(String const& key, CompileRequest* request)
+    {
+        CacheWriter writer;
+        writer.writeUInt32(kCompileCacheMagic);
+        writer.writeUInt32(kCompileCacheVersion);
+
+        writer.writeUInt32((uint32_t)request->mDependencyFiles.Count());
+        for (auto& file : request->mDependencyFiles)
+        {
+            writer.writeString(file.path);
+            writer.writeUInt64(file.contentHash);
+        }
+
+        writer.writeUInt32((uint32_t)request->mIncludeLookups.Count());
+        for (auto& lookup : request->mIncludeLookups)
+        {
+            writer.writeString(lookup.pathToInclude);
+            writer.writeString(lookup.pathIncludedFrom);
+            writer.writeString(lookup.foundPath);
+        }
+
+        writer.writeUInt32((uint32_t)request->translationUnits.Count());
+        for (auto& translationUnit : request->translationUnits)
+            writer.writeResult(translationUnit->result);
+
+        writer.writeUInt32((uint32_t)request->entryPoints.Count());
+        for (auto& entryPoint : request->entryPoints)
+            writer.writeResult(entryPoint->result);
+
+        CachedSyntax cachedSyntax;
+        saveSyntax(request, cachedSyntax);
+        writer.writeUInt32((uint32_t)cachedSyntax.builtinModuleCount);
+        writer.writeUInt32((uint32_t)cachedSyntax.builtinObjectCount);
+        writer.writeUInt32((uint32_t)cachedSyntax.importedModuleCount);
+        writer.writeBlob(cachedSyntax.blob);
+
+        // Other threads and processes may be reading or writing the same entry
+        if (!writeFileAtomically(directory, key, getEntryPath(key), writer.data))
+            return;
+
+        bool shouldEvict = false;
+        {
+            std::lock_guard<std::mutex> lock(evictMutex);
+            if (++storesSinceEvict >= kStoresPerEvict)
+            {
+                storesSinceEvict = 0;
+                shouldEvict = true;
+            }
+        }
+        if (shouldEvict)
+            evict();
+    }
+
+    String CompileCache::getStdlibPath()
+    {
+        // The library is only any good to the build that serialized it
+        StringBuilder sb;
+        sb << "stdlib-";
+        appendHex(sb, getCompilerBuildID());
+        sb << kStdlibFileExtension;
+        return Path::Combine(directory, sb.ProduceString());
+    }
+
+    bool CompileCache::tryLoadStdlib(List<unsigned char>& outData, UInt* outModuleCount)
+    {
+        List<unsigned char> data;
+        if (!readFile(getStdlibPath(), data))
+            return false;
+
+        CacheReader reader;
+        reader.cursor = data.Buffer();
+        reader.end = data.Buffer() + data.Count();
+
+        if (reader.readUInt32() != kStdlibFileMagic)
+            return false;
+        if (reader.readUInt32() != kStdlibFileVersion)
+            return false;
+        if (reader.readUInt64() != getCompilerBuildID())
+            return false;
+
+        UInt moduleCount = reader.readUInt32();
+        List<unsigned char> blob;
+        reader.readBlob(blob);
+        if (!reader.valid || reader.cursor != reader.end || !moduleCount)
+            return false;
+
+        outData = _Move(blob);
+        *outModuleCount = moduleCount;
+        return true;
+    }
+
+    void CompileCache::storeStdlib(List<unsigned char> const& data, UInt moduleCount)
+    {
+        // Don't replace a file that already has more of the library,
+        // e.g., because another process has used more of it than we have.
+        List<unsigned char> existingData;
+        UInt existingModuleCount = 0;
+        if (tryLoadStdlib(existingData, &existingModuleCount) && existingModuleCount >= moduleCount)
+            return;
+
+        CacheWriter writer;
+        writer.writeUInt32(kStdlibFileMagic);
+        writer.writeUInt32(kStdlibFileVersion);
+        writer.writeUInt64(getCompilerBuildID());
+        writer.writeUInt32((uint32_t)moduleCount);
+        writer.writeBlob(data);
+
+        String path = getStdlibPath();
+        if (!writeFileAtomically(directory, "stdlib", path, writer.data))
+            return;
+
+        // No other build of the compiler can use our library, and we
+        // can't use theirs, so the files left by older builds would
+        // otherwise pile up. (If one of those builds is still running,
+        // it will just serialize and store its library again.)
+        for (auto& file : findCacheFiles(directory, kStdlibFileExtension))
+        {
+            if (file.path != path && Path::GetFileName(file.path).StartsWith("stdlib-"))
+                deleteFile(file.path);
+        }
+    }
+
+    bool CompileCache::loadLayout(CompileRequest* request)
+    {
+        auto& cachedSyntax = request->cachedSyntax;
+        if (!cachedSyntax.blob.Count())
+            return false;
+
+        // The syntax refers to the builtin modules that compiling the
+        // request would have loaded, so we need to load those first,
+        // and they need to be the same ones as when it was saved.
+        for (auto& translationUnit : request->translationUnits)
+            request->mSession->getLanguageScope(translationUnit->sourceLanguage);
+
+        UInt builtinModuleCount = 0;
+        List<RefObject*> builtinObjects = request->mSession->getBuiltinObjects(&builtinModuleCount);
+        if (builtinModuleCount != cachedSyntax.builtinModuleCount
+            || builtinObjects.Count() != cachedSyntax.builtinObjectCount)
+        {
+            return false;
+        }
+
+        RefPtr<SerializedModuleReader> reader = new SerializedModuleReader(
+            cachedSyntax.blob.Buffer(),
+            cachedSyntax.blob.Count(),
+            builtinObjects,
+            request->sourceManager,
+            request->namePool);
+        if (!reader->isValid())
+            return false;
+
+        UInt translationUnitCount = request->translationUnits.Count();
+        if (reader->getModuleCount() != cachedSyntax.importedModuleCount + translationUnitCount)
+            return false;
+
+        List<RefPtr<ProgramSyntaxNode>> modules;
+        for (UInt ii = 0; ii < reader->getModuleCount(); ++ii)
+        {
+            RefPtr<ProgramSyntaxNode> module = reader->loadModule(ii);
+            if (!module)
+                return false;
+            modules.Add(module);
+        }
+
+        // Everything loaded, so we can fill in the request
+        for (UInt ii = 0; ii < cachedSyntax.importedModuleCount; ++ii)
+            request->loadedModulesList.Add(modules[ii]);
+        for (UInt ii = 0; ii < translationUnitCount; ++ii)
+            request->translationUnits[ii]->SyntaxNode = modules[cachedSyntax.importedModuleCount + ii];
+        cachedSyntax.reader = reader;
+
+        generateParameterBindings(request);
+        return true;
+    }
+
+    void CompileCache::evict()
+    {
+        // Temporary files don't count as entries, so we remove the
+        // ones that will never get moved into place on their own.
+        // A recent one may still be being written.
+        uint64_t now = (uint64_t)time(nullptr);
+        for (auto& file : findCacheFiles(directory, kTempFileExtension))
+        {
+            if (file.lastUsedTime + kStaleTempFileAge < now)
+                deleteFile(file.path);
+        }
+
+        List<CacheFileInfo> files = findCacheFiles(directory, kCompileCacheExtension);
+
+        uint64_t totalSize = 0;
+        for (auto& file : files)
+            totalSize += file.size;
+        if (totalSize <= maxSize)
+            return;
+
+        // Remove the least recently used entries first. Another
+        // process might be doing the same thing, but the worst that
+        // can happen is that we both remove an entry.
+        files.Sort([](CacheFileInfo const& a, CacheFileInfo const& b)
+        {
+            return a.lastUsedTime < b.lastUsedTime;
+        });
+
+        uint64_t targetSize = getEvictTargetSize(maxSize);
+        for (auto& file : files)
+        {
+            if (totalSize <= targetSize)
+                break;
+            deleteFile(file.path);
+            totalSize -= file.size;
+        }
+    }
+}
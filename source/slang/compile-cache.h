@@ -0,0 +1,90 @@
+// compile-cache.h
+#ifndef SLANG_COMPILE_CACHE_H_INCLUDED
+#define SLANG_COMPILE_CACHE_H_INCLUDED
+
+// This file provides a persistent cache of compile results, kept in
+// a directory (the `cacheDir` given to `spCreateSession()`) that any
+// number of processes may share.
+//
+// Each entry is keyed on a hash of everything about a request that
+// affects its output, except for the files it includes or imports,
+// since we can't know those without running the front end. Instead,
+// an entry records those files with a hash of their contents, along
+// with where each `#include` found its file, and it is only used if
+// none of them have changed and every `#include` finds the same file.
+//
+// An entry also holds the checked syntax of the request, so that the
+// reflection layout for a request whose output came from the cache
+// can be generated without running the front end again.
+//
+// The directory also holds the serialized standard library, so that
+// a new process doesn't have to compile the library from source.
+
+#include "compiler.h"
+
+#include <mutex>
+
+namespace Slang
+{
+    class CompileCache : public RefObject
+    {
+    public:
+        enum : uint64_t
+        {
+            kDefaultMaxSize = 256 * 1024 * 1024,
+        };
+
+        CompileCache(String const& directory);
+
+        // Get an identifier for the build of the compiler we are running
+        // in, which is part of every key. Returns zero if we can't tell,
+        // in which case the cache shouldn't be used.
+        static uint64_t getCompilerBuildID();
+
+        // Compute the key for the entry that would hold the results
+        // of `request`, which must not have been executed yet.
+        static String computeKey(CompileRequest* request);
+
+        // Fill in the results of `request` from the entry for `key`.
+        // Returns false if there is no such entry, or if any of the
+        // files the entry was compiled from have changed.
+        bool tryLoad(String const& key, CompileRequest* request);
+
+        // Save the results of `request` as the entry for `key`.
+        void store(String const& key, CompileRequest* request);
+
+        // Generate the layout for a request that `tryLoad()` filled in,
+        // from the checked syntax that was saved with the entry. Returns
+        // false if the entry didn't have it, or it couldn't be loaded.
+        static bool loadLayout(CompileRequest* request);
+
+        // Load the serialized standard library that an earlier session
+        // (possibly in another process) stored with `storeStdlib()`,
+        // along with how many of the library modules it holds.
+        bool tryLoadStdlib(List<unsigned char>& outData, UInt* outModuleCount);
+
+        // Save the serialized standard library, unless there is already
+        // one that holds at least as many modules. Saving it removes the
+        // libraries stored by other builds of the compiler.
+        void storeStdlib(List<unsigned char> const& data, UInt moduleCount);
+
+        // Once the entries take up more than this many bytes, the
+        // least recently used ones get removed.
+        uint64_t maxSize = kDefaultMaxSize;
+
+    private:
+        String getEntryPath(String const& key);
+        String getStdlibPath();
+
+        // Remove entries until we are under the size limit.
+        void evict();
+
+        String directory;
+
+        // The number of entries stored since we last checked the size
+        std::mutex  evictMutex;
+        int         storesSinceEvict = 0;
+    };
+}
+
+#endif
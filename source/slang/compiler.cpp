@@ -185,28 +185,55 @@ namespace Slang
         }
     }
 
-#ifdef _WIN32
-    void* GetD3DCompilerDLL()
+    void* Session::getExternalCompilerFunc(ExternalCompilerFunc func)
     {
-        // TODO(tfoley): let user specify version of d3dcompiler DLL to use.
-        static HMODULE d3dCompiler =  LoadLibraryA("d3dcompiler_47");
-        // TODO(tfoley): handle case where we can't find it gracefully
-        assert(d3dCompiler);
-        return d3dCompiler;
+#ifdef _WIN32
+        // Several requests might need a compiler at once, so the
+        // libraries get loaded (once per session) under a lock.
+        std::lock_guard<std::mutex> lock(externalCompilerMutex);
+
+        void*& result = externalCompilerFuncs[(int)func];
+        if (result)
+            return result;
+
+        switch (func)
+        {
+        case ExternalCompilerFunc::D3DCompile:
+        case ExternalCompilerFunc::D3DDisassemble:
+            // TODO(tfoley): let user specify version of d3dcompiler DLL to use.
+            if (!d3dCompilerLibrary)
+                d3dCompilerLibrary = LoadLibraryA("d3dcompiler_47");
+            // TODO(tfoley): handle case where we can't find it gracefully
+            assert(d3dCompilerLibrary);
+            result = (void*)GetProcAddress((HMODULE)d3dCompilerLibrary,
+                func == ExternalCompilerFunc::D3DCompile ? "D3DCompile" : "D3DDisassemble");
+            break;
+
+        case ExternalCompilerFunc::GLSLangCompile:
+            // TODO(tfoley): let user specify version of glslang DLL to use.
+            if (!glslangLibrary)
+                glslangLibrary = LoadLibraryA("glslang");
+            assert(glslangLibrary);
+            result = (void*)GetProcAddress((HMODULE)glslangLibrary, "glslang_compile");
+            break;
+
+        default:
+            break;
+        }
+        assert(result);
+        return result;
+#else
+        (void)func;
+        return nullptr;
+#endif
     }
 
+#ifdef _WIN32
     List<uint8_t> EmitDXBytecodeForEntryPoint(
         EntryPointRequest*  entryPoint)
     {
-        static pD3DCompile D3DCompile_ = nullptr;
-        if (!D3DCompile_)
-        {
-            HMODULE d3dCompiler = (HMODULE)GetD3DCompilerDLL();
-            assert(d3dCompiler);
-
-            D3DCompile_ = (pD3DCompile)GetProcAddress(d3dCompiler, "D3DCompile");
-            assert(D3DCompile_);
-        }
+        auto D3DCompile_ = (pD3DCompile)entryPoint->compileRequest->mSession->getExternalCompilerFunc(
+            ExternalCompilerFunc::D3DCompile);
 
         auto hlslCode = emitHLSLForEntryPoint(entryPoint);
 
@@ -274,15 +301,8 @@ namespace Slang
     List<uint8_t> EmitDXBytecodeAssemblyForEntryPoint(
         EntryPointRequest*  entryPoint)
     {
-        static pD3DDisassemble D3DDisassemble_ = nullptr;
-        if (!D3DDisassemble_)
-        {
-            HMODULE d3dCompiler = (HMODULE)GetD3DCompilerDLL();
-            assert(d3dCompiler);
-
-            D3DDisassemble_ = (pD3DDisassemble)GetProcAddress(d3dCompiler, "D3DDisassemble");
-            assert(D3DDisassemble_);
-        }
+        auto D3DDisassemble_ = (pD3DDisassemble)entryPoint->compileRequest->mSession->getExternalCompilerFunc(
+            ExternalCompilerFunc::D3DDisassemble);
 
         List<uint8_t> dxbc = EmitDXBytecodeForEntryPoint(entryPoint);
         if (!dxbc.Count())
@@ -332,31 +352,14 @@ namespace Slang
 #endif
 
 
-    HMODULE getGLSLCompilerDLL()
-    {
-        // TODO(tfoley): let user specify version of glslang DLL to use.
-        static HMODULE glslCompiler =  LoadLibraryA("glslang");
-        // TODO(tfoley): handle case where we can't find it gracefully
-        assert(glslCompiler);
-        return glslCompiler;
-    }
-
-
     List<uint8_t> emitSPIRVForEntryPoint(
         EntryPointRequest*  entryPoint,
         bool spirvAssembly)
     {
         String rawGLSL = emitGLSLForEntryPoint(entryPoint);
 
-        static glslang_CompileFunc glslang_compile = nullptr;
-        if (!glslang_compile)
-        {
-            HMODULE glslCompiler = getGLSLCompilerDLL();
-            assert(glslCompiler);
-
-            glslang_compile = (glslang_CompileFunc)GetProcAddress(glslCompiler, "glslang_compile");
-            assert(glslang_compile);
-        }
+        auto glslang_compile = (glslang_CompileFunc)entryPoint->compileRequest->mSession->getExternalCompilerFunc(
+            ExternalCompilerFunc::GLSLangCompile);
 
         List<uint8_t> diagnosticOutput;
         List<uint8_t> output;
@@ -9,11 +9,18 @@
 
 #include "../../slang.h"
 
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
 namespace Slang
 {
     struct IncludeHandler;
+    class CompileCache;
     class CompileRequest;
     class ProgramLayout;
+    class SerializedModuleReader;
+    struct SerializedStdlib;
 
     enum class CompilerMode
     {
@@ -110,18 +117,6 @@ namespace Slang
 //			GLSL,	// pass through GLSL to `glslang` library
     };
 
-    // Represents a single source file (either an on-disk file, or a
-    // "virtual" file passed in as a string)
-    class SourceFile : public RefObject
-    {
-    public:
-        // The file path for a real file, or the nominal path for a virtual file
-        String path;
-
-        // The actual contents of the file
-        String content;
-    };
-
     // A single translation unit requested to be compiled.
     //
     class TranslationUnitRequest : public RefObject
@@ -149,6 +144,11 @@ namespace Slang
         // Compile flags for this translation unit
         SlangCompileFlags compileFlags = 0;
 
+        // The preprocessed tokens of each source file, between
+        // preprocessing and parsing, if the translation unit was
+        // preprocessed ahead of time (see `preprocessTranslationUnit()`)
+        List<TokenList> preprocessedTokens;
+
         // The parsed syntax for the translation unit
         RefPtr<ProgramSyntaxNode>   SyntaxNode;
 
@@ -172,12 +172,164 @@ namespace Slang
 
     class Session;
 
+    // A file that some code was read from, along with a hash of
+    // what it contained at the time, so that we can tell if the
+    // file has changed since.
+    struct SourceDependency
+    {
+        String      path;
+        uint64_t    contentHash;
+
+        // When the file was last modified and how big it was when we
+        // read it, so that we can usually tell that it hasn't changed
+        // without reading it again. The time is -1 if we don't know.
+        int64_t     modifiedTime = -1;
+        int64_t     size = 0;
+    };
+
+    // Get the hash we use to tell if a file's contents have changed
+    uint64_t getContentHash(String const& contents);
+
+    // Where an `#include` (or `import`) found its file, so that we can
+    // tell if it would now find a different one (e.g., because a file
+    // has since been added earlier in the search path).
+    struct IncludeLookup
+    {
+        String      pathToInclude;
+        String      pathIncludedFrom;
+        String      foundPath;
+    };
+
+    // A module that was loaded through `import`, along with what we
+    // need to know to reuse it in another compile request.
+    class LoadedModule : public RefObject
+    {
+    public:
+        // The name the module was first imported by
+        String name;
+
+        // The path of the module's source file
+        String path;
+
+        // The arena that the module's AST and types are allocated from,
+        // so that sharing the module with other requests doesn't keep
+        // the arena of the request that loaded it alive. This comes
+        // before `syntax`, so that it is released after it.
+        RefPtr<SyntaxArena> syntaxArena;
+
+        RefPtr<ProgramSyntaxNode> syntax;
+
+        // Every file the module was built from: its own source file,
+        // anything it includes, and the files of any modules it imports
+        // (directly or indirectly).
+        List<SourceDependency> files;
+
+        // How each of the `#include`s and `import`s in those files
+        // found the file it refers to
+        List<IncludeLookup> includeLookups;
+
+        // The modules this one imports, in the order they were loaded
+        List<RefPtr<LoadedModule>> dependencies;
+
+        // Can other requests reuse this module? This is false if loading
+        // the module produced diagnostics (which a later request would
+        // otherwise miss), or if it used `#import` (which shares macros
+        // with the importing code).
+        bool canShare = true;
+
+        void addFile(SourceDependency const& file);
+        void addIncludeLookup(IncludeLookup const& lookup);
+    };
+
+    // A file read by `#include`, along with its tokens, so that
+    // a file that gets included again doesn't need to be read or
+    // lexed again.
+    //
+    // Once a file has been lexed it doesn't change, and may be shared
+    // with other requests (see `Session::sharedIncludedFiles`). The
+    // exception is a file with `#line` directives, since those get
+    // recorded on its `SourceFile` as it is preprocessed.
+    class IncludedFile : public RefObject
+    {
+    public:
+        // The text of the file, and when it was last modified and how
+        // big it was when we read it. The time is -1 if the text didn't
+        // come straight from the file system.
+        String              source;
+        int64_t             modifiedTime = -1;
+        int64_t             size = 0;
+
+        // Set once the file has been lexed
+        RefPtr<SourceFile>  sourceFile;
+        TokenList           tokens;
+
+        // The macro that guards the whole file, if any
+        // (see `findIncludeGuard()`)
+        Name*               includeGuard = nullptr;
+
+        // Whether the file has any `#line` directives
+        // (see `containsLineDirective()`)
+        bool                hasLineDirective = false;
+    };
+
+    // The checked syntax of a request, as saved in a compile cache entry
+    // (see `serializeModules()`). The blob holds the modules the request
+    // imported, followed by its translation units, and refers to the
+    // builtin modules by their index in `Session::getBuiltinObjects()`.
+    struct CachedSyntax
+    {
+        List<unsigned char> blob;
+
+        // What the session's builtin objects were when the blob was
+        // saved, which need to match for us to load it again
+        UInt                builtinModuleCount = 0;
+        UInt                builtinObjectCount = 0;
+
+        UInt                importedModuleCount = 0;
+
+        // Reads the blob, once it has been loaded. This holds on to the
+        // objects that the syntax only refers to with raw pointers.
+        RefPtr<SerializedModuleReader> reader;
+    };
+
+    // One of the sets of preprocessor definitions that a request is
+    // compiled with (see `spAddPermutation()`), and the results.
+    class PermutationRequest : public RefObject
+    {
+    public:
+        // Definitions to use for the translation units of the request,
+        // along with their own. These don't apply to imported modules.
+        Dictionary<String, String> preprocessorDefinitions;
+
+        // The request that compiled the code for this permutation.
+        // Permutations whose translation units preprocess to the
+        // same tokens share a single request.
+        RefPtr<CompileRequest> compileRequest;
+
+        // The output for each translation unit and entry point, as
+        // indices into the parent request's `permutationResults`
+        List<UInt> translationUnitResults;
+        List<UInt> entryPointResults;
+    };
+
     class CompileRequest : public RefObject
     {
     public:
         // Pointer to parent session
         Session* mSession;
 
+        // The session-wide source manager, which allocates the
+        // locations of the files we load, and maps them back
+        SourceManager* sourceManager;
+
+        // The session-wide pool of interned names
+        NamePool* namePool;
+
+        // The arena that the AST nodes and types created for this
+        // request are allocated from (requests that load the standard
+        // library use the session's arena instead).
+        RefPtr<SyntaxArena> syntaxArena;
+
         // What target language are we compiling to?
         CodeGenTarget Target = CodeGenTarget::Unknown;
 
@@ -212,11 +364,26 @@ namespace Slang
         String mDiagnosticOutput;
 
         // Files that compilation depended on
-        List<String> mDependencyFilePaths;
+        List<SourceDependency> mDependencyFiles;
+
+        // How each `#include` and `import` found its file
+        List<IncludeLookup> mIncludeLookups;
 
         // The resulting reflection layout information
+        //
+        // This is null if the output came from the session's compile
+        // cache, until someone asks for it (see `getLayout()`).
         RefPtr<ProgramLayout> layout;
 
+        // Did the output come from the session's compile cache?
+        bool loadedFromCache = false;
+
+        // The checked syntax saved with the compile cache entry that the
+        // output came from, if the entry had it, so that the layout can
+        // be generated without running the front end again (see
+        // `CompileCache::loadLayout()`).
+        CachedSyntax cachedSyntax;
+
         // Modules that have been dynamically loaded via `import`
         //
         // This is a list of unique modules loaded, in the order they were encountered.
@@ -228,22 +395,210 @@ namespace Slang
         // Map from the path of a module file to its definition
         Dictionary<String, RefPtr<ProgramSyntaxNode>> mapNameToLoadedModules;
 
+        // Information about each of the modules loaded through `import`
+        Dictionary<ProgramSyntaxNode*, RefPtr<LoadedModule>> mapSyntaxToLoadedModule;
+
+        // The modules that are being loaded right now, innermost last
+        List<LoadedModule*> moduleLoadStack;
+
+        // Is this request compiling the standard library?
+        bool compilingBuiltins = false;
+
+        // The permutations to compile the translation units with. If
+        // there are any, the ordinary results of the request are
+        // those of the first permutation.
+        List<RefPtr<PermutationRequest>> permutations;
+
+        // The distinct outputs of all the permutations
+        List<CompileResult> permutationResults;
+
+        // The request that this one was created to compile a
+        // permutation for, if any
+        CompileRequest* parentRequest = nullptr;
+
+        // Files read by `#include`, keyed on their path. Requests for
+        // permutations share the cache of their parent.
+        Dictionary<String, RefPtr<IncludedFile>> includedFiles;
+
+        // The text of macros defined through the API or command line
+        // (e.g., `-DFOO=1`), keyed on the text. Requests for permutations
+        // share the files of their parent, so that the same definition
+        // has the same locations in every permutation.
+        Dictionary<String, RefPtr<SourceFile>> commandLineSourceFiles;
+
+        // Extensions declared by the code in this request (including
+        // any modules it imports), keyed on the extended type. These
+        // are kept here, rather than linked into the type, because the
+        // type and the extension might both be shared with other requests.
+        Dictionary<AggTypeDecl*, List<ExtensionDecl*>> candidateExtensions;
+
+        // Results of looking up names from scopes during semantic checking
+        // (see `SemanticsVisitor::LookUpCached()`). Anything that can change
+        // the result of a lookup (adding a member to a declaration, adding
+        // an extension, or importing a module into a scope) needs to call
+        // `invalidateLookupCache()`.
+        struct LookupCacheKey
+        {
+            Scope*      scope;
+            Name*       name;
+            LookupMask  mask;
+
+            int GetHashCode() const
+            {
+                return int(UInt(Slang::GetHashCode(scope)) * 16777619) ^ Slang::GetHashCode(name) ^ int(mask);
+            }
+            bool operator==(LookupCacheKey const& other) const
+            {
+                return scope == other.scope && name == other.name && mask == other.mask;
+            }
+        };
+        struct LookupCacheEntry
+        {
+            // Keeps the scope alive, so that its address can't be reused
+            RefPtr<Scope>   scope;
+            LookupResult    result;
+        };
+        Dictionary<LookupCacheKey, LookupCacheEntry> lookupCache;
+        UInt lookupCount = 0;
+        UInt lookupCacheHitCount = 0;
+
+        // The members that extensions add to each type, keyed on the
+        // `GetCanonicalTypeId()` of the type. These are built when
+        // lookup first needs them, and thrown away with the lookup cache.
+        Dictionary<uint64_t, RefPtr<ExtensionMemberTable>> extensionMemberTables;
+
+        // The arguments inferred for calls to generic functions (see
+        // `SemanticsVisitor::SpecializeGenericForOverload()`), keyed on
+        // the generic and the `GetCanonicalTypeId()` of each argument
+        // type. A null result records that inference failed. Solving
+        // can depend on which extensions are visible, so these are
+        // thrown away with the lookup cache.
+        struct GenericInferenceKey
+        {
+            GenericDecl*    genericDecl;
+
+            // Substitutions for any outer generics, which must be
+            // interned (so that they can be compared by address)
+            Substitutions*  outer;
+
+            List<uint64_t>  argTypeIds;
+
+            int GetHashCode() const
+            {
+                int hash = int(UInt(Slang::GetHashCode(genericDecl)) * 16777619) ^ Slang::GetHashCode(outer);
+                for (auto id : argTypeIds)
+                    hash = int(UInt(hash) * 16777619) ^ int(id);
+                return hash;
+            }
+            bool operator==(GenericInferenceKey const& other) const
+            {
+                if (genericDecl != other.genericDecl || outer != other.outer)
+                    return false;
+                if (argTypeIds.Count() != other.argTypeIds.Count())
+                    return false;
+                for (UInt ii = 0; ii < argTypeIds.Count(); ++ii)
+                {
+                    if (argTypeIds[ii] != other.argTypeIds[ii])
+                        return false;
+                }
+                return true;
+            }
+        };
+        struct GenericInferenceEntry
+        {
+            // Keeps the outer substitutions alive, so that
+            // their address can't be reused
+            RefPtr<Substitutions>   outer;
+            RefPtr<Substitutions>   solvedSubst;
+        };
+        Dictionary<GenericInferenceKey, GenericInferenceEntry> genericInferenceCache;
+
+        void invalidateLookupCache()
+        {
+            if (lookupCache.Count())
+                lookupCache = Dictionary<LookupCacheKey, LookupCacheEntry>();
+            if (extensionMemberTables.Count())
+                extensionMemberTables = Dictionary<uint64_t, RefPtr<ExtensionMemberTable>>();
+            if (genericInferenceCache.Count())
+                genericInferenceCache = Dictionary<GenericInferenceKey, GenericInferenceEntry>();
+        }
+
+        // Substitutions created while checking this request are interned
+        // here, along with the types we got by applying them. This is
+        // null when compiling the standard library, whose syntax is
+        // shared with every request in the session.
+        RefPtr<SubstitutionCache> substitutionCache;
+
+
+        CompileRequest(Session* session);
+
+        ~CompileRequest();
+
+        // Get the macros to define when preprocessing a translation unit
+        Dictionary<String, String> getPreprocessorDefinitions(
+            TranslationUnitRequest* translationUnit);
 
-        CompileRequest(Session* session)
-            : mSession(session)
-        {}
-
-        ~CompileRequest()
-        {}
+        // Preprocess the whole of a translation unit ahead of parsing it,
+        // for when the tokens are needed for more than just parsing
+        void preprocessTranslationUnit(
+            TranslationUnitRequest* translationUnit);
 
+        // Parse a translation unit, preprocessing it on the way if
+        // `preprocessTranslationUnit()` hasn't already done so
         void parseTranslationUnit(
             TranslationUnitRequest* translationUnit);
 
+        // Read a file found by `#include` or `import`, unless we (or an
+        // earlier request in the session) have already read it, and it
+        // hasn't changed since. Returns false if the file doesn't exist.
+        bool readIncludedFile(
+            String const&   path,
+            String*         outSource);
+
+        // Get the tokens of a file found by `#include`, only lexing
+        // it if we haven't already seen the same file.
+        RefPtr<IncludedFile> getIncludedFile(
+            String const&   path,
+            String const&   source,
+            DiagnosticSink* sink);
+
+        // Get the source file for the value of a macro defined through the
+        // API or command line, allocating it the first time it is used.
+        SourceFile* getCommandLineSourceFile(
+            String const&   text,
+            DiagnosticSink* sink);
+
+        void lexIncludedFile(
+            IncludedFile*   includedFile,
+            String const&   path,
+            DiagnosticSink* sink);
+
         void checkAllTranslationUnits();
 
+        // Parse and check the translation units, and generate
+        // the reflection layout for them.
+        int runFrontEnd();
+
         int executeActionsInner();
         int executeActions();
 
+        // Compile each of the permutations in turn
+        int executePermutations();
+
+        // Create a request to compile the given permutation
+        RefPtr<CompileRequest> createPermutationRequest(
+            PermutationRequest* permutation);
+
+        // Get a key that identifies the preprocessed tokens of all the
+        // translation units. Returns false if the results of compiling
+        // the tokens could depend on more than that (e.g., `#import`).
+        bool getPreprocessedTokensKey(
+            String& outKey);
+
+        // Get the reflection layout, running the front end
+        // to produce it if the output came from the cache.
+        ProgramLayout* getLayout();
+
         int addTranslationUnit(SourceLanguage language, String const& name);
 
         void addTranslationUnitSourceString(
@@ -260,11 +615,58 @@ namespace Slang
             String const&           name,
             Profile                 profile);
 
+        // Note that code being compiled depends on the given file
+        void addDependencyFile(
+            String const&   path,
+            String const&   contents);
+
+        // Get the dependency record for a file that holds `contents`
+        SourceDependency getSourceDependency(
+            String const&   path,
+            String const&   contents);
+
+        // Get the paths that an `#include` of `pathToInclude` (or an
+        // `import`) from `pathIncludedFrom` tries, in order
+        List<String> getIncludeCandidatePaths(
+            String const&   pathToInclude,
+            String const&   pathIncludedFrom);
+
+        // Find the file that an `#include` (or `import`) would find now,
+        // or an empty string if it wouldn't find one
+        String findIncludedFile(
+            IncludeLookup const&    lookup);
+
+        // Note that an `#include` or `import` found the file at `foundPath`
+        void addIncludeLookup(
+            String const&   pathToInclude,
+            String const&   pathIncludedFrom,
+            String const&   foundPath);
+
+        // Note that the module currently being loaded (if any)
+        // imports `module`.
+        void addModuleDependency(
+            ProgramSyntaxNode*  module);
+
+        // Get a string that captures the options that affect the
+        // result of loading a module, for use in cache keys.
+        String getModuleOptionsKey();
+
+        // Add a module that was loaded by another request (along
+        // with the modules it imports) to this request. Returns false
+        // if that would conflict with modules this request has loaded.
+        bool addSharedModule(
+            LoadedModule*   module);
+
+        // Make an extension visible to code in this request
+        void addCandidateExtension(
+            AggTypeDecl*    aggTypeDecl,
+            ExtensionDecl*  extDecl);
+
         RefPtr<ProgramSyntaxNode> loadModule(
             String const&       name,
             String const&       path,
             String const&       source,
-            CodePosition const& loc);
+            SourceLoc const&    loc);
 
         void handlePoundImport(
             String const&       path,
@@ -272,7 +674,245 @@ namespace Slang
 
         RefPtr<ProgramSyntaxNode> findOrImportModule(
             String const&       name,
-            CodePosition const& loc);
+            SourceLoc const&    loc);
+    };
+
+    // The modules that make up the standard library, in the
+    // order they get loaded.
+    enum class StdlibModule
+    {
+        Core,
+        HLSL,
+        GLSL,
+
+        Count,
+    };
+
+    // Functions we use from external compilers
+    enum class ExternalCompilerFunc
+    {
+        D3DCompile,
+        D3DDisassemble,
+        GLSLangCompile,
+
+        Count,
+    };
+
+    // A session holds the state that can be shared by all of the
+    // compile requests made against it, such as the standard library.
+    //
+    // Requests on several threads can use a session at once. Once the
+    // session has been set up (including any `spAddBuiltins()` calls),
+    // the only state in it that changes is guarded by a lock: the
+    // standard library modules it loads on demand, the source files and
+    // names added by each request, the imported modules that requests
+    // share, and the external compilers it loads. Everything else a
+    // request changes belongs to the request.
+    class Session
+    {
+    public:
+        bool useCache = false;
+        String cacheDir;
+
+        // The on-disk cache of compile results in `cacheDir`, if any
+        RefPtr<CompileCache> compileCache;
+
+        // A hash of the code added with `spAddBuiltins()`, which
+        // is part of the key for any cached compile results
+        uint64_t addedBuiltinsHash = 0;
+
+        // Allocates the locations of all the source files loaded in
+        // this session (including the standard library code), so that
+        // source locations are unique across compile requests.
+        SourceManager   sourceManager;
+
+        // Interned names for all the identifiers seen in this session
+        NamePool        namePool;
+
+        // Arena for session-lifetime syntax, such as the standard library.
+        // Any request may allocate from it (e.g., for interned types).
+        RefPtr<SyntaxArena> syntaxArena;
+
+        // The builtin types of the standard library, and the like
+        RefPtr<SessionTypes> types;
+
+        // The scopes for the builtins of each language. These are
+        // created up front, but the library code that fills them in
+        // is only loaded when a translation unit needs it (see
+        // `getLanguageScope()`).
+        RefPtr<Scope>   coreLanguageScope;
+        RefPtr<Scope>   hlslLanguageScope;
+        RefPtr<Scope>   slangLanguageScope;
+        RefPtr<Scope>   glslLanguageScope;
+
+        List<RefPtr<ProgramSyntaxNode>> loadedModuleCode;
+
+        struct StdlibModuleInfo
+        {
+            RefPtr<ProgramSyntaxNode>   syntax;
+
+            // Did we get the module from the serialized library?
+            bool                        deserialized = false;
+
+            // How long it took to load the module, in seconds
+            double                      initTime = 0;
+        };
+        StdlibModuleInfo stdlibModules[(int)StdlibModule::Count];
+
+        // Held while loading standard library modules, so that
+        // a thread only sees a scope after it is fully built.
+        // This is recursive because compiling one module from
+        // source triggers loading of the modules it needs.
+        std::recursive_mutex stdlibMutex;
+
+        // The result of `getBuiltinObjects()`, which we only gather
+        // again if more builtin modules get loaded
+        List<RefObject*>    builtinObjects;
+        UInt                builtinObjectsModuleCount = 0;
+
+        // Set while we load a module, so that compiling the library
+        // code doesn't try to load more of the library
+        bool isLoadingStdlib = false;
+
+        // Reader for the serialized standard library, if we are loading
+        // modules that way, along with the blob it reads from
+        RefPtr<SerializedStdlib>        stdlibBlob;
+        RefPtr<SerializedModuleReader>  stdlibReader;
+
+        // Modules loaded through `import` that later requests can reuse,
+        // keyed on the canonical path of the module file and the options
+        // that affect how it is loaded (see `findSharedModule()`).
+        Dictionary<String, RefPtr<LoadedModule>> sharedModules;
+        std::mutex  sharedModuleMutex;
+        UInt        sharedModuleHitCount = 0;
+        UInt        sharedModuleMissCount = 0;
+
+        // Files read (and lexed) by `#include`, keyed on their path, that
+        // later requests can reuse as long as the file has the same
+        // modification time and size (see `findSharedIncludedFile()`).
+        // Files that produced diagnostics when lexed aren't shared.
+        Dictionary<String, RefPtr<IncludedFile>>    sharedIncludedFiles;
+        std::mutex                                  sharedIncludedFileMutex;
+
+        // How much reading and lexing was avoided by reusing
+        // included files, within and across requests
+        std::atomic<UInt>   includedFileBytesSaved{ 0 };
+        std::atomic<UInt>   includedFileTokensSaved{ 0 };
+
+        // How many `#include`s were skipped because of an include
+        // guard or `#pragma once` (see `findIncludeGuard()`)
+        std::atomic<UInt>   includesSkipped{ 0 };
+
+        // Whether (and at what cost) one type can be implicitly converted
+        // to another, for pairs of types where the answer doesn't depend
+        // on the code being checked (see `SemanticsVisitor::CanCoerce()`).
+        // The types are identified by `GetCanonicalTypeId()`.
+        struct CoercionKey
+        {
+            uint64_t toTypeId;
+            uint64_t fromTypeId;
+
+            int GetHashCode() const
+            {
+                return (int)(toTypeId * 16777619) ^ (int)fromTypeId;
+            }
+            bool operator==(CoercionKey const& other) const
+            {
+                return toTypeId == other.toTypeId && fromTypeId == other.fromTypeId;
+            }
+        };
+        struct CoercionResult
+        {
+            bool            canCoerce;
+            unsigned int    cost;
+        };
+        Dictionary<CoercionKey, CoercionResult> coercionCache;
+        std::shared_timed_mutex                 coercionCacheMutex;
+        std::atomic<UInt>                       coercionCacheHitCount{ 0 };
+        std::atomic<UInt>                       coercionCacheMissCount{ 0 };
+
+        // The libraries and functions of the external compilers,
+        // loaded the first time they are needed
+        std::mutex  externalCompilerMutex;
+        void*       externalCompilerFuncs[(int)ExternalCompilerFunc::Count] = {};
+        void*       d3dCompilerLibrary = nullptr;
+        void*       glslangLibrary = nullptr;
+
+        Session(bool useCache, String cacheDir);
+        ~Session();
+
+        // Get the scope to use for code in the given language,
+        // after loading the library code that it needs.
+        RefPtr<Scope> getLanguageScope(SourceLanguage language);
+
+        // Make sure the given standard library module, and
+        // everything it depends on, has been loaded.
+        void ensureStdlibModule(StdlibModule module);
+
+        RefPtr<ProgramSyntaxNode> compileStdlibModule(StdlibModule module);
+        RefPtr<ProgramSyntaxNode> loadSerializedStdlibModule(StdlibModule module);
+
+        void addBuiltinSource(
+            RefPtr<Scope> const&    scope,
+            String const&           path,
+            String const&           source);
+
+        RefPtr<ProgramSyntaxNode> compileBuiltinSource(
+            String const&           path,
+            String const&           source);
+
+        void addBuiltinModule(
+            RefPtr<Scope> const&                scope,
+            RefPtr<ProgramSyntaxNode> const&    syntax);
+
+        // Objects that the serialized standard library refers to,
+        // but which are owned by the session
+        List<RefObject*> getStdlibExternalObjects();
+
+        void saveSerializedStdlib();
+
+        // Get the objects that syntax saved in the compile cache refers
+        // to rather than holding copies of: the external objects of the
+        // standard library, followed by everything in `loadedModuleCode`.
+        // Also gets how many modules of `loadedModuleCode` that covers,
+        // since the same builtins may not have been loaded yet.
+        List<RefObject*> getBuiltinObjects(UInt* outModuleCount);
+
+        // Find a module that an earlier request loaded from the file
+        // at `path` (which currently holds `source`), with the same
+        // options. The module is only returned if none of the files it
+        // was built from have changed since, and if the `#include`s and
+        // `import`s in them would still find the same files when looked
+        // up from `request`.
+        RefPtr<LoadedModule> findSharedModule(
+            CompileRequest* request,
+            String const&   path,
+            String const&   optionsKey,
+            String const&   source);
+
+        // Find a file that an earlier request read and lexed from `path`,
+        // if the file still has the given modification time and size.
+        RefPtr<IncludedFile> findSharedIncludedFile(
+            String const&   path,
+            int64_t         modifiedTime,
+            int64_t         size);
+
+        // Make a file that has been read and lexed available to later requests
+        void addSharedIncludedFile(
+            String const&   path,
+            IncludedFile*   file);
+
+        bool tryGetCachedCoercion(CoercionKey const& key, CoercionResult* outResult);
+        void cacheCoercion(CoercionKey const& key, CoercionResult const& result);
+
+        // Make a module available to later requests
+        void addSharedModule(
+            String const&   optionsKey,
+            LoadedModule*   module);
+
+        // Get a function from one of the external compilers (e.g.,
+        // `D3DCompile`), or null if it isn't available.
+        void* getExternalCompilerFunc(ExternalCompilerFunc func);
     };
 
     void generateOutput(
@@ -21,7 +21,7 @@ ABSTRACT_SYNTAX_CLASS(ContainerDecl, Decl)
 
     // Dictionary for looking up members by name.
     // This is built on demand before performing lookup.
-    Dictionary<String, Decl*> memberDictionary;
+    Dictionary<Slang::Name*, Decl*> memberDictionary;
 
     // Whether the `memberDictionary` is valid.
     // Should be set to `false` if any members get added/remoed.
@@ -30,6 +30,12 @@ ABSTRACT_SYNTAX_CLASS(ContainerDecl, Decl)
     // A list of transparent members, to be used in lookup
     // Note: this is only valid if `memberDictionaryIsValid` is true
     List<TransparentMemberInfo> transparentMembers;
+
+    // Indices for the larger overload groups among the members, by name.
+    // These are only built for code shared between compile requests.
+    Dictionary<Slang::Name*, RefPtr<OverloadGroupIndex>> overloadGroupIndices;
+
+    static const bool kRawMembersNeedDestructor = true;
     )
 END_SYNTAX_CLASS()
 
@@ -84,7 +90,7 @@ RAW(
     {
         for (auto field : GetFields())
         {
-            if (field->Name.Content == name)
+            if (field->getName() == name)
                 return field.Ptr();
         }
         return nullptr;
@@ -94,7 +100,7 @@ RAW(
         int index = 0;
         for (auto field : GetFields())
         {
-            if (field->Name.Content == name)
+            if (field->getName() == name)
                 return index;
             index++;
         }
@@ -168,7 +174,7 @@ SIMPLE_SYNTAX_CLASS(SetterDecl, AccessorDecl)
 
 SIMPLE_SYNTAX_CLASS(FunctionSyntaxNode, FunctionDeclBase)
 
-SIMPLE_SYNTAX_CLASS(Variable, VarDeclBase);
+SIMPLE_SYNTAX_CLASS(Variable, VarDeclBase)
 
 // A "module" of code (essentiately, a single translation unit)
 // that provides a scope for some number of declarations.
@@ -47,6 +47,7 @@ DIAGNOSTIC(    1, Error, cannotOpenFile, "cannot open file '$0'.")
 DIAGNOSTIC(    2, Error, cannotFindFile, "cannot find file '$0'.")
 DIAGNOSTIC(    2, Error, unsupportedCompilerMode, "unsupported compiler mode.")
 DIAGNOSTIC(    4, Error, cannotWriteOutputFile, "cannot write output file '$0'.")
+DIAGNOSTIC(    5, Error, outOfSourceLocations, "too much source code has been loaded into this session to give locations to '$0'; use a new session.")
 
 //
 // 1xxxx - Lexical anaylsis
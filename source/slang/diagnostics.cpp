@@ -37,9 +37,19 @@ void printDiagnosticArg(StringBuilder& sb, Slang::String const& str)
     sb << str;
 }
 
+void printDiagnosticArg(StringBuilder& sb, UnownedStringSlice const& str)
+{
+    sb << str;
+}
+
+void printDiagnosticArg(StringBuilder& sb, Name* name)
+{
+    sb << getText(name);
+}
+
 void printDiagnosticArg(StringBuilder& sb, Decl* decl)
 {
-    sb << decl->Name.Content;
+    sb << decl->getName();
 }
 
 void printDiagnosticArg(StringBuilder& sb, ExpressionType* type)
@@ -64,20 +74,20 @@ void printDiagnosticArg(StringBuilder& sb, TokenType tokenType)
 
 void printDiagnosticArg(StringBuilder& sb, Token const& token)
 {
-    sb << token.Content;
+    sb << token.getContent();
 }
 
-CodePosition const& getDiagnosticPos(SyntaxNode const* syntax)
+SourceLoc getDiagnosticPos(SyntaxNode const* syntax)
 {
     return syntax->Position;
 }
 
-CodePosition const& getDiagnosticPos(Token const& token)
+SourceLoc getDiagnosticPos(Token const& token)
 {
     return token.Position;
 }
 
-CodePosition const& getDiagnosticPos(TypeExp const& typeExp)
+SourceLoc getDiagnosticPos(TypeExp const& typeExp)
 {
     return typeExp.exp->Position;
 }
@@ -141,12 +151,22 @@ static void formatDiagnosticMessage(StringBuilder& sb, char const* format, int a
 
 static void formatDiagnostic(
     StringBuilder&      sb,
+    SourceManager*      sourceManager,
     Diagnostic const&   diagnostic)
 {
-    sb << diagnostic.Position.FileName;
-    sb << "(";
-    sb << diagnostic.Position.Line;
-    sb << "): ";
+    HumaneSourceLoc humaneLoc;
+    if (sourceManager)
+        humaneLoc = sourceManager->getHumaneLoc(diagnostic.Position);
+
+    // A diagnostic without a location (e.g., for a file we couldn't
+    // open) names whatever it is about in its message instead.
+    if (humaneLoc.path.Length() || humaneLoc.line)
+    {
+        sb << humaneLoc.path;
+        sb << "(";
+        sb << humaneLoc.line;
+        sb << "): ";
+    }
     sb << getSeverityName(diagnostic.severity);
     sb << " ";
     sb << diagnostic.ErrorID;
@@ -155,7 +175,7 @@ static void formatDiagnostic(
     sb << "\n";
 }
 
-void DiagnosticSink::diagnoseImpl(CodePosition const& pos, DiagnosticInfo const& info, int argCount, DiagnosticArg const* const* args)
+void DiagnosticSink::diagnoseImpl(SourceLoc const& pos, DiagnosticInfo const& info, int argCount, DiagnosticArg const* const* args)
 {
     StringBuilder sb;
     formatDiagnosticMessage(sb, info.messageFormat, argCount, args);
@@ -170,13 +190,14 @@ void DiagnosticSink::diagnoseImpl(CodePosition const& pos, DiagnosticInfo const&
     {
         errorCount++;
     }
+    diagnosticCount++;
 
     // Did the client supply a callback for us to use?
     if( callback )
     {
         // If so, pass the error string along to them
         StringBuilder messageBuilder;
-        formatDiagnostic(messageBuilder, diagnostic);
+        formatDiagnostic(messageBuilder, sourceManager, diagnostic);
 
         callback(messageBuilder.ProduceString().begin(), callbackUserData);
     }
@@ -184,7 +205,7 @@ void DiagnosticSink::diagnoseImpl(CodePosition const& pos, DiagnosticInfo const&
     {
         // If the user doesn't have a callback, then just
         // collect our diagnostic messages into a buffer
-        formatDiagnostic(outputBuffer, diagnostic);
+        formatDiagnostic(outputBuffer, sourceManager, diagnostic);
     }
 
     if (diagnostic.severity >= Severity::Fatal)
@@ -46,7 +46,7 @@ namespace Slang
     {
     public:
         String Message;
-        CodePosition Position;
+        SourceLoc Position;
         int ErrorID;
         Severity severity;
 
@@ -57,7 +57,7 @@ namespace Slang
         Diagnostic(
             const String & msg,
             int id,
-            const CodePosition & pos,
+            const SourceLoc & pos,
             Severity severity)
             : severity(severity)
         {
@@ -79,6 +79,8 @@ namespace Slang
     void printDiagnosticArg(StringBuilder& sb, int val);
     void printDiagnosticArg(StringBuilder& sb, UInt val);
     void printDiagnosticArg(StringBuilder& sb, Slang::String const& str);
+    void printDiagnosticArg(StringBuilder& sb, UnownedStringSlice const& str);
+    void printDiagnosticArg(StringBuilder& sb, Name* name);
     void printDiagnosticArg(StringBuilder& sb, Decl* decl);
     void printDiagnosticArg(StringBuilder& sb, Type* type);
     void printDiagnosticArg(StringBuilder& sb, ExpressionType* type);
@@ -93,16 +95,16 @@ namespace Slang
         printDiagnosticArg(sb, ptr.Ptr());
     }
 
-    inline CodePosition const& getDiagnosticPos(CodePosition const& pos) { return pos;  }
+    inline SourceLoc getDiagnosticPos(SourceLoc const& pos) { return pos;  }
 
     class SyntaxNode;
     class ShaderClosure;
-    CodePosition const& getDiagnosticPos(SyntaxNode const* syntax);
-    CodePosition const& getDiagnosticPos(Token const& token);
-    CodePosition const& getDiagnosticPos(TypeExp const& typeExp);
+    SourceLoc getDiagnosticPos(SyntaxNode const* syntax);
+    SourceLoc getDiagnosticPos(Token const& token);
+    SourceLoc getDiagnosticPos(TypeExp const& typeExp);
 
     template<typename T>
-    CodePosition getDiagnosticPos(RefPtr<T> const& ptr)
+    SourceLoc getDiagnosticPos(RefPtr<T> const& ptr)
     {
         return getDiagnosticPos(ptr.Ptr());
     }
@@ -132,47 +134,54 @@ namespace Slang
 //            List<Diagnostic> diagnostics;
         int errorCount = 0;
 
+        // The number of diagnostics of any severity
+        int diagnosticCount = 0;
+
+        // Used to find the file and line for a source location
+        // when formatting a diagnostic message.
+        SourceManager*          sourceManager       = nullptr;
+
         SlangDiagnosticCallback callback            = nullptr;
         void*                   callbackUserData    = nullptr;
 
 /*
-        void Error(int id, const String & msg, const CodePosition & pos)
+        void Error(int id, const String & msg, const SourceLoc & pos)
         {
             diagnostics.Add(Diagnostic(msg, id, pos, Severity::Error));
             errorCount++;
         }
 
-        void Warning(int id, const String & msg, const CodePosition & pos)
+        void Warning(int id, const String & msg, const SourceLoc & pos)
         {
             diagnostics.Add(Diagnostic(msg, id, pos, Severity::Warning));
         }
 */
         int GetErrorCount() { return errorCount; }
 
-        void diagnoseDispatch(CodePosition const& pos, DiagnosticInfo const& info)
+        void diagnoseDispatch(SourceLoc const& pos, DiagnosticInfo const& info)
         {
             diagnoseImpl(pos, info, 0, NULL);
         }
 
-        void diagnoseDispatch(CodePosition const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0)
+        void diagnoseDispatch(SourceLoc const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0)
         {
             DiagnosticArg const* args[] = { &arg0 };
             diagnoseImpl(pos, info, 1, args);
         }
 
-        void diagnoseDispatch(CodePosition const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0, DiagnosticArg const& arg1)
+        void diagnoseDispatch(SourceLoc const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0, DiagnosticArg const& arg1)
         {
             DiagnosticArg const* args[] = { &arg0, &arg1 };
             diagnoseImpl(pos, info, 2, args);
         }
 
-        void diagnoseDispatch(CodePosition const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0, DiagnosticArg const& arg1, DiagnosticArg const& arg2)
+        void diagnoseDispatch(SourceLoc const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0, DiagnosticArg const& arg1, DiagnosticArg const& arg2)
         {
             DiagnosticArg const* args[] = { &arg0, &arg1, &arg2 };
             diagnoseImpl(pos, info, 3, args);
         }
 
-        void diagnoseDispatch(CodePosition const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0, DiagnosticArg const& arg1, DiagnosticArg const& arg2, DiagnosticArg const& arg3)
+        void diagnoseDispatch(SourceLoc const& pos, DiagnosticInfo const& info, DiagnosticArg const& arg0, DiagnosticArg const& arg1, DiagnosticArg const& arg2, DiagnosticArg const& arg3)
         {
             DiagnosticArg const* args[] = { &arg0, &arg1, &arg2, &arg3 };
             diagnoseImpl(pos, info, 4, args);
@@ -184,7 +193,7 @@ namespace Slang
             diagnoseDispatch(getDiagnosticPos(pos), info, args...);
         }
 
-        void diagnoseImpl(CodePosition const& pos, DiagnosticInfo const& info, int argCount, DiagnosticArg const* const* args);
+        void diagnoseImpl(SourceLoc const& pos, DiagnosticInfo const& info, int argCount, DiagnosticArg const* const* args);
     };
 
     namespace Diagnostics
@@ -194,18 +203,14 @@ namespace Slang
     }
 }
 
-#ifdef _DEBUG
 #define SLANG_INTERNAL_ERROR(sink, pos) \
-    (sink)->diagnose(Slang::CodePosition(__LINE__, 0, 0, __FILE__), Slang::Diagnostics::internalCompilerError)
+    (sink)->diagnose(pos, Slang::Diagnostics::internalCompilerError)
 #define SLANG_UNIMPLEMENTED(sink, pos, what) \
-    (sink)->diagnose(Slang::CodePosition(__LINE__, 0, 0, __FILE__), Slang::Diagnostics::unimplemented, what)
+    (sink)->diagnose(pos, Slang::Diagnostics::unimplemented, what)
 
+#ifdef _DEBUG
 #define SLANG_UNREACHABLE(msg) do { assert(!"ureachable code:" msg); exit(1); } while(0)
 #else
-#define SLANG_INTERNAL_ERROR(sink, pos) \
-    (sink)->diagnose(pos, Slang::Diagnostics::internalCompilerError)
-#define SLANG_UNIMPLEMENTED(sink, pos, what) \
-    (sink)->diagnose(pos, Slang::Diagnostics::unimplemented, what)
 
 // TODO: find something that will perform better
 #define SLANG_UNREACHABLE(msg) exit(1)
@@ -24,9 +24,12 @@ struct SharedEmitContext
     // The string of code we've built so far
     StringBuilder sb;
 
+    // Used to map source locations back to files and lines
+    SourceManager* sourceManager;
+
     // Current source position for tracking purposes...
-    CodePosition loc;
-    CodePosition nextSourceLocation;
+    HumaneSourceLoc loc;
+    SourceLoc nextSourceLocation;
     bool needToUpdateSourceLocation;
 
     // For GLSL output, we can't emit traidtional `#line` directives
@@ -72,7 +75,7 @@ static String getStringOrIdentifierTokenValue(
         return "";
 
     case TokenType::Identifier:
-        return token.Content;
+        return token.getContent();
 
     case TokenType::StringLiteral:
         return getStringLiteralTokenValue(token);
@@ -285,7 +288,7 @@ struct EDeclarator
 
     // Used for `Flavor::Name`
     String name;
-    CodePosition loc;
+    SourceLoc loc;
 
     // Used for `Flavor::Array`
     IntVal* elementCount;
@@ -343,7 +346,7 @@ struct EmitVisitor
         // Update our logical position
         // TODO(tfoley): Need to make "corelib" not use `int` for pointer-sized things...
         auto len = int(textEnd - textBegin);
-        context->shared->loc.Col += len;
+        context->shared->loc.column += len;
     }
 
     void Emit(char const* textBegin, char const* textEnd)
@@ -367,8 +370,8 @@ struct EmitVisitor
                 // At the end of a line, we need to update our tracking
                 // information on code positions
                 emitTextSpan(spanBegin, spanEnd);
-                context->shared->loc.Line++;
-                context->shared->loc.Col = 1;
+                context->shared->loc.line++;
+                context->shared->loc.column = 1;
 
                 // Start a new span for emit purposes
                 spanBegin = spanEnd;
@@ -386,9 +389,14 @@ struct EmitVisitor
         Emit(text.begin(), text.end());
     }
 
+    void emit(UnownedStringSlice const& text)
+    {
+        Emit(text.begin(), text.end());
+    }
+
     void emitName(
         String const&       inName,
-        CodePosition const& loc)
+        SourceLoc const&    loc)
     {
         String name = inName;
 
@@ -398,12 +406,13 @@ struct EmitVisitor
 
     void emitName(Token const& nameToken)
     {
-        emitName(nameToken.Content, nameToken.Position);
+        advanceToSourceLocation(nameToken.Position);
+        emit(nameToken.getContent());
     }
 
     void emitName(String const& name)
     {
-        emitName(name, CodePosition());
+        emitName(name, SourceLoc());
     }
 
     void Emit(IntegerLiteralValue value)
@@ -440,19 +449,19 @@ struct EmitVisitor
     // Emit a `#line` directive to the output.
     // Doesn't udpate state of source-location tracking.
     void emitLineDirective(
-        CodePosition const& sourceLocation)
+        HumaneSourceLoc const& sourceLocation)
     {
         emitRawText("\n#line ");
 
         char buffer[16];
-        sprintf(buffer, "%d", sourceLocation.Line);
+        sprintf(buffer, "%d", sourceLocation.line);
         emitRawText(buffer);
 
         emitRawText(" ");
 
         if(context->shared->target == CodeGenTarget::GLSL)
         {
-            auto path = sourceLocation.FileName;
+            auto path = sourceLocation.path;
 
             // GLSL doesn't support the traditional form of a `#line` directive without
             // an extension. Rather than depend on that extension we will output
@@ -483,7 +492,7 @@ struct EmitVisitor
             // in a module that tracks source files.
 
             emitRawText("\"");
-            for(auto c : sourceLocation.FileName)
+            for(auto c : sourceLocation.path)
             {
                 char charBuffer[] = { c, 0 };
                 switch(c)
@@ -512,44 +521,50 @@ struct EmitVisitor
     // ensure that source location tracking information
     // is correct based on the directive we just output.
     void emitLineDirectiveAndUpdateSourceLocation(
-        CodePosition const& sourceLocation)
+        HumaneSourceLoc const& sourceLocation)
     {
         emitLineDirective(sourceLocation);
     
-        context->shared->loc.FileName = sourceLocation.FileName;
-        context->shared->loc.Line = sourceLocation.Line;
-        context->shared->loc.Col = 1;
+        context->shared->loc.path = sourceLocation.path;
+        context->shared->loc.line = sourceLocation.line;
+        context->shared->loc.column = 1;
     }
 
     void emitLineDirectiveIfNeeded(
-        CodePosition const& sourceLocation)
+        SourceLoc const& loc)
     {
         // Ignore invalid source locations
-        if(sourceLocation.Line <= 0)
+        if(!loc.isValid())
+            return;
+
+        // Only now that we know we need it do we look up
+        // the file and line for the location.
+        HumaneSourceLoc sourceLocation = context->shared->sourceManager->getHumaneLoc(loc);
+        if(sourceLocation.line <= 0)
             return;
 
         // If we are currently emitting code at a source location with
         // a differnet file or line, *or* if the source location is
         // somehow later on the line than what we want to emit,
         // then we need to emit a new `#line` directive.
-        if(sourceLocation.FileName != context->shared->loc.FileName
-            || sourceLocation.Line != context->shared->loc.Line
-            || sourceLocation.Col < context->shared->loc.Col)
+        if(sourceLocation.line != context->shared->loc.line
+            || sourceLocation.column < context->shared->loc.column
+            || sourceLocation.path != context->shared->loc.path)
         {
             // Special case: if we are in the same file, and within a small number
             // of lines of the target location, then go ahead and output newlines
             // to get us caught up.
             enum { kSmallLineCount = 3 };
-            auto lineDiff = sourceLocation.Line - context->shared->loc.Line;
-            if(sourceLocation.FileName == context->shared->loc.FileName
-                && sourceLocation.Line > context->shared->loc.Line
-                && lineDiff <= kSmallLineCount)
+            auto lineDiff = sourceLocation.line - context->shared->loc.line;
+            if(sourceLocation.line > context->shared->loc.line
+                && lineDiff <= kSmallLineCount
+                && sourceLocation.path == context->shared->loc.path)
             {
                 for(int ii = 0; ii < lineDiff; ++ii )
                 {
                     Emit("\n");
                 }
-                assert(sourceLocation.Line == context->shared->loc.Line);
+                assert(sourceLocation.line == context->shared->loc.line);
             }
             else
             {
@@ -565,22 +580,22 @@ struct EmitVisitor
         // came in as spaces or tabs, so there is necessarily going to be
         // coupling between how the downstream compiler counts columns,
         // and how we do.
-        if(sourceLocation.Col > context->shared->loc.Col)
+        if(sourceLocation.column > context->shared->loc.column)
         {
-            int delta = sourceLocation.Col - context->shared->loc.Col;
+            int delta = sourceLocation.column - context->shared->loc.column;
             for( int ii = 0; ii < delta; ++ii )
             {
                 emitRawText(" ");
             }
-            context->shared->loc.Col = sourceLocation.Col;
+            context->shared->loc.column = sourceLocation.column;
         }
     }
 
     void advanceToSourceLocation(
-        CodePosition const& sourceLocation)
+        SourceLoc const& sourceLocation)
     {
         // Skip invalid locations
-        if(sourceLocation.Line <= 0)
+        if(!sourceLocation.isValid())
             return;
 
         context->shared->needToUpdateSourceLocation = true;
@@ -602,7 +617,7 @@ struct EmitVisitor
 
     void emitTokenWithLocation(Token const& token)
     {
-        if( token.Position.FileName.Length() != 0 )
+        if( token.Position.isValid() )
         {
             advanceToSourceLocation(token.Position);
         }
@@ -620,7 +635,7 @@ struct EmitVisitor
         }
 
         // Emit the raw textual content of the token
-        emit(token.Content);
+        emit(token.getContent());
     }
 
 
@@ -1061,9 +1076,9 @@ struct EmitVisitor
 
     void EmitType(
         RefPtr<ExpressionType>  type,
-        CodePosition const&     typeLoc,
+        SourceLoc const&        typeLoc,
         String const&           name,
-        CodePosition const&     nameLoc)
+        SourceLoc const&        nameLoc)
     {
         advanceToSourceLocation(typeLoc);
 
@@ -1077,7 +1092,7 @@ struct EmitVisitor
 
     void EmitType(RefPtr<ExpressionType> type, Token const& nameToken)
     {
-        EmitType(type, CodePosition(), nameToken.Content, nameToken.Position);
+        EmitType(type, SourceLoc(), nameToken.getContent(), nameToken.Position);
     }
 
     void EmitType(RefPtr<ExpressionType> type)
@@ -1087,7 +1102,7 @@ struct EmitVisitor
 
     void emitTypeBasedOnExpr(ExpressionSyntaxNode* expr, EDeclarator* declarator)
     {
-        if (auto subscriptExpr = dynamic_cast<IndexExpressionSyntaxNode*>(expr))
+        if (auto subscriptExpr = dynamicCast<IndexExpressionSyntaxNode>(expr))
         {
             // Looks like an array
             emitTypeBasedOnExpr(subscriptExpr->BaseExpression, declarator);
@@ -1106,7 +1121,7 @@ struct EmitVisitor
         }
     }
 
-    void EmitType(TypeExp const& typeExp, String const& name, CodePosition const& nameLoc)
+    void EmitType(TypeExp const& typeExp, String const& name, SourceLoc const& nameLoc)
     {
         if (!typeExp.type || typeExp.type->As<ErrorType>())
         {
@@ -1122,19 +1137,19 @@ struct EmitVisitor
         else
         {
             EmitType(typeExp.type,
-                typeExp.exp ? typeExp.exp->Position : CodePosition(),
+                typeExp.exp ? typeExp.exp->Position : SourceLoc(),
                 name, nameLoc);
         }
     }
 
     void EmitType(TypeExp const& typeExp, Token const& nameToken)
     {
-        EmitType(typeExp, nameToken.Content, nameToken.Position);
+        EmitType(typeExp, nameToken.getContent(), nameToken.Position);
     }
 
     void EmitType(TypeExp const& typeExp, String const& name)
     {
-        EmitType(typeExp, name, CodePosition());
+        EmitType(typeExp, name, SourceLoc());
     }
 
     void emitTypeExp(TypeExp const& typeExp)
@@ -1329,7 +1344,7 @@ struct EmitVisitor
 
         // Otherwise, we need to check if the target name matches what
         // we expect.
-        auto const& targetName = targetToken.Content;
+        auto targetName = targetToken.getContent();
 
         switch(context->shared->target)
         {
@@ -1598,7 +1613,7 @@ struct EmitVisitor
             auto funcDecl = funcDeclRef.getDecl();
             if(!funcDecl)
             {
-                emitUncheckedCallExpr(callExpr, funcDeclRefExpr->name, arg);
+                emitUncheckedCallExpr(callExpr, getText(funcDeclRefExpr->name), arg);
                 return;
             }
             else if (auto intrinsicOpModifier = funcDecl->FindModifier<IntrinsicOpModifier>())
@@ -1939,7 +1954,7 @@ struct EmitVisitor
         {
             // This case arises when checking didn't find anything, but we were
             // in "rewrite" mode so we blazed ahead anyway.
-            emitName(memberExpr->name);
+            emitName(getText(memberExpr->name));
         }
         else
         {
@@ -2014,7 +2029,7 @@ struct EmitVisitor
         }
         else
         {
-            emit(varExpr->name);
+            emit(getText(varExpr->name));
         }
 
         if(needClose) Emit(")");
@@ -2174,11 +2189,11 @@ struct EmitVisitor
 
         for(auto attr : decl->GetModifiersOfType<HLSLUncheckedAttribute>())
         {
-            if(attr->nameToken.Content == "loop")
+            if(attr->nameToken.getContent() == "loop")
             {
                 Emit("[loop]");
             }
-            else if(attr->nameToken.Content == "unroll")
+            else if(attr->nameToken.getContent() == "unroll")
             {
                 Emit("[unroll]");
             }
@@ -2508,7 +2523,7 @@ struct EmitVisitor
         assert(context->shared->target != CodeGenTarget::GLSL);
 
         Emit("typedef ");
-        EmitType(decl->Type, decl->Name.Content);
+        EmitType(decl->Type, decl->getName());
         Emit(";\n");
     }
 
@@ -2563,11 +2578,11 @@ struct EmitVisitor
                 Emit(", ");
             }
 
-            emit(mod->nameToken.Content);
+            emit(mod->nameToken.getContent());
             if(mod->valToken.Type != TokenType::Unknown)
             {
                 Emit(" = ");
-                emit(mod->valToken.Content);
+                emit(mod->valToken.getContent());
             }
         }
         if(anyLayout)
@@ -2641,7 +2656,7 @@ struct EmitVisitor
             else if (auto uncheckedAttr = mod.As<HLSLAttribute>())
             {
                 Emit("[");
-                emit(uncheckedAttr->nameToken.Content);
+                emit(uncheckedAttr->nameToken.getContent());
                 auto& args = uncheckedAttr->args;
                 auto argCount = args.Count();
                 if (argCount != 0)
@@ -2659,7 +2674,7 @@ struct EmitVisitor
 
             else if(auto simpleModifier = mod.As<SimpleModifier>())
             {
-                emit(simpleModifier->nameToken.Content);
+                emit(simpleModifier->nameToken.getContent());
                 Emit(" ");
             }
 
@@ -2686,18 +2701,18 @@ struct EmitVisitor
         if (auto simple = semantic.As<HLSLSimpleSemantic>())
         {
             Emit(": ");
-            emit(simple->name.Content);
+            emit(simple->name.getContent());
         }
         else if(auto registerSemantic = semantic.As<HLSLRegisterSemantic>())
         {
             // Don't print out semantic from the user, since we are going to print the same thing our own way...
     #if 0
             Emit(": register(");
-            Emit(registerSemantic->registerName.Content);
+            Emit(registerSemantic->registerName.getContent());
             if(registerSemantic->componentMask.Type != TokenType::Unknown)
             {
                 Emit(".");
-                Emit(registerSemantic->componentMask.Content);
+                Emit(registerSemantic->componentMask.getContent());
             }
             Emit(")");
     #endif
@@ -2710,11 +2725,11 @@ struct EmitVisitor
                 return;
 
             Emit(": packoffset(");
-            Emit(packOffsetSemantic->registerName.Content);
+            Emit(packOffsetSemantic->registerName.getContent());
             if(packOffsetSemantic->componentMask.Type != TokenType::Unknown)
             {
                 Emit(".");
-                Emit(packOffsetSemantic->componentMask.Content);
+                Emit(packOffsetSemantic->componentMask.getContent());
             }
             Emit(")");
     #endif
@@ -3313,11 +3328,11 @@ struct EmitVisitor
             // TODO(tfoley): Emit an appropriate `#line` directive...
 
             Emit("#version ");
-            emit(versionDirective->versionNumberToken.Content);
+            emit(versionDirective->versionNumberToken.getContent());
             if(versionDirective->glslProfileToken.Type != TokenType::Unknown)
             {
                 Emit(" ");
-                emit(versionDirective->glslProfileToken.Content);
+                emit(versionDirective->glslProfileToken.getContent());
             }
             Emit("\n");
         }
@@ -3341,9 +3356,9 @@ struct EmitVisitor
             // TODO(tfoley): Emit an appropriate `#line` directive...
 
             Emit("#extension ");
-            emit(extensionDirective->extensionNameToken.Content);
+            emit(extensionDirective->extensionNameToken.getContent());
             Emit(" : ");
-            emit(extensionDirective->dispositionToken.Content);
+            emit(extensionDirective->dispositionToken.getContent());
             Emit("\n");
         }
 
@@ -3387,6 +3402,7 @@ String emitEntryPoint(
 
     SharedEmitContext sharedContext;
     sharedContext.target = target;
+    sharedContext.sourceManager = entryPoint->compileRequest->sourceManager;
 
     sharedContext.programLayout = programLayout;
 
@@ -13,7 +13,7 @@ ABSTRACT_SYNTAX_CLASS(DeclRefExpr, ExpressionSyntaxNode)
     DECL_FIELD(DeclRef<Decl>, declRef)
 
     // The name of the symbol being referenced
-    FIELD(String, name)
+    FIELD(Name*, name RAW(= nullptr))
 END_SYNTAX_CLASS()
 
 SIMPLE_SYNTAX_CLASS(VarExpressionSyntaxNode, DeclRefExpr)
@@ -48,6 +48,8 @@ SYNTAX_CLASS(ConstantExpressionSyntaxNode, ExpressionSyntaxNode)
         FloatingPointLiteralValue   floatingPointValue;
     };
     String stringValue;
+
+    static const bool kRawMembersNeedDestructor = true;
     )
 END_SYNTAX_CLASS()
 
@@ -83,7 +85,10 @@ END_SYNTAX_CLASS()
 SYNTAX_CLASS(SwizzleExpr, ExpressionSyntaxNode)
     SYNTAX_FIELD(RefPtr<ExpressionSyntaxNode>, base)
     FIELD(int, elementCount)
-    FIELD(int, elementIndices[4])
+
+    // (This is declared raw, since code that walks the fields
+    // can't handle an array-typed field)
+    RAW(int elementIndices[4];)
 END_SYNTAX_CLASS()
 
 // A dereference of a pointer or pointer-like type
@@ -122,8 +127,8 @@ SYNTAX_CLASS(SharedTypeExpr, ExpressionSyntaxNode)
 END_SYNTAX_CLASS()
 
 SYNTAX_CLASS(AssignExpr, ExpressionSyntaxNode)
-    SYNTAX_FIELD(RefPtr<ExpressionSyntaxNode>, left);
-    SYNTAX_FIELD(RefPtr<ExpressionSyntaxNode>, right);
+    SYNTAX_FIELD(RefPtr<ExpressionSyntaxNode>, left)
+    SYNTAX_FIELD(RefPtr<ExpressionSyntaxNode>, right)
 END_SYNTAX_CLASS()
 
 // Just an expression inside parentheses `(exp)`
@@ -131,5 +136,5 @@ END_SYNTAX_CLASS()
 // We keep this around explicitly to be sure we don't lose any structure
 // when we do rewriter stuff.
 SYNTAX_CLASS(ParenExpr, ExpressionSyntaxNode)
-    SYNTAX_FIELD(RefPtr<ExpressionSyntaxNode>, base);
+    SYNTAX_FIELD(RefPtr<ExpressionSyntaxNode>, base)
 END_SYNTAX_CLASS()
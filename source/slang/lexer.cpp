@@ -1,12 +1,14 @@
 #include "Lexer.h"
 
+#include "syntax.h"
+
 #include <assert.h>
 
 namespace Slang
 {
     static Token GetEndOfFileToken()
     {
-        return Token(TokenType::EndOfFile, "", 0, 0, 0, "");
+        return Token(TokenType::EndOfFile, UnownedStringSlice(), SourceLoc());
     }
 
     Token* TokenList::begin() const
@@ -52,10 +54,10 @@ namespace Slang
         return mCursor->Type;
     }
 
-    CodePosition TokenReader::PeekLoc() const
+    SourceLoc TokenReader::PeekLoc() const
     {
         if (!mCursor)
-            return CodePosition();
+            return SourceLoc();
         assert(mCursor);
         return mCursor->Position;
     }
@@ -68,25 +70,77 @@ namespace Slang
         Token token = *mCursor;
         if (mCursor == mEnd)
             token.Type = TokenType::EndOfFile;
-        else
-            mCursor++;
+        else if (++mCursor == mEnd && mChunk && !mChunk->isLast)
+            moveToNextChunk();
         return token;
     }
 
+    // How many tokens to read from a `TokenSource` at a time
+    static const UInt kTokenChunkSize = 256;
+
+    TokenReader::TokenReader(TokenSource* source)
+        : mSource(source)
+    {
+        RefPtr<TokenChunk> chunk = new TokenChunk();
+        source->readTokens(chunk->tokens, kTokenChunkSize);
+        moveToChunk(chunk.Ptr());
+    }
+
+    void TokenReader::moveToChunk(TokenChunk* chunk)
+    {
+        chunk->isLast = chunk->tokens.Last().Type == TokenType::EndOfFile;
+
+        mChunk = chunk;
+        mCursor = chunk->tokens.Buffer();
+        mEnd = mCursor + chunk->tokens.Count() - (chunk->isLast ? 1 : 0);
+    }
+
+    void TokenReader::moveToNextChunk()
+    {
+        // A copy of this reader (e.g., one used to look ahead)
+        // may have already read the next chunk.
+        if (!mChunk->next)
+        {
+            RefPtr<TokenChunk> next = new TokenChunk();
+            mSource->readTokens(next->tokens, kTokenChunkSize);
+            mChunk->next = next;
+        }
+        moveToChunk(mChunk->next.Ptr());
+    }
+
     // Lexer
 
     Lexer::Lexer(
-        String const&   path,
-        String const&   content,
-        DiagnosticSink* sink)
-        : path(path)
+        SourceFile*     sourceFile,
+        DiagnosticSink* sink,
+        NamePool*       namePool)
+        : sourceFile(sourceFile)
+        , content(sourceFile->content.getUnownedSlice())
+        , sink(sink)
+        , namePool(namePool)
+    {
+        begin   = content.begin();
+        cursor  = begin;
+        end     = content.end();
+
+        startLoc = sourceFile->sourceRange.begin;
+        tokenFlags = TokenFlag::AtStartOfLine | TokenFlag::AfterWhitespace;
+        lexerFlags = 0;
+    }
+
+    Lexer::Lexer(
+        UnownedStringSlice const& content,
+        DiagnosticSink* sink,
+        NamePool*       namePool)
+        : sourceFile(nullptr)
         , content(content)
         , sink(sink)
+        , namePool(namePool)
     {
-        cursor  = content.begin();
+        begin   = content.begin();
+        cursor  = begin;
         end     = content.end();
 
-        loc = CodePosition(1, 1, 0, path);
         tokenFlags = TokenFlag::AtStartOfLine | TokenFlag::AfterWhitespace;
         lexerFlags = 0;
     }
@@ -97,6 +151,18 @@ namespace Slang
 
     enum { kEOF = -1 };
 
+    // Get the source location of the lexer's cursor.
+    //
+    // We don't track line and column numbers while lexing;
+    // they get computed from the location only when needed.
+    static SourceLoc getSourceLoc(Lexer* lexer)
+    {
+        // Text without a range of locations has no locations to give out
+        if (!lexer->startLoc.isValid())
+            return SourceLoc();
+        return lexer->startLoc + UInt(lexer->cursor - lexer->begin);
+    }
+
     // Get the next input byte, without any handling of
     // escaped newlines, non-ASCII code points, source locations, etc.
     static int peekRaw(Lexer* lexer)
@@ -142,9 +208,6 @@ namespace Slang
         {
             advanceRaw(lexer);
         }
-
-        lexer->loc.Line++;
-        lexer->loc.Col = 1;
     }
 
     // Look ahead one code point, dealing with complications like
@@ -209,10 +272,14 @@ namespace Slang
                 switch (d)
                 {
                 case '\r': case '\n':
-                    // handle the end-of-line for our source location tracking
+                    // consume the rest of the end-of-line sequence
                     lexer->cursor++;
                     handleNewLineInner(lexer, d);
 
+                    // Remember that the current token will need to have
+                    // its text scrubbed to remove the escaped newline.
+                    lexer->lexerFlags |= kLexerFlag_SawEscapedNewline;
+
                     // Now try again, looking at the character after the
                     // escaped nmewline.
                     continue;
@@ -224,12 +291,7 @@ namespace Slang
 
             // TODO: Need to handle non-ASCII code points.
 
-            // Default case is to advance by one location
-            // and return the raw byte we saw.
-
-            lexer->loc.Col++;
-            lexer->loc.Pos++;
-
+            // Default case is to return the raw byte we saw.
             return c;
         }
     }
@@ -355,7 +417,7 @@ namespace Slang
             if(digitVal >= base)
             {
                 char buffer[] = { (char) c, 0 };
-                lexer->sink->diagnose(lexer->loc, Diagnostics::invalidDigitForBase, buffer, base);
+                lexer->sink->diagnose(getSourceLoc(lexer), Diagnostics::invalidDigitForBase, buffer, base);
             }
 
             advance(lexer);
@@ -491,12 +553,17 @@ namespace Slang
         return tokenType;
     }
 
-    static int maybeReadDigit(char const** ioCursor, int base)
+    // Note: the text of a token is not null-terminated (it is a slice of
+    // the source file), so the routines below must not read past `end`.
+    static int maybeReadDigit(char const** ioCursor, char const* end, int base)
     {
         auto& cursor = *ioCursor;
 
         for(;;)
         {
+            if(cursor == end)
+                return -1;
+
             int c = *cursor;
             switch(c)
             {
@@ -532,12 +599,15 @@ namespace Slang
         }
     }
 
-    static int readOptionalBase(char const** ioCursor)
+    static int readOptionalBase(char const** ioCursor, char const* end)
     {
         auto& cursor = *ioCursor;
-        if( *cursor == '0' )
+        if( cursor != end && *cursor == '0' )
         {
             cursor++;
+            if(cursor == end)
+                return 10;
+
             switch(*cursor)
             {
             case 'x': case 'X':
@@ -566,14 +636,15 @@ namespace Slang
     {
         IntegerLiteralValue value = 0;
 
-        char const* cursor = token.Content.begin();
-        char const* end = token.Content.end();
+        auto content = token.getContent();
+        char const* cursor = content.begin();
+        char const* end = content.end();
 
-        int base = readOptionalBase(&cursor);
+        int base = readOptionalBase(&cursor, end);
 
         for( ;;)
         {
-            int digit = maybeReadDigit(&cursor, base);
+            int digit = maybeReadDigit(&cursor, end, base);
             if(digit < 0)
                 break;
 
@@ -592,23 +663,24 @@ namespace Slang
     {
         FloatingPointLiteralValue value = 0;
 
-        char const* cursor = token.Content.begin();
-        char const* end = token.Content.end();
+        auto content = token.getContent();
+        char const* cursor = content.begin();
+        char const* end = content.end();
 
-        int radix = readOptionalBase(&cursor);
+        int radix = readOptionalBase(&cursor, end);
 
         bool seenDot = false;
         FloatingPointLiteralValue divisor = 1;
         for( ;;)
         {
-            if(*cursor == '.')
+            if(cursor != end && *cursor == '.')
             {
                 cursor++;
                 seenDot = true;
                 continue;
             }
 
-            int digit = maybeReadDigit(&cursor, radix);
+            int digit = maybeReadDigit(&cursor, end, radix);
             if(digit < 0)
                 break;
 
@@ -621,12 +693,12 @@ namespace Slang
         }
 
         // Now read optional exponent
-        if(isNumberExponent(*cursor, radix))
+        if(cursor != end && isNumberExponent(*cursor, radix))
         {
             cursor++;
 
             bool exponentIsNegative = false;
-            switch(*cursor)
+            switch(cursor != end ? *cursor : 0)
             {
             default:
                 break;
@@ -646,7 +718,7 @@ namespace Slang
 
             for(;;)
             {
-                int digit = maybeReadDigit(&cursor, exponentRadix);
+                int digit = maybeReadDigit(&cursor, end, exponentRadix);
                 if(digit < 0)
                     break;
 
@@ -695,11 +767,11 @@ namespace Slang
             switch(c)
             {
             case kEOF:
-                lexer->sink->diagnose(lexer->loc, Diagnostics::endOfFileInLiteral);
+                lexer->sink->diagnose(getSourceLoc(lexer), Diagnostics::endOfFileInLiteral);
                 return;
 
             case '\n': case '\r':
-                lexer->sink->diagnose(lexer->loc, Diagnostics::newlineInLiteral);
+                lexer->sink->diagnose(getSourceLoc(lexer), Diagnostics::newlineInLiteral);
                 return;
 
             case '\\':
@@ -777,8 +849,9 @@ namespace Slang
         assert(token.Type == TokenType::StringLiteral
             || token.Type == TokenType::CharLiteral);
 
-        char const* cursor = token.Content.begin();
-        char const* end = token.Content.end();
+        auto content = token.getContent();
+        char const* cursor = content.begin();
+        char const* end = content.end();
 
         auto quote = *cursor++;
         assert(quote == '\'' || quote == '"');
@@ -905,7 +978,8 @@ namespace Slang
 
         // Just trim off the first and last characters to remove the quotes
         // (whether they were `""` or `<>`.
-        return token.Content.SubString(1, token.Content.Length()-2);
+        auto content = token.getContent();
+        return String(content.begin() + 1, content.end() - 1);
     }
 
 
@@ -952,7 +1026,7 @@ namespace Slang
 
         case '0':
             {
-                auto loc = lexer->loc;
+                auto loc = getSourceLoc(lexer);
                 advance(lexer);
                 switch(peek(lexer))
                 {
@@ -1170,7 +1244,7 @@ namespace Slang
             // If none of the above cases matched, then we have an
             // unexpected/invalid character.
 
-            auto loc = lexer->loc;
+            auto loc = getSourceLoc(lexer);
             auto sink = lexer->sink;
             int c = advance(lexer);
             if(c >= 0x20 && c <=  0x7E)
@@ -1194,9 +1268,10 @@ namespace Slang
         for(;;)
         {
             Token token;
-            token.Position = loc;
+            token.Position = getSourceLoc(this);
 
             char const* textBegin = cursor;
+            lexerFlags &= ~kLexerFlag_SawEscapedNewline;
 
             auto tokenType = lexTokenImpl(this);
 
@@ -1248,15 +1323,17 @@ namespace Slang
 
             char const* textEnd = cursor;
 
-            // Note(tfoley): `StringBuilder::Append()` seems to crash when appending zero bytes
-            if(textEnd != textBegin)
+            // The token text usually maps directly onto the source,
+            // so we just point into the file's content.
+            // Only a token that contained an escaped newline needs
+            // a "scrubbed" copy of its text to be built, which is
+            // kept alongside the file rather than in the token.
+            if(!(this->lexerFlags & kLexerFlag_SawEscapedNewline))
+            {
+                token.setContent(UnownedStringSlice(textBegin, textEnd));
+            }
+            else
             {
-                // HACK(tfoley): "scrubbing" token value here to remove escaped newlines...
-                //
-                // TODO: Only perform this work if we encountered an escaped newline
-                // while lexing this token (e.g., keep a flag on the lexer), or
-                // do it on-demand when the actual value of the token is needed.
-
                 StringBuilder valueBuilder;
                 auto tt = textBegin;
                 while(tt != textEnd)
@@ -1284,7 +1361,17 @@ namespace Slang
                     }
                     valueBuilder.Append(c);
                 }
-                token.Content = valueBuilder.ProduceString();
+                String scrubbedText = valueBuilder.ProduceString();
+                token.setContent(sourceFile
+                    ? sourceFile->addScrubbedText(scrubbedText)
+                    : allocateSyntaxText(scrubbedText.getUnownedSlice()));
+            }
+
+            // Identifiers get interned here, once, so that everything
+            // downstream can look them up by `Name*`.
+            if(tokenType == TokenType::Identifier && namePool)
+            {
+                token.setName(namePool->getName(token.getContent()));
             }
 
             token.flags = flags;
@@ -1308,6 +1395,86 @@ namespace Slang
         }
     }
 
+    void Lexer::skipToNextDirective()
+    {
+        // Comments and white space don't stop a `#` from starting
+        // a directive, but anything else on the line does.
+        bool atStartOfLine = (tokenFlags & TokenFlag::AtStartOfLine) != 0;
+        for(;;)
+        {
+            switch(peek(this))
+            {
+            case kEOF:
+                return;
+
+            case '\n': case '\r':
+                handleNewLine(this);
+                atStartOfLine = true;
+                continue;
+
+            case ' ': case '\t':
+                advance(this);
+                continue;
+
+            case '#':
+                if(atStartOfLine)
+                {
+                    tokenFlags = TokenFlag::AtStartOfLine | TokenFlag::AfterWhitespace;
+                    return;
+                }
+                advance(this);
+                continue;
+
+            case '/':
+                advance(this);
+                switch(peek(this))
+                {
+                case '/':
+                    lexLineComment(this);
+                    continue;
+
+                case '*':
+                    advance(this);
+                    lexBlockComment(this);
+                    continue;
+
+                default:
+                    atStartOfLine = false;
+                    continue;
+                }
+
+            // A literal might contain `/*`, so we need to step
+            // over it rather than look inside it.
+            case '"': case '\'':
+                {
+                    int quote = advance(this);
+                    for(;;)
+                    {
+                        int c = peek(this);
+                        if(c == kEOF || c == '\n' || c == '\r')
+                            break;
+                        advance(this);
+                        if(c == quote)
+                            break;
+                        if(c == '\\')
+                        {
+                            int d = peek(this);
+                            if(d != kEOF && d != '\n' && d != '\r')
+                                advance(this);
+                        }
+                    }
+                    atStartOfLine = false;
+                }
+                continue;
+
+            default:
+                advance(this);
+                atStartOfLine = false;
+                continue;
+            }
+        }
+    }
+
 
 
 #if 0
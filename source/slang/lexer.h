@@ -32,6 +32,30 @@ namespace Slang
         Token* mEnd;
     };
 
+    // Something that produces tokens a chunk at a time as they are
+    // read (e.g., the preprocessor), so that a `TokenReader` can read
+    // them without every token being held at once.
+    class TokenSource : public RefObject
+    {
+    public:
+        // Append up to `count` more tokens (but at least one) to
+        // `outTokens`. The last token produced is an end-of-file token.
+        virtual void readTokens(List<Token>& outTokens, UInt count) = 0;
+    };
+
+    // A chunk of the tokens read from a `TokenSource`. Each chunk keeps
+    // alive the ones after it, so a chunk is freed as soon as no reader
+    // (including copies saved to backtrack to) is in it or before it.
+    class TokenChunk : public RefObject
+    {
+    public:
+        List<Token>         tokens;
+        RefPtr<TokenChunk>  next;
+
+        // Does this chunk end with the end-of-file token?
+        bool                isLast = false;
+    };
+
     struct TokenReader
     {
         TokenReader();
@@ -44,10 +68,13 @@ namespace Slang
             , mEnd   (tokens.end  ())
         {}
 
+        // Read the tokens of `source` as they are needed
+        explicit TokenReader(TokenSource* source);
+
         bool IsAtEnd() const { return mCursor == mEnd; }
         Token PeekToken() const;
         TokenType PeekTokenType() const;
-        CodePosition PeekLoc() const;
+        SourceLoc PeekLoc() const;
 
         Token AdvanceToken();
 
@@ -55,6 +82,17 @@ namespace Slang
 
         Token* mCursor;
         Token* mEnd;
+
+        // When reading from a `TokenSource`, the chunk that `mCursor`
+        // and `mEnd` point into. Only the last chunk has its end-of-file
+        // token at `mEnd`; for the others, the reader moves on to the
+        // next chunk as soon as it reaches the end of one.
+        RefPtr<TokenChunk>  mChunk;
+        TokenSource*        mSource = nullptr;
+
+    private:
+        void moveToChunk(TokenChunk* chunk);
+        void moveToNextChunk();
     };
 
     typedef unsigned int LexerFlags;
@@ -62,14 +100,27 @@ namespace Slang
     {
         kLexerFlag_InDirective = 1 << 0,
         kLexerFlag_ExpectFileName = 2 << 0,
+
+        // Set when the token being lexed contains an escaped newline,
+        // so that its text needs to be scrubbed.
+        kLexerFlag_SawEscapedNewline = 1 << 2,
     };
 
     struct Lexer
     {
         Lexer(
-            String const&   path,
-            String const&   content,
-            DiagnosticSink* sink);
+            SourceFile*     sourceFile,
+            DiagnosticSink* sink,
+            NamePool*       namePool);
+
+        // Lex text that isn't part of any source file (e.g., the
+        // result of pasting tokens together). Its tokens have no
+        // locations, and refer to `content` for their text, so it
+        // must outlive them (e.g., by coming from `allocateSyntaxText()`).
+        Lexer(
+            UnownedStringSlice const& content,
+            DiagnosticSink* sink,
+            NamePool*       namePool);
 
         ~Lexer();
 
@@ -77,13 +128,26 @@ namespace Slang
 
         TokenList lexAllTokens();
 
-        String          path;
-        String          content;
+        // Skip ahead, without producing any tokens, to the next `#` at
+        // the start of a line (or to the end of the input), so that the
+        // body of a disabled preprocessor conditional needn't be lexed.
+        void skipToNextDirective();
+
+        SourceFile*     sourceFile;
+        UnownedStringSlice content;
         DiagnosticSink* sink;
 
+        // Pool used to intern the names of identifier tokens
+        NamePool*       namePool;
+
+        char const*     begin;
         char const*     cursor;
         char const*     end;
-        CodePosition    loc;
+
+        // The location of the first byte of the file; the location
+        // of anything else in the file is found by adding its offset.
+        SourceLoc       startLoc;
+
         TokenFlags      tokenFlags;
         LexerFlags      lexerFlags;
     };
@@ -5,13 +5,6 @@ namespace Slang {
 
 //
 
-DeclRef<ExtensionDecl> ApplyExtensionToType(
-    SemanticsVisitor*       semantics,
-    ExtensionDecl*          extDecl,
-    RefPtr<ExpressionType>  type);
-
-//
-
 
 // Helper for constructing breadcrumb trails during lookup, without unnecessary heap allocaiton
 struct BreadcrumbInfo
@@ -22,7 +15,7 @@ struct BreadcrumbInfo
 };
 
 void DoLocalLookupImpl(
-    String const&		    name,
+    Name*        		    name,
     DeclRef<ContainerDecl>	    containerDeclRef,
     LookupRequest const&    request,
     LookupResult&		    result,
@@ -41,7 +34,7 @@ void buildMemberDictionary(ContainerDecl* decl)
 
     for (auto m : decl->Members)
     {
-        auto name = m->Name.Content;
+        auto name = m->getInternedName();
 
         // Add any transparent members to a separate list for lookup
         if (m->HasModifier<TransparentModifier>())
@@ -51,8 +44,8 @@ void buildMemberDictionary(ContainerDecl* decl)
             decl->transparentMembers.Add(info);
         }
 
-        // Ignore members with an empty name
-        if (name.Length() == 0)
+        // Ignore members without a name
+        if (!name)
             continue;
 
         m->nextInContainerWithSameName = nullptr;
@@ -67,20 +60,360 @@ void buildMemberDictionary(ContainerDecl* decl)
     decl->memberDictionaryIsValid = true;
 }
 
+void buildMemberDictionariesRec(ContainerDecl* decl)
+{
+    buildMemberDictionary(decl);
+
+    for (auto m : decl->Members)
+    {
+        if (auto containerDecl = dynamicCast<ContainerDecl>(m.Ptr()))
+            buildMemberDictionariesRec(containerDecl);
+    }
+
+    // The declaration inside a generic isn't one of its members
+    if (auto genericDecl = dynamicCast<GenericDecl>(decl))
+    {
+        if (auto innerDecl = dynamicCast<ContainerDecl>(genericDecl->inner.Ptr()))
+            buildMemberDictionariesRec(innerDecl);
+    }
+}
+
+// Overload group indices
+
+typedef OverloadGroupIndex::TypeShape TypeShape;
+
+// Groups smaller than this aren't worth indexing
+static const UInt kMinIndexedOverloadGroupSize = 4;
+
+// The classes that the first argument of a call falls into, for
+// the purposes of `OverloadGroupIndex::candidatesByKey`. The common
+// vector sizes get a class each, while vectors of any other (or
+// unknown) size share one.
+enum
+{
+    kFirstArgClass_Any,
+    kFirstArgClass_Scalar,
+    kFirstArgClass_Vector,
+    kFirstArgClass_Vector1,
+    kFirstArgClass_Vector4 = kFirstArgClass_Vector1 + 3,
+    kFirstArgClass_Matrix,
+    kFirstArgClass_Other,
+
+    kFirstArgClassCount,
+};
+
+static int getFirstArgClass(TypeShape const& shape)
+{
+    switch (shape.kind)
+    {
+    case TypeShape::Kind::Any:
+        return kFirstArgClass_Any;
+
+    case TypeShape::Kind::Scalar:
+        return kFirstArgClass_Scalar;
+
+    case TypeShape::Kind::Vector:
+        if (shape.rowCount >= 1 && shape.rowCount <= 4)
+            return kFirstArgClass_Vector1 + (shape.rowCount - 1);
+        return kFirstArgClass_Vector;
+
+    case TypeShape::Kind::Matrix:
+        return kFirstArgClass_Matrix;
+
+    default:
+        return kFirstArgClass_Other;
+    }
+}
+
+// Get a shape that stands in for every argument in a class, in that
+// a parameter that could accept any of those arguments can accept it.
+static TypeShape getFirstArgClassShape(int argClass)
+{
+    TypeShape shape;
+    switch (argClass)
+    {
+    case kFirstArgClass_Any:
+        break;
+
+    case kFirstArgClass_Scalar:
+        shape.kind = TypeShape::Kind::Scalar;
+        break;
+
+    case kFirstArgClass_Matrix:
+        shape.kind = TypeShape::Kind::Matrix;
+        break;
+
+    case kFirstArgClass_Other:
+        shape.kind = TypeShape::Kind::Other;
+        break;
+
+    default:
+        shape.kind = TypeShape::Kind::Vector;
+        if (argClass != kFirstArgClass_Vector)
+            shape.rowCount = 1 + (argClass - kFirstArgClass_Vector1);
+        break;
+    }
+    return shape;
+}
+
+static UInt getCandidateKey(UInt argCount, int firstArgClass)
+{
+    return argCount * kFirstArgClassCount + firstArgClass;
+}
+
+// Get the size of a vector or matrix, or zero if it isn't a
+// (reasonable) constant
+static int getKnownSize(IntVal* val)
+{
+    if (auto constantVal = dynamicCast<ConstantIntVal>(val))
+    {
+        if (constantVal->value > 0 && constantVal->value < 0x10000)
+            return (int)constantVal->value;
+    }
+    return 0;
+}
+
+static bool sizesMayMatch(int left, int right)
+{
+    return left == 0 || right == 0 || left == right;
+}
+
+// Could a parameter with the shape `param` accept an argument with
+// the shape `arg`? This must never say "no" when the full checks
+// could succeed, so it follows the conversions that `TryCoerceImpl()`
+// allows, and leaves room for generic arguments to be inferred.
+static bool paramMayAcceptArg(TypeShape const& param, TypeShape const& arg)
+{
+    if (param.kind == TypeShape::Kind::Any || arg.kind == TypeShape::Kind::Any)
+        return true;
+
+    switch (param.kind)
+    {
+    case TypeShape::Kind::Scalar:
+        // Any scalar type converts to any other
+        return arg.kind == TypeShape::Kind::Scalar;
+
+    case TypeShape::Kind::Vector:
+        // A scalar converts to a vector of any size, but a vector
+        // only converts to one with the same number of elements
+        if (arg.kind == TypeShape::Kind::Scalar)
+            return true;
+        return arg.kind == TypeShape::Kind::Vector
+            && sizesMayMatch(param.rowCount, arg.rowCount);
+
+    case TypeShape::Kind::Matrix:
+        // There are no conversions to matrix types, so the
+        // types have to match exactly
+        return arg.kind == TypeShape::Kind::Matrix
+            && (param.elementType == BaseType::Void
+                || arg.elementType == BaseType::Void
+                || param.elementType == arg.elementType)
+            && sizesMayMatch(param.rowCount, arg.rowCount)
+            && sizesMayMatch(param.columnCount, arg.columnCount);
+
+    default:
+        return true;
+    }
+}
+
+OverloadGroupIndex::TypeShape getOverloadTypeShape(ExpressionType* type)
+{
+    TypeShape shape;
+    if (!type || type->As<ErrorType>())
+        return shape;
+
+    if (type->AsBasicType())
+    {
+        shape.kind = TypeShape::Kind::Scalar;
+    }
+    else if (auto vectorType = type->AsVectorType())
+    {
+        shape.kind = TypeShape::Kind::Vector;
+        shape.rowCount = getKnownSize(vectorType->elementCount.Ptr());
+    }
+    else if (auto matrixType = type->AsMatrixType())
+    {
+        shape.kind = TypeShape::Kind::Matrix;
+        if (auto elementType = matrixType->getElementType()->AsBasicType())
+            shape.elementType = elementType->BaseType;
+        shape.rowCount = getKnownSize(matrixType->getRowCount());
+        shape.columnCount = getKnownSize(matrixType->getColumnCount());
+    }
+    else
+    {
+        shape.kind = TypeShape::Kind::Other;
+    }
+    return shape;
+}
+
+void OverloadGroupIndex::findCandidates(
+    List<TypeShape> const&  argShapes,
+    List<UInt>&             outPositions)
+{
+    UInt argCount = argShapes.Count();
+    int firstArgClass = argCount ? getFirstArgClass(argShapes[0]) : kFirstArgClass_Any;
+
+    auto positions = candidatesByKey.TryGetValue(getCandidateKey(argCount, firstArgClass));
+    if (!positions)
+        return;
+
+    for (auto cc : *positions)
+    {
+        auto& candidate = candidates[cc];
+
+        bool mayApply = true;
+        for (UInt aa = 0; aa < argCount; ++aa)
+        {
+            if (!paramMayAcceptArg(paramShapes[candidate.firstParamShape + aa], argShapes[aa]))
+            {
+                mayApply = false;
+                break;
+            }
+        }
+        if (mayApply)
+            outPositions.Add(cc);
+    }
+}
+
+bool OverloadGroupIndex::tryGetResolvedCall(
+    ResolvedCallKey const&  key,
+    UInt*                   outPosition)
+{
+    std::shared_lock<std::shared_timed_mutex> lock(resolvedCallsMutex);
+    return resolvedCalls.TryGetValue(key, *outPosition);
+}
+
+void OverloadGroupIndex::addResolvedCall(
+    ResolvedCallKey const&  key,
+    UInt                    position)
+{
+    std::unique_lock<std::shared_timed_mutex> lock(resolvedCallsMutex);
+    resolvedCalls[key] = position;
+}
+
+static RefPtr<OverloadGroupIndex> buildOverloadGroupIndex(Decl* firstDecl)
+{
+    RefPtr<OverloadGroupIndex> index = new OverloadGroupIndex();
+    for (auto m = firstDecl; m; m = m->nextInContainerWithSameName)
+    {
+        auto callableDecl = dynamicCast<CallableDecl>(m);
+        bool isGeneric = false;
+        if (!callableDecl)
+        {
+            if (auto genericDecl = dynamicCast<GenericDecl>(m))
+            {
+                callableDecl = dynamicCast<CallableDecl>(genericDecl->inner.Ptr());
+                isGeneric = true;
+            }
+        }
+
+        // We can't say anything about other kinds of declarations,
+        // so a group that includes one doesn't get an index.
+        if (!callableDecl)
+            return nullptr;
+
+        OverloadGroupIndex::Candidate candidate;
+        candidate.decl = m;
+        candidate.minArgCount = 0;
+        candidate.maxArgCount = 0;
+        candidate.firstParamShape = index->paramShapes.Count();
+        for (auto paramDecl : callableDecl->getMembersOfType<ParameterSyntaxNode>())
+        {
+            candidate.maxArgCount++;
+            if (!paramDecl->Expr)
+                candidate.minArgCount++;
+
+            auto paramType = paramDecl->Type.type.Ptr();
+            auto shape = getOverloadTypeShape(paramType);
+            if (shape.kind == TypeShape::Kind::Other)
+            {
+                shape = TypeShape();
+
+                auto declRefType = paramType->As<DeclRefType>();
+                if (declRefType && declRefType->declRef.As<InterfaceDecl>())
+                    index->hasInterfaceParams = true;
+            }
+            index->paramShapes.Add(shape);
+        }
+
+        // Inferring the arguments to a generic requires
+        // an argument for every parameter.
+        if (isGeneric)
+            candidate.minArgCount = candidate.maxArgCount;
+
+        index->candidates.Add(candidate);
+    }
+
+    if (index->candidates.Count() < kMinIndexedOverloadGroupSize)
+        return nullptr;
+
+    for (UInt cc = 0; cc < index->candidates.Count(); ++cc)
+    {
+        auto& candidate = index->candidates[cc];
+        for (UInt argCount = candidate.minArgCount; argCount <= candidate.maxArgCount; ++argCount)
+        {
+            for (int argClass = 0; argClass < kFirstArgClassCount; ++argClass)
+            {
+                if (argCount == 0)
+                {
+                    if (argClass != kFirstArgClass_Any)
+                        continue;
+                }
+                else if (!paramMayAcceptArg(index->paramShapes[candidate.firstParamShape], getFirstArgClassShape(argClass)))
+                {
+                    continue;
+                }
+
+                UInt key = getCandidateKey(argCount, argClass);
+                auto positions = index->candidatesByKey.TryGetValue(key);
+                if (!positions)
+                {
+                    index->candidatesByKey.Add(key, List<UInt>());
+                    positions = index->candidatesByKey.TryGetValue(key);
+                }
+                positions->Add(cc);
+            }
+        }
+    }
+
+    return index;
+}
+
+void buildOverloadGroupIndicesRec(ContainerDecl* decl)
+{
+    for (auto entry : decl->memberDictionary)
+    {
+        if (auto index = buildOverloadGroupIndex(entry.Value))
+            decl->overloadGroupIndices[entry.Key] = index;
+    }
+
+    for (auto m : decl->Members)
+    {
+        if (auto containerDecl = dynamicCast<ContainerDecl>(m.Ptr()))
+            buildOverloadGroupIndicesRec(containerDecl);
+    }
+
+    if (auto genericDecl = dynamicCast<GenericDecl>(decl))
+    {
+        if (auto innerDecl = dynamicCast<ContainerDecl>(genericDecl->inner.Ptr()))
+            buildOverloadGroupIndicesRec(innerDecl);
+    }
+}
+
 
 bool DeclPassesLookupMask(Decl* decl, LookupMask mask)
 {
     // type declarations
-    if(auto aggTypeDecl = dynamic_cast<AggTypeDecl*>(decl))
+    if(auto aggTypeDecl = dynamicCast<AggTypeDecl>(decl))
     {
         return int(mask) & int(LookupMask::Type);
     }
-    else if(auto simpleTypeDecl = dynamic_cast<SimpleTypeDecl*>(decl))
+    else if(auto simpleTypeDecl = dynamicCast<SimpleTypeDecl>(decl))
     {
         return int(mask) & int(LookupMask::Type);
     }
     // function declarations
-    else if(auto funcDecl = dynamic_cast<FunctionDeclBase*>(decl))
+    else if(auto funcDecl = dynamicCast<FunctionDeclBase>(decl))
     {
         return (int(mask) & int(LookupMask::Function)) != 0;
     }
@@ -151,7 +484,7 @@ LookupResultItem CreateLookupResultItem(
 }
 
 void DoMemberLookupImpl(
-    String const&			name,
+    Name*        			name,
     RefPtr<ExpressionType>	baseType,
     LookupRequest const&    request,
     LookupResult&			ioResult,
@@ -185,7 +518,7 @@ void DoMemberLookupImpl(
 }
 
 void DoMemberLookupImpl(
-    String const&	        name,
+    Name*        	        name,
     DeclRef<Decl>			        baseDeclRef,
     LookupRequest const&    request,
     LookupResult&	        ioResult,
@@ -197,7 +530,7 @@ void DoMemberLookupImpl(
 
 // Look for members of the given name in the given container for declarations
 void DoLocalLookupImpl(
-    String const&		    name,
+    Name*        		    name,
     DeclRef<ContainerDecl>	containerDeclRef,
     LookupRequest const&    request,
     LookupResult&		    result,
@@ -252,25 +585,38 @@ void DoLocalLookupImpl(
     // Consider lookup via extension
     if( auto aggTypeDeclRef = containerDeclRef.As<AggTypeDecl>() )
     {
-        RefPtr<ExpressionType> type = DeclRefType::Create(aggTypeDeclRef);
+        auto extensionTable = getExtensionMemberTable(request.semantics, aggTypeDeclRef);
+        if (!extensionTable)
+            return;
 
-        for (auto ext = GetCandidateExtensions(aggTypeDeclRef); ext; ext = ext->nextCandidateExtension)
+        // TODO: eventually we need to insert a breadcrumb here so that
+        // the constructed result can somehow indicate that a member
+        // was found through an extension.
+
+        if (extensionTable->hasTransparentMembers)
         {
-            auto extDeclRef = ApplyExtensionToType(request.semantics, ext, type);
-            if (!extDeclRef)
-                continue;
+            for (auto extDeclRef : extensionTable->extensions)
+                DoLocalLookupImpl(name, extDeclRef, request, result, inBreadcrumbs);
+            return;
+        }
 
-            // TODO: eventually we need to insert a breadcrumb here so that
-            // the constructed result can somehow indicate that a member
-            // was found through an extension.
+        auto members = extensionTable->membersByName.TryGetValue(name);
+        if (!members)
+            return;
+
+        for (auto member : *members)
+        {
+            if (!DeclPassesLookupMask(member.decl, request.mask))
+                continue;
 
-            DoLocalLookupImpl(name, extDeclRef, request, result, inBreadcrumbs);
+            auto& extDeclRef = extensionTable->extensions[member.extensionIndex];
+            AddToLookupResult(result, CreateLookupResultItem(DeclRef<Decl>(member.decl, extDeclRef.substitutions), inBreadcrumbs));
         }
     }
 }
 
 void DoLookupImpl(
-    String const&           name,
+    Name*                   name,
     LookupRequest const&    request,
     LookupResult&           result)
 {
@@ -292,7 +638,7 @@ void DoLookupImpl(
             // at the parameters themselves, so provide a fully-resolved
             // declaration reference for lookup.
             RefPtr<Substitutions> subst = nullptr;
-            if(auto parentGenericDecl = dynamic_cast<GenericDecl*>(containerDecl->ParentDecl))
+            if(auto parentGenericDecl = dynamicCast<GenericDecl>(containerDecl->ParentDecl))
             {
                 subst = new Substitutions();
                 subst->genericDecl = parentGenericDecl;
@@ -308,6 +654,7 @@ void DoLookupImpl(
                         subst->args.Add(new GenericParamIntVal(DeclRef<GenericValueParamDecl>(genericValParam.Ptr(), nullptr)));
                     }
                 }
+                subst = internSubstitutions(subst);
             }
 
             DeclRef<ContainerDecl> containerRef = DeclRef<Decl>(containerDecl, subst).As<ContainerDecl>();
@@ -325,7 +672,7 @@ void DoLookupImpl(
     // If we run out of scopes, then we are done.
 }
 
-LookupResult DoLookup(String const& name, LookupRequest const& request)
+LookupResult DoLookup(Name* name, LookupRequest const& request)
 {
     LookupResult result;
     DoLookupImpl(name, request, result);
@@ -334,7 +681,7 @@ LookupResult DoLookup(String const& name, LookupRequest const& request)
 
 LookupResult LookUp(
     SemanticsVisitor*   semantics,
-    String const&       name,
+    Name*               name,
     RefPtr<Scope>       scope)
 {
     LookupRequest request;
@@ -347,7 +694,7 @@ LookupResult LookUp(
 // and do *not* look further up the chain
 LookupResult LookUpLocal(
     SemanticsVisitor*       semantics,
-    String const&           name,
+    Name*                   name,
     DeclRef<ContainerDecl>  containerDeclRef)
 {
     LookupRequest request;
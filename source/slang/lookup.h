@@ -15,18 +15,96 @@ LookupResult refineLookup(LookupResult const& inResult, LookupMask mask);
 // built for the given container declaration.
 void buildMemberDictionary(ContainerDecl* decl);
 
+// Build the member dictionaries for a declaration and everything
+// nested inside of it. Code that is shared between compile requests
+// (like the standard library) needs this done up front, since the
+// dictionaries are otherwise built lazily during lookup.
+void buildMemberDictionariesRec(ContainerDecl* decl);
+
+// Build the indices for the overload groups in a declaration and
+// everything nested inside of it. The code must already have been
+// checked, and have its member dictionaries built.
+void buildOverloadGroupIndicesRec(ContainerDecl* decl);
+
+// Get what an `OverloadGroupIndex` needs to know about a type
+OverloadGroupIndex::TypeShape getOverloadTypeShape(ExpressionType* type);
+
+// The extensions that might apply to an aggregate type: first
+// those declared by the code in the current compile request,
+// and then those from the standard library (which are linked
+// through `nextCandidateExtension`).
+struct CandidateExtensionList
+{
+    struct Iterator
+    {
+        ExtensionDecl* const*   localCursor;
+        ExtensionDecl* const*   localEnd;
+        ExtensionDecl*          shared;
+
+        ExtensionDecl* operator*() const
+        {
+            return localCursor != localEnd ? *localCursor : shared;
+        }
+
+        void operator++()
+        {
+            if (localCursor != localEnd)
+                ++localCursor;
+            else
+                shared = shared->nextCandidateExtension;
+        }
+
+        bool operator!=(Iterator const& other) const
+        {
+            return localCursor != other.localCursor || shared != other.shared;
+        }
+    };
+
+    List<ExtensionDecl*> const* local = nullptr;
+    ExtensionDecl*              shared = nullptr;
+
+    Iterator begin() const
+    {
+        Iterator iter = { nullptr, nullptr, shared };
+        if (local)
+        {
+            iter.localCursor = local->begin();
+            iter.localEnd = local->end();
+        }
+        return iter;
+    }
+
+    Iterator end() const
+    {
+        ExtensionDecl* const* localEnd = local ? local->end() : nullptr;
+        Iterator iter = { localEnd, localEnd, nullptr };
+        return iter;
+    }
+};
+
+CandidateExtensionList GetCandidateExtensions(
+    SemanticsVisitor*       semantics,
+    DeclRef<AggTypeDecl>    declRef);
+
+// Get the extensions that apply to the type `declRef` refers to, and
+// their members. Returns null if there is no semantics visitor, since
+// extensions can't be applied without one.
+RefPtr<ExtensionMemberTable> getExtensionMemberTable(
+    SemanticsVisitor*       semantics,
+    DeclRef<AggTypeDecl>    declRef);
+
 // Look up a name in the given scope, proceeding up through
 // parent scopes as needed.
 LookupResult LookUp(
     SemanticsVisitor*   semantics,
-    String const&       name,
+    Name*               name,
     RefPtr<Scope>       scope);
 
 // perform lookup within the context of a particular container declaration,
 // and do *not* look further up the chain
 LookupResult LookUpLocal(
     SemanticsVisitor*       semantics,
-    String const&           name,
+    Name*                   name,
     DeclRef<ContainerDecl>  containerDeclRef);
 
 // TODO: this belongs somewhere else
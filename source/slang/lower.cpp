@@ -176,6 +176,10 @@ public:
         throw "unexpected";
     }
 
+    // Unlike the syntax classes, this isn't in the table of
+    // classes that need destructors (for its `List`)
+    void* operator new(size_t size) { return allocateSyntaxObject(size, true); }
+
     List<RefPtr<VarDeclBase>> decls;
 };
 
@@ -189,6 +193,10 @@ public:
         throw "unexpected";
     }
 
+    // Unlike the syntax classes, this isn't in the table of
+    // classes that need destructors (for its `List`)
+    void* operator new(size_t size) { return allocateSyntaxObject(size, true); }
+
     List<RefPtr<ExpressionSyntaxNode>> exprs;
 };
 
@@ -205,7 +213,7 @@ struct SharedLoweringContext
     CodeGenTarget   target;
 
     // A set of words reserved by the target
-    Dictionary<String, String> reservedWords;
+    HashSet<Name*> reservedWords;
 
 
     RefPtr<ProgramSyntaxNode>   loweredProgram;
@@ -250,15 +258,20 @@ struct LoweringVisitor
 
     CodeGenTarget getTarget() { return shared->target; }
 
-    bool isReservedWord(String const& name)
+    Name* getName(String const& text)
+    {
+        return shared->compileRequest->namePool->getName(text);
+    }
+
+    bool isReservedWord(Name* name)
     {
-        return shared->reservedWords.TryGetValue(name) != nullptr;
+        return shared->reservedWords.Contains(name);
     }
 
     void registerReservedWord(
-        String const&   name)
+        String const&   text)
     {
-        shared->reservedWords.Add(name, name);
+        shared->reservedWords.Add(getName(text));
     }
 
     void registerReservedWords()
@@ -543,7 +556,7 @@ struct LoweringVisitor
     }
 
     RefPtr<ExpressionSyntaxNode> createVarRef(
-        CodePosition const& loc,
+        SourceLoc const&    loc,
         VarDeclBase*        decl)
     {
         if (auto tupleDecl = dynamic_cast<TupleDecl*>(decl))
@@ -561,7 +574,7 @@ struct LoweringVisitor
     }
 
     RefPtr<ExpressionSyntaxNode> createTupleRef(
-        CodePosition const& loc,
+        SourceLoc const&    loc,
         TupleDecl*          decl)
     {
         RefPtr<TupleExpr> result = new TupleExpr();
@@ -1017,10 +1030,10 @@ struct LoweringVisitor
 
     RefPtr<Val> translateVal(Val* val)
     {
-        if (auto type = dynamic_cast<ExpressionType*>(val))
+        if (auto type = dynamicCast<ExpressionType>(val))
             return lowerType(type);
 
-        if (auto litVal = dynamic_cast<ConstantIntVal*>(val))
+        if (auto litVal = dynamicCast<ConstantIntVal>(val))
             return val;
 
         throw 99;
@@ -1043,7 +1056,7 @@ struct LoweringVisitor
     static Decl* getModifiedDecl(Decl* decl)
     {
         if (!decl) return nullptr;
-        if (auto genericDecl = dynamic_cast<GenericDecl*>(decl->ParentDecl))
+        if (auto genericDecl = dynamicCast<GenericDecl>(decl->ParentDecl))
             return genericDecl;
         return decl;
     }
@@ -1095,7 +1108,7 @@ struct LoweringVisitor
     RefPtr<DeclBase> lowerDeclBase(
         DeclBase* declBase)
     {
-        if (Decl* decl = dynamic_cast<Decl*>(declBase))
+        if (Decl* decl = dynamicCast<Decl>(declBase))
         {
             return lowerDecl(decl);
         }
@@ -1178,9 +1191,9 @@ struct LoweringVisitor
         // and ad hoc fashion, but longer term we'll want to do
         // something sytematic.
 
-        if (isReservedWord(decl->getName()))
+        if (isReservedWord(decl->getInternedName()))
         {
-            decl->Name.Content.append("_");
+            decl->Name.setName(getName(decl->getName() + "_"));
         }
     }
 
@@ -1535,7 +1548,7 @@ struct LoweringVisitor
         char const* name)
     {
         RefPtr<VarExpressionSyntaxNode> globalVarRef = new VarExpressionSyntaxNode();
-        globalVarRef->name = name;
+        globalVarRef->name = getName(name);
         return globalVarRef;
     }
 
@@ -1705,7 +1718,7 @@ struct LoweringVisitor
         if (!globalVarExpr)
         {
             RefPtr<Variable> globalVarDecl = new Variable();
-            globalVarDecl->Name.Content = info.name;
+            globalVarDecl->Name.setName(getName(info.name));
             globalVarDecl->Type.type = type;
 
             ensureDeclHasAValidName(globalVarDecl);
@@ -1733,7 +1746,7 @@ struct LoweringVisitor
             RefPtr<VarExpressionSyntaxNode> globalVarRef = new VarExpressionSyntaxNode();
             globalVarRef->Position = globalVarDecl->Position;
             globalVarRef->declRef = makeDeclRef(globalVarDecl.Ptr());
-            globalVarRef->name = globalVarDecl->getName();
+            globalVarRef->name = globalVarDecl->getInternedName();
 
             globalVarExpr = globalVarRef;
         }
@@ -1874,7 +1887,7 @@ struct LoweringVisitor
         auto declRef = makeDeclRef(localVarDecl.Ptr());
 
         RefPtr<VarExpressionSyntaxNode> expr = new VarExpressionSyntaxNode();
-        expr->name = name;
+        expr->name = localVarDecl->getInternedName();
         expr->declRef = declRef;
         expr->Type.type = GetType(declRef);
 
@@ -1918,11 +1931,11 @@ struct LoweringVisitor
         // Now we will generate a `void main() { ... }` function to call the lowered code.
         RefPtr<FunctionSyntaxNode> mainDecl = new FunctionSyntaxNode();
         mainDecl->ReturnType.type = ExpressionType::GetVoid();
-        mainDecl->Name.Content = "main";
+        mainDecl->Name.setName(getName("main"));
 
         // If the user's entry point was called `main` then rename it here
         if (loweredEntryPointFunc->getName() == "main")
-            loweredEntryPointFunc->Name.Content = "main_";
+            loweredEntryPointFunc->Name.setName(getName("main_"));
 
         RefPtr<BlockStmt> bodyStmt = new BlockStmt();
         bodyStmt->scopeDecl = new ScopeDecl();
@@ -1948,7 +1961,7 @@ struct LoweringVisitor
 
             RefPtr<Variable> localVarDecl = new Variable();
             localVarDecl->Position = paramDecl->Position;
-            localVarDecl->Name.Content = paramDecl->getName();
+            localVarDecl->Name.setName(paramDecl->getInternedName());
             localVarDecl->Type = lowerType(paramDecl->Type);
 
             ensureDeclHasAValidName(localVarDecl);
@@ -1984,7 +1997,7 @@ struct LoweringVisitor
         {
             resultVarDecl = new Variable();
             resultVarDecl->Position = loweredEntryPointFunc->Position;
-            resultVarDecl->Name.Content = "main_result";
+            resultVarDecl->Name.setName(getName("main_result"));
             resultVarDecl->Type = TypeExp(loweredEntryPointFunc->ReturnType);
 
             ensureDeclHasAValidName(resultVarDecl);
@@ -1999,7 +2012,7 @@ struct LoweringVisitor
         entryPointType->declRef = entryPointDeclRef;
 
         RefPtr<VarExpressionSyntaxNode> entryPointRef = new VarExpressionSyntaxNode();
-        entryPointRef->name = loweredEntryPointFunc->getName();
+        entryPointRef->name = loweredEntryPointFunc->getInternedName();
         entryPointRef->declRef = entryPointDeclRef;
         entryPointRef->Type = QualType(entryPointType);
 
@@ -2013,7 +2026,7 @@ struct LoweringVisitor
             auto localVarDecl = paramPair.lowered;
 
             RefPtr<VarExpressionSyntaxNode> varRef = new VarExpressionSyntaxNode();
-            varRef->name = localVarDecl->getName();
+            varRef->name = localVarDecl->getInternedName();
             varRef->declRef = makeDeclRef(localVarDecl.Ptr());
             varRef->Type = QualType(localVarDecl->getType());
 
@@ -2087,13 +2100,13 @@ struct LoweringVisitor
         {
             resultGlobal = new Variable();
             // TODO: need a scheme for generating unique names
-            resultGlobal->Name.Content = "_main_result";
+            resultGlobal->Name.setName(getName("_main_result"));
             resultGlobal->Type = loweredReturnType;
 
             addMember(shared->loweredProgram, resultGlobal);
         }
 
-        loweredDecl->Name.Content = "main";
+        loweredDecl->Name.setName(getName("main"));
         loweredDecl->ReturnType.type = ExpressionType::GetVoid();
 
         // We will emit the body statement in a context where
@@ -6,22 +6,22 @@
 #define SIMPLE_MODIFIER(NAME) \
     SIMPLE_SYNTAX_CLASS(NAME##Modifier, Modifier)
 
-SIMPLE_MODIFIER(In);
-SIMPLE_MODIFIER(Out);
-SIMPLE_MODIFIER(Const);
-SIMPLE_MODIFIER(Instance);
-SIMPLE_MODIFIER(Builtin);
-SIMPLE_MODIFIER(Inline);
-SIMPLE_MODIFIER(Public);
-SIMPLE_MODIFIER(Require);
-SIMPLE_MODIFIER(Param);
-SIMPLE_MODIFIER(Extern);
-SIMPLE_MODIFIER(Input);
-SIMPLE_MODIFIER(Transparent);
-SIMPLE_MODIFIER(FromStdLib);
-SIMPLE_MODIFIER(Prefix);
-SIMPLE_MODIFIER(Postfix);
-SIMPLE_MODIFIER(Exported);
+SIMPLE_MODIFIER(In)
+SIMPLE_MODIFIER(Out)
+SIMPLE_MODIFIER(Const)
+SIMPLE_MODIFIER(Instance)
+SIMPLE_MODIFIER(Builtin)
+SIMPLE_MODIFIER(Inline)
+SIMPLE_MODIFIER(Public)
+SIMPLE_MODIFIER(Require)
+SIMPLE_MODIFIER(Param)
+SIMPLE_MODIFIER(Extern)
+SIMPLE_MODIFIER(Input)
+SIMPLE_MODIFIER(Transparent)
+SIMPLE_MODIFIER(FromStdLib)
+SIMPLE_MODIFIER(Prefix)
+SIMPLE_MODIFIER(Postfix)
+SIMPLE_MODIFIER(Exported)
 
 #undef SIMPLE_MODIFIER
 
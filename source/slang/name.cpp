@@ -0,0 +1,94 @@
+// name.cpp
+#include "name.h"
+
+namespace Slang {
+
+String const& getText(Name* name)
+{
+    static const String emptyText;
+    return name ? name->text : emptyText;
+}
+
+Name* NamePool::getName(UnownedStringSlice const& text)
+{
+    int hash = text.GetHashCode();
+    UInt index = 0;
+
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex);
+        if (buckets.Count())
+        {
+            if (auto name = findName(text, hash, &index))
+                return name;
+        }
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+
+    // Keep the table at most half full, so that probe sequences stay short.
+    if ((names.Count() + 1) * 2 > buckets.Count())
+    {
+        rehash(buckets.Count() ? buckets.Count() * 2 : 256);
+    }
+
+    // Another thread may have added the name since we looked.
+    if (auto name = findName(text, hash, &index))
+        return name;
+
+    // This is the first time we've seen the name, so we need to create it.
+    // Names (and their text) are used by requests on any thread.
+    SharedRefObjectScope sharedScope;
+    RefPtr<Name> name = new Name();
+    name->text = String(text);
+    names.Add(name);
+
+    Entry& entry = buckets[index];
+    entry.name = name.Ptr();
+    entry.hash = hash;
+
+    return name.Ptr();
+}
+
+Name* NamePool::findName(UnownedStringSlice const& text, int hash, UInt* outIndex)
+{
+    UInt mask = buckets.Count() - 1;
+    UInt index = UInt(hash) & mask;
+    for (;;)
+    {
+        Entry& entry = buckets[index];
+        if (!entry.name)
+            break;
+
+        if (entry.hash == hash && entry.name->text.getUnownedSlice() == text)
+            return entry.name;
+
+        index = (index + 1) & mask;
+    }
+
+    *outIndex = index;
+    return nullptr;
+}
+
+void NamePool::rehash(UInt bucketCount)
+{
+    List<Entry> oldBuckets;
+    oldBuckets.SwapWith(buckets);
+
+    buckets.SetSize(bucketCount);
+    for (auto& entry : buckets)
+        entry = Entry();
+
+    UInt mask = bucketCount - 1;
+    for (auto const& oldEntry : oldBuckets)
+    {
+        if (!oldEntry.name)
+            continue;
+
+        UInt index = UInt(oldEntry.hash) & mask;
+        while (buckets[index].name)
+            index = (index + 1) & mask;
+        buckets[index] = oldEntry;
+    }
+}
+
+} // namespace Slang
@@ -0,0 +1,74 @@
+// name.h
+#ifndef SLANG_NAME_H_INCLUDED
+#define SLANG_NAME_H_INCLUDED
+
+#include "../core/basic.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+namespace Slang {
+
+// An interned identifier.
+//
+// Every distinct spelling of an identifier maps to a single `Name`
+// (owned by a `NamePool`), so that code that needs to look things
+// up by name can hash and compare `Name*` pointers instead of
+// the text of the names.
+class Name : public RefObject
+{
+public:
+    // The text of the name
+    String text;
+};
+
+// Get the text of a name, allowing for a null name.
+String const& getText(Name* name);
+
+// A table of all the interned names used in a session.
+//
+// Compile requests on different threads can share a pool. Looking
+// up a name that already exists (which is what the lexer does for
+// almost every identifier) only takes the lock shared, so threads
+// only wait on each other when one of them adds a name.
+class NamePool
+{
+public:
+    // Get the unique `Name` with the given text, creating it if needed.
+    //
+    // Looking up a name that already exists doesn't allocate.
+    Name* getName(UnownedStringSlice const& text);
+
+    Name* getName(String const& text)
+    {
+        return getName(text.getUnownedSlice());
+    }
+
+private:
+    struct Entry
+    {
+        Name*   name = nullptr;
+        int     hash = 0;
+    };
+
+    // Find the name with the given text in the table, or else the
+    // index of the empty bucket where it would go. The caller needs
+    // to hold `mutex` (shared or not).
+    Name* findName(UnownedStringSlice const& text, int hash, UInt* outIndex);
+
+    // Grow the hash table, and re-insert all the names.
+    void rehash(UInt bucketCount);
+
+    // Open-addressed hash table of the names, keyed on their text.
+    // The number of buckets is always a power of two.
+    List<Entry> buckets;
+
+    // Storage for all the names we have created.
+    List<RefPtr<Name>> names;
+
+    std::shared_timed_mutex mutex;
+};
+
+} // namespace Slang
+
+#endif
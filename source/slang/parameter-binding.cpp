@@ -180,7 +180,7 @@ LayoutSemanticInfo ExtractLayoutSemanticInfo(
     info.index = 0;
     info.kind = LayoutResourceKind::None;
 
-    auto registerName = semantic->registerName.Content;
+    String registerName = semantic->registerName.getContent();
     if (registerName.Length() == 0)
         return info;
 
@@ -256,7 +256,7 @@ static bool findLayoutArg(
     {
         if( modifier )
         {
-            *outVal = (UInt) strtoull(modifier->valToken.Content.Buffer(), nullptr, 10);
+            *outVal = (UInt) strtoull(String(modifier->valToken.getContent()).Buffer(), nullptr, 10);
             return true;
         }
     }
@@ -448,7 +448,7 @@ static void collectGlobalScopeParameter(
     //
     // First we look for an existing entry matching the name
     // of this parameter:
-    auto parameterName = varDecl->Name.Content;
+    auto parameterName = varDecl->getName();
     ParameterInfo* parameterInfo = nullptr;
     if( context->mapNameToParameterInfo.TryGetValue(parameterName, parameterInfo) )
     {
@@ -731,7 +731,7 @@ struct SimpleSemanticInfo
 SimpleSemanticInfo decomposeSimpleSemantic(
     HLSLSimpleSemantic* semantic)
 {
-    auto composedName = semantic->name.Content;
+    String composedName = semantic->name.getContent();
 
     // look for a trailing sequence of decimal digits
     // at the end of the composed name
@@ -1008,8 +1008,10 @@ static void collectEntryPointParameters(
     // Make sure we've got a query-able member dictionary
     buildMemberDictionary(translationUnitSyntax);
 
+    Name* entryPointName = entryPoint->compileRequest->namePool->getName(entryPoint->name);
+
     Decl* entryPointDecl;
-    if( !translationUnitSyntax->memberDictionary.TryGetValue(entryPoint->name, entryPointDecl) )
+    if( !translationUnitSyntax->memberDictionary.TryGetValue(entryPointName, entryPointDecl) )
     {
         // No such entry point!
         return;
@@ -1020,7 +1022,7 @@ static void collectEntryPointParameters(
         return;
     }
 
-    FunctionSyntaxNode* entryPointFuncDecl = dynamic_cast<FunctionSyntaxNode*>(entryPointDecl);
+    FunctionSyntaxNode* entryPointFuncDecl = dynamicCast<FunctionSyntaxNode>(entryPointDecl);
     if( !entryPointFuncDecl )
     {
         // Not a function!
@@ -54,6 +54,11 @@ namespace Slang
         // a token that we expected, when we exit recovery.
         bool isRecovering = false;
 
+        Name* getName(String const& text)
+        {
+            return translationUnit->compileRequest->namePool->getName(text);
+        }
+
         void FillPosition(SyntaxNode * node)
         {
             node->Position = tokenReader.PeekLoc();
@@ -71,7 +76,7 @@ namespace Slang
             currentScope = currentScope->parent;
         }
         Parser(
-            TokenSpan const& _tokens,
+            TokenReader const& _tokens,
             DiagnosticSink * sink,
             String _fileName,
             RefPtr<Scope> const& outerScope)
@@ -250,7 +255,7 @@ namespace Slang
     Token Parser::ReadToken(const char* expected)
     {
         if (tokenReader.PeekTokenType() == TokenType::Identifier
-                && tokenReader.PeekToken().Content == expected)
+                && tokenReader.PeekToken().getContent() == expected)
         {
             isRecovering = false;
             return tokenReader.AdvanceToken();
@@ -269,7 +274,7 @@ namespace Slang
                 // The token we expected?
                 // Then exit recovery mode and pretend like all is well.
                 if (tokenReader.PeekTokenType() == TokenType::Identifier
-                    && tokenReader.PeekToken().Content == expected)
+                    && tokenReader.PeekToken().getContent() == expected)
                 {
                     isRecovering = false;
                     return tokenReader.AdvanceToken();
@@ -425,16 +430,25 @@ namespace Slang
 
     bool Parser::LookAheadToken(const char * string, int offset)
     {
+        if (offset == 0)
+        {
+            return tokenReader.PeekTokenType() == TokenType::Identifier
+                && tokenReader.PeekToken().getContent() == string;
+        }
+
         TokenReader r = tokenReader;
         for (int ii = 0; ii < offset; ++ii)
             r.AdvanceToken();
 
         return r.PeekTokenType() == TokenType::Identifier
-            && r.PeekToken().Content == string;
+            && r.PeekToken().getContent() == string;
 }
 
     bool Parser::LookAheadToken(TokenType type, int offset)
     {
+        if (offset == 0)
+            return tokenReader.PeekTokenType() == type;
+
         TokenReader r = tokenReader;
         for (int ii = 0; ii < offset; ++ii)
             r.AdvanceToken();
@@ -526,8 +540,7 @@ namespace Slang
         RefPtr<ModifiableSyntaxNode>    syntax,
         RefPtr<Modifier>                modifier)
     {
-        auto modifierLink = &syntax->modifiers.first;
-        AddModifier(&modifierLink, modifier);
+        syntax->modifiers.add(modifier);
     }
 
     // Parse HLSL-style `[name(arg, ...)]` style "attribute" modifiers
@@ -574,7 +587,7 @@ namespace Slang
         RefPtr<Modifier>* modifierLink = &modifiers.first;
         for (;;)
         {
-            CodePosition loc = parser->tokenReader.PeekLoc();
+            SourceLoc loc = parser->tokenReader.PeekLoc();
 
             if (0) {}
 
@@ -637,13 +650,13 @@ namespace Slang
                 parser->ReadToken(TokenType::LParent);
                 if (parser->LookAheadToken(TokenType::IntegerLiteral))
                 {
-                    modifier->op = (IntrinsicOp)StringToInt(parser->ReadToken().Content);
+                    modifier->op = (IntrinsicOp)StringToInt(parser->ReadToken().getContent());
                 }
                 else
                 {
                     modifier->opToken = parser->ReadToken(TokenType::Identifier);
 
-                    modifier->op = findIntrinsicOp(modifier->opToken.Content.Buffer());
+                    modifier->op = findIntrinsicOp(String(modifier->opToken.getContent()).Buffer());
 
                     if (modifier->op == IntrinsicOp::Unknown)
                     {
@@ -696,7 +709,7 @@ namespace Slang
                     // TODO: better handling of this choise (e.g., lookup in scope)
                     if(0) {}
                 #define CASE(KEYWORD, CLASS) \
-                    else if(nameToken.Content == #KEYWORD) modifier = new CLASS()
+                    else if(nameToken.getContent() == #KEYWORD) modifier = new CLASS()
 
                     CASE(constant_id,   GLSLConstantIDLayoutModifier);
                     CASE(binding,       GLSLBindingLayoutModifier);
@@ -731,7 +744,7 @@ namespace Slang
             {
                 RefPtr<BuiltinTypeModifier> modifier = new BuiltinTypeModifier();
                 parser->ReadToken(TokenType::LParent);
-                modifier->tag = BaseType(StringToInt(parser->ReadToken(TokenType::IntegerLiteral).Content));
+                modifier->tag = BaseType(StringToInt(parser->ReadToken(TokenType::IntegerLiteral).getContent()));
                 parser->ReadToken(TokenType::RParent);
 
                 AddModifier(&modifierLink, modifier);
@@ -740,10 +753,10 @@ namespace Slang
             {
                 RefPtr<MagicTypeModifier> modifier = new MagicTypeModifier();
                 parser->ReadToken(TokenType::LParent);
-                modifier->name = parser->ReadToken(TokenType::Identifier).Content;
+                modifier->name = parser->ReadToken(TokenType::Identifier).getContent();
                 if (AdvanceIf(parser, TokenType::Comma))
                 {
-                    modifier->tag = uint32_t(StringToInt(parser->ReadToken(TokenType::IntegerLiteral).Content));
+                    modifier->tag = uint32_t(StringToInt(parser->ReadToken(TokenType::IntegerLiteral).getContent()));
                 }
                 parser->ReadToken(TokenType::RParent);
 
@@ -759,7 +772,7 @@ namespace Slang
                 {
                     LookupResult lookupResult = LookUp(
                         nullptr, // No semantics visitor available yet!
-                        parser->tokenReader.PeekToken().Content,
+                        parser->tokenReader.PeekToken().getName(),
                         parser->currentScope);
 
                     if( lookupResult.isValid() && !lookupResult.isOverloaded() )
@@ -767,14 +780,14 @@ namespace Slang
                         auto& item = lookupResult.item;
                         auto decl = item.declRef.getDecl();
 
-                        if( auto modifierDecl = dynamic_cast<ModifierDecl*>(decl) )
+                        if( auto modifierDecl = dynamicCast<ModifierDecl>(decl) )
                         {
                             // We found a declaration for some modifier syntax,
                             // so lets create an instance of the type it names
                             // here.
 
-                            auto syntax = createInstanceOfSyntaxClassByName(modifierDecl->classNameToken.Content);
-                            auto modifier = dynamic_cast<Modifier*>(syntax);
+                            auto syntax = createInstanceOfSyntaxClassByName(modifierDecl->classNameToken.getContent());
+                            auto modifier = dynamicCast<Modifier>(syntax);
 
                             if( modifier )
                             {
@@ -794,6 +807,7 @@ namespace Slang
                 }
 
                 // Done with modifier list
+                modifiers.updateClasses();
                 return modifiers;
             }
         }
@@ -817,7 +831,7 @@ namespace Slang
         if (peekTokenType(parser) == TokenType::StringLiteral)
         {
             auto nameToken = parser->ReadToken(TokenType::StringLiteral);
-            nameToken.Content = getStringLiteralTokenValue(nameToken);
+            nameToken.setContent(allocateSyntaxText(getStringLiteralTokenValue(nameToken).getUnownedSlice()));
             decl->nameToken = nameToken;
         }
         else
@@ -828,14 +842,14 @@ namespace Slang
             if (peekTokenType(parser) == TokenType::Dot)
             {
                 StringBuilder sb;
-                sb << nameToken.Content;
+                sb << nameToken.getContent();
                 while (AdvanceIf(parser, TokenType::Dot))
                 {
                     sb << "/";
-                    sb << parser->ReadToken(TokenType::Identifier).Content;
+                    sb << parser->ReadToken(TokenType::Identifier).getContent();
                 }
 
-                nameToken.Content = sb.ProduceString();
+                nameToken.setContent(allocateSyntaxText(sb.ProduceString().getUnownedSlice()));
             }
 
             decl->nameToken = nameToken;
@@ -894,14 +908,18 @@ namespace Slang
             case TokenType::QuestionMark:
                 if (AdvanceIf(parser, TokenType::Colon))
                 {
-                    name.Content = name.Content + ":";
+                    name.setName(parser->getName(String(name.getContent()) + ":"));
                     break;
                 }
 
             default:
-                parser->sink->diagnose(name.Position, Diagnostics::invalidOperator, name.Content);
+                parser->sink->diagnose(name.Position, Diagnostics::invalidOperator, name.getContent());
                 break;
             }
+
+            // The lexer only interns names for identifiers, so
+            // operator names need to be interned here.
+            name.setName(parser->getName(name.getContent()));
         }
         else
         {
@@ -933,7 +951,7 @@ namespace Slang
     struct PointerDeclarator : Declarator
     {
         // location of the `*` token
-        CodePosition starLoc;
+        SourceLoc starLoc;
 
         RefPtr<Declarator>				inner;
     };
@@ -944,7 +962,7 @@ namespace Slang
         RefPtr<Declarator>				inner;
 
         // location of the `[` token
-        CodePosition openBracketLoc;
+        SourceLoc openBracketLoc;
 
         // The expression that yields the element count, or NULL
         RefPtr<ExpressionSyntaxNode>	elementCountExpr;
@@ -961,7 +979,7 @@ namespace Slang
 
     // Add a member declaration to its container, and ensure that its
     // parent link is set up correctly.
-    static void AddMember(RefPtr<ContainerDecl> container, RefPtr<Decl> member)
+    static void AddMember(Parser* parser, RefPtr<ContainerDecl> container, RefPtr<Decl> member)
     {
         if (container)
         {
@@ -969,14 +987,15 @@ namespace Slang
             container->Members.Add(member);
 
             container->memberDictionaryIsValid = false;
+            parser->translationUnit->compileRequest->invalidateLookupCache();
         }
     }
 
-    static void AddMember(RefPtr<Scope> scope, RefPtr<Decl> member)
+    static void AddMember(Parser* parser, RefPtr<Scope> scope, RefPtr<Decl> member)
     {
         if (scope)
         {
-            AddMember(scope->containerDecl, member);
+            AddMember(parser, scope->containerDecl, member);
         }
     }
 
@@ -1001,7 +1020,7 @@ namespace Slang
 
         while (!AdvanceIfMatch(parser, TokenType::RParent))
         {
-            AddMember(decl, parser->ParseParameter());
+            AddMember(parser, decl, parser->ParseParameter());
             if (AdvanceIf(parser, TokenType::RParent))
                 break;
             parser->ReadToken(TokenType::Comma);
@@ -1048,11 +1067,11 @@ namespace Slang
     static RefPtr<VarDeclBase> CreateVarDeclForContext(
         ContainerDecl*  containerDecl )
     {
-        if (dynamic_cast<StructSyntaxNode*>(containerDecl) || dynamic_cast<ClassSyntaxNode*>(containerDecl))
+        if (dynamicCast<StructSyntaxNode>(containerDecl) || dynamicCast<ClassSyntaxNode>(containerDecl))
         {
             return new StructField();
         }
-        else if (dynamic_cast<CallableDecl*>(containerDecl))
+        else if (dynamicCast<CallableDecl>(containerDecl))
         {
             return new ParameterSyntaxNode();
         }
@@ -1068,22 +1087,17 @@ namespace Slang
         if (!modifiers)
             return;
 
-        RefPtr<Modifier>* link = &decl->modifiers.first;
-        while (*link)
-        {
-            link = &(*link)->next;
-        }
-        *link = modifiers;
+        decl->modifiers.add(modifiers);
     }
 
 
-    static String GenerateName(Parser* /*parser*/, String const& base)
+    static Name* GenerateName(Parser* parser, String const& base)
     {
         // TODO: somehow mangle the name to avoid clashes
-        return base;
+        return parser->getName(base);
     }
 
-    static String GenerateName(Parser* parser)
+    static Name* GenerateName(Parser* parser)
     {
         return GenerateName(parser, "_anonymous_" + String(parser->anonymousCounter++));
     }
@@ -1100,7 +1114,7 @@ namespace Slang
         if( declaratorInfo.nameToken.Type == TokenType::Unknown )
         {
             // HACK(tfoley): we always give a name, even if the declarator didn't include one... :(
-            decl->Name.Content = GenerateName(parser);
+            decl->Name.setName(GenerateName(parser));
         }
         else
         {
@@ -1307,7 +1321,7 @@ namespace Slang
     // Either a single declaration, or a group of them
     struct DeclGroupBuilder
     {
-        CodePosition        startPosition;
+        SourceLoc           startPosition;
         RefPtr<Decl>        decl;
         RefPtr<DeclGroup>   group;
 
@@ -1360,7 +1374,7 @@ namespace Slang
         auto expr = new VarExpressionSyntaxNode();
         expr->scope = parser->currentScope.Ptr();
         expr->Position = decl->getNameToken().Position;
-        expr->name = decl->getName();
+        expr->name = decl->getInternedName();
         return expr;
     }
 
@@ -1453,7 +1467,7 @@ namespace Slang
         auto basicType = new VarExpressionSyntaxNode();
         basicType->scope = parser->currentScope.Ptr();
         basicType->Position = typeName.Position;
-        basicType->name = typeName.Content;
+        basicType->name = typeName.getName();
 
         RefPtr<ExpressionSyntaxNode> typeExpr = basicType;
 
@@ -1476,7 +1490,7 @@ namespace Slang
         Parser*         parser,
         ContainerDecl*  containerDecl)
     {
-        CodePosition startPosition = parser->tokenReader.PeekLoc();
+        SourceLoc startPosition = parser->tokenReader.PeekLoc();
 
         auto typeSpec = parseTypeSpec(parser);
 
@@ -1710,7 +1724,7 @@ namespace Slang
         // We first look at the declaration keywrod to determine
         // the type of buffer to declare:
         String bufferWrapperTypeName;
-        CodePosition bufferWrapperTypeNamePos = parser->tokenReader.PeekLoc();
+        SourceLoc bufferWrapperTypeNamePos = parser->tokenReader.PeekLoc();
         if (AdvanceIf(parser, "cbuffer"))
         {
             bufferWrapperTypeName = "ConstantBuffer";
@@ -1742,8 +1756,8 @@ namespace Slang
         addModifier(bufferVarDecl, reflectionNameModifier);
 
         // Both the buffer variable and its type need to have names generated
-        bufferVarDecl->Name.Content = GenerateName(parser, "SLANG_constantBuffer_" + reflectionNameToken.Content);
-        bufferDataTypeDecl->Name.Content = GenerateName(parser, "SLANG_ConstantBuffer_" + reflectionNameToken.Content);
+        bufferVarDecl->Name.setName(GenerateName(parser, "SLANG_constantBuffer_" + String(reflectionNameToken.getContent())));
+        bufferDataTypeDecl->Name.setName(GenerateName(parser, "SLANG_ConstantBuffer_" + String(reflectionNameToken.getContent())));
 
         addModifier(bufferDataTypeDecl, new ImplicitParameterBlockElementTypeModifier());
         addModifier(bufferVarDecl, new ImplicitParameterBlockVariableModifier());
@@ -1756,13 +1770,13 @@ namespace Slang
         // Construct a type expression to reference the buffer data type
         auto bufferDataTypeExpr = new VarExpressionSyntaxNode();
         bufferDataTypeExpr->Position = bufferDataTypeDecl->Position;
-        bufferDataTypeExpr->name = bufferDataTypeDecl->Name.Content;
+        bufferDataTypeExpr->name = bufferDataTypeDecl->getInternedName();
         bufferDataTypeExpr->scope = parser->currentScope.Ptr();
 
         // Construct a type exrpession to reference the type constructor
         auto bufferWrapperTypeExpr = new VarExpressionSyntaxNode();
         bufferWrapperTypeExpr->Position = bufferWrapperTypeNamePos;
-        bufferWrapperTypeExpr->name = bufferWrapperTypeName;
+        bufferWrapperTypeExpr->name = parser->getName(bufferWrapperTypeName);
 
         // Always need to look this up in the outer scope,
         // so that it won't collide with, e.g., a local variable called `ConstantBuffer`
@@ -1788,8 +1802,7 @@ namespace Slang
         // members are implicitly made visible in the parent scope.
         // We achieve this by applying the transparent modifier to the variable.
         auto transparentModifier = new TransparentModifier();
-        transparentModifier->next = bufferVarDecl->modifiers.first;
-        bufferVarDecl->modifiers.first = transparentModifier;
+        bufferVarDecl->modifiers.prepend(transparentModifier);
 
         // Because we are constructing two declarations, we have a thorny
         // issue that were are only supposed to return one.
@@ -1801,7 +1814,7 @@ namespace Slang
         // will get attached to the variable declaration, not the type.
         // There might be cases where we need to shuffle things around.
 
-        AddMember(parser->currentScope, bufferDataTypeDecl);
+        AddMember(parser, parser->currentScope, bufferDataTypeDecl);
 
         return bufferVarDecl;
     }
@@ -1816,6 +1829,7 @@ namespace Slang
             if (*link == modifier)
             {
                 *link = (*link)->next;
+                modifiers.updateClasses();
                 return;
             }
 
@@ -1844,7 +1858,7 @@ namespace Slang
         // will see through it to the members inside.
 
 
-        CodePosition pos = parser->tokenReader.PeekLoc();
+        SourceLoc pos = parser->tokenReader.PeekLoc();
 
         // The initial name before the `{` is only supposed
         // to be made visible to reflection
@@ -1899,7 +1913,7 @@ namespace Slang
         parser->FillPosition(blockVarDecl.Ptr());
 
         // Generate a unique name for the data type
-        blockDataTypeDecl->Name.Content = GenerateName(parser, "SLANG_ParameterBlock_" + reflectionNameToken.Content);
+        blockDataTypeDecl->Name.setName(GenerateName(parser, "SLANG_ParameterBlock_" + String(reflectionNameToken.getContent())));
 
         // TODO(tfoley): We end up constructing unchecked syntax here that
         // is expected to type check into the right form, but it might be
@@ -1909,13 +1923,13 @@ namespace Slang
         // Construct a type expression to reference the buffer data type
         auto blockDataTypeExpr = new VarExpressionSyntaxNode();
         blockDataTypeExpr->Position = blockDataTypeDecl->Position;
-        blockDataTypeExpr->name = blockDataTypeDecl->Name.Content;
+        blockDataTypeExpr->name = blockDataTypeDecl->getInternedName();
         blockDataTypeExpr->scope = parser->currentScope.Ptr();
 
         // Construct a type exrpession to reference the type constructor
         auto blockWrapperTypeExpr = new VarExpressionSyntaxNode();
         blockWrapperTypeExpr->Position = pos;
-        blockWrapperTypeExpr->name = blockWrapperTypeName;
+        blockWrapperTypeExpr->name = parser->getName(blockWrapperTypeName);
         // Always need to look this up in the outer scope,
         // so that it won't collide with, e.g., a local variable called `ConstantBuffer`
         blockWrapperTypeExpr->scope = parser->outerScope;
@@ -1944,7 +1958,7 @@ namespace Slang
         else
         {
             // synthesize a dummy name
-            blockVarDecl->Name.Content = GenerateName(parser, "SLANG_parameterBlock_" + reflectionNameToken.Content);
+            blockVarDecl->Name.setName(GenerateName(parser, "SLANG_parameterBlock_" + String(reflectionNameToken.getContent())));
 
             // Otherwise we have a transparent declaration, similar
             // to an HLSL `cbuffer`
@@ -1966,7 +1980,7 @@ namespace Slang
         // will get attached to the variable declaration, not the type.
         // There might be cases where we need to shuffle things around.
 
-        AddMember(parser->currentScope, blockDataTypeDecl);
+        AddMember(parser, parser->currentScope, blockDataTypeDecl);
 
         return blockVarDecl;
     }
@@ -2017,7 +2031,7 @@ namespace Slang
                 paramConstraint->sub = TypeExp(paramTypeExpr);
                 paramConstraint->sup = parser->ParseTypeExp();
 
-                AddMember(genericDecl, paramConstraint);
+                AddMember(parser, genericDecl, paramConstraint);
 
 
             }
@@ -2040,7 +2054,7 @@ namespace Slang
         parser->genericDepth++;
         while (!parser->LookAheadToken(TokenType::OpGreater))
         {
-            AddMember(decl, ParseGenericParamDecl(parser, decl));
+            AddMember(parser, decl, ParseGenericParamDecl(parser, decl));
 
             if( parser->LookAheadToken(TokenType::OpGreater) )
                 break;
@@ -2084,7 +2098,7 @@ namespace Slang
                 inheritanceDecl->Position = base.exp->Position;
                 inheritanceDecl->base = base;
 
-                AddMember(decl, inheritanceDecl);
+                AddMember(parser, decl, inheritanceDecl);
 
             } while( AdvanceIf(parser, TokenType::Comma) );
         }
@@ -2159,7 +2173,7 @@ namespace Slang
         parser->ReadToken("__subscript");
 
         // TODO: the use of this name here is a bit magical...
-        decl->Name.Content = "operator[]";
+        decl->Name.setName(parser->getName("operator[]"));
 
         parseParameterList(parser, decl);
 
@@ -2174,7 +2188,7 @@ namespace Slang
             while( !AdvanceIfMatch(parser, TokenType::RBrace) )
             {
                 auto accessor = parseAccessorDecl(parser);
-                AddMember(decl, accessor);
+                AddMember(parser, decl, accessor);
             }
         }
         else
@@ -2208,7 +2222,7 @@ namespace Slang
 
     // Finish up work on a declaration that was parsed
     static void CompleteDecl(
-        Parser*				/*parser*/,
+        Parser*				parser,
         RefPtr<Decl>		decl,
         ContainerDecl*		containerDecl,
         Modifiers			modifiers)
@@ -2220,7 +2234,7 @@ namespace Slang
         // Make sure the decl is properly nested inside its lexical parent
         if (containerDecl)
         {
-            AddMember(containerDecl, decl);
+            AddMember(parser, containerDecl, decl);
         }
     }
 
@@ -2289,8 +2303,7 @@ namespace Slang
                 // were shared, vs. which ones are specific to a single declaration.
 
                 auto sharedModifiers = new SharedModifiers();
-                sharedModifiers->next = modifiers.first;
-                modifiers.first = sharedModifiers;
+                modifiers.prepend(sharedModifiers);
 
                 for( auto subDecl : declGroup->decls )
                 {
@@ -2375,7 +2388,7 @@ namespace Slang
         }
 
         PushScope(program);
-        program->Position = CodePosition(0, 0, 0, fileName);
+        program->Position = tokenReader.PeekLoc();
         ParseDeclBody(this, program, TokenType::EndOfFile);
         PopScope();
 
@@ -2453,7 +2466,7 @@ namespace Slang
         return stmt;
     }
 
-    static bool isGenericName(Parser* parser, String const& name)
+    static bool isGenericName(Parser* parser, Name* name)
     {
         auto lookupResult = LookUp(
             nullptr, // no semantics visitor available yet
@@ -2463,7 +2476,7 @@ namespace Slang
             return false;
 
         auto decl = lookupResult.item.declRef.getDecl();
-        if( auto genericDecl = dynamic_cast<GenericDecl*>(decl) )
+        if( auto genericDecl = dynamicCast<GenericDecl>(decl) )
         {
             return true;
         }
@@ -2474,7 +2487,7 @@ namespace Slang
     }
 
 
-    static bool isTypeName(Parser* parser, String const& name)
+    static bool isTypeName(Parser* parser, Name* name)
     {
         auto lookupResult = LookUp(
             nullptr, // no semantics visitor available yet
@@ -2484,11 +2497,11 @@ namespace Slang
             return false;
 
         auto decl = lookupResult.item.declRef.getDecl();
-        if( auto typeDecl = dynamic_cast<AggTypeDecl*>(decl) )
+        if( auto typeDecl = dynamicCast<AggTypeDecl>(decl) )
         {
             return true;
         }
-        else if( auto typeVarDecl = dynamic_cast<SimpleTypeDecl*>(decl) )
+        else if( auto typeVarDecl = dynamicCast<SimpleTypeDecl>(decl) )
         {
             return true;
         }
@@ -2503,7 +2516,7 @@ namespace Slang
         if(!parser->LookAheadToken(TokenType::Identifier))
             return false;
 
-        auto name = parser->tokenReader.PeekToken().Content;
+        Name* name = parser->tokenReader.PeekToken().getName();
         return isTypeName(parser, name);
     }
 
@@ -2550,7 +2563,7 @@ namespace Slang
             //
             // We'll solve this with backtracking for now.
 
-            Token* startPos = tokenReader.mCursor;
+            TokenReader startPos = tokenReader;
 
             // Try to parse a type (knowing that the type grammar is
             // a subset of the expression grammar, and so this should
@@ -2572,13 +2585,13 @@ namespace Slang
                 // Reset the cursor and try to parse a declaration now.
                 // Note: the declaration will consume any modifiers
                 // that had been in place on the statement.
-                tokenReader.mCursor = startPos;
+                tokenReader = startPos;
                 statement = ParseVarDeclrStatement(modifiers);
                 return statement;
             }
 
             // Fallback: reset and parse an expression
-            tokenReader.mCursor = startPos;
+            tokenReader = startPos;
             statement = ParseExpressionStatement();
         }
         else if (LookAheadToken(TokenType::Semicolon))
@@ -2874,7 +2887,7 @@ namespace Slang
         auto typeSpec = parseTypeSpec(this);
         if( typeSpec.decl )
         {
-            AddMember(currentScope, typeSpec.decl);
+            AddMember(this, currentScope, typeSpec.decl);
         }
         auto typeExpr = typeSpec.expr;
 
@@ -2972,7 +2985,8 @@ namespace Slang
         {
         case TokenType::QuestionMark:
             opToken = parser->ReadToken();
-            opToken.Content = "?:";
+            static const String conditionalOpText("?:");
+            opToken.setContent(conditionalOpText.getUnownedSlice());
             break;
 
         default:
@@ -2981,7 +2995,7 @@ namespace Slang
         }
 
         auto opExpr = new VarExpressionSyntaxNode();
-        opExpr->name = opToken.Content;
+        opExpr->name = parser->getName(opToken.getContent());
         opExpr->scope = parser->currentScope;
         opExpr->Position = opToken.Position;
 
@@ -3399,7 +3413,7 @@ namespace Slang
                     constExpr->token = token;
                     parser->FillPosition(constExpr.Ptr());
                     constExpr->ConstType = ConstantExpressionSyntaxNode::ConstantType::Bool;
-                    constExpr->integerValue = token.Content == "true" ? 1 : 0;
+                    constExpr->integerValue = token.getContent() == "true" ? 1 : 0;
 
                     return constExpr;
                 }
@@ -3409,7 +3423,7 @@ namespace Slang
                 varExpr->scope = parser->currentScope.Ptr();
                 parser->FillPosition(varExpr.Ptr());
                 auto token = parser->ReadToken(TokenType::Identifier);
-                varExpr->name = token.Content;
+                varExpr->name = token.getName();
 
                 if(peekTokenType(parser) == TokenType::OpLess)
                 {
@@ -3498,7 +3512,7 @@ namespace Slang
                     parser->FillPosition(memberExpr.Ptr());
                     memberExpr->BaseExpression = expr;
                     parser->ReadToken(TokenType::Dot); 
-                    memberExpr->name = parser->ReadToken(TokenType::Identifier).Content;
+                    memberExpr->name = parser->ReadToken(TokenType::Identifier).getName();
 
                     expr = memberExpr;
                 }
@@ -3609,12 +3623,12 @@ namespace Slang
             if (token.Type == TokenType::IntegerLiteral)
             {
                 constExpr->ConstType = ConstantExpressionSyntaxNode::ConstantType::Int;
-                constExpr->IntValue = StringToInt(token.Content);
+                constExpr->IntValue = StringToInt(token.getContent());
             }
             else if (token.Type == TokenType::FloatingPointLiteral)
             {
                 constExpr->ConstType = ConstantExpressionSyntaxNode::ConstantType::Float;
-                constExpr->FloatValue = (FloatingPointLiteralValue) StringToDouble(token.Content);
+                constExpr->FloatValue = (FloatingPointLiteralValue) StringToDouble(token.getContent());
             }
             rs = constExpr;
         }
@@ -3624,7 +3638,7 @@ namespace Slang
             auto token = tokenReader.AdvanceToken();
             FillPosition(constExpr.Ptr());
             constExpr->ConstType = ConstantExpressionSyntaxNode::ConstantType::Bool;
-            constExpr->IntValue = token.Content == "true" ? 1 : 0;
+            constExpr->IntValue = token.getContent() == "true" ? 1 : 0;
             rs = constExpr;
         }
         else if (LookAheadToken(TokenType::Identifier))
@@ -3633,7 +3647,7 @@ namespace Slang
             varExpr->scope = currentScope.Ptr();
             FillPosition(varExpr.Ptr());
             auto token = ReadToken(TokenType::Identifier);
-            varExpr->name = token.Content;
+            varExpr->name = token.getName();
             rs = varExpr;
         }
 
@@ -3698,7 +3712,7 @@ namespace Slang
                 FillPosition(memberExpr.Ptr());
                 memberExpr->BaseExpression = rs;
                 ReadToken(TokenType::Dot); 
-                memberExpr->name = ReadToken(TokenType::Identifier).Content;
+                memberExpr->name = ReadToken(TokenType::Identifier).getName();
                 rs = memberExpr;
             }
         }
@@ -3713,7 +3727,7 @@ namespace Slang
     // Parse a source file into an existing translation unit
     void parseSourceFile(
         TranslationUnitRequest*         translationUnit,
-        TokenSpan const&                tokens,
+        TokenReader const&              tokens,
         DiagnosticSink*                 sink,
         String const&                   fileName,
         RefPtr<Scope> const&            outerScope)
@@ -10,7 +10,7 @@ namespace Slang
     // Parse a source file into an existing translation unit
     void parseSourceFile(
         TranslationUnitRequest*         translationUnit,
-        TokenSpan const&                tokens,
+        TokenReader const&              tokens,
         DiagnosticSink*                 sink,
         String const&                   fileName,
         RefPtr<Scope> const&            outerScope);
@@ -1,6 +1,7 @@
 // preprocessor.cpp
 #include "preprocessor.h"
 
+#include "../core/slang-io.h"
 #include "compiler.h"
 #include "diagnostics.h"
 #include "lexer.h"
@@ -44,6 +45,7 @@ struct PreprocessorConditional
 };
 
 struct PreprocessorMacro;
+struct MacroExpansion;
 
 struct PreprocessorEnvironment
 {
@@ -51,7 +53,7 @@ struct PreprocessorEnvironment
     PreprocessorEnvironment*                parent = NULL;
 
     // Macros defined in this environment
-    Dictionary<String, PreprocessorMacro*>  macros;
+    Dictionary<Name*, PreprocessorMacro*>   macros;
 
     ~PreprocessorEnvironment();
 };
@@ -69,56 +71,79 @@ struct PreprocessorInputStream
     // The deepest preprocessor conditional active for this stream.
     PreprocessorConditional*        conditional;
 
-    // Environment to use when looking up macros
-    PreprocessorEnvironment*        environment;
+    // The expansion of a function-like macro whose parameters
+    // can be referenced by the tokens of this stream, or NULL
+    MacroExpansion*                 arguments;
+
+    // The expansions of the macros that the tokens of this stream came
+    // out of, innermost first (and linked by `hideSetParent`). These
+    // macros are "hidden" and aren't expanded again when they are
+    // referenced, which is what stops a macro from expanding itself.
+    MacroExpansion*                 hideSet;
 
     // Reader for pre-tokenized input
     TokenReader                     tokenReader;
 
-    // If we are clobbering source locations with `#line`, then
-    // the state is tracked here:
-
-    // Are we overriding source locations?
-    bool                            isOverridingSourceLoc;
+    // If the input is source text that is being lexed on demand,
+    // the lexer that is producing its tokens (see `LexMoreTokens()`)
+    Lexer*                          lexer = nullptr;
 
-    // What is the file name we are overriding to?
-    String                          overrideFileName;
-
-    // What is the relative offset to apply to any line numbers?
-    int                             overrideLineOffset;
+    // Is this stream a `MacroExpansion`?
+    bool                            isMacroExpansion = false;
 
     // Destructor is virtual so that we can clean up
     // after concrete subtypes.
-    virtual ~PreprocessorInputStream() = default;
+    virtual ~PreprocessorInputStream() { delete lexer; }
 };
 
 struct SourceTextInputStream : PreprocessorInputStream
 {
-    // The pre-tokenized input
+    // The pre-tokenized input, or (when `lexer` is set) the
+    // window of tokens that have been lexed but not yet dropped
     TokenList           lexedTokens;
 };
 
-struct MacroExpansion : PreprocessorInputStream
+// One argument to an invocation of a function-like macro
+struct MacroArgument
 {
-    // The macro we will expand
-    PreprocessorMacro*  macro;
-};
+    // The argument's tokens are `MacroExpansion::argumentTokens` from
+    // `beginIndex` up to the end-of-file token at `endIndex`.
+    UInt                beginIndex;
+    UInt                endIndex;
 
-struct ObjectLikeMacroExpansion : MacroExpansion
-{
+    // The `arguments` of the stream the argument was read from,
+    // which are the ones that its tokens can reference
+    MacroExpansion*     arguments;
 };
 
-struct FunctionLikeMacroExpansion : MacroExpansion
+// The expansion of a macro, or of one argument to a function-like
+// macro, or the result of pasting tokens together with `##`. The
+// preprocessor keeps a pool of these and reuses them, along with their
+// lists, so that expanding a macro usually doesn't need to allocate
+// anything.
+struct MacroExpansion : PreprocessorInputStream
 {
-    // Environment for macro arguments
-    PreprocessorEnvironment     argumentEnvironment;
+    // The macro we will expand, or NULL if we are expanding an
+    // argument or a paste
+    PreprocessorMacro*  macro;
+
+    // The next expansion out in the hide set of this one's tokens
+    MacroExpansion*     hideSetParent;
+
+    // For a function-like macro, its arguments, and the tokens of all
+    // of them (each argument followed by an end-of-file token). For a
+    // paste, the tokens lexed from the pasted text.
+    List<MacroArgument> args;
+    List<Token>         argumentTokens;
+
+    // The next expansion in a list of unused expansions
+    MacroExpansion*     nextFree;
 };
 
 // An enumeration for the diferent types of macros
 enum class PreprocessorMacroFlavor
 {
     ObjectLike,
-    FunctionArg,
     FunctionLike,
 };
 
@@ -139,12 +164,6 @@ struct PreprocessorMacro
 
     // The flavor of macro
     PreprocessorMacroFlavor     flavor;
-
-    // The environment in which this macro needs to be expanded.
-    // For ordinary macros this will be the global environment,
-    // while for function-like macro arguments, it will be
-    // the environment of the macro invocation.
-    PreprocessorEnvironment*    environment;
 };
 
 // State of the preprocessor
@@ -153,6 +172,12 @@ struct Preprocessor
     // diagnostics sink to use when writing messages
     DiagnosticSink*                         sink;
 
+    // Source manager that owns the files we read
+    SourceManager*                          sourceManager;
+
+    // Pool used to intern identifier names
+    NamePool*                               namePool;
+
     // An external callback interface to use when looking
     // for files in a `#include` directive
     IncludeHandler*                         includeHandler;
@@ -170,6 +195,22 @@ struct Preprocessor
     // The translation unit that is being parsed
     TranslationUnitRequest*                 translationUnit;
 
+    // Canonical paths (see `Path::GetCanonical()`) of the files that
+    // have used `#pragma once`, and so shouldn't be included again,
+    // however the path to them is spelled
+    HashSet<String>                         pragmaOnceFiles;
+
+    // Macro expansions that are ready to be reused
+    MacroExpansion*                         freeExpansions;
+
+    // Macro expansions that have ended, but that the expansions still
+    // in progress might refer to (see `DestroyInputStream()`)
+    MacroExpansion*                         endedExpansions;
+
+    // The number of macro expansions that have been created
+    // and haven't ended yet
+    int                                     activeExpansionCount;
+
     TranslationUnitRequest* getTranslationUnit()
     {
         return translationUnit;
@@ -192,6 +233,18 @@ static DiagnosticSink* GetSink(Preprocessor* preprocessor)
     return preprocessor->sink;
 }
 
+// Convenience routine to access the source manager
+static SourceManager* GetSourceManager(Preprocessor* preprocessor)
+{
+    return preprocessor->sourceManager;
+}
+
+// Convenience routine to access the name pool
+static NamePool* GetNamePool(Preprocessor* preprocessor)
+{
+    return preprocessor->namePool;
+}
+
 //
 // Forward declarations
 //
@@ -204,29 +257,118 @@ static void DestroyMacro(Preprocessor* preprocessor, PreprocessorMacro* macro);
 //
 
 // Create a fresh input stream
-static void  InitializeInputStream(Preprocessor* preprocessor, PreprocessorInputStream* inputStream)
+static void  InitializeInputStream(Preprocessor* /*preprocessor*/, PreprocessorInputStream* inputStream)
 {
     inputStream->parent = NULL;
     inputStream->conditional = NULL;
-    inputStream->environment = &preprocessor->globalEnv;
+    inputStream->arguments = NULL;
+    inputStream->hideSet = NULL;
 }
 
 // Destroy an input stream
-static void DestroyInputStream(Preprocessor* /*preprocessor*/, PreprocessorInputStream* inputStream)
+static void DestroyInputStream(Preprocessor* preprocessor, PreprocessorInputStream* inputStream)
 {
-    delete inputStream;
+    if (!inputStream->isMacroExpansion)
+    {
+        delete inputStream;
+        return;
+    }
+
+    // A macro expansion goes back to the pool. Expansions that are still
+    // in progress can refer to one that has ended (for example, when the
+    // arguments of a macro invoked in its body run past its end), so it
+    // can't be reused until every expansion has ended.
+    MacroExpansion* expansion = static_cast<MacroExpansion*>(inputStream);
+    expansion->nextFree = preprocessor->endedExpansions;
+    preprocessor->endedExpansions = expansion;
+
+    if (--preprocessor->activeExpansionCount == 0)
+    {
+        while (MacroExpansion* ended = preprocessor->endedExpansions)
+        {
+            preprocessor->endedExpansions = ended->nextFree;
+            ended->nextFree = preprocessor->freeExpansions;
+            preprocessor->freeExpansions = ended;
+        }
+    }
+}
+
+// How many tokens to lex at a time for a stream that
+// lexes its source text on demand
+static const UInt kLexedTokenChunkSize = 256;
+
+// Lex the next chunk of tokens for a stream that lexes its source
+// text on demand. The tokens that have already been read are
+// dropped, so the stream only ever holds a chunk's worth of tokens,
+// rather than every token in the file.
+static void LexMoreTokens(PreprocessorInputStream* inputStream)
+{
+    // Only source text streams are ever given a lexer
+    SourceTextInputStream* sourceStream = static_cast<SourceTextInputStream*>(inputStream);
+    List<Token>& tokens = sourceStream->lexedTokens.mTokens;
+    TokenReader& reader = inputStream->tokenReader;
+
+    // Keep any tokens that have been lexed but not read yet
+    UInt unreadCount = UInt(reader.mEnd - reader.mCursor);
+    if (tokens.Count() > unreadCount)
+        tokens.RemoveRange(0, tokens.Count() - unreadCount);
+
+    Lexer* lexer = inputStream->lexer;
+    while (tokens.Count() < kLexedTokenChunkSize)
+    {
+        Token token = lexer->lexToken();
+        tokens.Add(token);
+
+        if (token.Type == TokenType::EndOfFile)
+        {
+            // The stream now holds the rest of its input, ending
+            // in the end-of-file token that `TokenList` expects.
+            delete lexer;
+            inputStream->lexer = nullptr;
+            reader = TokenReader(sourceStream->lexedTokens);
+            return;
+        }
+    }
+
+    // There is more input to come, so the reader can use every
+    // token we have; `EnsureRawTokens()` makes sure that it never
+    // looks past them.
+    reader.mCursor = tokens.Buffer();
+    reader.mEnd = tokens.Buffer() + tokens.Count();
 }
 
-// Create an input stream to represent a pre-tokenized input file.
-// TODO(tfoley): pre-tokenizing files isn't going to work in the long run.
-static PreprocessorInputStream* CreateInputStreamForSource(Preprocessor* preprocessor, String const& source, String const& fileName)
+// Make sure the next `count` tokens of a stream (up to its end)
+// have been lexed, so that they can be read or peeked.
+static void EnsureRawTokens(PreprocessorInputStream* inputStream, int count)
+{
+    if (inputStream->lexer && inputStream->tokenReader.GetCount() < count)
+        LexMoreTokens(inputStream);
+}
+
+// Create an input stream to read the tokens of a source file. The
+// file is lexed on demand, a chunk at a time, as the tokens are read.
+static PreprocessorInputStream* CreateInputStreamForSource(Preprocessor* preprocessor, SourceFile* sourceFile)
 {
     SourceTextInputStream* inputStream = new SourceTextInputStream();
     InitializeInputStream(preprocessor, inputStream);
 
+    // The tokens refer to the file, and may end up in the syntax
+    addSyntaxSourceFile(sourceFile);
+
     // Use existing `Lexer` to generate a token stream.
-    Lexer lexer(fileName, source, GetSink(preprocessor));
-    inputStream->lexedTokens = lexer.lexAllTokens();
+    inputStream->lexer = new Lexer(sourceFile, GetSink(preprocessor), GetNamePool(preprocessor));
+    LexMoreTokens(inputStream);
+
+    return inputStream;
+}
+
+// Create an input stream to read tokens that were already lexed
+static PreprocessorInputStream* CreateInputStreamForTokens(Preprocessor* preprocessor, TokenList const& tokens)
+{
+    SourceTextInputStream* inputStream = new SourceTextInputStream();
+    InitializeInputStream(preprocessor, inputStream);
+
+    inputStream->lexedTokens = tokens;
     inputStream->tokenReader = TokenReader(inputStream->lexedTokens);
 
     return inputStream;
@@ -262,33 +404,24 @@ static void EndInputStream(Preprocessor* preprocessor, PreprocessorInputStream*
     DestroyInputStream(preprocessor, inputStream);
 }
 
-// Potentially clobber source location information based on `#line`
-static Token PossiblyOverrideSourceLoc(PreprocessorInputStream* inputStream, Token const& token)
-{
-    Token result = token;
-    if( inputStream->isOverridingSourceLoc )
-    {
-        result.Position.FileName = inputStream->overrideFileName;
-        result.Position.Line += inputStream->overrideLineOffset;
-    }
-    return result;
-}
-
 // Consume one token from an input stream
 static Token AdvanceRawToken(PreprocessorInputStream* inputStream)
 {
-    return PossiblyOverrideSourceLoc(inputStream, inputStream->tokenReader.AdvanceToken());
+    EnsureRawTokens(inputStream, 1);
+    return inputStream->tokenReader.AdvanceToken();
 }
 
 // Peek one token from an input stream
 static Token PeekRawToken(PreprocessorInputStream* inputStream)
 {
-    return PossiblyOverrideSourceLoc(inputStream, inputStream->tokenReader.PeekToken());
+    EnsureRawTokens(inputStream, 1);
+    return inputStream->tokenReader.PeekToken();
 }
 
 // Peek one token type from an input stream
 static TokenType PeekRawTokenType(PreprocessorInputStream* inputStream)
 {
+    EnsureRawTokens(inputStream, 1);
     return inputStream->tokenReader.PeekTokenType();
 }
 
@@ -375,6 +508,7 @@ TokenType PeekSecondRawTokenType(Preprocessor* preprocessor)
         // look one entry up the stack (don't actually pop
         // here, since we are just peeking)
 
+        EnsureRawTokens(inputStream, count + 1);
         TokenReader reader = inputStream->tokenReader;
         if (reader.PeekTokenType() == TokenType::EndOfFile)
         {
@@ -403,7 +537,7 @@ TokenType PeekSecondRawTokenType(Preprocessor* preprocessor)
 
 
 // Get the location of the current (raw) token
-static CodePosition PeekLoc(Preprocessor* preprocessor)
+static SourceLoc PeekLoc(Preprocessor* preprocessor)
 {
     return PeekRawToken(preprocessor).Position;
 }
@@ -426,7 +560,6 @@ static PreprocessorMacro* CreateMacro(Preprocessor* preprocessor)
 
     PreprocessorMacro* macro = new PreprocessorMacro();
     macro->flavor = PreprocessorMacroFlavor::ObjectLike;
-    macro->environment = &preprocessor->globalEnv;
     return macro;
 }
 
@@ -438,7 +571,7 @@ static void DestroyMacro(Preprocessor* /*preprocessor*/, PreprocessorMacro* macr
 
 
 // Find the currently-defined macro of the given name, or return NULL
-static PreprocessorMacro* LookupMacro(PreprocessorEnvironment* environment, String const& name)
+static PreprocessorMacro* LookupMacro(PreprocessorEnvironment* environment, Name* name)
 {
     for(PreprocessorEnvironment* e = environment; e; e = e->parent)
     {
@@ -450,72 +583,67 @@ static PreprocessorMacro* LookupMacro(PreprocessorEnvironment* environment, Stri
     return NULL;
 }
 
-static PreprocessorEnvironment* GetCurrentEnvironment(Preprocessor* preprocessor)
+// Find the input stream that the next raw token will be read from.
+static PreprocessorInputStream* GetCurrentInputStream(Preprocessor* preprocessor)
 {
-    // The environment we will use for looking up a macro is assocaited
-    // with the current input stream (because it may include entries
-    // for macro arguments).
-    //
-    // We need to be careful, though, when we are at the end of an
-    // input stream (e.g., representing one argument), so that we
-    // don't use its environment.
+    // The stream on top of the stack may be at its end (e.g., when
+    // it represents one argument), in which case the token will
+    // come from a stream further down.
 
     PreprocessorInputStream* inputStream = preprocessor->inputStream;
-
-    for(;;)
+    while (inputStream && PeekRawTokenType(inputStream) == TokenType::EndOfFile)
     {
-        // If there is no input stream that isn't at its end,
-        // then fall back to the global environment.
-        if (!inputStream)
-            return &preprocessor->globalEnv;
-
-        // If the current input stream is at its end, then
-        // fall back to its parent stream.
-        if (inputStream->tokenReader.PeekTokenType() == TokenType::EndOfFile)
-        {
-            inputStream = inputStream->parent;
-            continue;
-        }
-
-        // If we've found an active stream that isn't at its end,
-        // then use that for lookup.
-        return inputStream->environment;
+        inputStream = inputStream->parent;
     }
+    return inputStream;
+}
+
+static PreprocessorMacro* LookupMacro(Preprocessor* preprocessor, Name* name)
+{
+    return LookupMacro(&preprocessor->globalEnv, name);
 }
 
-static PreprocessorMacro* LookupMacro(Preprocessor* preprocessor, String const& name)
+// Find the index of the parameter with the given name in a
+// function-like macro, or return -1 if there isn't one.
+static Int FindMacroParam(PreprocessorMacro* macro, Name* name)
 {
-    return LookupMacro(GetCurrentEnvironment(preprocessor), name);
+    UInt paramCount = macro->params.Count();
+    for (UInt ii = 0; ii < paramCount; ++ii)
+    {
+        if (macro->params[ii].getName() == name)
+            return Int(ii);
+    }
+    return -1;
 }
 
 // A macro is "busy" if it is currently being used for expansion.
 // A macro cannot be expanded again while busy, to avoid infinite recursion.
-static bool IsMacroBusy(PreprocessorMacro* /*macro*/)
-{
-    // TODO: need to implement this correctly
-    //
-    // The challenge here is that we are implementing expansion
-    // for argumenst to function-like macros in a "lazy" fashion.
-    //
-    // The letter of the spec is that we should macro expand
-    // each argument *before* substitution, and then go and
-    // macro-expand the substituted body. This means that we
-    // can invoke a macro as part of an argument to an
-    // invocation of the same macro:
-    //
-    //     FOO( 1, FOO(22), 333 );
-    //
-    // In our implementation, the "inner" invocation of `FOO`
-    // gets expanded at the point where it gets referenced
-    // in the body of the "outer" invocation of `FOO`.
-    // Doing things this way leads to greatly simplified
-    // code for handling expansion.
-    //
-    // A proper implementation of `IsMacroBusy` needs to
-    // take context into account, so that it bans recursive
-    // use of a macro when it occurs (indirectly) through
-    // the *body* of the expansion, but not when it occcurs
-    // only through an *argument*.
+//
+// Arguments to function-like macros are expanded "lazily", at the
+// point where they are referenced in the body of the macro, rather
+// than before they are substituted. Doing things this way leads to
+// greatly simplified code for handling expansion, but it means that
+// a macro can't be treated as busy just because an expansion of it is
+// on the input stack: we can invoke a macro as part of an argument to
+// an invocation of the same macro:
+//
+//     FOO( 1, FOO(22), 333 );
+//
+// Instead each stream has a "hide set" of the macros whose bodies its
+// tokens came out of. The stream for an argument gets the hide set of
+// the stream the invocation was read from, rather than that of the
+// macro body that referenced it, so `FOO` is busy in the body of `FOO`
+// but not in the arguments it was invoked with.
+static bool IsMacroBusy(PreprocessorInputStream* inputStream, PreprocessorMacro* macro)
+{
+    if (!inputStream)
+        return false;
+
+    for (MacroExpansion* e = inputStream->hideSet; e; e = e->hideSetParent)
+    {
+        if (e->macro == macro)
+            return true;
+    }
     return false;
 }
 
@@ -523,15 +651,28 @@ static bool IsMacroBusy(PreprocessorMacro* /*macro*/)
 // Reading Tokens With Expansion
 //
 
-static void InitializeMacroExpansion(
-    Preprocessor*       preprocessor,
-    MacroExpansion*     expansion,
-    PreprocessorMacro*  macro)
+// Get an unused macro expansion from the pool (or make a new one)
+static MacroExpansion* CreateMacroExpansion(Preprocessor* preprocessor)
 {
+    MacroExpansion* expansion = preprocessor->freeExpansions;
+    if (expansion)
+    {
+        preprocessor->freeExpansions = expansion->nextFree;
+    }
+    else
+    {
+        expansion = new MacroExpansion();
+        expansion->isMacroExpansion = true;
+    }
+    preprocessor->activeExpansionCount++;
+
     InitializeInputStream(preprocessor, expansion);
-    expansion->environment = macro->environment;
-    expansion->macro = macro;
-    expansion->tokenReader = TokenReader(macro->tokens);
+    expansion->macro = NULL;
+    expansion->hideSetParent = NULL;
+    expansion->args.Clear();
+    expansion->argumentTokens.Clear();
+    expansion->nextFree = NULL;
+    return expansion;
 }
 
 static void PushMacroExpansion(
@@ -541,13 +682,50 @@ static void PushMacroExpansion(
     PushInputStream(preprocessor, expansion);
 }
 
-static void AddEndOfStreamToken(
+// Start reading the tokens of argument `argIndex` to the function-like
+// macro expansion `expansion`.
+static void BeginArgumentExpansion(
+    Preprocessor*   preprocessor,
+    MacroExpansion* expansion,
+    UInt            argIndex)
+{
+    MacroArgument const& arg = expansion->args[argIndex];
+
+    MacroExpansion* argExpansion = CreateMacroExpansion(preprocessor);
+    argExpansion->arguments = arg.arguments;
+    argExpansion->hideSet = expansion->hideSetParent;
+
+    Token* tokens = expansion->argumentTokens.Buffer();
+    argExpansion->tokenReader.mCursor = tokens + arg.beginIndex;
+    argExpansion->tokenReader.mEnd = tokens + arg.endIndex;
+
+    PushMacroExpansion(preprocessor, argExpansion);
+}
+
+// Start reading an argument to the function-like macro being invoked
+static void BeginMacroArgument(
     Preprocessor*       preprocessor,
-    PreprocessorMacro*  macro)
+    MacroExpansion*     expansion)
 {
+    PreprocessorInputStream* inputStream = GetCurrentInputStream(preprocessor);
+
+    MacroArgument arg;
+    arg.beginIndex = expansion->argumentTokens.Count();
+    arg.endIndex = arg.beginIndex;
+    arg.arguments = inputStream ? inputStream->arguments : NULL;
+    expansion->args.Add(arg);
+}
+
+// Finish the argument that is being read
+static void EndMacroArgument(
+    Preprocessor*       preprocessor,
+    MacroExpansion*     expansion)
+{
+    expansion->args.Last().endIndex = expansion->argumentTokens.Count();
+
     Token token = PeekRawToken(preprocessor);
     token.Type = TokenType::EndOfFile;
-    macro->tokens.mTokens.Add(token);
+    expansion->argumentTokens.Add(token);
 }
 
 // Check whether the current token on the given input stream should be
@@ -567,8 +745,24 @@ static void MaybeBeginMacroExpansion(
         if (token.Type != TokenType::Identifier)
             return;
 
+        Name* name = token.getName();
+        PreprocessorInputStream* inputStream = GetCurrentInputStream(preprocessor);
+
+        // A parameter of the function-like macro being expanded
+        // expands to the corresponding argument.
+        if (inputStream && inputStream->arguments)
+        {
+            MacroExpansion* expansion = inputStream->arguments;
+            Int paramIndex = FindMacroParam(expansion->macro, name);
+            if (paramIndex >= 0)
+            {
+                AdvanceRawToken(preprocessor);
+                BeginArgumentExpansion(preprocessor, expansion, UInt(paramIndex));
+                continue;
+            }
+        }
+
         // Look for a macro with the given name.
-        String name = token.Content;
         PreprocessorMacro* macro = LookupMacro(preprocessor, name);
 
         // Not a macro? Can't be an invocation.
@@ -577,7 +771,7 @@ static void MaybeBeginMacroExpansion(
 
         // If the macro is busy (already being expanded),
         // don't try to trigger recursive expansion
-        if (IsMacroBusy(macro))
+        if (IsMacroBusy(inputStream, macro))
             return;
 
         // A function-style macro invocation should only match
@@ -594,10 +788,10 @@ static void MaybeBeginMacroExpansion(
             // Consume the opening `(`
             Token leftParen = AdvanceRawToken(preprocessor);
 
-            FunctionLikeMacroExpansion* expansion = new FunctionLikeMacroExpansion();
-            InitializeMacroExpansion(preprocessor, expansion, macro);
-            expansion->argumentEnvironment.parent = &preprocessor->globalEnv;
-            expansion->environment = &expansion->argumentEnvironment;
+            MacroExpansion* expansion = CreateMacroExpansion(preprocessor);
+            expansion->macro = macro;
+            expansion->arguments = expansion;
+            expansion->hideSet = expansion;
 
             // Try to read any arguments present.
             UInt paramCount = macro->params.Count();
@@ -615,17 +809,7 @@ static void MaybeBeginMacroExpansion(
                 while(argIndex < paramCount)
                 {
                     // Read an argument
-
-                    // Create the argument, represented as a special flavor of macro
-                    PreprocessorMacro* arg = CreateMacro(preprocessor);
-                    arg->flavor = PreprocessorMacroFlavor::FunctionArg;
-                    arg->environment = GetCurrentEnvironment(preprocessor);
-
-                    // Associate the new macro with its parameter name
-                    Token paramToken = macro->params[argIndex];
-                    String const& paramName = paramToken.Content;
-                    arg->nameToken = paramToken;
-                    expansion->argumentEnvironment.macros[paramName] = arg;
+                    BeginMacroArgument(preprocessor, expansion);
                     argIndex++;
 
                     // Read tokens for the argument
@@ -642,7 +826,7 @@ static void MaybeBeginMacroExpansion(
                             // if we reach the end of the file,
                             // then we have an error, and need to
                             // bail out
-                            AddEndOfStreamToken(preprocessor, arg);
+                            EndMacroArgument(preprocessor, expansion);
                             goto doneWithAllArguments;
 
                         case TokenType::RParent:
@@ -650,7 +834,7 @@ static void MaybeBeginMacroExpansion(
                             // then we are at the end of an argument
                             if (nesting == 0)
                             {
-                                AddEndOfStreamToken(preprocessor, arg);
+                                EndMacroArgument(preprocessor, expansion);
                                 goto doneWithAllArguments;
                             }
                             // Otherwise we decrease our nesting depth, add
@@ -663,7 +847,7 @@ static void MaybeBeginMacroExpansion(
                             // then we are at the end of an argument
                             if (nesting == 0)
                             {
-                                AddEndOfStreamToken(preprocessor, arg);
+                                EndMacroArgument(preprocessor, expansion);
                                 AdvanceRawToken(preprocessor);
                                 goto doneWithArgument;
                             }
@@ -681,7 +865,7 @@ static void MaybeBeginMacroExpansion(
                         }
 
                         // Add the token and continue parsing.
-                        arg->tokens.mTokens.Add(AdvanceRawToken(preprocessor));
+                        expansion->argumentTokens.Add(AdvanceRawToken(preprocessor));
                     }
                 doneWithArgument: {}
                     // We've parsed an argument and should move onto
@@ -692,6 +876,12 @@ static void MaybeBeginMacroExpansion(
         doneWithAllArguments:
             // TODO: handle possible varargs
 
+            // The tokens of the expansion are hidden from the macros whose
+            // expansions the closing `)` came out of (which, since it is read
+            // last, are a subset of those that the macro name came out of).
+            PreprocessorInputStream* closingStream = GetCurrentInputStream(preprocessor);
+            expansion->hideSetParent = closingStream ? closingStream->hideSet : NULL;
+
             // Expect closing right paren
             if (PeekRawTokenType(preprocessor) == TokenType::RParent)
             {
@@ -710,16 +900,22 @@ static void MaybeBeginMacroExpansion(
             }
 
             // We are ready to expand.
+            expansion->tokenReader = TokenReader(macro->tokens);
             PushMacroExpansion(preprocessor, expansion);
         }
         else
         {
+            MacroExpansion* hideSetParent = inputStream ? inputStream->hideSet : NULL;
+
             // Consume the token that triggered macro expansion
             AdvanceRawToken(preprocessor);
 
             // Object-like macros are the easy case.
-            ObjectLikeMacroExpansion* expansion = new ObjectLikeMacroExpansion();
-            InitializeMacroExpansion(preprocessor, expansion, macro);
+            MacroExpansion* expansion = CreateMacroExpansion(preprocessor);
+            expansion->macro = macro;
+            expansion->hideSet = expansion;
+            expansion->hideSetParent = hideSetParent;
+            expansion->tokenReader = TokenReader(macro->tokens);
             PushMacroExpansion(preprocessor, expansion);
         }
     }
@@ -745,8 +941,19 @@ top:
     {
         // We are pasting tokens, which could get messy
 
+        // The result of the paste is read as if it were still in the
+        // stream that the `##` is in: it can't expand the macros whose
+        // expansions that stream came out of, and it can refer to the
+        // same macro parameters. We set up the expansion for it now, so
+        // that the expansions those refer to can't be reused while we
+        // read the rest of the paste.
+        PreprocessorInputStream* pasteStream = GetCurrentInputStream(preprocessor);
+        MacroExpansion* expansion = CreateMacroExpansion(preprocessor);
+        expansion->arguments = pasteStream ? pasteStream->arguments : NULL;
+        expansion->hideSet = pasteStream ? pasteStream->hideSet : NULL;
+
         StringBuilder sb;
-        sb << token.Content;
+        sb << token.getContent();
 
         while (PeekRawTokenType(preprocessor) == TokenType::PoundPound)
         {
@@ -759,18 +966,34 @@ top:
             // Read the next raw token (now that expansion has been triggered)
             Token nextToken = AdvanceRawToken(preprocessor);
 
-            sb << nextToken.Content;
+            sb << nextToken.getContent();
+        }
+
+        // Now re-lex the input. The pasted text isn't given locations
+        // of its own (which would use up the session's locations on
+        // every paste), so its tokens get the location of the first
+        // token that was pasted.
+        Lexer lexer(allocateSyntaxText(sb.ProduceString().getUnownedSlice()), GetSink(preprocessor), GetNamePool(preprocessor));
+        for (;;)
+        {
+            Token pastedToken = lexer.lexToken();
+            pastedToken.Position = token.Position;
+            expansion->argumentTokens.Add(pastedToken);
+
+            if (pastedToken.Type == TokenType::EndOfFile)
+                break;
         }
 
-        // Now re-lex the input
-        PreprocessorInputStream* inputStream = CreateInputStreamForSource(preprocessor, sb.ProduceString(), "token paste");
-        if (inputStream->tokenReader.GetCount() != 1)
+        Token* pastedTokens = expansion->argumentTokens.Buffer();
+        expansion->tokenReader.mCursor = pastedTokens;
+        expansion->tokenReader.mEnd = pastedTokens + expansion->argumentTokens.Count() - 1;
+        if (expansion->tokenReader.GetCount() != 1)
         {
             // We expect a token paste to produce a single token
             // TODO(tfoley): emit a diagnostic here
         }
 
-        PushInputStream(preprocessor, inputStream);
+        PushMacroExpansion(preprocessor, expansion);
         goto top;
     }
 }
@@ -834,17 +1057,27 @@ inline Token const& GetDirective(PreprocessorDirectiveContext* context)
 }
 
 // Get the name of the directive being parsed.
-inline String const& GetDirectiveName(PreprocessorDirectiveContext* context)
+inline UnownedStringSlice GetDirectiveName(PreprocessorDirectiveContext* context)
 {
-    return context->directiveToken.Content;
+    return context->directiveToken.getContent();
 }
 
 // Get the location of the directive being parsed.
-inline CodePosition const& GetDirectiveLoc(PreprocessorDirectiveContext* context)
+inline SourceLoc const& GetDirectiveLoc(PreprocessorDirectiveContext* context)
 {
     return context->directiveToken.Position;
 }
 
+// Get the path of the file that contains the directive being parsed.
+//
+// Note that this is the path of the actual file, and not any
+// path that might have been specified with `#line`.
+static String GetDirectivePath(PreprocessorDirectiveContext* context)
+{
+    SourceFile* sourceFile = GetSourceManager(context->preprocessor)->findSourceFile(GetDirectiveLoc(context));
+    return sourceFile ? sourceFile->path : String();
+}
+
 // Wrapper to get the diagnostic sink in the context of a directive.
 static inline DiagnosticSink* GetSink(PreprocessorDirectiveContext* context)
 {
@@ -852,13 +1085,13 @@ static inline DiagnosticSink* GetSink(PreprocessorDirectiveContext* context)
 }
 
 // Wrapper to get a "current" location when parsing a directive
-static CodePosition PeekLoc(PreprocessorDirectiveContext* context)
+static SourceLoc PeekLoc(PreprocessorDirectiveContext* context)
 {
     return PeekLoc(context->preprocessor);
 }
 
 // Wrapper to look up a macro in the context of a directive.
-static PreprocessorMacro* LookupMacro(PreprocessorDirectiveContext* context, String const& name)
+static PreprocessorMacro* LookupMacro(PreprocessorDirectiveContext* context, Name* name)
 {
     return LookupMacro(context->preprocessor, name);
 }
@@ -1084,12 +1317,12 @@ static PreprocessorExpressionValue ParseAndEvaluateUnaryExpression(PreprocessorD
         }
 
     case TokenType::IntegerLiteral:
-        return StringToInt(AdvanceToken(context).Content);
+        return StringToInt(AdvanceToken(context).getContent());
 
     case TokenType::Identifier:
         {
             Token token = AdvanceToken(context);
-            if (token.Content == "defined")
+            if (token.getContent() == "defined")
             {
                 // handle `defined(someName)`
 
@@ -1106,7 +1339,7 @@ static PreprocessorExpressionValue ParseAndEvaluateUnaryExpression(PreprocessorD
                 {
                     return 0;
                 }
-                String name = nameToken.Content;
+                Name* name = nameToken.getName();
 
                 // If we saw an opening `(`, then expect one to close
                 if (leftParen.Type != TokenType::Unknown)
@@ -1323,7 +1556,7 @@ static void HandleIfDefDirective(PreprocessorDirectiveContext* context)
     Token nameToken;
     if(!ExpectRaw(context, TokenType::Identifier, Diagnostics::expectedTokenInPreprocessorDirective, &nameToken))
         return;
-    String name = nameToken.Content;
+    Name* name = nameToken.getName();
 
     // Check if the name is defined.
     beginConditional(context, LookupMacro(context, name) != NULL);
@@ -1336,7 +1569,7 @@ static void HandleIfNDefDirective(PreprocessorDirectiveContext* context)
     Token nameToken;
     if(!ExpectRaw(context, TokenType::Identifier, Diagnostics::expectedTokenInPreprocessorDirective, &nameToken))
         return;
-    String name = nameToken.Content;
+    Name* name = nameToken.getName();
 
     // Check if the name is defined.
     beginConditional(context, LookupMacro(context, name) == NULL);
@@ -1493,8 +1726,7 @@ static void HandleIncludeDirective(PreprocessorDirectiveContext* context)
 
     String path = getFileNameTokenValue(pathToken);
 
-    // TODO(tfoley): make this robust in presence of `#line`
-    String pathIncludedFrom = GetDirectiveLoc(context).FileName;
+    String pathIncludedFrom = GetDirectivePath(context);
     String foundPath;
     String foundSource;
 
@@ -1523,9 +1755,36 @@ static void HandleIncludeDirective(PreprocessorDirectiveContext* context)
     // a switch of input stream
     expectEndOfDirective(context);
 
+    CompileRequest* request = context->preprocessor->getCompileRequest();
+
+    // A file that used `#pragma once` doesn't get included again
+    HashSet<String>& pragmaOnceFiles = context->preprocessor->pragmaOnceFiles;
+    if (pragmaOnceFiles.Count() && pragmaOnceFiles.Contains(Path::GetCanonical(foundPath)))
+    {
+        request->mSession->includesSkipped++;
+        return;
+    }
+
+    RefPtr<IncludedFile> includedFile = request->getIncludedFile(
+        foundPath,
+        foundSource,
+        GetSink(context));
+
+    // Nor does a file whose include guard is already defined, since
+    // everything in it would be skipped.
+    if (includedFile->includeGuard
+        && LookupMacro(&context->preprocessor->globalEnv, includedFile->includeGuard))
+    {
+        request->mSession->includesSkipped++;
+        return;
+    }
+
+    // The tokens refer to the file, and may end up in the syntax
+    addSyntaxSourceFile(includedFile->sourceFile.Ptr());
+
     // Push the new file onto our stack of input streams
     // TODO(tfoley): check if we have made our include stack too deep
-    PreprocessorInputStream* inputStream = CreateInputStreamForSource(context->preprocessor, foundSource, foundPath);
+    PreprocessorInputStream* inputStream = CreateInputStreamForTokens(context->preprocessor, includedFile->tokens);
     inputStream->parent = context->preprocessor->inputStream;
     context->preprocessor->inputStream = inputStream;
 }
@@ -1536,7 +1795,7 @@ static void HandleDefineDirective(PreprocessorDirectiveContext* context)
     Token nameToken;
     if (!Expect(context, TokenType::Identifier, Diagnostics::expectedTokenInPreprocessorDirective, &nameToken))
         return;
-    String name = nameToken.Content;
+    Name* name = nameToken.getName();
 
     PreprocessorMacro* macro = CreateMacro(context->preprocessor);
     macro->nameToken = nameToken;
@@ -1618,7 +1877,7 @@ static void HandleUndefDirective(PreprocessorDirectiveContext* context)
     Token nameToken;
     if (!Expect(context, TokenType::Identifier, Diagnostics::expectedTokenInPreprocessorDirective, &nameToken))
         return;
-    String name = nameToken.Content;
+    Name* name = nameToken.getName();
 
     PreprocessorEnvironment* env = &context->preprocessor->globalEnv;
     PreprocessorMacro* macro = LookupMacro(env, name);
@@ -1655,18 +1914,22 @@ static void HandleErrorDirective(PreprocessorDirectiveContext* context)
 // Handle a `#line` directive
 static void HandleLineDirective(PreprocessorDirectiveContext* context)
 {
+    SourceLoc directiveLoc = GetDirectiveLoc(context);
+    SourceFile* sourceFile = GetSourceManager(context->preprocessor)->findSourceFile(directiveLoc);
+
     int line = 0;
     if (PeekTokenType(context) == TokenType::IntegerLiteral)
     {
-        line = StringToInt(AdvanceToken(context).Content);
+        line = StringToInt(AdvanceToken(context).getContent());
     }
     else if (PeekTokenType(context) == TokenType::Identifier
-        && PeekToken(context).Content == "default")
+        && PeekToken(context).getContent() == "default")
     {
         AdvanceToken(context);
 
         // Stop overiding soure locations.
-        context->preprocessor->inputStream->isOverridingSourceLoc = false;
+        if (sourceFile)
+            sourceFile->addDefaultLineDirective(directiveLoc);
         return;
     }
     else
@@ -1679,22 +1942,20 @@ static void HandleLineDirective(PreprocessorDirectiveContext* context)
         return;
     }
 
-    CodePosition directiveLoc = GetDirectiveLoc(context);
-
     String file;
     if (PeekTokenType(context) == TokenType::EndOfDirective)
     {
-        file = directiveLoc.FileName;
+        file = GetSourceManager(context->preprocessor)->getHumaneLoc(directiveLoc).path;
     }
     else if (PeekTokenType(context) == TokenType::StringLiteral)
     {
-        file = AdvanceToken(context).Content;
+        file = AdvanceToken(context).getContent();
     }
     else if (PeekTokenType(context) == TokenType::IntegerLiteral)
     {
         // Note(tfoley): GLSL allows the "source string" to be indicated by an integer
         // TODO(tfoley): Figure out a better way to handle this, if it matters
-        file = AdvanceToken(context).Content;
+        file = AdvanceToken(context).getContent();
     }
     else
     {
@@ -1702,17 +1963,23 @@ static void HandleLineDirective(PreprocessorDirectiveContext* context)
         return;
     }
 
-    PreprocessorInputStream* inputStream = context->preprocessor->inputStream;
-
-    inputStream->isOverridingSourceLoc = true;
-    inputStream->overrideFileName = file;
-    inputStream->overrideLineOffset = line - (directiveLoc.Line + 1);
+    if (sourceFile)
+        sourceFile->addLineDirective(directiveLoc, file, line);
 }
 
 // Handle a `#pragma` directive
 static void HandlePragmaDirective(PreprocessorDirectiveContext* context)
 {
-    // TODO(tfoley): figure out which pragmas to parse,
+    // `#pragma once` means the file containing it shouldn't
+    // be included again in this translation unit.
+    if (PeekRawTokenType(context) == TokenType::Identifier
+        && PeekRawToken(context).getContent() == "once")
+    {
+        AdvanceRawToken(context);
+        context->preprocessor->pragmaOnceFiles.Add(Path::GetCanonical(GetDirectivePath(context)));
+    }
+
+    // TODO(tfoley): figure out which other pragmas to parse,
     // and which to pass along
     SkipToEndOfLine(context);
 }
@@ -1856,12 +2123,11 @@ static const PreprocessorDirective kInvalidDirective = {
 };
 
 // Look up the directive with the given name.
-static PreprocessorDirective const* FindDirective(String const& name)
+static PreprocessorDirective const* FindDirective(UnownedStringSlice const& name)
 {
-    char const* nameStr = name.Buffer();
     for (int ii = 0; kDirectives[ii].name; ++ii)
     {
-        if (strcmp(kDirectives[ii].name, nameStr) != 0)
+        if (name != kDirectives[ii].name)
             continue;
 
         return &kDirectives[ii];
@@ -1914,6 +2180,56 @@ static void HandleDirective(PreprocessorDirectiveContext* context)
     expectEndOfDirective(context);
 }
 
+// Skip tokens in a disabled conditional block, up to the next
+// directive (a `#` at the start of a line) in the current input
+// stream. Only the directives in a disabled block matter, so we
+// just move the reader over the tokens in between, rather than
+// reading each one through `AdvanceRawToken()` (which copies it).
+// When the stream is lexing its source on demand, the rest of the
+// block isn't even lexed: the lexer scans the text for the next
+// directive instead.
+//
+// The current token is known not to start a directive.
+static void SkipDisabledTokens(Preprocessor* preprocessor)
+{
+    PreprocessorInputStream* inputStream = preprocessor->inputStream;
+
+    // Leaving the stream (and diagnosing any unterminated
+    // conditionals in it) is left to `AdvanceRawToken()`.
+    if (PeekRawTokenType(inputStream) == TokenType::EndOfFile)
+    {
+        AdvanceRawToken(preprocessor);
+        return;
+    }
+
+    TokenReader& reader = inputStream->tokenReader;
+    reader.mCursor++;
+    for (;;)
+    {
+        Token* cursor = reader.mCursor;
+        Token* end = reader.mEnd;
+        while (cursor != end)
+        {
+            if (cursor->Type == TokenType::EndOfFile)
+                break;
+            if (cursor->Type == TokenType::Pound && (cursor->flags & TokenFlag::AtStartOfLine))
+                break;
+            cursor++;
+        }
+        reader.mCursor = cursor;
+
+        Lexer* lexer = inputStream->lexer;
+        if (cursor != end || !lexer)
+            return;
+
+        // Everything lexed so far is disabled. A line that is still
+        // inside a directive can't start one, so it has to be lexed.
+        if (!(lexer->lexerFlags & kLexerFlag_InDirective))
+            lexer->skipToNextDirective();
+        LexMoreTokens(inputStream);
+    }
+}
+
 // Read one token using the full preprocessor, with all its behaviors.
 static Token ReadToken(Preprocessor* preprocessor)
 {
@@ -1942,7 +2258,7 @@ static Token ReadToken(Preprocessor* preprocessor)
         // otherwise, if we are currently in a skipping mode, then skip tokens
         if (IsSkipping(preprocessor))
         {
-            AdvanceRawToken(preprocessor);
+            SkipDisabledTokens(preprocessor);
             continue;
         }
 
@@ -1957,7 +2273,12 @@ static void InitializePreprocessor(
     DiagnosticSink* sink)
 {
     preprocessor->sink = sink;
+    preprocessor->sourceManager = NULL;
+    preprocessor->namePool = NULL;
     preprocessor->includeHandler = NULL;
+    preprocessor->freeExpansions = NULL;
+    preprocessor->endedExpansions = NULL;
+    preprocessor->activeExpansionCount = 0;
     preprocessor->endOfFileToken.Type = TokenType::EndOfFile;
     preprocessor->endOfFileToken.flags = TokenFlag::AtStartOfLine;
 }
@@ -1984,6 +2305,13 @@ static void FinalizePreprocessor(
         input = parent;
     }
 
+    // Free the pooled macro expansions
+    while (MacroExpansion* expansion = preprocessor->freeExpansions)
+    {
+        preprocessor->freeExpansions = expansion->nextFree;
+        delete expansion;
+    }
+
 #if 0
     // clean up any macros that were allocated
     for (auto pair : preprocessor->globalEnv.macros)
@@ -2000,21 +2328,26 @@ static void DefineMacro(
     String const&   key,
     String const&   value)
 {
-    String fileName = "command line";
+    SourceFile* sourceFile = preprocessor->getCompileRequest()->getCommandLineSourceFile(value, GetSink(preprocessor));
+    addSyntaxSourceFile(sourceFile);
     PreprocessorMacro* macro = CreateMacro(preprocessor);
 
     // Use existing `Lexer` to generate a token stream.
-    Lexer lexer(fileName, value, GetSink(preprocessor));
+    Lexer lexer(sourceFile, GetSink(preprocessor), GetNamePool(preprocessor));
     macro->tokens = lexer.lexAllTokens();
-    macro->nameToken = Token(TokenType::Identifier, key, 0, 0, 0, fileName);
+
+    Name* name = GetNamePool(preprocessor)->getName(key);
+    macro->nameToken.Type = TokenType::Identifier;
+    macro->nameToken.Position = sourceFile->sourceRange.begin;
+    macro->nameToken.setName(name);
 
     PreprocessorMacro* oldMacro = NULL;
-    if (preprocessor->globalEnv.macros.TryGetValue(key, oldMacro))
+    if (preprocessor->globalEnv.macros.TryGetValue(name, oldMacro))
     {
         DestroyMacro(preprocessor, oldMacro);
     }
 
-    preprocessor->globalEnv.macros[key] = macro;
+    preprocessor->globalEnv.macros[name] = macro;
 }
 
 // read the entire input into tokens
@@ -2036,17 +2369,160 @@ static TokenList ReadAllTokens(
     return tokens;
 }
 
-TokenList preprocessSource(
-    String const&               source,
-    String const&               fileName,
+// Check whether `token` is the name of the directive
+// started by the `#` token before it
+static bool isDirectiveName(Token const* token, char const* name)
+{
+    return token[-1].Type == TokenType::Pound
+        && (token[-1].flags & TokenFlag::AtStartOfLine)
+        && token->Type == TokenType::Identifier
+        && token->getContent() == name;
+}
+
+Name* findIncludeGuard(TokenList const& tokens)
+{
+    Token const* cursor = tokens.begin();
+    Token const* end = tokens.end();
+
+    // The file has to start with the `#ifndef` (or `#if !defined`)
+    if (end - cursor < 4)
+        return nullptr;
+    if (cursor[0].Type != TokenType::Pound || !(cursor[0].flags & TokenFlag::AtStartOfLine))
+        return nullptr;
+    cursor++;
+
+    Name* guard = nullptr;
+    if (isDirectiveName(cursor, "ifndef"))
+    {
+        cursor++;
+        if (cursor->Type != TokenType::Identifier)
+            return nullptr;
+        guard = cursor->getName();
+        cursor++;
+    }
+    else if (isDirectiveName(cursor, "if"))
+    {
+        cursor++;
+        if (cursor->Type != TokenType::OpNot)
+            return nullptr;
+        cursor++;
+        if (cursor->Type != TokenType::Identifier || cursor->getContent() != "defined")
+            return nullptr;
+        cursor++;
+
+        bool paren = cursor->Type == TokenType::LParent;
+        if (paren)
+            cursor++;
+        if (cursor->Type != TokenType::Identifier)
+            return nullptr;
+        guard = cursor->getName();
+        cursor++;
+        if (paren)
+        {
+            if (cursor->Type != TokenType::RParent)
+                return nullptr;
+            cursor++;
+        }
+    }
+    else
+    {
+        return nullptr;
+    }
+    if (cursor->Type != TokenType::EndOfDirective)
+        return nullptr;
+    cursor++;
+
+    // Now find the `#endif` that matches it, which has to be
+    // the last thing in the file.
+    int depth = 1;
+    for (; cursor != end; cursor++)
+    {
+        if (cursor->Type != TokenType::Identifier || cursor[-1].Type != TokenType::Pound)
+            continue;
+
+        if (isDirectiveName(cursor, "if")
+            || isDirectiveName(cursor, "ifdef")
+            || isDirectiveName(cursor, "ifndef"))
+        {
+            depth++;
+        }
+        else if (isDirectiveName(cursor, "else")
+            || isDirectiveName(cursor, "elif"))
+        {
+            if (depth == 1)
+                return nullptr;
+        }
+        else if (isDirectiveName(cursor, "endif"))
+        {
+            if (--depth == 0)
+                break;
+        }
+    }
+    if (cursor == end)
+        return nullptr;
+
+    // Skip the rest of the `#endif` line
+    while (cursor != end && cursor->Type != TokenType::EndOfDirective)
+        cursor++;
+    if (cursor == end)
+        return nullptr;
+    cursor++;
+
+    if (cursor == end || cursor->Type != TokenType::EndOfFile)
+        return nullptr;
+    return guard;
+}
+
+bool containsLineDirective(TokenList const& tokens)
+{
+    Token const* begin = tokens.begin();
+    Token const* end = tokens.end();
+    for (Token const* cursor = begin; cursor != end; cursor++)
+    {
+        if (cursor != begin && isDirectiveName(cursor, "line"))
+            return true;
+    }
+    return false;
+}
+
+// Preprocesses a source file a chunk at a time, as its tokens are read
+class PreprocessorTokenSource : public TokenSource
+{
+public:
+    Preprocessor preprocessor;
+
+    ~PreprocessorTokenSource()
+    {
+        FinalizePreprocessor(&preprocessor);
+    }
+
+    virtual void readTokens(List<Token>& outTokens, UInt count) override
+    {
+        for (UInt ii = 0; ii < count; ++ii)
+        {
+            Token token = ReadToken(&preprocessor);
+            outTokens.Add(token);
+
+            if (token.Type == TokenType::EndOfFile)
+                break;
+        }
+    }
+};
+
+static RefPtr<PreprocessorTokenSource> createPreprocessorTokenSource(
+    SourceFile*                 sourceFile,
     DiagnosticSink*             sink,
     IncludeHandler*             includeHandler,
     Dictionary<String, String>  defines,
     TranslationUnitRequest*     translationUnit)
 {
-    Preprocessor preprocessor;
+    RefPtr<PreprocessorTokenSource> source = new PreprocessorTokenSource();
+    Preprocessor& preprocessor = source->preprocessor;
+
     InitializePreprocessor(&preprocessor, sink);
     preprocessor.translationUnit = translationUnit;
+    preprocessor.sourceManager = translationUnit->compileRequest->sourceManager;
+    preprocessor.namePool = translationUnit->compileRequest->namePool;
 
     preprocessor.includeHandler = includeHandler;
     for (auto p : defines)
@@ -2055,11 +2531,44 @@ TokenList preprocessSource(
     }
 
     // create an initial input stream based on the provided buffer
-    preprocessor.inputStream = CreateInputStreamForSource(&preprocessor, source, fileName);
+    preprocessor.inputStream = CreateInputStreamForSource(&preprocessor, sourceFile);
+
+    return source;
+}
+
+RefPtr<TokenSource> beginPreprocessingSource(
+    SourceFile*                 sourceFile,
+    DiagnosticSink*             sink,
+    IncludeHandler*             includeHandler,
+    Dictionary<String, String>  defines,
+    TranslationUnitRequest*     translationUnit)
+{
+    return createPreprocessorTokenSource(
+        sourceFile,
+        sink,
+        includeHandler,
+        defines,
+        translationUnit);
+}
+
+TokenList preprocessSource(
+    SourceFile*                 sourceFile,
+    DiagnosticSink*             sink,
+    IncludeHandler*             includeHandler,
+    Dictionary<String, String>  defines,
+    TranslationUnitRequest*     translationUnit)
+{
+    RefPtr<PreprocessorTokenSource> source = createPreprocessorTokenSource(
+        sourceFile,
+        sink,
+        includeHandler,
+        defines,
+        translationUnit);
 
-    TokenList tokens = ReadAllTokens(&preprocessor);
+    TokenList tokens = ReadAllTokens(&source->preprocessor);
 
-    FinalizePreprocessor(&preprocessor);
+    // Finish up with the preprocessor
+    source = nullptr;
 
     // debugging: build the pre-processed source back together
 #if 0
@@ -2075,7 +2584,7 @@ TokenList preprocessSource(
             sb << " ";
         }
         
-        sb << t.Content;
+        sb << t.getContent();
     }
 
     String s = sb.ProduceString();
@@ -2095,8 +2604,7 @@ static void HandleImportDirective(PreprocessorDirectiveContext* context)
 
     String path = getFileNameTokenValue(pathToken);
 
-    // TODO(tfoley): make this robust in presence of `#line`
-    String pathIncludedFrom = GetDirectiveLoc(context).FileName;
+    String pathIncludedFrom = GetDirectivePath(context);
     String foundPath;
     String foundSource;
 
@@ -2160,7 +2668,8 @@ static void HandleImportDirective(PreprocessorDirectiveContext* context)
             PreprocessorInputStream* savedStream = preprocessor->inputStream;
 
             // Create an input stream for reading from the imported file
-            PreprocessorInputStream* subInputStream = CreateInputStreamForSource(preprocessor, foundSource, foundPath);
+            RefPtr<SourceFile> sourceFile = GetSourceManager(preprocessor)->allocateSourceFile(foundPath, foundSource, GetSink(preprocessor));
+            PreprocessorInputStream* subInputStream = CreateInputStreamForSource(preprocessor, sourceFile.Ptr());
 
             // Now preprocess that stream
             preprocessor->inputStream = subInputStream;
@@ -2184,7 +2693,7 @@ static void HandleImportDirective(PreprocessorDirectiveContext* context)
     token.Type = TokenType::PoundImport;
     token.Position = GetDirectiveLoc(context);
     token.flags = 0;
-    token.Content = foundPath;
+    token.setContent(allocateSyntaxText(foundPath.getUnownedSlice()));
  
     inputStream->lexedTokens.mTokens.Add(token);
  
@@ -29,10 +29,33 @@ struct IncludeHandler
         String* outFoundSource) = 0;
 };
 
+// Find the macro that guards the whole of a file's tokens, as in:
+//
+//     #ifndef FOO_H        (or `#if !defined(FOO_H)`)
+//     ...
+//     #endif
+//
+// with nothing outside the conditional, and no `#else` or `#elif`
+// for it. Once the macro is defined, including the file again has
+// no effect. Returns null if the file isn't guarded this way.
+Name* findIncludeGuard(TokenList const& tokens);
+
+// Check whether a file has any `#line` directives.
+bool containsLineDirective(TokenList const& tokens);
+
+// Start preprocessing a source file, producing its tokens as they are
+// read (see `TokenReader(TokenSource*)`) rather than all at once.
+// `includeHandler` must stay alive for as long as the source does.
+RefPtr<TokenSource> beginPreprocessingSource(
+    SourceFile*                 sourceFile,
+    DiagnosticSink*             sink,
+    IncludeHandler*             includeHandler,
+    Dictionary<String, String>  defines,
+    TranslationUnitRequest*     translationUnit);
+
 // Take a string of source code and preprocess it into a list of tokens.
 TokenList preprocessSource(
-    String const&               source,
-    String const&               fileName,
+    SourceFile*                 sourceFile,
     DiagnosticSink*             sink,
     IncludeHandler*             includeHandler,
     Dictionary<String, String>  defines,
@@ -165,7 +165,7 @@ SLANG_API unsigned int spReflectionType_GetFieldCount(SlangReflectionType* inTyp
 
     // TODO: maybe filter based on kind
 
-    if(auto declRefType = dynamic_cast<DeclRefType*>(type))
+    if(auto declRefType = dynamicCast<DeclRefType>(type))
     {
         auto declRef = declRefType->declRef;
         if( auto structDeclRef = declRef.As<StructSyntaxNode>())
@@ -184,7 +184,7 @@ SLANG_API SlangReflectionVariable* spReflectionType_GetFieldByIndex(SlangReflect
 
     // TODO: maybe filter based on kind
 
-    if(auto declRefType = dynamic_cast<DeclRefType*>(type))
+    if(auto declRefType = dynamicCast<DeclRefType>(type))
     {
         auto declRef = declRefType->declRef;
         if( auto structDeclRef = declRef.As<StructSyntaxNode>())
@@ -202,11 +202,11 @@ SLANG_API size_t spReflectionType_GetElementCount(SlangReflectionType* inType)
     auto type = convert(inType);
     if(!type) return 0;
 
-    if(auto arrayType = dynamic_cast<ArrayExpressionType*>(type))
+    if(auto arrayType = dynamicCast<ArrayExpressionType>(type))
     {
         return (size_t) GetIntVal(arrayType->ArrayLength);
     }
-    else if( auto vectorType = dynamic_cast<VectorExpressionType*>(type))
+    else if( auto vectorType = dynamicCast<VectorExpressionType>(type))
     {
         return (size_t) GetIntVal(vectorType->elementCount);
     }
@@ -219,19 +219,19 @@ SLANG_API SlangReflectionType* spReflectionType_GetElementType(SlangReflectionTy
     auto type = convert(inType);
     if(!type) return nullptr;
 
-    if(auto arrayType = dynamic_cast<ArrayExpressionType*>(type))
+    if(auto arrayType = dynamicCast<ArrayExpressionType>(type))
     {
         return (SlangReflectionType*) arrayType->BaseType.Ptr();
     }
-    else if( auto constantBufferType = dynamic_cast<ConstantBufferType*>(type))
+    else if( auto constantBufferType = dynamicCast<ConstantBufferType>(type))
     {
         return convert(constantBufferType->elementType.Ptr());
     }
-    else if( auto vectorType = dynamic_cast<VectorExpressionType*>(type))
+    else if( auto vectorType = dynamicCast<VectorExpressionType>(type))
     {
         return convert(vectorType->elementType.Ptr());
     }
-    else if( auto matrixType = dynamic_cast<MatrixExpressionType*>(type))
+    else if( auto matrixType = dynamicCast<MatrixExpressionType>(type))
     {
         return convert(matrixType->getElementType());
     }
@@ -244,15 +244,15 @@ SLANG_API unsigned int spReflectionType_GetRowCount(SlangReflectionType* inType)
     auto type = convert(inType);
     if(!type) return 0;
 
-    if(auto matrixType = dynamic_cast<MatrixExpressionType*>(type))
+    if(auto matrixType = dynamicCast<MatrixExpressionType>(type))
     {
         return (unsigned int) GetIntVal(matrixType->getRowCount());
     }
-    else if(auto vectorType = dynamic_cast<VectorExpressionType*>(type))
+    else if(auto vectorType = dynamicCast<VectorExpressionType>(type))
     {
         return 1;
     }
-    else if( auto basicType = dynamic_cast<BasicExpressionType*>(type) )
+    else if( auto basicType = dynamicCast<BasicExpressionType>(type) )
     {
         return 1;
     }
@@ -265,15 +265,15 @@ SLANG_API unsigned int spReflectionType_GetColumnCount(SlangReflectionType* inTy
     auto type = convert(inType);
     if(!type) return 0;
 
-    if(auto matrixType = dynamic_cast<MatrixExpressionType*>(type))
+    if(auto matrixType = dynamicCast<MatrixExpressionType>(type))
     {
         return (unsigned int) GetIntVal(matrixType->getColumnCount());
     }
-    else if(auto vectorType = dynamic_cast<VectorExpressionType*>(type))
+    else if(auto vectorType = dynamicCast<VectorExpressionType>(type))
     {
         return (unsigned int) GetIntVal(vectorType->elementCount);
     }
-    else if( auto basicType = dynamic_cast<BasicExpressionType*>(type) )
+    else if( auto basicType = dynamicCast<BasicExpressionType>(type) )
     {
         return 1;
     }
@@ -286,16 +286,16 @@ SLANG_API SlangScalarType spReflectionType_GetScalarType(SlangReflectionType* in
     auto type = convert(inType);
     if(!type) return 0;
 
-    if(auto matrixType = dynamic_cast<MatrixExpressionType*>(type))
+    if(auto matrixType = dynamicCast<MatrixExpressionType>(type))
     {
         type = matrixType->getElementType();
     }
-    else if(auto vectorType = dynamic_cast<VectorExpressionType*>(type))
+    else if(auto vectorType = dynamicCast<VectorExpressionType>(type))
     {
         type = vectorType->elementType.Ptr();
     }
 
-    if(auto basicType = dynamic_cast<BasicExpressionType*>(type))
+    if(auto basicType = dynamicCast<BasicExpressionType>(type))
     {
         switch (basicType->BaseType)
         {
@@ -569,7 +569,7 @@ SLANG_API char const* spReflectionVariable_GetName(SlangReflectionVariable* inVa
     // If the variable is one that has an "external" name that is supposed
     // to be exposed for reflection, then report it here
     if(auto reflectionNameMod = var->FindModifier<ParameterBlockReflectionName>())
-        return reflectionNameMod->nameToken.Content.Buffer();
+        return getText(reflectionNameMod->nameToken.getName()).Buffer();
 
     return var->getName().Buffer();
 }
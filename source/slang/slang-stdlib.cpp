@@ -989,13 +989,8 @@ typedef Texture2D texture2D;
 
 namespace Slang
 {
-    static String stdlibPath;
-
     String getStdlibPath()
     {
-        if(stdlibPath.Length() != 0)
-            return stdlibPath;
-
         StringBuilder pathBuilder;
         for( auto cc = __FILE__; *cc; ++cc )
         {
@@ -1010,17 +1005,9 @@ namespace Slang
                 break;
             }
         }
-        stdlibPath = pathBuilder.ProduceString();
-
-        return stdlibPath;
+        return pathBuilder.ProduceString();
     }
 
-    // Cached code for the various libraries
-    String coreLibraryCode;
-    String slangLibraryCode;
-    String hlslLibraryCode;
-    String glslLibraryCode;
-
     enum
     {
         SINT_MASK   = 1 << 0,
@@ -1105,9 +1092,6 @@ namespace Slang
 
     String getCoreLibraryCode()
     {
-        if (coreLibraryCode.Length() > 0)
-            return coreLibraryCode;
-
         StringBuilder sb;
 
         // generate operator overloads
@@ -1780,15 +1764,11 @@ namespace Slang
             sb << kCoreLibIncludeStringChunks[cc];
         }
 
-        coreLibraryCode = sb.ProduceString();
-        return coreLibraryCode;
+        return sb.ProduceString();
     }
 
     String getHLSLLibraryCode()
     {
-        if (hlslLibraryCode.Length() > 0)
-            return hlslLibraryCode;
-
         StringBuilder sb;
 
 
@@ -1835,8 +1815,7 @@ namespace Slang
             sb << kHLSLLibIncludeStringChunks[cc];
         }
 
-        hlslLibraryCode = sb.ProduceString();
-        return hlslLibraryCode;
+        return sb.ProduceString();
     }
 
 
@@ -1844,9 +1823,6 @@ namespace Slang
 
     String getGLSLLibraryCode()
     {
-        if(glslLibraryCode.Length() != 0)
-            return glslLibraryCode;
-
         String path = getStdlibPath();
 
         StringBuilder sb;
@@ -2012,21 +1988,7 @@ namespace Slang
         sb << "__modifier(SimpleModifier)           flat;\n";
         sb << "__modifier(SimpleModifier)           highp;\n";
 
-        glslLibraryCode = sb.ProduceString();
-        return glslLibraryCode;
-    }
-
-
-
-    //
-
-    void finalizeShaderLibrary()
-    {
-        stdlibPath = String();
-
-        coreLibraryCode = String();
-        hlslLibraryCode = String();
-        glslLibraryCode = String();
+        return sb.ProduceString();
     }
 
 }
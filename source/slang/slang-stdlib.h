@@ -8,8 +8,6 @@ namespace Slang
     String getCoreLibraryCode();
     String getHLSLLibraryCode();
     String getGLSLLibraryCode();
-
-    void finalizeShaderLibrary();
 }
 
 #endif
\ No newline at end of file
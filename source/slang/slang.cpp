@@ -2,12 +2,17 @@
 
 #include "../core/slang-io.h"
 #include "../slang/slang-stdlib.h"
+#include "compile-cache.h"
 #include "parameter-binding.h"
 #include "../slang/parser.h"
 #include "../slang/preprocessor.h"
 #include "../slang/reflection.h"
+#include "syntax-serialize.h"
 #include "syntax-visitors.h"
 #include "../slang/type-layout.h"
+#include "lookup.h"
+
+#include <chrono>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -19,65 +24,71 @@
 
 namespace Slang {
 
-class Session
+// The standard library modules, serialized by the first session
+// that had to parse and check them. Later sessions load their own
+// copy of the modules from this, which is much faster than
+// compiling the library code all over again. Sessions with a cache
+// directory also save the blob there, so that the first session
+// in a new process can load it too (see `CompileCache::storeStdlib()`).
+//
+// Sessions only load the modules they actually use, so a blob
+// may hold just a prefix of the modules; a session that compiles
+// more of the library than the current blob holds will replace it.
+// Any session reading from a blob keeps it alive, so it is safe
+// to replace the global blob while other sessions are using it.
+struct SerializedStdlib : RefObject
 {
-public:
-    bool useCache = false;
-    String cacheDir;
-
-    RefPtr<Scope>   coreLanguageScope;
-    RefPtr<Scope>   hlslLanguageScope;
-    RefPtr<Scope>   slangLanguageScope;
-    RefPtr<Scope>   glslLanguageScope;
-
-    List<RefPtr<ProgramSyntaxNode>> loadedModuleCode;
-
-
-    Session(bool /*pUseCache*/, String /*pCacheDir*/)
+    SerializedStdlib()
     {
-        // Initialize global state
-        // TODO: move this into the session instead
-        BasicExpressionType::Init();
+        markShared();
+    }
 
-        // Create scopes for various language builtins.
-        //
-        // TODO: load these on-demand to avoid parsing
-        // stdlib code for languages the user won't use.
+    List<unsigned char> data;
+    UInt                moduleCount = 0;
+};
+static RefPtr<SerializedStdlib> gSerializedStdlib;
+static std::mutex gSerializedStdlibMutex;
 
-        coreLanguageScope = new Scope();
+static char const* const kStdlibModuleNames[] = { "core", "hlsl", "glsl" };
 
-        hlslLanguageScope = new Scope();
-        hlslLanguageScope->nextSibling = coreLanguageScope;
+Session::Session(bool pUseCache, String pCacheDir)
+    : useCache(pUseCache)
+    , cacheDir(pCacheDir)
+    , syntaxArena(new SyntaxArena())
+{
+    // Everything the session holds can be used by requests on any thread
+    SharedRefObjectScope sharedScope;
+    cacheDir.markShared();
+    syntaxArena->isShared = true;
+
+    // If we can't tell which build of the compiler we are, we can't
+    // tell if the entries in the cache came from this one.
+    if (useCache && CompileCache::getCompilerBuildID() != 0)
+    {
+        compileCache = new CompileCache(cacheDir);
+    }
 
-        slangLanguageScope = new Scope();
-        slangLanguageScope->nextSibling = hlslLanguageScope;
+    SyntaxArenaScope arenaScope(syntaxArena.Ptr());
 
-        glslLanguageScope = new Scope();
-        glslLanguageScope->nextSibling = coreLanguageScope;
+    types = new SessionTypes();
+    types->arena = syntaxArena.Ptr();
 
-        addBuiltinSource(coreLanguageScope, "core", getCoreLibraryCode());
-        addBuiltinSource(hlslLanguageScope, "hlsl", getHLSLLibraryCode());
-        addBuiltinSource(glslLanguageScope, "glsl", getGLSLLibraryCode());
-    }
+    // Create scopes for various language builtins.
 
-    ~Session()
-    {
-        // We need to clean up the strings for the standard library
-        // code that we might have allocated and loaded into static
-        // variables (TODO: don't use `static` variables for this stuff)
+    coreLanguageScope = new Scope();
 
-        finalizeShaderLibrary();
+    hlslLanguageScope = new Scope();
+    hlslLanguageScope->nextSibling = coreLanguageScope;
 
-        // Ditto for our type represnetation stuff
+    slangLanguageScope = new Scope();
+    slangLanguageScope->nextSibling = hlslLanguageScope;
 
-        ExpressionType::Finalize();
-    }
+    glslLanguageScope = new Scope();
+    glslLanguageScope->nextSibling = coreLanguageScope;
+}
 
-    void addBuiltinSource(
-        RefPtr<Scope> const&    scope,
-        String const&           path,
-        String const&           source);
-};
+Session::~Session()
+{}
 
 struct IncludeHandlerImpl : IncludeHandler
 {
@@ -89,26 +100,14 @@ struct IncludeHandlerImpl : IncludeHandler
         String* outFoundPath,
         String* outFoundSource) override
     {
-        String path = Path::Combine(Path::GetDirectoryName(pathIncludedFrom), pathToInclude);
-        if (File::Exists(path))
+        for (auto& path : request->getIncludeCandidatePaths(pathToInclude, pathIncludedFrom))
         {
-            *outFoundPath = path;
-            *outFoundSource = File::ReadAllText(path);
-
-            request->mDependencyFilePaths.Add(path);
-
-            return IncludeResult::Found;
-        }
-
-        for (auto & dir : request->searchDirectories)
-        {
-            path = Path::Combine(dir.path, pathToInclude);
-            if (File::Exists(path))
+            if (request->readIncludedFile(path, outFoundSource))
             {
                 *outFoundPath = path;
-                *outFoundSource = File::ReadAllText(path);
 
-                request->mDependencyFilePaths.Add(path);
+                request->addDependencyFile(path, *outFoundSource);
+                request->addIncludeLookup(pathToInclude, pathIncludedFrom, path);
 
                 return IncludeResult::Found;
             }
@@ -118,60 +117,231 @@ struct IncludeHandlerImpl : IncludeHandler
 };
 
 
-void CompileRequest::parseTranslationUnit(
+CompileRequest::CompileRequest(Session* session)
+    : mSession(session)
+    , sourceManager(&session->sourceManager)
+    , namePool(&session->namePool)
+    , syntaxArena(new SyntaxArena())
+{
+    mSink.sourceManager = sourceManager;
+    substitutionCache = new SubstitutionCache();
+}
+
+CompileRequest::~CompileRequest()
+{}
+
+Dictionary<String, String> CompileRequest::getPreprocessorDefinitions(
+    TranslationUnitRequest* translationUnit)
+{
+    // Definitions on the translation unit take precedence
+    // over those for the whole request.
+    Dictionary<String, String> combinedPreprocessorDefinitions;
+    for(auto& def : preprocessorDefinitions)
+        combinedPreprocessorDefinitions[def.Key] = def.Value;
+    for(auto& def : translationUnit->preprocessorDefinitions)
+        combinedPreprocessorDefinitions[def.Key] = def.Value;
+    return combinedPreprocessorDefinitions;
+}
+
+void CompileRequest::preprocessTranslationUnit(
     TranslationUnitRequest* translationUnit)
 {
     IncludeHandlerImpl includeHandler;
     includeHandler.request = this;
 
-    RefPtr<Scope> languageScope;
-    switch (translationUnit->sourceLanguage)
+    // Directives like `#version` attach modifiers to the syntax
+    // for the translation unit, so we start that here.
+    translationUnit->SyntaxNode = new ProgramSyntaxNode();
+
+    translationUnit->preprocessedTokens.Clear();
+    for (auto sourceFile : translationUnit->sourceFiles)
     {
-    case SourceLanguage::HLSL:
-        languageScope = mSession->hlslLanguageScope;
-        break;
+        translationUnit->preprocessedTokens.Add(preprocessSource(
+            sourceFile.Ptr(),
+            &mSink,
+            &includeHandler,
+            getPreprocessorDefinitions(translationUnit),
+            translationUnit));
+    }
+}
 
-    case SourceLanguage::GLSL:
-        languageScope = mSession->glslLanguageScope;
-        break;
+void CompileRequest::parseTranslationUnit(
+    TranslationUnitRequest* translationUnit)
+{
+    RefPtr<Scope> languageScope = mSession->getLanguageScope(translationUnit->sourceLanguage);
 
-    case SourceLanguage::Slang:
-    default:
-        languageScope = mSession->slangLanguageScope;
-        break;
+    // The translation unit may have been preprocessed already
+    // (e.g., to compare it against another permutation).
+    if (translationUnit->preprocessedTokens.Count() == translationUnit->sourceFiles.Count())
+    {
+        for (UInt ii = 0; ii < translationUnit->sourceFiles.Count(); ++ii)
+        {
+            parseSourceFile(
+                translationUnit,
+                TokenReader(translationUnit->preprocessedTokens[ii]),
+                &mSink,
+                translationUnit->sourceFiles[ii]->path,
+                languageScope);
+        }
+
+        // The tokens aren't needed once we have the syntax
+        translationUnit->preprocessedTokens = List<TokenList>();
+        return;
     }
 
-    Dictionary<String, String> combinedPreprocessorDefinitions;
-    for(auto& def : preprocessorDefinitions)
-        combinedPreprocessorDefinitions.Add(def.Key, def.Value);
-    for(auto& def : translationUnit->preprocessorDefinitions)
-        combinedPreprocessorDefinitions.Add(def.Key, def.Value);
+    // Otherwise, each file is preprocessed as the parser reads it, so
+    // only the tokens the parser is still using need to be held.
+    IncludeHandlerImpl includeHandler;
+    includeHandler.request = this;
 
-    RefPtr<ProgramSyntaxNode> translationUnitSyntax = new ProgramSyntaxNode();
-    translationUnit->SyntaxNode = translationUnitSyntax;
+    translationUnit->SyntaxNode = new ProgramSyntaxNode();
 
     for (auto sourceFile : translationUnit->sourceFiles)
     {
-        auto sourceFilePath = sourceFile->path;
-        String source = sourceFile->content;
-
-        auto tokens = preprocessSource(
-            source,
-            sourceFilePath,
+        RefPtr<TokenSource> tokens = beginPreprocessingSource(
+            sourceFile.Ptr(),
             &mSink,
             &includeHandler,
-            combinedPreprocessorDefinitions,
+            getPreprocessorDefinitions(translationUnit),
             translationUnit);
 
         parseSourceFile(
             translationUnit,
-            tokens,
+            TokenReader(tokens.Ptr()),
             &mSink,
-            sourceFilePath,
+            sourceFile->path,
             languageScope);
     }
 }
 
+bool CompileRequest::readIncludedFile(
+    String const&   path,
+    String*         outSource)
+{
+    if (parentRequest)
+        return parentRequest->readIncludedFile(path, outSource);
+
+    int64_t modifiedTime = 0;
+    int64_t size = 0;
+    if (!File::GetTimeAndSize(path, &modifiedTime, &size))
+        return false;
+
+    // If the file hasn't changed since we (or an earlier request)
+    // last read it, we can use the same text.
+    RefPtr<IncludedFile> includedFile;
+    if (includedFiles.TryGetValue(path, includedFile)
+        && (includedFile->modifiedTime != modifiedTime || includedFile->size != size))
+    {
+        includedFile = nullptr;
+    }
+    if (!includedFile)
+    {
+        includedFile = mSession->findSharedIncludedFile(path, modifiedTime, size);
+        if (includedFile)
+            includedFiles[path] = includedFile;
+    }
+
+    if (includedFile)
+    {
+        mSession->includedFileBytesSaved += (UInt)size;
+        *outSource = includedFile->source;
+        return true;
+    }
+
+    includedFile = new IncludedFile();
+    includedFile->source = File::ReadAllText(path);
+    includedFile->modifiedTime = modifiedTime;
+    includedFile->size = size;
+    includedFiles[path] = includedFile;
+
+    *outSource = includedFile->source;
+    return true;
+}
+
+SourceFile* CompileRequest::getCommandLineSourceFile(
+    String const&   text,
+    DiagnosticSink* sink)
+{
+    if (parentRequest)
+        return parentRequest->getCommandLineSourceFile(text, sink);
+
+    RefPtr<SourceFile> sourceFile;
+    if (!commandLineSourceFiles.TryGetValue(text, sourceFile))
+    {
+        sourceFile = sourceManager->allocateSourceFile("command line", text, sink);
+        commandLineSourceFiles.Add(text, sourceFile);
+    }
+    return sourceFile.Ptr();
+}
+
+RefPtr<IncludedFile> CompileRequest::getIncludedFile(
+    String const&   path,
+    String const&   source,
+    DiagnosticSink* sink)
+{
+    if (parentRequest)
+        return parentRequest->getIncludedFile(path, source, sink);
+
+    // We can only reuse the tokens if the file still holds
+    // the same text as when we lexed it. Text that we got from
+    // `readIncludedFile()` is usually the very same string.
+    RefPtr<IncludedFile> includedFile;
+    if (includedFiles.TryGetValue(path, includedFile)
+        && includedFile->source.begin() != source.begin()
+        && includedFile->source != source)
+    {
+        includedFile = nullptr;
+    }
+    if (!includedFile)
+    {
+        includedFile = new IncludedFile();
+        includedFile->source = source;
+        includedFiles[path] = includedFile;
+    }
+    else if (includedFile->hasLineDirective)
+    {
+        // Preprocessing a file records its `#line` directives on
+        // its `SourceFile`, so every inclusion of such a file gets
+        // a `SourceFile` (and tokens) of its own.
+        includedFile = new IncludedFile();
+        includedFile->source = source;
+        lexIncludedFile(includedFile, path, sink);
+        return includedFile;
+    }
+
+    if (includedFile->sourceFile)
+    {
+        mSession->includedFileTokensSaved += includedFile->tokens.mTokens.Count();
+        return includedFile;
+    }
+
+    int diagnosticCount = sink->diagnosticCount;
+    lexIncludedFile(includedFile, path, sink);
+
+    // Later requests would miss any diagnostics from lexing,
+    // so only files without any are shared.
+    if (includedFile->modifiedTime >= 0
+        && !includedFile->hasLineDirective
+        && sink->diagnosticCount == diagnosticCount)
+    {
+        mSession->addSharedIncludedFile(path, includedFile);
+    }
+    return includedFile;
+}
+
+void CompileRequest::lexIncludedFile(
+    IncludedFile*   includedFile,
+    String const&   path,
+    DiagnosticSink* sink)
+{
+    includedFile->sourceFile = sourceManager->allocateSourceFile(path, includedFile->source, sink);
+
+    Lexer lexer(includedFile->sourceFile.Ptr(), sink, namePool);
+    includedFile->tokens = lexer.lexAllTokens();
+    includedFile->includeGuard = findIncludeGuard(includedFile->tokens);
+    includedFile->hasLineDirective = containsLineDirective(includedFile->tokens);
+}
+
 void CompileRequest::checkAllTranslationUnits()
 {
     for( auto& translationUnit : translationUnits )
@@ -275,29 +445,37 @@ int CompileRequest::executeActionsInner()
     }
 #endif
 
+    // A request with permutations is compiled as a separate
+    // request for each permutation.
+    if (permutations.Count())
+    {
+        return executePermutations();
+    }
+
+    // If the session has a cache, and it has the output of an earlier
+    // compile with the same options and inputs, we can use that.
+    //
+    // The standard library is never cached this way, since it
+    // has a (much faster) cache of its own.
+    auto compileCache = mSession->compileCache.Ptr();
+    String cacheKey;
+    if (compileCache && !compilingBuiltins)
+    {
+        cacheKey = CompileCache::computeKey(this);
+        if (compileCache->tryLoad(cacheKey, this))
+        {
+            loadedFromCache = true;
+            return 0;
+        }
+    }
+
     // We only do parsing and semantic checking if we *aren't* doing
     // a pass-through compilation.
     //
     // Note that we *do* perform output generation as normal in pass-through mode.
     if( passThrough == PassThroughMode::None )
     {
-        // Parse everything from the input files requested
-        for (auto& translationUnit : translationUnits)
-        {
-            parseTranslationUnit(translationUnit.Ptr());
-        }
-        if (mSink.GetErrorCount() != 0)
-            return 1;
-
-        // Perform semantic checking on the whole collection
-        checkAllTranslationUnits();
-        if (mSink.GetErrorCount() != 0)
-            return 1;
-
-        // Now do shader parameter binding generation, which
-        // needs to be performed globally.
-        generateParameterBindings(this);
-        if (mSink.GetErrorCount() != 0)
+        if (runFrontEnd() != 0)
             return 1;
     }
 
@@ -306,12 +484,47 @@ int CompileRequest::executeActionsInner()
     if (mSink.GetErrorCount() != 0)
         return 1;
 
+    // We only save output that came with no diagnostics at all,
+    // so that a later hit doesn't need to reproduce any.
+    if (cacheKey.Length() && mSink.diagnosticCount == 0)
+    {
+        compileCache->store(cacheKey, this);
+    }
+
+    return 0;
+}
+
+int CompileRequest::runFrontEnd()
+{
+    // Parse everything from the input files requested
+    for (auto& translationUnit : translationUnits)
+    {
+        parseTranslationUnit(translationUnit.Ptr());
+    }
+    if (mSink.GetErrorCount() != 0)
+        return 1;
+
+    // Perform semantic checking on the whole collection
+    checkAllTranslationUnits();
+    if (mSink.GetErrorCount() != 0)
+        return 1;
+
+    // Now do shader parameter binding generation, which
+    // needs to be performed globally.
+    generateParameterBindings(this);
+    if (mSink.GetErrorCount() != 0)
+        return 1;
+
     return 0;
 }
 
 // Act as expected of the API-based compiler
 int CompileRequest::executeActions()
 {
+    SyntaxArenaScope arenaScope(syntaxArena.Ptr());
+    SessionTypesScope typesScope(mSession->types.Ptr());
+    SubstitutionCacheScope substitutionCacheScope(substitutionCache.Ptr());
+
     int err = executeActionsInner();
 
     mDiagnosticOutput = mSink.outputBuffer.ProduceString();
@@ -319,6 +532,374 @@ int CompileRequest::executeActions()
     return err;
 }
 
+static void addUniqueDependencyFile(
+    List<SourceDependency>&     files,
+    SourceDependency const&     file)
+{
+    for (auto& existingFile : files)
+    {
+        if (existingFile.path == file.path)
+            return;
+    }
+    files.Add(file);
+}
+
+RefPtr<CompileRequest> CompileRequest::createPermutationRequest(
+    PermutationRequest* permutation)
+{
+    RefPtr<CompileRequest> request = new CompileRequest(mSession);
+    request->parentRequest = this;
+
+    request->Target = Target;
+    request->extraTarget = extraTarget;
+    request->searchDirectories = searchDirectories;
+    request->preprocessorDefinitions = preprocessorDefinitions;
+    request->profile = profile;
+    request->passThrough = passThrough;
+    request->compileFlags = compileFlags;
+
+    request->mSink.callback = mSink.callback;
+    request->mSink.callbackUserData = mSink.callbackUserData;
+
+    for (auto& translationUnit : translationUnits)
+    {
+        int translationUnitIndex = request->addTranslationUnit(translationUnit->sourceLanguage, String());
+        auto newTranslationUnit = request->translationUnits[translationUnitIndex];
+
+        // The source files are shared, so that the tokens
+        // of each permutation have the same locations. A file that
+        // had `#line` directives recorded on it by an earlier
+        // permutation needs a copy of its own, though, since this
+        // permutation might see different ones.
+        for (auto& sourceFile : translationUnit->sourceFiles)
+        {
+            if (sourceFile->getLineDirectives().Count())
+            {
+                newTranslationUnit->sourceFiles.Add(
+                    sourceManager->allocateSourceFile(sourceFile->path, sourceFile->content, &request->mSink));
+            }
+            else
+            {
+                newTranslationUnit->sourceFiles.Add(sourceFile);
+            }
+        }
+        newTranslationUnit->compileFlags = translationUnit->compileFlags;
+        newTranslationUnit->preprocessorDefinitions = translationUnit->preprocessorDefinitions;
+        for (auto& def : permutation->preprocessorDefinitions)
+            newTranslationUnit->preprocessorDefinitions[def.Key] = def.Value;
+    }
+
+    for (auto& entryPoint : entryPoints)
+    {
+        request->addEntryPoint(
+            entryPoint->translationUnitIndex,
+            entryPoint->name,
+            entryPoint->profile);
+    }
+
+    return request;
+}
+
+bool CompileRequest::getPreprocessedTokensKey(
+    String& outKey)
+{
+    uint64_t hash = GetHashCode64(nullptr, 0);
+    uint64_t altHash = GetHashCode64(nullptr, 0, 0x736c616e67746f6bULL);
+    auto addToHash = [&](void const* data, UInt size)
+    {
+        hash = GetHashCode64((char const*)data, size, hash);
+        altHash = GetHashCode64((char const*)data, size, altHash);
+    };
+
+    for (auto& translationUnit : translationUnits)
+    {
+        // Directives like `#version` leave modifiers on the syntax
+        // rather than tokens, so we can't tell if those match.
+        if (translationUnit->SyntaxNode->modifiers.first)
+            return false;
+
+        for (auto& tokens : translationUnit->preprocessedTokens)
+        {
+            UInt tokenCount = tokens.mTokens.Count();
+            addToHash(&tokenCount, sizeof(tokenCount));
+
+            for (auto& token : tokens)
+            {
+                // The tokens for `#import` don't include the imported code,
+                // which was preprocessed with the macros of this permutation.
+                if (token.Type == TokenType::PoundImport)
+                    return false;
+
+                // The location is part of the key, since it
+                // ends up in the output (e.g., in `#line` directives).
+                auto content = token.getContent();
+                UInt contentSize = content.getLength();
+                SourceLoc::RawValue loc = token.Position.getRaw();
+                addToHash(&token.Type, sizeof(token.Type));
+                addToHash(&token.flags, sizeof(token.flags));
+                addToHash(&loc, sizeof(loc));
+                addToHash(&contentSize, sizeof(contentSize));
+                addToHash(content.begin(), contentSize);
+            }
+        }
+    }
+
+    StringBuilder sb;
+    sb << String((long long)hash, 16) << ":" << String((long long)altHash, 16);
+    outKey = sb.ProduceString();
+    return true;
+}
+
+// Add `result` to the distinct results of the permutations,
+// and return its index.
+static UInt addPermutationResult(
+    List<CompileResult>&                    results,
+    Dictionary<uint64_t, List<UInt>>&       resultsByHash,
+    CompileResult const&                    result)
+{
+    uint64_t hash = GetHashCode64((char const*)&result.format, sizeof(result.format));
+    hash = GetHashCode64(result.outputString.Buffer(), result.outputString.Length(), hash);
+    hash = GetHashCode64((char const*)result.outputBinary.Buffer(), result.outputBinary.Count(), hash);
+
+    auto indices = resultsByHash.TryGetValue(hash);
+    if (!indices)
+    {
+        resultsByHash.Add(hash, List<UInt>());
+        indices = resultsByHash.TryGetValue(hash);
+    }
+
+    for (auto index : *indices)
+    {
+        auto& existing = results[index];
+        if (existing.format == result.format
+            && existing.outputString == result.outputString
+            && existing.outputBinary.Count() == result.outputBinary.Count()
+            && memcmp(existing.outputBinary.Buffer(), result.outputBinary.Buffer(), result.outputBinary.Count()) == 0)
+        {
+            return index;
+        }
+    }
+
+    UInt index = results.Count();
+    results.Add(result);
+    indices->Add(index);
+    return index;
+}
+
+// The preprocessed tokens of a permutation that got checked and
+// compiled, so that later permutations can be compared with it
+struct PermutationTokens
+{
+    PermutationRequest*     permutation;
+    List<List<TokenList>>   translationUnitTokens;
+};
+
+static List<List<TokenList>> getPreprocessedTokens(
+    CompileRequest* request)
+{
+    List<List<TokenList>> tokens;
+    for (auto& translationUnit : request->translationUnits)
+        tokens.Add(translationUnit->preprocessedTokens);
+    return tokens;
+}
+
+// Do the translation units of `request` preprocess to exactly
+// the tokens of an earlier permutation? This compares everything
+// that `getPreprocessedTokensKey()` hashes.
+static bool arePreprocessedTokensEqual(
+    PermutationTokens const&    existing,
+    CompileRequest*             request)
+{
+    if (existing.translationUnitTokens.Count() != request->translationUnits.Count())
+        return false;
+    for (UInt ii = 0; ii < existing.translationUnitTokens.Count(); ++ii)
+    {
+        auto& existingFiles = existing.translationUnitTokens[ii];
+        auto& files = request->translationUnits[ii]->preprocessedTokens;
+        if (existingFiles.Count() != files.Count())
+            return false;
+        for (UInt jj = 0; jj < files.Count(); ++jj)
+        {
+            auto& existingTokens = existingFiles[jj].mTokens;
+            auto& tokens = files[jj].mTokens;
+            if (existingTokens.Count() != tokens.Count())
+                return false;
+            for (UInt kk = 0; kk < tokens.Count(); ++kk)
+            {
+                auto& existingToken = existingTokens[kk];
+                auto& token = tokens[kk];
+                if (existingToken.Type != token.Type
+                    || existingToken.flags != token.flags
+                    || existingToken.Position.getRaw() != token.Position.getRaw()
+                    || existingToken.getContent() != token.getContent())
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int CompileRequest::executePermutations()
+{
+    // Permutations that preprocess to the same tokens will produce the
+    // same output, so only the first of them gets checked and compiled.
+    // The key is only a hash of the tokens, so we keep the tokens of
+    // each permutation we compile to check that a match is real.
+    Dictionary<String, List<PermutationTokens>> permutationsByTokens;
+
+    Dictionary<uint64_t, List<UInt>> resultsByHash;
+    permutationResults.Clear();
+
+    int err = 0;
+    for (auto& permutation : permutations)
+    {
+        RefPtr<CompileRequest> request = createPermutationRequest(permutation);
+
+        PermutationRequest* existingPermutation = nullptr;
+        int permutationErr = 0;
+        {
+            SyntaxArenaScope arenaScope(request->syntaxArena.Ptr());
+            SubstitutionCacheScope substitutionCacheScope(request->substitutionCache.Ptr());
+
+            String tokensKey;
+            if (passThrough == PassThroughMode::None)
+            {
+                for (auto& translationUnit : request->translationUnits)
+                    request->preprocessTranslationUnit(translationUnit.Ptr());
+
+                if (request->mSink.GetErrorCount() == 0
+                    && request->getPreprocessedTokensKey(tokensKey))
+                {
+                    if (auto candidates = permutationsByTokens.TryGetValue(tokensKey))
+                    {
+                        for (auto& candidate : *candidates)
+                        {
+                            if (arePreprocessedTokensEqual(candidate, request.Ptr()))
+                            {
+                                existingPermutation = candidate.permutation;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (!existingPermutation)
+            {
+                // Parsing consumes the preprocessed tokens, so we need
+                // to take our copy of them first.
+                //
+                // The tokens refer to text held by the request's source
+                // files (and arena), which `permutation->compileRequest`
+                // keeps alive.
+                PermutationTokens permutationTokens;
+                if (tokensKey.Length())
+                {
+                    permutationTokens.permutation = permutation.Ptr();
+                    permutationTokens.translationUnitTokens = getPreprocessedTokens(request.Ptr());
+                }
+
+                permutationErr = request->executeActionsInner();
+
+                if (tokensKey.Length())
+                {
+                    auto candidates = permutationsByTokens.TryGetValue(tokensKey);
+                    if (!candidates)
+                    {
+                        permutationsByTokens.Add(tokensKey, List<PermutationTokens>());
+                        candidates = permutationsByTokens.TryGetValue(tokensKey);
+                    }
+                    candidates->Add(permutationTokens);
+                }
+            }
+        }
+
+        // Any diagnostics for the permutation (including those from
+        // preprocessing, when we reuse another permutation's output)
+        // go into the output for the whole request.
+        mSink.outputBuffer << request->mSink.outputBuffer;
+        mSink.errorCount += request->mSink.errorCount;
+        mSink.diagnosticCount += request->mSink.diagnosticCount;
+
+        if (existingPermutation)
+        {
+            permutation->compileRequest = existingPermutation->compileRequest;
+            permutation->translationUnitResults = existingPermutation->translationUnitResults;
+            permutation->entryPointResults = existingPermutation->entryPointResults;
+            continue;
+        }
+
+        permutation->compileRequest = request;
+        permutation->translationUnitResults.Clear();
+        permutation->entryPointResults.Clear();
+        if (permutationErr)
+        {
+            err = permutationErr;
+            continue;
+        }
+
+        for (auto& translationUnit : request->translationUnits)
+            permutation->translationUnitResults.Add(addPermutationResult(permutationResults, resultsByHash, translationUnit->result));
+        for (auto& entryPoint : request->entryPoints)
+            permutation->entryPointResults.Add(addPermutationResult(permutationResults, resultsByHash, entryPoint->result));
+
+        for (auto& file : request->mDependencyFiles)
+            addUniqueDependencyFile(mDependencyFiles, file);
+    }
+
+    // The ordinary results of the request are those of the first permutation
+    auto firstPermutation = permutations[0];
+    if (firstPermutation->translationUnitResults.Count() == translationUnits.Count())
+    {
+        for (UInt ii = 0; ii < translationUnits.Count(); ++ii)
+            translationUnits[ii]->result = permutationResults[firstPermutation->translationUnitResults[ii]];
+    }
+    if (firstPermutation->entryPointResults.Count() == entryPoints.Count())
+    {
+        for (UInt ii = 0; ii < entryPoints.Count(); ++ii)
+            entryPoints[ii]->result = permutationResults[firstPermutation->entryPointResults[ii]];
+    }
+
+    return err;
+}
+
+ProgramLayout* CompileRequest::getLayout()
+{
+    if (permutations.Count())
+        return permutations[0]->compileRequest ? permutations[0]->compileRequest->getLayout() : nullptr;
+
+    if (!loadedFromCache || passThrough != PassThroughMode::None)
+        return layout.Ptr();
+    loadedFromCache = false;
+
+    SyntaxArenaScope arenaScope(syntaxArena.Ptr());
+    SessionTypesScope typesScope(mSession->types.Ptr());
+    SubstitutionCacheScope substitutionCacheScope(substitutionCache.Ptr());
+
+    // The layout is generated from the checked syntax, which the
+    // cache entry usually holds.
+    if (CompileCache::loadLayout(this))
+        return layout.Ptr();
+
+    // Otherwise, we have to run the front end to produce it. We
+    // already reported all the diagnostics there were (none), and the
+    // files we depend on are already known, so we don't want to add
+    // to either.
+
+    DiagnosticSink savedSink = mSink;
+    List<SourceDependency> savedDependencyFiles = mDependencyFiles;
+    mSink.callback = nullptr;
+
+    runFrontEnd();
+
+    mSink = savedSink;
+    mDependencyFiles = savedDependencyFiles;
+
+    return layout.Ptr();
+}
+
 int CompileRequest::addTranslationUnit(SourceLanguage language, String const&)
 {
     UInt result = translationUnits.Count();
@@ -337,9 +918,7 @@ void CompileRequest::addTranslationUnitSourceString(
     String const&   path,
     String const&   source)
 {
-    RefPtr<SourceFile> sourceFile = new SourceFile();
-    sourceFile->path = path;
-    sourceFile->content = source;
+    RefPtr<SourceFile> sourceFile = sourceManager->allocateSourceFile(path, source, &mSink);
 
     translationUnits[translationUnitIndex]->sourceFiles.Add(sourceFile);
 }
@@ -357,7 +936,7 @@ void CompileRequest::addTranslationUnitSourceFile(
     {
         // Emit a diagnostic!
         mSink.diagnose(
-            CodePosition(0, 0, 0, path),
+            SourceLoc(),
             Diagnostics::cannotOpenFile,
             path);
         return;
@@ -368,7 +947,7 @@ void CompileRequest::addTranslationUnitSourceFile(
         path,
         source);
 
-    mDependencyFilePaths.Add(path);
+    addDependencyFile(path, source);
 }
 
 int CompileRequest::addEntryPoint(
@@ -390,12 +969,252 @@ int CompileRequest::addEntryPoint(
     return (int) result;
 }
 
+uint64_t getContentHash(String const& contents)
+{
+    return GetHashCode64(contents.Buffer(), contents.Length());
+}
+
+void LoadedModule::addFile(SourceDependency const& file)
+{
+    for (auto& existingFile : files)
+    {
+        if (existingFile.path == file.path)
+            return;
+    }
+    files.Add(file);
+}
+
+static void addUniqueIncludeLookup(
+    List<IncludeLookup>&    lookups,
+    IncludeLookup const&    lookup)
+{
+    for (auto& existingLookup : lookups)
+    {
+        if (existingLookup.pathToInclude == lookup.pathToInclude
+            && existingLookup.pathIncludedFrom == lookup.pathIncludedFrom)
+        {
+            return;
+        }
+    }
+    lookups.Add(lookup);
+}
+
+void LoadedModule::addIncludeLookup(IncludeLookup const& lookup)
+{
+    addUniqueIncludeLookup(includeLookups, lookup);
+}
+
+void CompileRequest::addDependencyFile(
+    String const&   path,
+    String const&   contents)
+{
+    SourceDependency file = getSourceDependency(path, contents);
+    mDependencyFiles.Add(file);
+
+    if (moduleLoadStack.Count())
+    {
+        moduleLoadStack.Last()->addFile(file);
+    }
+}
+
+SourceDependency CompileRequest::getSourceDependency(
+    String const&   path,
+    String const&   contents)
+{
+    if (parentRequest)
+        return parentRequest->getSourceDependency(path, contents);
+
+    SourceDependency file;
+    file.path = path;
+    file.contentHash = getContentHash(contents);
+
+    // If the text is what `readIncludedFile()` read, then we also
+    // know when the file was modified and how big it was.
+    RefPtr<IncludedFile> includedFile;
+    if (includedFiles.TryGetValue(path, includedFile)
+        && (includedFile->source.begin() == contents.begin()
+            || includedFile->source == contents))
+    {
+        file.modifiedTime = includedFile->modifiedTime;
+        file.size = includedFile->size;
+    }
+    return file;
+}
+
+List<String> CompileRequest::getIncludeCandidatePaths(
+    String const&   pathToInclude,
+    String const&   pathIncludedFrom)
+{
+    // We look next to the file doing the including first,
+    // and then in each of the search directories.
+    List<String> paths;
+    paths.Add(Path::Combine(Path::GetDirectoryName(pathIncludedFrom), pathToInclude));
+    for (auto& dir : searchDirectories)
+        paths.Add(Path::Combine(dir.path, pathToInclude));
+    return paths;
+}
+
+String CompileRequest::findIncludedFile(
+    IncludeLookup const&    lookup)
+{
+    for (auto& path : getIncludeCandidatePaths(lookup.pathToInclude, lookup.pathIncludedFrom))
+    {
+        if (File::Exists(path))
+            return path;
+    }
+    return String();
+}
+
+void CompileRequest::addIncludeLookup(
+    String const&   pathToInclude,
+    String const&   pathIncludedFrom,
+    String const&   foundPath)
+{
+    IncludeLookup lookup;
+    lookup.pathToInclude = pathToInclude;
+    lookup.pathIncludedFrom = pathIncludedFrom;
+    lookup.foundPath = foundPath;
+    addUniqueIncludeLookup(mIncludeLookups, lookup);
+
+    if (moduleLoadStack.Count())
+    {
+        moduleLoadStack.Last()->addIncludeLookup(lookup);
+    }
+}
+
+void CompileRequest::addModuleDependency(
+    ProgramSyntaxNode*  module)
+{
+    // The code doing the import (in the current arena) can refer
+    // to the module's code, so the module's arena must outlive it.
+    if (module)
+        addSyntaxArenaDependency(getSyntaxObjectArena(module));
+
+    if (!moduleLoadStack.Count())
+        return;
+    auto importer = moduleLoadStack.Last();
+
+    // A module that failed to load, or was loaded with `#import`,
+    // doesn't have the information we'd need to share the importer.
+    RefPtr<LoadedModule> loadedModule;
+    if (!module || !mapSyntaxToLoadedModule.TryGetValue(module, loadedModule))
+    {
+        importer->canShare = false;
+        return;
+    }
+
+    if (!importer->dependencies.Contains(loadedModule))
+        importer->dependencies.Add(loadedModule);
+
+    for (auto& file : loadedModule->files)
+        importer->addFile(file);
+    for (auto& lookup : loadedModule->includeLookups)
+        importer->addIncludeLookup(lookup);
+
+    if (!loadedModule->canShare)
+        importer->canShare = false;
+}
+
+String CompileRequest::getModuleOptionsKey()
+{
+    // Imported modules are preprocessed with the request's macros, and
+    // the search directories decide which files their imports find.
+    StringBuilder sb;
+    for (auto& def : preprocessorDefinitions)
+        sb << "-D" << def.Key << "=" << def.Value << "\n";
+    for (auto& dir : searchDirectories)
+        sb << "-I" << dir.path << "\n";
+    return sb.ProduceString();
+}
+
+bool CompileRequest::addSharedModule(
+    LoadedModule*   module)
+{
+    RefPtr<ProgramSyntaxNode> existingModule;
+    if (mapPathToLoadedModule.TryGetValue(module->path, existingModule))
+        return existingModule == module->syntax;
+
+    for (auto dependency : module->dependencies)
+    {
+        if (!addSharedModule(dependency))
+            return false;
+    }
+
+    mapPathToLoadedModule.Add(module->path, module->syntax);
+    mapNameToLoadedModules.AddIfNotExists(module->name, module->syntax);
+    mapSyntaxToLoadedModule.Add(module->syntax.Ptr(), module);
+    loadedModulesList.Add(module->syntax);
+
+    for (auto& file : module->files)
+        addUniqueDependencyFile(mDependencyFiles, file);
+    for (auto& lookup : module->includeLookups)
+        addUniqueIncludeLookup(mIncludeLookups, lookup);
+
+    // The extensions in the module were registered with the request
+    // that checked it, so we need to register them with this one.
+    for (auto member : module->syntax->Members)
+    {
+        Decl* decl = member.Ptr();
+        if (auto genericDecl = dynamicCast<GenericDecl>(decl))
+            decl = genericDecl->inner.Ptr();
+
+        auto extDecl = dynamicCast<ExtensionDecl>(decl);
+        if (!extDecl)
+            continue;
+
+        if (auto targetDeclRefType = extDecl->targetType->As<DeclRefType>())
+        {
+            if (auto aggTypeDeclRef = targetDeclRefType->declRef.As<AggTypeDecl>())
+                addCandidateExtension(aggTypeDeclRef.getDecl(), extDecl);
+        }
+    }
+
+    return true;
+}
+
+void CompileRequest::addCandidateExtension(
+    AggTypeDecl*    aggTypeDecl,
+    ExtensionDecl*  extDecl)
+{
+    auto extensions = candidateExtensions.TryGetValue(aggTypeDecl);
+    if (!extensions)
+    {
+        candidateExtensions.Add(aggTypeDecl, List<ExtensionDecl*>());
+        extensions = candidateExtensions.TryGetValue(aggTypeDecl);
+    }
+
+    // Later extensions are considered first
+    extensions->Insert(0, extDecl);
+
+    invalidateLookupCache();
+}
+
 RefPtr<ProgramSyntaxNode> CompileRequest::loadModule(
     String const&       name,
     String const&       path,
     String const&       source,
-    CodePosition const&)
+    SourceLoc const&)
 {
+    RefPtr<LoadedModule> loadedModule = new LoadedModule();
+    loadedModule->name = name;
+    loadedModule->path = path;
+    loadedModule->addFile(getSourceDependency(path, source));
+
+    // The module gets its own arena, and its own cache of substitutions,
+    // so that nothing in it refers to objects in this request's arena.
+    // Other requests may end up using the module too.
+    loadedModule->syntaxArena = new SyntaxArena();
+    loadedModule->syntaxArena->isShared = true;
+    SyntaxArenaScope arenaScope(loadedModule->syntaxArena.Ptr());
+
+    RefPtr<SubstitutionCache> moduleSubstitutionCache = new SubstitutionCache();
+    SubstitutionCacheScope substitutionCacheScope(moduleSubstitutionCache.Ptr());
+
+    // Anything the module includes or imports gets recorded
+    // as a dependency of the module while it is on the stack.
+    moduleLoadStack.Add(loadedModule.Ptr());
+    int diagnosticCount = mSink.diagnosticCount;
+
     RefPtr<TranslationUnitRequest> translationUnit = new TranslationUnitRequest();
     translationUnit->compileRequest = this;
 
@@ -405,9 +1224,7 @@ RefPtr<ProgramSyntaxNode> CompileRequest::loadModule(
     //
     // TODO: decide which options, if any, should be inherited.
 
-    RefPtr<SourceFile> sourceFile = new SourceFile();
-    sourceFile->path = path;
-    sourceFile->content = source;
+    RefPtr<SourceFile> sourceFile = sourceManager->allocateSourceFile(path, source, &mSink);
 
     translationUnit->sourceFiles.Add(sourceFile);
 
@@ -423,10 +1240,21 @@ RefPtr<ProgramSyntaxNode> CompileRequest::loadModule(
 
     RefPtr<ProgramSyntaxNode> moduleDecl = translationUnit->SyntaxNode;
 
+    moduleLoadStack.RemoveAt(moduleLoadStack.Count() - 1);
+    if (mSink.diagnosticCount != diagnosticCount)
+        loadedModule->canShare = false;
+    loadedModule->syntax = moduleDecl;
+
     mapPathToLoadedModule.Add(path, moduleDecl);
     mapNameToLoadedModules.Add(name, moduleDecl);
+    mapSyntaxToLoadedModule.Add(moduleDecl.Ptr(), loadedModule);
     loadedModulesList.Add(moduleDecl);
 
+    if (loadedModule->canShare)
+    {
+        mSession->addSharedModule(getModuleOptionsKey(), loadedModule.Ptr());
+    }
+
     return moduleDecl;
 
 }
@@ -435,18 +1263,23 @@ void CompileRequest::handlePoundImport(
     String const&       path,
     TokenList const&    tokens)
 {
+    // The imported code shares macros with the code that imports it,
+    // so any module being loaded can't be reused by other requests.
+    for (auto module : moduleLoadStack)
+        module->canShare = false;
+
     RefPtr<TranslationUnitRequest> translationUnit = new TranslationUnitRequest();
     translationUnit->compileRequest = this;
 
     // Imported code is always native Slang code
-    RefPtr<Scope> languageScope = mSession->slangLanguageScope;
+    RefPtr<Scope> languageScope = mSession->getLanguageScope(SourceLanguage::Slang);
 
     RefPtr<ProgramSyntaxNode> translationUnitSyntax = new ProgramSyntaxNode();
     translationUnit->SyntaxNode = translationUnitSyntax;
 
     parseSourceFile(
         translationUnit.Ptr(),
-        tokens,
+        TokenReader(tokens),
         &mSink,
         path,
         languageScope);
@@ -473,13 +1306,16 @@ void CompileRequest::handlePoundImport(
 
 RefPtr<ProgramSyntaxNode> CompileRequest::findOrImportModule(
     String const&       name,
-    CodePosition const& loc)
+    SourceLoc const&    loc)
 {
     // Have we already loaded a module matching this name?
     // If so, return it.
     RefPtr<ProgramSyntaxNode> moduleDecl;
     if (mapNameToLoadedModules.TryGetValue(name, moduleDecl))
+    {
+        addModuleDependency(moduleDecl);
         return moduleDecl;
+    }
 
     // Derive a file name for the module, by taking the given
     // identifier, replacing all occurences of `_` with `-`,
@@ -487,73 +1323,243 @@ RefPtr<ProgramSyntaxNode> CompileRequest::findOrImportModule(
     //
     // For example, `foo_bar` becomes `foo-bar.slang`.
 
-    StringBuilder sb;
-    for (auto c : name)
+    StringBuilder sb;
+    for (auto c : name)
+    {
+        if (c == '_')
+            c = '-';
+
+        sb.Append(c);
+    }
+    sb.Append(".slang");
+
+    String fileName = sb.ProduceString();
+
+    // Next, try to find the file of the given name,
+    // using our ordinary include-handling logic.
+
+    IncludeHandlerImpl includeHandler;
+    includeHandler.request = this;
+
+    String pathIncludedFrom;
+    if (auto sourceFile = sourceManager->findSourceFile(loc))
+        pathIncludedFrom = sourceFile->path;
+
+    String foundPath;
+    String foundSource;
+    IncludeResult includeResult = includeHandler.TryToFindIncludeFile(fileName, pathIncludedFrom, &foundPath, &foundSource);
+    switch( includeResult )
+    {
+    case IncludeResult::NotFound:
+    case IncludeResult::Error:
+        {
+            this->mSink.diagnose(loc, Diagnostics::cannotFindFile, fileName);
+
+            mapNameToLoadedModules[name] = nullptr;
+            addModuleDependency(nullptr);
+            return nullptr;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    // Maybe this was loaded previously via `#import`
+    if (mapPathToLoadedModule.TryGetValue(foundPath, moduleDecl))
+    {
+        addModuleDependency(moduleDecl);
+        return moduleDecl;
+    }
+
+    // Maybe an earlier request in this session loaded the same module
+    if (auto sharedModule = mSession->findSharedModule(this, foundPath, getModuleOptionsKey(), foundSource))
+    {
+        if (addSharedModule(sharedModule.Ptr()))
+        {
+            mapNameToLoadedModules.AddIfNotExists(name, sharedModule->syntax);
+            addModuleDependency(sharedModule->syntax.Ptr());
+            return sharedModule->syntax;
+        }
+    }
+
+    // We've found a file that we can load for the given module, so
+    // go ahead and perform the module-load action
+    moduleDecl = loadModule(
+        name,
+        foundPath,
+        foundSource,
+        loc);
+    addModuleDependency(moduleDecl);
+    return moduleDecl;
+}
+
+RefPtr<ProgramSyntaxNode> findOrImportModule(
+    CompileRequest*     request,
+    String const&       name,
+    SourceLoc const&    loc)
+{
+    return request->findOrImportModule(name, loc);
+}
+
+RefPtr<Scope> Session::getLanguageScope(SourceLanguage language)
+{
+    switch (language)
+    {
+    case SourceLanguage::HLSL:
+        ensureStdlibModule(StdlibModule::HLSL);
+        return hlslLanguageScope;
+
+    case SourceLanguage::GLSL:
+        ensureStdlibModule(StdlibModule::GLSL);
+        return glslLanguageScope;
+
+    case SourceLanguage::Slang:
+    default:
+        ensureStdlibModule(StdlibModule::HLSL);
+        return slangLanguageScope;
+    }
+}
+
+void Session::ensureStdlibModule(StdlibModule module)
+{
+    auto& info = stdlibModules[(int)module];
+
+    std::lock_guard<std::recursive_mutex> lock(stdlibMutex);
+    if (info.syntax || isLoadingStdlib)
+        return;
+
+    // The library code is all checked as Slang code, so every
+    // module can see the core and HLSL modules, and they
+    // need to be loaded first. This also means the modules
+    // always get loaded in the order they are declared.
+    for (int ii = 0; ii < (int)module && ii <= (int)StdlibModule::HLSL; ++ii)
     {
-        if (c == '_')
-            c = '-';
+        ensureStdlibModule(StdlibModule(ii));
+    }
 
-        sb.Append(c);
+    isLoadingStdlib = true;
+
+    SyntaxArenaScope arenaScope(syntaxArena.Ptr());
+    SessionTypesScope typesScope(types.Ptr());
+
+    // The library is loaded on behalf of whichever request needed it
+    // first, but it outlives that request, so nothing in it may be
+    // interned in the request's substitution cache.
+    SubstitutionCacheScope substitutionCacheScope(nullptr);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    RefPtr<ProgramSyntaxNode> syntax = loadSerializedStdlibModule(module);
+    info.deserialized = syntax != nullptr;
+    if (!syntax)
+    {
+        syntax = compileStdlibModule(module);
     }
-    sb.Append(".slang");
 
-    String fileName = sb.ProduceString();
+    RefPtr<Scope> scopes[] = { coreLanguageScope, hlslLanguageScope, glslLanguageScope };
+    addBuiltinModule(scopes[(int)module], syntax);
+    info.syntax = syntax;
 
-    // Next, try to find the file of the given name,
-    // using our ordinary include-handling logic.
+    info.initTime = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
 
-    IncludeHandlerImpl includeHandler;
-    includeHandler.request = this;
+    isLoadingStdlib = false;
 
-    String pathIncludedFrom = loc.FileName;
+    if (!info.deserialized)
+    {
+        saveSerializedStdlib();
+    }
+}
 
-    String foundPath;
-    String foundSource;
-    IncludeResult includeResult = includeHandler.TryToFindIncludeFile(fileName, pathIncludedFrom, &foundPath, &foundSource);
-    switch( includeResult )
+RefPtr<ProgramSyntaxNode> Session::compileStdlibModule(StdlibModule module)
+{
+    switch (module)
     {
-    case IncludeResult::NotFound:
-    case IncludeResult::Error:
-        {
-            this->mSink.diagnose(loc, Diagnostics::cannotFindFile, fileName);
+    case StdlibModule::Core:    return compileBuiltinSource("core", getCoreLibraryCode());
+    case StdlibModule::HLSL:    return compileBuiltinSource("hlsl", getHLSLLibraryCode());
+    case StdlibModule::GLSL:    return compileBuiltinSource("glsl", getGLSLLibraryCode());
+    default:
+        return nullptr;
+    }
+}
 
-            mapNameToLoadedModules[name] = nullptr;
+RefPtr<ProgramSyntaxNode> Session::loadSerializedStdlibModule(StdlibModule module)
+{
+    if (!stdlibReader)
+    {
+        // The first module we load picks the blob we will use
+        // for the rest of the session (if there is one).
+        if (module != StdlibModule::Core)
             return nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(gSerializedStdlibMutex);
+            stdlibBlob = gSerializedStdlib;
         }
-        break;
+        if (!stdlibBlob && compileCache)
+        {
+            // Nothing in this process has serialized the library yet,
+            // but an earlier process may have left it in the cache.
+            RefPtr<SerializedStdlib> blob = new SerializedStdlib();
+            if (compileCache->tryLoadStdlib(blob->data, &blob->moduleCount))
+            {
+                std::lock_guard<std::mutex> lock(gSerializedStdlibMutex);
+                if (!gSerializedStdlib || gSerializedStdlib->moduleCount < blob->moduleCount)
+                    gSerializedStdlib = blob;
+                stdlibBlob = gSerializedStdlib;
+            }
+        }
+        if (!stdlibBlob)
+            return nullptr;
 
-    default:
-        break;
+        RefPtr<SerializedModuleReader> reader = new SerializedModuleReader(
+            stdlibBlob->data.Buffer(),
+            stdlibBlob->data.Count(),
+            getStdlibExternalObjects(),
+            &sourceManager,
+            &namePool);
+        if (!reader->isValid())
+            return nullptr;
+        stdlibReader = reader;
     }
 
-    // Maybe this was loaded previously via `#import`
-    if (mapPathToLoadedModule.TryGetValue(foundPath, moduleDecl))
-        return moduleDecl;
+    // The modules are stored in the order we load them,
+    // so a module is either in the blob, or needs to be
+    // compiled from source along with all those after it.
+    if ((UInt)module >= stdlibReader->getModuleCount())
+        return nullptr;
 
+    RefPtr<ProgramSyntaxNode> syntax = stdlibReader->loadModule((UInt)module);
+    if (!syntax)
+        return nullptr;
 
-    // We've found a file that we can load for the given module, so
-    // go ahead and perform the module-load action
-    return loadModule(
-        name,
-        foundPath,
-        foundSource,
-        loc);
-}
+    // Loading doesn't go through semantic checking, so we need
+    // to register the builtin types ourselves.
+    registerBuiltinDecls(syntax.Ptr());
 
-RefPtr<ProgramSyntaxNode> findOrImportModule(
-    CompileRequest*     request,
-    String const&       name,
-    CodePosition const& loc)
-{
-    return request->findOrImportModule(name, loc);
+    return syntax;
 }
 
 void Session::addBuiltinSource(
     RefPtr<Scope> const&    scope,
     String const&           path,
     String const&           source)
+{
+    addedBuiltinsHash = GetHashCode64(path.Buffer(), path.Length(), addedBuiltinsHash);
+    addedBuiltinsHash = GetHashCode64(source.Buffer(), source.Length(), addedBuiltinsHash);
+
+    addBuiltinModule(scope, compileBuiltinSource(path, source));
+}
+
+RefPtr<ProgramSyntaxNode> Session::compileBuiltinSource(
+    String const&           path,
+    String const&           source)
 {
     RefPtr<CompileRequest> compileRequest = new CompileRequest(this);
+    compileRequest->syntaxArena = syntaxArena;
+    compileRequest->substitutionCache = nullptr;
+    compileRequest->compilingBuiltins = true;
 
     auto translationUnitIndex = compileRequest->addTranslationUnit(SourceLanguage::Slang, path);
 
@@ -582,12 +1588,19 @@ void Session::addBuiltinSource(
     for (auto m : syntax->Members)
     {
         auto fromStdLibModifier = new FromStdLibModifier();
-
-        fromStdLibModifier->next = m->modifiers.first;
-        m->modifiers.first = fromStdLibModifier;
+        m->modifiers.prepend(fromStdLibModifier);
     }
 
-    // Add the resulting code to the appropriate scope
+    return syntax;
+}
+
+void Session::addBuiltinModule(
+    RefPtr<Scope> const&                scope,
+    RefPtr<ProgramSyntaxNode> const&    syntax)
+{
+    SharedRefObjectScope sharedScope;
+
+    // Add the code to the appropriate scope
     if (!scope->containerDecl)
     {
         // We are the first chunk of code to be loaded for this scope
@@ -602,11 +1615,279 @@ void Session::addBuiltinSource(
         scope->nextSibling = subScope;
     }
 
+    // Lookup builds these lazily, which would mean writing to
+    // the shared library code from whichever thread gets there first.
+    buildMemberDictionariesRec(syntax.Ptr());
+    buildOverloadGroupIndicesRec(syntax.Ptr());
+
     // We need to retain this AST so that we can use it in other code
     // (Note that the `Scope` type does not retain the AST it points to)
     loadedModuleCode.Add(syntax);
 }
 
+static String getSharedModuleKey(
+    String const&   path,
+    String const&   optionsKey)
+{
+    return Path::GetCanonical(path) + "\n" + optionsKey;
+}
+
+// Does `file` still hold what it did when we read it? We only read
+// the file again, and hash it, if its modification time or size
+// has changed. If the caller has already read the file, it can pass
+// in its `source`.
+static bool isSourceDependencyUpToDate(
+    SourceDependency const& file,
+    String const*           source)
+{
+    int64_t modifiedTime = 0;
+    int64_t size = 0;
+    if (!File::GetTimeAndSize(file.path, &modifiedTime, &size))
+        return false;
+    if (file.modifiedTime != -1 && file.modifiedTime == modifiedTime && file.size == size)
+        return true;
+
+    if (source)
+        return file.contentHash == getContentHash(*source);
+    try
+    {
+        return file.contentHash == getContentHash(File::ReadAllText(file.path));
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+RefPtr<LoadedModule> Session::findSharedModule(
+    CompileRequest* request,
+    String const&   path,
+    String const&   optionsKey,
+    String const&   source)
+{
+    String key = getSharedModuleKey(path, optionsKey);
+
+    RefPtr<LoadedModule> module;
+    {
+        std::lock_guard<std::mutex> lock(sharedModuleMutex);
+        if (!sharedModules.TryGetValue(key, module))
+        {
+            sharedModuleMissCount++;
+            return nullptr;
+        }
+    }
+
+    // The module can only be used if none of the files it was built
+    // from have changed. The first file is the module's own source,
+    // which the caller already read for us.
+    bool upToDate = true;
+    for (UInt ii = 0; upToDate && ii < module->files.Count(); ++ii)
+        upToDate = isSourceDependencyUpToDate(module->files[ii], ii == 0 ? &source : nullptr);
+
+    // A file added earlier in the search path (or next to the file
+    // that includes it) would hide one that the module was built
+    // with, without any of the files above changing.
+    for (UInt ii = 0; upToDate && ii < module->includeLookups.Count(); ++ii)
+    {
+        auto& lookup = module->includeLookups[ii];
+        upToDate = request->findIncludedFile(lookup) == lookup.foundPath;
+    }
+
+    std::lock_guard<std::mutex> lock(sharedModuleMutex);
+    if (!upToDate)
+    {
+        sharedModuleMissCount++;
+        return nullptr;
+    }
+    sharedModuleHitCount++;
+    return module;
+}
+
+// Let other threads use `module`, along with the strings it holds
+// (see `RefObject::markShared()`). The modules it imports were
+// already shared when they were loaded.
+static void markLoadedModuleShared(
+    LoadedModule*   module)
+{
+    module->markShared();
+    module->name.markShared();
+    module->path.markShared();
+    for (auto& file : module->files)
+        file.path.markShared();
+    for (auto& lookup : module->includeLookups)
+    {
+        lookup.pathToInclude.markShared();
+        lookup.pathIncludedFrom.markShared();
+        lookup.foundPath.markShared();
+    }
+}
+
+void Session::addSharedModule(
+    String const&   optionsKey,
+    LoadedModule*   module)
+{
+    // Other requests may look up names in the module at the
+    // same time, so the lookup tables must be built up front.
+    {
+        SharedRefObjectScope sharedScope;
+        buildMemberDictionariesRec(module->syntax.Ptr());
+        buildOverloadGroupIndicesRec(module->syntax.Ptr());
+    }
+
+    markLoadedModuleShared(module);
+    String key = getSharedModuleKey(module->path, optionsKey);
+    key.markShared();
+
+    std::lock_guard<std::mutex> lock(sharedModuleMutex);
+    sharedModules[key] = module;
+}
+
+RefPtr<IncludedFile> Session::findSharedIncludedFile(
+    String const&   path,
+    int64_t         modifiedTime,
+    int64_t         size)
+{
+    std::lock_guard<std::mutex> lock(sharedIncludedFileMutex);
+
+    RefPtr<IncludedFile> file;
+    if (!sharedIncludedFiles.TryGetValue(path, file))
+        return nullptr;
+    if (file->modifiedTime != modifiedTime || file->size != size)
+        return nullptr;
+    return file;
+}
+
+void Session::addSharedIncludedFile(
+    String const&   path,
+    IncludedFile*   file)
+{
+    // The file's `SourceFile` is already shared
+    file->markShared();
+    file->source.markShared();
+    path.markShared();
+
+    std::lock_guard<std::mutex> lock(sharedIncludedFileMutex);
+    sharedIncludedFiles[path] = file;
+}
+
+bool Session::tryGetCachedCoercion(
+    CoercionKey const&  key,
+    CoercionResult*     outResult)
+{
+    bool found;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(coercionCacheMutex);
+        found = coercionCache.TryGetValue(key, *outResult);
+    }
+    if (found)
+        coercionCacheHitCount++;
+    else
+        coercionCacheMissCount++;
+    return found;
+}
+
+void Session::cacheCoercion(
+    CoercionKey const&      key,
+    CoercionResult const&   result)
+{
+    // Entries for types that have since been destroyed are never
+    // looked up again (their IDs aren't reused), so we start over
+    // if the cache gets too big, rather than let those pile up.
+    static const int kMaxCoercionCacheSize = 1 << 16;
+
+    std::unique_lock<std::shared_timed_mutex> lock(coercionCacheMutex);
+    if (coercionCache.Count() >= kMaxCoercionCacheSize)
+        coercionCache = Dictionary<CoercionKey, CoercionResult>();
+    coercionCache[key] = result;
+}
+
+List<RefObject*> Session::getStdlibExternalObjects()
+{
+    List<RefObject*> objects;
+    objects.Add(coreLanguageScope.Ptr());
+    objects.Add(hlslLanguageScope.Ptr());
+    objects.Add(slangLanguageScope.Ptr());
+    objects.Add(glslLanguageScope.Ptr());
+    objects.Add(types->errorType.Ptr());
+    objects.Add(types->initializerListType.Ptr());
+    objects.Add(types->overloadedType.Ptr());
+    return objects;
+}
+
+List<RefObject*> Session::getBuiltinObjects(UInt* outModuleCount)
+{
+    std::lock_guard<std::recursive_mutex> lock(stdlibMutex);
+
+    // Modules only ever get added to the end of the list, and code in
+    // one module can't change what is in an earlier one, so the objects
+    // of the earlier modules always come out the same.
+    if (builtinObjectsModuleCount != loadedModuleCode.Count())
+    {
+        List<RefObject*> externalObjects = getStdlibExternalObjects();
+        builtinObjects = externalObjects;
+        collectModuleObjects(
+            loadedModuleCode,
+            externalObjects,
+            &sourceManager,
+            builtinObjects);
+        builtinObjectsModuleCount = loadedModuleCode.Count();
+    }
+
+    *outModuleCount = builtinObjectsModuleCount;
+    return builtinObjects;
+}
+
+void Session::saveSerializedStdlib()
+{
+    // Gather the modules we've loaded, which are
+    // always some prefix of the whole library.
+    List<RefPtr<ProgramSyntaxNode>> modules;
+    for (auto& info : stdlibModules)
+    {
+        if (!info.syntax)
+            break;
+        modules.Add(info.syntax);
+    }
+
+    {
+        // Don't bother if the blob already has everything we have.
+        std::lock_guard<std::mutex> lock(gSerializedStdlibMutex);
+        if (gSerializedStdlib && gSerializedStdlib->moduleCount >= modules.Count())
+            return;
+    }
+
+    // If anything in the library can't be serialized, we
+    // just leave the blob alone, and keep compiling the
+    // library for each session.
+    RefPtr<SerializedStdlib> blob = new SerializedStdlib();
+    if (!serializeModules(
+        modules,
+        getStdlibExternalObjects(),
+        &sourceManager,
+        blob->data))
+    {
+        return;
+    }
+    blob->moduleCount = modules.Count();
+
+    {
+        std::lock_guard<std::mutex> lock(gSerializedStdlibMutex);
+
+        // Another session may have saved more of the
+        // library than we have while we were busy.
+        if (!gSerializedStdlib || gSerializedStdlib->moduleCount < blob->moduleCount)
+        {
+            gSerializedStdlib = blob;
+        }
+    }
+
+    // Later processes can use it too
+    if (compileCache)
+    {
+        compileCache->storeStdlib(blob->data, blob->moduleCount);
+    }
+}
+
 }
 
 // implementation of C interface
@@ -641,6 +1922,89 @@ SLANG_API void spAddBuiltins(
         sourceString);
 }
 
+SLANG_API double spGetStdlibModuleInitTime(
+    SlangSession*   session,
+    char const*     moduleName,
+    int*            outDeserialized)
+{
+    auto s = SESSION(session);
+    for (int ii = 0; ii < (int)Slang::StdlibModule::Count; ++ii)
+    {
+        if (strcmp(moduleName, Slang::kStdlibModuleNames[ii]) != 0)
+            continue;
+
+        std::lock_guard<std::recursive_mutex> lock(s->stdlibMutex);
+        auto& info = s->stdlibModules[ii];
+        if (!info.syntax)
+            return -1.0;
+
+        if (outDeserialized)
+            *outDeserialized = info.deserialized;
+        return info.initTime;
+    }
+    return -1.0;
+}
+
+SLANG_API void spGetModuleCacheStats(
+    SlangSession*   session,
+    unsigned int*   outHitCount,
+    unsigned int*   outMissCount)
+{
+    auto s = SESSION(session);
+
+    std::lock_guard<std::mutex> lock(s->sharedModuleMutex);
+    if (outHitCount)
+        *outHitCount = (unsigned int)s->sharedModuleHitCount;
+    if (outMissCount)
+        *outMissCount = (unsigned int)s->sharedModuleMissCount;
+}
+
+
+SLANG_API void spGetIncludeCacheStats(
+    SlangSession*   session,
+    size_t*         outBytesSaved,
+    size_t*         outTokensSaved,
+    size_t*         outIncludesSkipped)
+{
+    auto s = SESSION(session);
+
+    if (outBytesSaved)
+        *outBytesSaved = (size_t)s->includedFileBytesSaved;
+    if (outTokensSaved)
+        *outTokensSaved = (size_t)s->includedFileTokensSaved;
+    if (outIncludesSkipped)
+        *outIncludesSkipped = (size_t)s->includesSkipped;
+}
+
+SLANG_API void spGetCoercionCacheStats(
+    SlangSession*   session,
+    unsigned int*   outHitCount,
+    unsigned int*   outMissCount)
+{
+    auto s = SESSION(session);
+
+    if (outHitCount)
+        *outHitCount = (unsigned int)s->coercionCacheHitCount;
+    if (outMissCount)
+        *outMissCount = (unsigned int)s->coercionCacheMissCount;
+}
+
+SLANG_API void spGetSourceLocationStats(
+    SlangSession*   session,
+    size_t*         outLocationsInUse,
+    size_t*         outLocationSpaceUsed)
+{
+    auto s = SESSION(session);
+
+    Slang::UInt locationsInUse = 0;
+    Slang::UInt locationSpaceUsed = 0;
+    s->sourceManager.getLocationStats(&locationsInUse, &locationSpaceUsed);
+
+    if (outLocationsInUse)
+        *outLocationsInUse = (size_t)locationsInUse;
+    if (outLocationSpaceUsed)
+        *outLocationSpaceUsed = (size_t)locationSpaceUsed;
+}
 
 SLANG_API SlangCompileRequest* spCreateCompileRequest(
     SlangSession* session)
@@ -817,6 +2181,27 @@ SLANG_API int spAddEntryPoint(
 }
 
 
+SLANG_API int spAddPermutation(
+    SlangCompileRequest*    request)
+{
+    auto req = REQ(request);
+
+    Slang::UInt result = req->permutations.Count();
+    req->permutations.Add(new Slang::PermutationRequest());
+    return (int) result;
+}
+
+SLANG_API void spPermutation_addPreprocessorDefine(
+    SlangCompileRequest*    request,
+    int                     permutationIndex,
+    const char*             key,
+    const char*             value)
+{
+    auto req = REQ(request);
+
+    req->permutations[permutationIndex]->preprocessorDefinitions[key] = value;
+}
+
 // Compile in a context that already has its translation units specified
 SLANG_API int spCompile(
     SlangCompileRequest*    request)
@@ -833,7 +2218,7 @@ spGetDependencyFileCount(
 {
     if(!request) return 0;
     auto req = REQ(request);
-    return (int) req->mDependencyFilePaths.Count();
+    return (int) req->mDependencyFiles.Count();
 }
 
 /** Get the path to a file this compilation dependend on.
@@ -845,7 +2230,7 @@ spGetDependencyFilePath(
 {
     if(!request) return 0;
     auto req = REQ(request);
-    return req->mDependencyFilePaths[index].begin();
+    return req->mDependencyFiles[index].path.begin();
 }
 
 SLANG_API int
@@ -884,6 +2269,69 @@ SLANG_API void const* spGetEntryPointCode(
     return result.outputBinary.Buffer();
 }
 
+SLANG_API int spGetPermutationCount(
+    SlangCompileRequest*    request)
+{
+    auto req = REQ(request);
+    return (int) req->permutations.Count();
+}
+
+// Get the result for a translation unit or entry point of a permutation,
+// if the permutation compiled successfully
+static Slang::CompileResult* getPermutationResult(
+    Slang::CompileRequest*          req,
+    Slang::List<Slang::UInt> const& resultIndices,
+    int                             index)
+{
+    if (Slang::UInt(index) >= resultIndices.Count())
+        return nullptr;
+    return &req->permutationResults[resultIndices[index]];
+}
+
+SLANG_API char const* spGetPermutationTranslationUnitSource(
+    SlangCompileRequest*    request,
+    int                     permutationIndex,
+    int                     translationUnitIndex)
+{
+    auto req = REQ(request);
+    auto result = getPermutationResult(req, req->permutations[permutationIndex]->translationUnitResults, translationUnitIndex);
+    return result ? result->outputString.Buffer() : nullptr;
+}
+
+SLANG_API char const* spGetPermutationEntryPointSource(
+    SlangCompileRequest*    request,
+    int                     permutationIndex,
+    int                     entryPointIndex)
+{
+    auto req = REQ(request);
+    auto result = getPermutationResult(req, req->permutations[permutationIndex]->entryPointResults, entryPointIndex);
+    return result ? result->outputString.Buffer() : nullptr;
+}
+
+SLANG_API void const* spGetPermutationEntryPointCode(
+    SlangCompileRequest*    request,
+    int                     permutationIndex,
+    int                     entryPointIndex,
+    size_t*                 outSize)
+{
+    auto req = REQ(request);
+    auto result = getPermutationResult(req, req->permutations[permutationIndex]->entryPointResults, entryPointIndex);
+    if(outSize) *outSize = result ? result->outputBinary.Count() : 0;
+    return result ? result->outputBinary.Buffer() : nullptr;
+}
+
+SLANG_API void spGetLookupCacheStats(
+    SlangCompileRequest*    request,
+    unsigned int*           outLookupCount,
+    unsigned int*           outHitCount)
+{
+    auto req = REQ(request);
+    if (outLookupCount)
+        *outLookupCount = (unsigned int)req->lookupCount;
+    if (outHitCount)
+        *outHitCount = (unsigned int)req->lookupCacheHitCount;
+}
+
 // Reflection API
 
 SLANG_API SlangReflection* spGetReflection(
@@ -892,7 +2340,19 @@ SLANG_API SlangReflection* spGetReflection(
     if( !request ) return 0;
 
     auto req = REQ(request);
-    return (SlangReflection*) req->layout.Ptr();
+    return (SlangReflection*) req->getLayout();
+}
+
+SLANG_API SlangReflection* spGetPermutationReflection(
+    SlangCompileRequest*    request,
+    int                     permutationIndex)
+{
+    if( !request ) return 0;
+
+    auto req = REQ(request);
+    auto permutationRequest = req->permutations[permutationIndex]->compileRequest;
+    if( !permutationRequest ) return 0;
+    return (SlangReflection*) permutationRequest->getLayout();
 }
 
 // ... rest of reflection API implementation is in `Reflection.cpp`
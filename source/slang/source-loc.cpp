@@ -0,0 +1,327 @@
+// source-loc.cpp
+#include "source-loc.h"
+
+#include "diagnostics.h"
+
+#include <assert.h>
+
+namespace Slang {
+
+// SourceFile
+
+SourceFile::~SourceFile()
+{
+    if (sourceManager)
+        sourceManager->releaseSourceFile(this);
+}
+
+void SourceFile::computeLineStarts()
+{
+    // The first line always starts at offset zero.
+    lineStarts.Add(0);
+
+    // We use the same definition of a newline as the lexer:
+    // one of `\n`, `\r`, `\r\n`, or `\n\r`.
+    char const* begin = content.begin();
+    char const* end = content.end();
+    char const* cursor = begin;
+    while (cursor != end)
+    {
+        int c = *cursor++;
+        if (c != '\n' && c != '\r')
+            continue;
+
+        if (cursor != end)
+        {
+            int d = *cursor;
+            if ((c ^ d) == ('\n' ^ '\r'))
+                cursor++;
+        }
+
+        lineStarts.Add(int(cursor - begin));
+    }
+}
+
+void SourceFile::getRawLineAndColumn(SourceLoc loc, int* outLine, int* outColumn)
+{
+    assert(sourceRange.contains(loc));
+    int offset = int(loc.getRaw() - sourceRange.begin.getRaw());
+
+    std::call_once(lineStartsOnce, [this]() { computeLineStarts(); });
+
+    // Binary search for the last line that starts at or before `offset`
+    auto const& starts = lineStarts;
+    int lo = 0;
+    int hi = int(starts.Count());
+    while (hi - lo > 1)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (starts[mid] <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    *outLine = lo + 1;
+    *outColumn = offset - starts[lo] + 1;
+}
+
+HumaneSourceLoc SourceFile::getHumaneLoc(SourceLoc loc)
+{
+    HumaneSourceLoc humaneLoc;
+    humaneLoc.path = path;
+    getRawLineAndColumn(loc, &humaneLoc.line, &humaneLoc.column);
+
+    // Apply the last `#line` directive (if any) before the location
+    for (UInt ii = lineDirectives.Count(); ii > 0; --ii)
+    {
+        auto const& directive = lineDirectives[ii - 1];
+        if (loc < directive.loc)
+            continue;
+
+        humaneLoc.path = directive.path;
+        humaneLoc.line += directive.lineAdjust;
+        break;
+    }
+
+    return humaneLoc;
+}
+
+void SourceFile::addLineDirective(SourceLoc loc, String const& directivePath, int line)
+{
+    int rawLine = 0;
+    int rawColumn = 0;
+    getRawLineAndColumn(loc, &rawLine, &rawColumn);
+
+    // A `#line` directive sets the line number of the line
+    // *after* the directive.
+    LineDirective directive;
+    directive.loc = loc;
+    directivePath.markShared();
+    directive.path = directivePath;
+    directive.lineAdjust = line - (rawLine + 1);
+
+    lineDirectives.Add(directive);
+}
+
+void SourceFile::addDefaultLineDirective(SourceLoc loc)
+{
+    LineDirective directive;
+    directive.loc = loc;
+    directive.path = path;
+    directive.lineAdjust = 0;
+
+    lineDirectives.Add(directive);
+}
+
+UnownedStringSlice SourceFile::addScrubbedText(String const& text)
+{
+    text.markShared();
+
+    std::lock_guard<std::mutex> lock(scrubbedTextMutex);
+    scrubbedTexts.Add(text);
+    return scrubbedTexts.Last().getUnownedSlice();
+}
+
+// SourceManager
+
+SourceManager::~SourceManager()
+{
+    // Any files that outlive the session keep their locations,
+    // but have nobody to give them back to.
+    for (auto sourceFile : sourceFiles)
+        sourceFile->sourceManager = nullptr;
+}
+
+RefPtr<SourceFile> SourceManager::allocateSourceFile(
+    String const&   path,
+    String const&   content,
+    DiagnosticSink* sink)
+{
+    // Files can be shared between requests on different threads,
+    // e.g., through the syntax of the standard library.
+    RefPtr<SourceFile> sourceFile;
+    {
+        SharedRefObjectScope sharedScope;
+        sourceFile = new SourceFile();
+    }
+    path.markShared();
+    content.markShared();
+    sourceFile->path = path;
+    sourceFile->content = content;
+
+    // The file gets one location per byte, plus one for
+    // the end-of-file position.
+    uint64_t size = content.Length();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Use the first range given back by an earlier file that
+        // is big enough, if there is one.
+        bool found = false;
+        SourceLoc::RawValue begin = 0;
+        for (UInt ii = 0; ii < freeRanges.Count(); ++ii)
+        {
+            auto& range = freeRanges[ii];
+            uint64_t rangeSize = uint64_t(range.end.getRaw()) - range.begin.getRaw() + 1;
+            if (rangeSize < size + 1)
+                continue;
+
+            begin = range.begin.getRaw();
+            if (rangeSize == size + 1)
+                freeRanges.RemoveAt(ii);
+            else
+                range.begin = range.begin + UInt(size + 1);
+            found = true;
+            break;
+        }
+
+        // Otherwise the file goes after all the others. Rather than
+        // let the locations wrap around (and alias those of other
+        // files), a file that doesn't fit gets no locations at all.
+        if (!found)
+        {
+            uint64_t newNextLoc = uint64_t(nextLoc) + size + 1;
+            if (newNextLoc <= uint64_t(SourceLoc::RawValue(~0)))
+            {
+                begin = nextLoc;
+                nextLoc = SourceLoc::RawValue(newNextLoc);
+                found = true;
+            }
+        }
+
+        if (found)
+        {
+            sourceFile->sourceRange.begin = SourceLoc::fromRaw(begin);
+            sourceFile->sourceRange.end = SourceLoc::fromRaw(SourceLoc::RawValue(begin + size));
+            sourceFile->sourceManager = this;
+
+            sourceFiles.Insert(findSourceFileIndex(sourceFile->sourceRange.begin), sourceFile.Ptr());
+            locationsInUse += UInt(size + 1);
+            return sourceFile;
+        }
+    }
+
+    // We report the error outside the lock, since formatting a
+    // diagnostic looks up its location.
+    if (sink)
+        sink->diagnose(SourceLoc(), Diagnostics::outOfSourceLocations, path);
+    return sourceFile;
+}
+
+void SourceManager::releaseSourceFile(SourceFile* sourceFile)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    SourceRange range = sourceFile->sourceRange;
+
+    UInt index = findSourceFileIndex(range.begin);
+    assert(index < sourceFiles.Count() && sourceFiles[index] == sourceFile);
+    sourceFiles.RemoveAt(index);
+    locationsInUse -= UInt(range.end.getRaw() - range.begin.getRaw()) + 1;
+
+    if (lastFoundSourceFile == sourceFile)
+        lastFoundSourceFile = nullptr;
+
+    // Add the range to the free list, merging it with the free
+    // ranges on either side of it.
+    UInt rangeIndex = 0;
+    while (rangeIndex < freeRanges.Count() && freeRanges[rangeIndex].begin < range.begin)
+        rangeIndex++;
+    if (rangeIndex < freeRanges.Count()
+        && freeRanges[rangeIndex].begin.getRaw() == range.end.getRaw() + 1)
+    {
+        range.end = freeRanges[rangeIndex].end;
+        freeRanges.RemoveAt(rangeIndex);
+    }
+    if (rangeIndex > 0
+        && freeRanges[rangeIndex - 1].end.getRaw() + 1 == range.begin.getRaw())
+    {
+        rangeIndex--;
+        range.begin = freeRanges[rangeIndex].begin;
+        freeRanges.RemoveAt(rangeIndex);
+    }
+
+    // A range at the end of the locations in use just goes back
+    // to being unallocated.
+    if (range.end.getRaw() + 1 == nextLoc)
+    {
+        nextLoc = range.begin.getRaw();
+        return;
+    }
+    freeRanges.Insert(rangeIndex, range);
+}
+
+UInt SourceManager::findSourceFileIndex(SourceLoc loc)
+{
+    UInt lo = 0;
+    UInt hi = sourceFiles.Count();
+    while (lo < hi)
+    {
+        UInt mid = lo + (hi - lo) / 2;
+        if (sourceFiles[mid]->sourceRange.begin < loc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void SourceManager::getLocationStats(UInt* outLocationsInUse, UInt* outLocationSpaceUsed)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outLocationsInUse)
+        *outLocationsInUse = locationsInUse;
+    if (outLocationSpaceUsed)
+        *outLocationSpaceUsed = nextLoc - 1;
+}
+
+SourceFile* SourceManager::findSourceFile(SourceLoc loc)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return findSourceFileImpl(loc);
+}
+
+SourceFile* SourceManager::findSourceFileImpl(SourceLoc loc)
+{
+    if (!loc.isValid())
+        return nullptr;
+
+    if (lastFoundSourceFile && lastFoundSourceFile->sourceRange.contains(loc))
+        return lastFoundSourceFile;
+
+    // Files are kept in order of location, so we can
+    // binary search for the one we want.
+    int lo = 0;
+    int hi = int(sourceFiles.Count());
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        SourceFile* sourceFile = sourceFiles[mid];
+        if (loc.getRaw() < sourceFile->sourceRange.begin.getRaw())
+        {
+            hi = mid;
+        }
+        else if (loc.getRaw() > sourceFile->sourceRange.end.getRaw())
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            lastFoundSourceFile = sourceFile;
+            return sourceFile;
+        }
+    }
+    return nullptr;
+}
+
+HumaneSourceLoc SourceManager::getHumaneLoc(SourceLoc loc)
+{
+    SourceFile* sourceFile = findSourceFile(loc);
+    if (!sourceFile)
+        return HumaneSourceLoc();
+
+    return sourceFile->getHumaneLoc(loc);
+}
+
+} // namespace Slang
@@ -4,40 +4,245 @@
 
 #include "../core/basic.h"
 
+#include <stdint.h>
+#include <mutex>
+
 namespace Slang {
 
-class CodePosition
+class DiagnosticSink;
+class SourceManager;
+
+// A location in the source code of a program.
+//
+// All of the source files loaded into a session are assigned
+// disjoint ranges in a single 32-bit "location space" (see
+// `SourceManager`), so that a location is just an integer,
+// and is cheap to store on every token and syntax node.
+// A file's range is reused once the file is destroyed, so a
+// location is only meaningful while its file is alive.
+//
+// Finding the file, line, and column for a location is more
+// expensive, and should only be done when we actually need
+// to show the location to a user (e.g., in a diagnostic).
+class SourceLoc
+{
+public:
+    typedef uint32_t RawValue;
+
+    SourceLoc()
+        : raw(0)
+    {}
+
+    static SourceLoc fromRaw(RawValue value)
+    {
+        SourceLoc loc;
+        loc.raw = value;
+        return loc;
+    }
+
+    RawValue getRaw() const { return raw; }
+
+    // The zero location is reserved to mean "no location"
+    bool isValid() const { return raw != 0; }
+
+    bool operator==(SourceLoc const& other) const { return raw == other.raw; }
+    bool operator!=(SourceLoc const& other) const { return raw != other.raw; }
+    bool operator< (SourceLoc const& other) const { return raw <  other.raw; }
+
+    SourceLoc operator+(UInt offset) const
+    {
+        return fromRaw(RawValue(raw + offset));
+    }
+
+private:
+    RawValue raw;
+};
+
+// A contiguous range of source locations.
+//
+// The `end` location is included in the range, so that
+// a source file of `N` bytes covers `N+1` locations, and
+// its end-of-file token still has a location in the file.
+struct SourceRange
+{
+    SourceLoc begin;
+    SourceLoc end;
+
+    bool contains(SourceLoc loc) const
+    {
+        return begin.getRaw() <= loc.getRaw()
+            && loc.getRaw() <= end.getRaw();
+    }
+};
+
+// A source location in the form that we present to users.
+struct HumaneSourceLoc
+{
+    String  path;
+    int     line    = 0;
+    int     column  = 0;
+};
+
+// Represents a single source file (either an on-disk file, or a
+// "virtual" file passed in as a string)
+class SourceFile : public RefObject
 {
 public:
-	int Line = -1, Col = -1, Pos = -1;
-	String FileName;
-	String ToString()
-	{
-		StringBuilder sb(100);
-		sb << FileName;
-		if (Line != -1)
-			sb << "(" << Line << ")";
-		return sb.ProduceString();
-	}
-	CodePosition() = default;
-	CodePosition(int line, int col, int pos, String fileName)
-	{
-		Line = line;
-		Col = col;
-		Pos = pos;
-		this->FileName = fileName;
-	}
-	bool operator < (const CodePosition & pos) const
-	{
-		return FileName < pos.FileName || (FileName == pos.FileName && Line < pos.Line) ||
-			(FileName == pos.FileName && Line == pos.Line && Col < pos.Col);
-	}
-	bool operator == (const CodePosition & pos) const
-	{
-		return FileName == pos.FileName && Line == pos.Line && Col == pos.Col;
-	}
+    // The file path for a real file, or the nominal path for a virtual file
+    String path;
+
+    // The actual contents of the file
+    String content;
+
+    // The range of locations that has been assigned to this file
+    SourceRange sourceRange;
+
+    ~SourceFile();
+
+    // Map a location inside this file to a line and column,
+    // taking any `#line` directives into account.
+    HumaneSourceLoc getHumaneLoc(SourceLoc loc);
+
+    // Record a `#line <line> "<path>"` directive at `loc`, which
+    // affects all locations in the file after it.
+    //
+    // Only the one preprocessing run that owns the file may do
+    // this (see `CompileRequest::getIncludedFile()`), and it must
+    // be done before the file is used on other threads.
+    void addLineDirective(SourceLoc loc, String const& path, int line);
+
+    // Record a `#line default` directive at `loc`.
+    void addDefaultLineDirective(SourceLoc loc);
+
+    struct LineDirective
+    {
+        // Location of the directive
+        SourceLoc   loc;
+
+        // Path to report for locations after the directive
+        String      path;
+
+        // Offset to add to line numbers after the directive
+        int         lineAdjust;
+    };
+
+    // The `#line` directives recorded so far, in order of location.
+    // These are exposed so that a file's line information can be
+    // saved along with syntax that refers to it.
+    List<LineDirective> const& getLineDirectives() { return lineDirectives; }
+
+    // Record a directive that was previously saved out of a file
+    // with the same content.
+    void addLineDirective(LineDirective const& directive) { lineDirectives.Add(directive); }
+
+    // Keep `text` for as long as the file, and return a view of it.
+    // This holds the text of tokens that can't just point into
+    // `content` (i.e., ones with an escaped newline removed).
+    UnownedStringSlice addScrubbedText(String const& text);
+
+private:
+    friend class SourceManager;
+
+    // Find the offsets at which each line in the file starts.
+    // This is only done the first time we need to map a location
+    // to a line (see `getRawLineAndColumn()`), since most files
+    // never have a diagnostic or `#line` directive in them.
+    void computeLineStarts();
+
+    // Get the line and column of `loc`, ignoring `#line` directives.
+    void getRawLineAndColumn(SourceLoc loc, int* outLine, int* outColumn);
+
+    // Offset of the start of each line, once `lineStartsOnce` has run.
+    // The same file can be used on several threads at once, so
+    // the table is only built by whichever one needs it first.
+    List<int> lineStarts;
+    std::once_flag lineStartsOnce;
+
+    // The source manager that gave the file its locations, which
+    // gets them back when the file is destroyed
+    SourceManager* sourceManager = nullptr;
+
+    // Any `#line` directives in the file, in order of location
+    List<LineDirective> lineDirectives;
+
+    // Storage for `addScrubbedText()`. A file given on the command
+    // line can be lexed by several requests at once, so this is
+    // guarded by a lock.
+    List<String> scrubbedTexts;
+    std::mutex scrubbedTextMutex;
 };
 
+// Tracks all of the source files loaded in a session, and
+// allocates the ranges of locations assigned to them.
+//
+// The source manager doesn't own the files: whatever refers to
+// locations in a file (e.g., the syntax parsed from it, see
+// `addSyntaxSourceFile()`) holds a reference to it, and the file's
+// range of locations is given back to be reused by later files
+// when the last reference goes away. That way a long-lived session
+// doesn't use up its locations on the files of each request.
+//
+// A session's source manager is shared by all of its compile
+// requests, which may run on different threads, so all of
+// these operations take a lock.
+class SourceManager
+{
+public:
+    ~SourceManager();
+
+    // Create a new source file, and give it a range of locations.
+    //
+    // If the session has run out of locations, the file gets none
+    // (so all of its tokens have an invalid location), and an error
+    // is reported to `sink` if there is one.
+    RefPtr<SourceFile> allocateSourceFile(
+        String const&   path,
+        String const&   content,
+        DiagnosticSink* sink);
+
+    // Find the file that contains `loc`, or `nullptr` if there is none.
+    SourceFile* findSourceFile(SourceLoc loc);
+
+    // Get a file path, line, and column for `loc`.
+    HumaneSourceLoc getHumaneLoc(SourceLoc loc);
+
+    // Get the number of locations held by the files that are alive right
+    // now, and how much of the location space is taken up (which also
+    // counts any gaps left by destroyed files that haven't been reused).
+    void getLocationStats(UInt* outLocationsInUse, UInt* outLocationSpaceUsed);
+
+private:
+    friend class SourceFile;
+
+    SourceFile* findSourceFileImpl(SourceLoc loc);
+
+    // Find where the file starting at `loc` is (or would go) in `sourceFiles`
+    UInt findSourceFileIndex(SourceLoc loc);
+
+    // Give back the locations of a file that is being destroyed
+    void releaseSourceFile(SourceFile* sourceFile);
+
+    std::mutex mutex;
+
+    // The next location that has not been assigned to any file.
+    // Location zero is reserved as the invalid location.
+    SourceLoc::RawValue nextLoc = 1;
+
+    // The files that have locations, in order of location. The
+    // files remove themselves from this list when destroyed.
+    List<SourceFile*> sourceFiles;
+
+    // Ranges below `nextLoc` that belonged to files that have been
+    // destroyed, in order of location. Adjacent ranges are merged.
+    List<SourceRange> freeRanges;
+
+    // The number of locations held by the files in `sourceFiles`
+    UInt locationsInUse = 0;
+
+    // The last file found by `findSourceFile()`, since queries
+    // tend to come in runs that hit the same file.
+    SourceFile* lastFoundSourceFile = nullptr;
+};
 
 } // namespace Slang
 
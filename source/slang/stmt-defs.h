@@ -13,7 +13,7 @@ END_SYNTAX_CLASS()
 
 // The simplest kind of scope statement: just a `{...}` block
 SYNTAX_CLASS(BlockStmt, ScopeStmt)
-    SYNTAX_FIELD(RefPtr<StatementSyntaxNode>, body);
+    SYNTAX_FIELD(RefPtr<StatementSyntaxNode>, body)
 END_SYNTAX_CLASS()
 
 // A statement that we aren't going to parse or check, because
@@ -83,7 +83,7 @@ END_SYNTAX_CLASS()
 
 // A `for` statement in a language that doesn't restrict the scope
 // of the loop variable to the body.
-SYNTAX_CLASS(UnscopedForStmt, ForStatementSyntaxNode);
+SYNTAX_CLASS(UnscopedForStmt, ForStatementSyntaxNode)
 END_SYNTAX_CLASS()
 
 SYNTAX_CLASS(WhileStatementSyntaxNode, LoopStmt)
@@ -6,17 +6,17 @@
 
 // Base class for all nodes representing actual syntax
 // (thus having a location in the source code)
-ABSTRACT_SYNTAX_CLASS(SyntaxNodeBase, RefObject)
+ABSTRACT_SYNTAX_CLASS(SyntaxNodeBase, SyntaxObject)
 
     // The primary source location associated with this AST node
-    FIELD(CodePosition, Position)
+    FIELD(SourceLoc, Position)
 END_SYNTAX_CLASS()
 
 // Base class for compile-time values (most often a type).
 // These are *not* syntax nodes, because they do not have
 // a unique location, and any two `Val`s representing
 // the same value should be conceptually equal.
-ABSTRACT_SYNTAX_CLASS(Val, RefObject)
+ABSTRACT_SYNTAX_CLASS(Val, SyntaxObject)
     RAW(typedef IValVisitor Visitor;)
 
     RAW(virtual void accept(IValVisitor* visitor, void* extra) = 0;)
@@ -62,19 +62,8 @@ ABSTRACT_SYNTAX_CLASS(ExpressionType, Val)
 
 RAW(
 public:
-    static RefPtr<ExpressionType> Error;
-    static RefPtr<ExpressionType> initializerListType;
-    static RefPtr<ExpressionType> Overloaded;
-
-    static Dictionary<int, RefPtr<ExpressionType>> sBuiltinTypes;
-    static Dictionary<String, Decl*> sMagicDecls;
-
-    // Note: just exists to make sure we can clean up
-    // canonical types we create along the way
-    static List<RefPtr<ExpressionType>> sCanonicalTypes;
-
-
-
+    // Get builtin and special types, from the `SessionTypes`
+    // for the session the current thread is working on.
     static ExpressionType* GetBool();
     static ExpressionType* GetFloat();
     static ExpressionType* getDoubleType();
@@ -83,6 +72,7 @@ public:
     static ExpressionType* GetVoid();
     static ExpressionType* getInitializerListType();
     static ExpressionType* GetError();
+    static ExpressionType* getOverloadedType();
 
 public:
     virtual String ToString() = 0;
@@ -96,7 +86,7 @@ public:
     template<typename T>
     T* As()
     {
-        return dynamic_cast<T*>(GetCanonicalType());
+        return dynamicCast<T>(GetCanonicalType());
     }
 
     // Convenience/legacy wrappers for `As<>`
@@ -115,25 +105,61 @@ public:
     bool IsSampler() { return As<SamplerStateType>() != nullptr; }
     bool IsStruct();
     bool IsClass();
-    static void Init();
-    static void Finalize();
     ExpressionType* GetCanonicalType();
 
+    // Get a hash of the canonical type, which agrees with `Equals()`
+    int GetCanonicalHash();
+
+    // Get a number that identifies the canonical type within its
+    // session, and is never reused for another type. This is zero
+    // if the canonical type isn't interned.
+    uint64_t GetCanonicalTypeId();
+
     virtual RefPtr<Val> SubstituteImpl(Substitutions* subst, int* ioDiff) override;
 
     virtual bool EqualsVal(Val* val) override;
+
+    ~ExpressionType();
+
+    // Interned types need to remove themselves from the table
+    static const bool kRawMembersNeedDestructor = true;
+
 protected:
     virtual bool EqualsImpl(ExpressionType * type) = 0;
 
     virtual ExpressionType* CreateCanonicalType() = 0;
-    ExpressionType* canonicalType = nullptr;
+
+    // Compute the hash used to intern this (canonical) type. Returns
+    // false for types that can't be interned, because `EqualsImpl()`
+    // doesn't treat them as equal to themselves.
+    virtual bool ComputeCanonicalHash(int* outHash);
+
+    // The canonical type is computed on demand. Types shared through a
+    // session (e.g., those in the standard library) can be asked for it
+    // by several threads at once, so this is atomic.
+    std::atomic<ExpressionType*> canonicalType{ nullptr };
+
+    // Canonical types are interned in the `SessionTypes` that was
+    // current when they were created, so that there is only one object
+    // for each distinct type, and `Equals()` can compare pointers.
+    // Each type removes itself from the table when its arena is freed.
+    SessionTypes*   internedIn = nullptr;
+    int             canonicalHash = 0;
+    uint64_t        internId = 0;
+
+    // Set for interned types that live in the arena of the code they
+    // refer to (or the session's arena), which anything that can refer
+    // to that code keeps alive, so that code in any arena can use them.
+    // Other interned types can only be used from their own arena.
+    bool            internedForAllArenas = false;
+
+    friend class SessionTypes;
     )
 END_SYNTAX_CLASS()
 
 // A substitution represents a binding of certain
 // type-level variables to concrete argument values
-SYNTAX_CLASS(Substitutions, RefObject)
-
+SYNTAX_CLASS(Substitutions, SyntaxObject)
     // The generic declaration that defines the
     // parametesr we are binding to arguments
     DECL_FIELD(GenericDecl*,  genericDecl)
@@ -156,14 +182,19 @@ SYNTAX_CLASS(Substitutions, RefObject)
     }
     int GetHashCode() const
     {
-        int rs = 0;
-        for (auto && v : args)
-        {
-            rs ^= v->GetHashCode();
-            rs *= 16777619;
-        }
-        return rs;
+        if (internedIn.load(std::memory_order_acquire))
+            return hashCode;
+        return ComputeHashCode();
     }
+    int ComputeHashCode() const;
+
+    // Set while these substitutions are interned in a `SubstitutionCache`
+    // (see `internSubstitutions()`), after which they must not change.
+    // Substitutions from a module shared between requests can be seen
+    // by other threads when the owning request's cache goes away, so
+    // this is atomic.
+    std::atomic<SubstitutionCache*> internedIn{ nullptr };
+    int                             hashCode = 0;
     )
 END_SYNTAX_CLASS()
 
@@ -194,13 +225,13 @@ ABSTRACT_SYNTAX_CLASS(ModifiableSyntaxNode, SyntaxNode)
 
     RAW(
     template<typename T>
-    FilteredModifierList<T> GetModifiersOfType() { return FilteredModifierList<T>(modifiers.first.Ptr()); }
+    FilteredModifierList<T> GetModifiersOfType() { return modifiers.getModifiersOfType<T>(); }
 
     // Find the first modifier of a given type, or return `nullptr` if none is found.
     template<typename T>
     T* FindModifier()
     {
-        return *GetModifiersOfType<T>().begin();
+        return modifiers.findModifier<T>();
     }
 
     template<typename T>
@@ -224,8 +255,12 @@ ABSTRACT_SYNTAX_CLASS(Decl, DeclBase)
     FIELD(Token, Name)
 
     RAW(
-    String const& getName() { return Name.Content; }
+    String const& getName() { return getText(Name.getName()); }
     Token const& getNameToken() { return Name; }
+
+    // The interned name of the declaration, which is what lookup uses.
+    // (The type needs to be qualified here, since `Name` is also a field)
+    Slang::Name* getInternedName() { return Name.getName(); }
     )
 
 
@@ -0,0 +1,1060 @@
+// syntax-serialize.cpp
+#include "syntax-serialize.h"
+
+#include "name.h"
+
+#include <string.h>
+#include <type_traits>
+
+namespace Slang
+{
+    // A blob starts with these, so that we can reject
+    // anything that wasn't written by the current code.
+    static const uint32_t kSerializedSyntaxMagic   = 0x534c4153; // 'SLAS'
+    static const uint32_t kSerializedSyntaxVersion = 1;
+
+    //
+    // Class tags
+    //
+
+    // Identifies the class of each serialized object. The syntax
+    // classes use the same values as their `SerializedObjectTag`.
+    //
+    // These values aren't stable across changes to the syntax
+    // definitions, which is fine as long as blobs aren't expected
+    // to outlive the compiler that wrote them.
+    enum class SerializedObjectTag
+    {
+#define SYNTAX_CLASS(NAME, BASE, ...) NAME,
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+        // Lookup scopes aren't syntax, but they hang off of
+        // the syntax, so we need to save them too.
+        Scope,
+
+        Count,
+    };
+    static_assert(int(SerializedObjectTag::Scope) == int(SyntaxClassTag::Count),
+        "serialized object tags must match the syntax class tags");
+
+    static SerializedObjectTag getSerializedObjectTag(SyntaxObject* obj)
+    {
+        return SerializedObjectTag(obj->getClassTag());
+    }
+
+    static SerializedObjectTag getSerializedObjectTag(Scope*)
+    {
+        return SerializedObjectTag::Scope;
+    }
+
+    //
+    // Creating objects
+    //
+
+    // Abstract classes (and any class without a default constructor)
+    // can't be created when reading, so we refuse to write them.
+    template<typename T,
+        bool kCanCreate = std::is_default_constructible<T>::value && !std::is_abstract<T>::value>
+    struct SyntaxObjectFactory
+    {
+        static RefObject* create() { return new T(); }
+        static bool canCreate() { return true; }
+    };
+
+    template<typename T>
+    struct SyntaxObjectFactory<T, false>
+    {
+        static RefObject* create() { return nullptr; }
+        static bool canCreate() { return false; }
+    };
+
+    static RefObject* createSyntaxObject(SerializedObjectTag tag)
+    {
+        switch (tag)
+        {
+#define SYNTAX_CLASS(NAME, BASE, ...) \
+        case SerializedObjectTag::NAME: return SyntaxObjectFactory<NAME>::create();
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+        case SerializedObjectTag::Scope: return new Scope();
+
+        default:
+            return nullptr;
+        }
+    }
+
+    static bool canCreateSyntaxObject(SerializedObjectTag tag)
+    {
+        switch (tag)
+        {
+#define SYNTAX_CLASS(NAME, BASE, ...) \
+        case SerializedObjectTag::NAME: return SyntaxObjectFactory<NAME>::canCreate();
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+        case SerializedObjectTag::Scope: return true;
+
+        default:
+            return false;
+        }
+    }
+
+    //
+    // Fields
+    //
+
+    // The code to visit the fields of an object is shared between reading
+    // and writing: each field is passed by reference to `s.io()`, and the
+    // reader and writer contexts provide overloads of `io()` for all the
+    // types of fields that we support.
+
+    template<typename S>
+    void serializeFields(S&, RefObject*)
+    {}
+
+    // State that is declared with `RAW(...)` in the syntax definitions
+    // is invisible to the generated code, so any of it that we need
+    // gets handled here.
+
+    template<typename S, typename T>
+    void serializeRawFields(S&, T*)
+    {}
+
+    template<typename S>
+    void serializeRawFields(S& s, ConstantExpressionSyntaxNode* expr)
+    {
+        s.io(expr->ConstType);
+        switch (expr->ConstType)
+        {
+        case ConstantExpressionSyntaxNode::ConstantType::Int:
+        case ConstantExpressionSyntaxNode::ConstantType::Bool:
+            s.io(expr->integerValue);
+            break;
+
+        case ConstantExpressionSyntaxNode::ConstantType::Float:
+            s.io(expr->floatingPointValue);
+            break;
+
+        default:
+            break;
+        }
+        s.io(expr->stringValue);
+    }
+
+    template<typename S>
+    void serializeRawFields(S& s, SwizzleExpr* expr)
+    {
+        for (int ii = 0; ii < 4; ++ii)
+            s.io(expr->elementIndices[ii]);
+    }
+
+    template<typename S>
+    void serializeRawFields(S& s, AggTypeDecl* decl)
+    {
+        s.io(decl->candidateExtensions);
+    }
+
+    // Note: the member dictionary of a `ContainerDecl` and the canonical
+    // type of an `ExpressionType` are caches that get rebuilt on demand,
+    // so we don't save them.
+
+#define SYNTAX_CLASS(NAME, BASE, ...)           \
+    template<typename S>                        \
+    void serializeFields(S& s, NAME* obj)       \
+    {                                           \
+        serializeFields(s, (BASE*) obj);        \
+        serializeRawFields(s, obj);
+
+#define FIELD(TYPE, NAME) s.io(obj->NAME);
+
+#define END_SYNTAX_CLASS() \
+    }
+
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+    template<typename S>
+    void serializeFields(S& s, Scope* scope)
+    {
+        s.io(scope->parent);
+        s.io(scope->nextSibling);
+        s.io(scope->containerDecl);
+    }
+
+    template<typename S>
+    void serializeObject(S& s, SerializedObjectTag tag, RefObject* obj)
+    {
+        switch (tag)
+        {
+#define SYNTAX_CLASS(NAME, BASE, ...) \
+        case SerializedObjectTag::NAME: serializeFields(s, static_cast<NAME*>(obj)); break;
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+        case SerializedObjectTag::Scope: serializeFields(s, static_cast<Scope*>(obj)); break;
+
+        default:
+            break;
+        }
+    }
+
+    //
+    // Encoding
+    //
+
+    // Unsigned integers are written as a sequence of 7-bit groups,
+    // low bits first, with the high bit of each byte set if more
+    // bytes follow. Most of what we write (object and string indices,
+    // enum values, offsets into a file) fit in one or two bytes.
+    static void writeUInt(List<unsigned char>& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.Add((unsigned char)(value | 0x80));
+            value >>= 7;
+        }
+        out.Add((unsigned char)value);
+    }
+
+    // Signed integers are "zig-zag" encoded first, so that small
+    // negative values are small too.
+    static void writeInt(List<unsigned char>& out, int64_t value)
+    {
+        writeUInt(out, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+    }
+
+    struct BlobCursor
+    {
+        unsigned char const*    data = nullptr;
+        UInt                    size = 0;
+        UInt                    offset = 0;
+        bool                    error = false;
+
+        uint64_t readUInt()
+        {
+            uint64_t value = 0;
+            int shift = 0;
+            for (;;)
+            {
+                if (offset >= size || shift >= 64)
+                {
+                    error = true;
+                    return 0;
+                }
+                unsigned char byte = data[offset++];
+                value |= uint64_t(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    return value;
+                shift += 7;
+            }
+        }
+
+        int64_t readInt()
+        {
+            uint64_t value = readUInt();
+            return int64_t(value >> 1) ^ -int64_t(value & 1);
+        }
+
+        void readBytes(void* dest, UInt count)
+        {
+            if (count > size - offset)
+            {
+                error = true;
+                memset(dest, 0, count);
+                return;
+            }
+            memcpy(dest, data + offset, count);
+            offset += count;
+        }
+
+        void skip(UInt count)
+        {
+            if (count > size - offset)
+            {
+                error = true;
+                offset = size;
+                return;
+            }
+            offset += count;
+        }
+    };
+
+    //
+    // Writing
+    //
+
+    struct ModuleWriteContext
+    {
+        struct ModuleInfo
+        {
+            List<UInt>          dependencies;
+            UInt                firstObject = 0;
+            UInt                objectCount = 0;
+            UInt                rootObject = 0;
+            List<unsigned char> data;
+        };
+
+        // Index given to objects that aren't part of any module
+        static const UInt kNoModule = ~UInt(0);
+
+        SourceManager*  sourceManager = nullptr;
+
+        // Set if we ran into anything we can't save
+        bool            failed = false;
+
+        Dictionary<String, UInt>        stringIndices;
+        List<String>                    strings;
+
+        Dictionary<SourceFile*, UInt>   fileIndices;
+        List<SourceFile*>               files;
+
+        // Index of each object we've seen, including externals
+        Dictionary<RefObject*, UInt>    objectIndices;
+
+        // The objects written as part of modules, with their
+        // class tag and the module they were written into.
+        // (Object index N is at entry `N - firstModuleObject`)
+        List<RefObject*>                objects;
+        List<SerializedObjectTag>            objectTags;
+        List<UInt>                      objectModules;
+        UInt                            firstModuleObject = 1;
+
+        List<ModuleInfo>                modules;
+
+        // The module we are currently writing
+        UInt                            currentModule = kNoModule;
+        List<unsigned char>*            out = nullptr;
+
+        void addExternalObject(RefObject* obj)
+        {
+            objectIndices[obj] = firstModuleObject++;
+        }
+
+        UInt getStringIndex(String const& str)
+        {
+            UInt index = 0;
+            if (stringIndices.TryGetValue(str, index))
+                return index;
+
+            index = strings.Count();
+            strings.Add(str);
+            stringIndices.Add(str, index);
+            return index;
+        }
+
+        UInt getFileIndex(SourceFile* file)
+        {
+            UInt index = 0;
+            if (fileIndices.TryGetValue(file, index))
+                return index;
+
+            index = files.Count();
+            files.Add(file);
+            fileIndices.Add(file, index);
+
+            // Make sure the strings for the file are in the table
+            getStringIndex(file->path);
+            getStringIndex(file->content);
+            for (auto& directive : file->getLineDirectives())
+                getStringIndex(directive.path);
+
+            return index;
+        }
+
+        template<typename T>
+        UInt getObjectIndex(T* obj)
+        {
+            RefObject* key = obj;
+
+            UInt index = 0;
+            if (!objectIndices.TryGetValue(key, index))
+            {
+                // First time we've seen this object, so it
+                // becomes part of the current module.
+                SerializedObjectTag tag = getSerializedObjectTag(obj);
+                if (!canCreateSyntaxObject(tag))
+                    failed = true;
+
+                index = firstModuleObject + objects.Count();
+                objects.Add(key);
+                objectTags.Add(tag);
+                objectModules.Add(currentModule);
+                objectIndices.Add(key, index);
+                return index;
+            }
+
+            // Referring to an object from an earlier module
+            // means that module must be loaded before this one.
+            if (index >= firstModuleObject)
+            {
+                UInt module = objectModules[index - firstModuleObject];
+                if (module != currentModule)
+                {
+                    auto& dependencies = modules[currentModule].dependencies;
+                    if (dependencies.IndexOf(module) == UInt(-1))
+                        dependencies.Add(module);
+                }
+            }
+            return index;
+        }
+
+        void writeModule(ProgramSyntaxNode* moduleDecl)
+        {
+            currentModule = modules.Count();
+            modules.Add(ModuleInfo());
+            auto& module = modules.Last();
+            out = &module.data;
+
+            module.firstObject = firstModuleObject + objects.Count();
+            module.rootObject = getObjectIndex(moduleDecl);
+
+            // Writing the fields of one object will discover any
+            // new objects it refers to, and add them to the end
+            // of the list, so we keep going until we catch up.
+            for (UInt ii = module.firstObject - firstModuleObject; ii < objects.Count(); ++ii)
+            {
+                serializeObject(*this, objectTags[ii], objects[ii]);
+            }
+            module.objectCount = firstModuleObject + objects.Count() - module.firstObject;
+
+            out = nullptr;
+            currentModule = kNoModule;
+        }
+
+        void writeBlob(List<unsigned char>& blob)
+        {
+            writeUInt(blob, kSerializedSyntaxMagic);
+            writeUInt(blob, kSerializedSyntaxVersion);
+
+            writeUInt(blob, firstModuleObject - 1);
+
+            writeUInt(blob, strings.Count());
+            for (auto& str : strings)
+            {
+                writeUInt(blob, str.Length());
+                blob.AddRange((unsigned char const*)str.Buffer(), str.Length());
+            }
+
+            writeUInt(blob, files.Count());
+            for (auto file : files)
+            {
+                writeUInt(blob, getStringIndex(file->path));
+                writeUInt(blob, getStringIndex(file->content));
+
+                auto& directives = file->getLineDirectives();
+                writeUInt(blob, directives.Count());
+                for (auto& directive : directives)
+                {
+                    writeUInt(blob, directive.loc.getRaw() - file->sourceRange.begin.getRaw());
+                    writeUInt(blob, getStringIndex(directive.path));
+                    writeInt(blob, directive.lineAdjust);
+                }
+            }
+
+            writeUInt(blob, modules.Count());
+            for (auto& module : modules)
+            {
+                writeUInt(blob, module.dependencies.Count());
+                for (auto dependency : module.dependencies)
+                    writeUInt(blob, dependency);
+
+                writeUInt(blob, module.objectCount);
+                writeUInt(blob, module.rootObject);
+
+                for (UInt ii = 0; ii < module.objectCount; ++ii)
+                    writeUInt(blob, (UInt)objectTags[module.firstObject - firstModuleObject + ii]);
+
+                writeUInt(blob, module.data.Count());
+                blob.AddRange(module.data);
+            }
+        }
+
+        // Field types
+
+        void io(bool& value)        { writeUInt(*out, value ? 1 : 0); }
+        void io(int& value)         { writeInt(*out, value); }
+        void io(unsigned int& value){ writeUInt(*out, value); }
+        void io(uint16_t& value)    { writeUInt(*out, value); }
+        void io(long long& value)   { writeInt(*out, value); }
+
+        void io(double& value)
+        {
+            unsigned char bytes[sizeof(double)];
+            memcpy(bytes, &value, sizeof(double));
+            out->AddRange(bytes, sizeof(double));
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_enum<T>::value>::type io(T& value)
+        {
+            writeInt(*out, (int64_t)value);
+        }
+
+        void io(String& value)
+        {
+            writeUInt(*out, getStringIndex(value));
+        }
+
+        void io(Name*& name)
+        {
+            writeUInt(*out, name ? getStringIndex(name->text) + 1 : 0);
+        }
+
+        void io(SourceLoc& loc)
+        {
+            SourceFile* file = loc.isValid() ? sourceManager->findSourceFile(loc) : nullptr;
+            if (!file)
+            {
+                writeUInt(*out, 0);
+                return;
+            }
+
+            writeUInt(*out, getFileIndex(file) + 1);
+            writeUInt(*out, loc.getRaw() - file->sourceRange.begin.getRaw());
+        }
+
+        void io(Token& token)
+        {
+            writeUInt(*out, (UInt)token.Type);
+            io(token.Position);
+            writeUInt(*out, token.flags);
+
+            // Identifiers just store their name, since the
+            // content of the token is the same text.
+            Name* name = token.getName();
+            io(name);
+            if (!name)
+            {
+                writeUInt(*out, getStringIndex(String(token.getContent())));
+            }
+        }
+
+        template<typename T>
+        void io(RefPtr<T>& ptr)
+        {
+            T* obj = ptr.Ptr();
+            io(obj);
+        }
+
+        template<typename T>
+        void io(T*& obj)
+        {
+            writeUInt(*out, obj ? getObjectIndex(obj) : 0);
+        }
+
+        template<typename T>
+        void io(List<T>& list)
+        {
+            writeUInt(*out, list.Count());
+            for (auto& item : list)
+                io(item);
+        }
+
+        void io(Modifiers& modifiers)
+        {
+            io(modifiers.first);
+        }
+
+        void io(QualType& type)
+        {
+            io(type.type);
+            io(type.IsLeftValue);
+        }
+
+        void io(TypeExp& typeExp)
+        {
+            io(typeExp.exp);
+            io(typeExp.type);
+        }
+
+        void io(DeclRefBase& declRef)
+        {
+            io(declRef.decl);
+            io(declRef.substitutions);
+        }
+
+        template<typename T>
+        void io(DeclRef<T>& declRef)
+        {
+            io((DeclRefBase&)declRef);
+        }
+
+        // The results of lookup are only held onto while checking,
+        // and layouts are only attached to the output of lowering,
+        // so we don't expect to ever see either in checked code.
+
+        void io(LookupResult& result)
+        {
+            if (result.isValid() || result.items.Count())
+                failed = true;
+        }
+
+        void io(RefPtr<Layout>& layout)
+        {
+            if (layout)
+                failed = true;
+        }
+    };
+
+    bool serializeModules(
+        List<RefPtr<ProgramSyntaxNode>> const&  modules,
+        List<RefObject*> const&                 externalObjects,
+        SourceManager*                          sourceManager,
+        List<unsigned char>&                    outBlob)
+    {
+        outBlob.Clear();
+
+        ModuleWriteContext context;
+        context.sourceManager = sourceManager;
+
+        for (auto obj : externalObjects)
+            context.addExternalObject(obj);
+
+        for (auto& moduleDecl : modules)
+            context.writeModule(moduleDecl.Ptr());
+
+        if (context.failed)
+            return false;
+
+        context.writeBlob(outBlob);
+        return true;
+    }
+
+    void collectModuleObjects(
+        List<RefPtr<ProgramSyntaxNode>> const&  modules,
+        List<RefObject*> const&                 externalObjects,
+        SourceManager*                          sourceManager,
+        List<RefObject*>&                       outObjects)
+    {
+        ModuleWriteContext context;
+        context.sourceManager = sourceManager;
+
+        for (auto obj : externalObjects)
+            context.addExternalObject(obj);
+
+        for (auto& moduleDecl : modules)
+            context.writeModule(moduleDecl.Ptr());
+
+        outObjects.AddRange(context.objects);
+    }
+
+    //
+    // Reading
+    //
+
+    struct ModuleReadContext
+    {
+        SerializedModuleReader* reader;
+        BlobCursor              cursor;
+
+        RefObject* readObject()
+        {
+            UInt index = (UInt)cursor.readUInt();
+            if (index >= reader->objects.Count())
+            {
+                cursor.error = true;
+                return nullptr;
+            }
+            return reader->objects[index].Ptr();
+        }
+
+        // Field types
+
+        void io(bool& value)        { value = cursor.readUInt() != 0; }
+        void io(int& value)         { value = (int)cursor.readInt(); }
+        void io(unsigned int& value){ value = (unsigned int)cursor.readUInt(); }
+        void io(uint16_t& value)    { value = (uint16_t)cursor.readUInt(); }
+        void io(long long& value)   { value = (long long)cursor.readInt(); }
+
+        void io(double& value)
+        {
+            cursor.readBytes(&value, sizeof(double));
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_enum<T>::value>::type io(T& value)
+        {
+            value = (T)cursor.readInt();
+        }
+
+        void io(String& value)
+        {
+            value = reader->getString((UInt)cursor.readUInt());
+        }
+
+        void io(Name*& name)
+        {
+            UInt index = (UInt)cursor.readUInt();
+            name = index ? reader->getName(index - 1) : nullptr;
+        }
+
+        void io(SourceLoc& loc)
+        {
+            UInt fileIndex = (UInt)cursor.readUInt();
+            if (!fileIndex)
+            {
+                loc = SourceLoc();
+                return;
+            }
+
+            UInt offset = (UInt)cursor.readUInt();
+            SourceFile* file = reader->getSourceFile(fileIndex - 1);
+            if (!file)
+            {
+                cursor.error = true;
+                return;
+            }
+            // A file that the session had no locations left
+            // for doesn't give its syntax any locations.
+            if (file->sourceRange.begin.isValid())
+                loc = file->sourceRange.begin + offset;
+            else
+                loc = SourceLoc();
+        }
+
+        void io(Token& token)
+        {
+            token.Type = (TokenType)cursor.readUInt();
+            io(token.Position);
+            token.flags = (TokenFlags)cursor.readUInt();
+
+            Name* name = nullptr;
+            io(name);
+            if (name)
+            {
+                token.setName(name);
+            }
+            else
+            {
+                token.setContent(allocateSyntaxText(reader->getString((UInt)cursor.readUInt()).getUnownedSlice()));
+            }
+        }
+
+        template<typename T>
+        void io(RefPtr<T>& ptr)
+        {
+            ptr = static_cast<T*>(readObject());
+        }
+
+        template<typename T>
+        void io(T*& obj)
+        {
+            obj = static_cast<T*>(readObject());
+        }
+
+        template<typename T>
+        void io(List<T>& list)
+        {
+            UInt count = (UInt)cursor.readUInt();
+            if (count > cursor.size - cursor.offset)
+            {
+                // Every item takes at least a byte
+                cursor.error = true;
+                return;
+            }
+
+            list.SetSize(count);
+            for (auto& item : list)
+                io(item);
+        }
+
+        void io(Modifiers& modifiers)
+        {
+            io(modifiers.first);
+        }
+
+        void io(QualType& type)
+        {
+            io(type.type);
+            io(type.IsLeftValue);
+        }
+
+        void io(TypeExp& typeExp)
+        {
+            io(typeExp.exp);
+            io(typeExp.type);
+        }
+
+        void io(DeclRefBase& declRef)
+        {
+            io(declRef.decl);
+            io(declRef.substitutions);
+        }
+
+        template<typename T>
+        void io(DeclRef<T>& declRef)
+        {
+            io((DeclRefBase&)declRef);
+        }
+
+        void io(LookupResult&)
+        {}
+
+        void io(RefPtr<Layout>&)
+        {}
+    };
+
+    SerializedModuleReader::SerializedModuleReader(
+        unsigned char const*    data,
+        UInt                    size,
+        List<RefObject*> const& externalObjects,
+        SourceManager*          sourceManager,
+        NamePool*               namePool)
+        : data(data)
+        , size(size)
+        , sourceManager(sourceManager)
+        , namePool(namePool)
+    {
+        valid = readHeader();
+        if (!valid)
+            return;
+
+        if (externalObjects.Count() != externalObjectCount)
+        {
+            valid = false;
+            return;
+        }
+
+        for (UInt ii = 0; ii < externalObjectCount; ++ii)
+            objects[ii + 1] = externalObjects[ii];
+    }
+
+    bool SerializedModuleReader::readHeader()
+    {
+        BlobCursor cursor;
+        cursor.data = data;
+        cursor.size = size;
+
+        if (cursor.readUInt() != kSerializedSyntaxMagic)
+            return false;
+        if (cursor.readUInt() != kSerializedSyntaxVersion)
+            return false;
+
+        externalObjectCount = (UInt)cursor.readUInt();
+
+        // We just note where each string is for now, and only
+        // create the strings that actually get used.
+        UInt stringCount = (UInt)cursor.readUInt();
+        if (stringCount > size)
+            return false;
+        for (UInt ii = 0; ii < stringCount && !cursor.error; ++ii)
+        {
+            stringOffsets.Add(cursor.offset);
+            cursor.skip((UInt)cursor.readUInt());
+        }
+        strings.SetSize(stringCount);
+        stringLoaded.SetSize(stringCount);
+        names.SetSize(stringCount);
+        for (UInt ii = 0; ii < stringCount; ++ii)
+        {
+            stringLoaded[ii] = false;
+            names[ii] = nullptr;
+        }
+
+        UInt fileCount = (UInt)cursor.readUInt();
+        if (fileCount > size)
+            return false;
+        for (UInt ii = 0; ii < fileCount && !cursor.error; ++ii)
+        {
+            FileInfo file;
+            file.pathIndex = (UInt)cursor.readUInt();
+            file.contentIndex = (UInt)cursor.readUInt();
+            file.directivesOffset = cursor.offset;
+
+            UInt directiveCount = (UInt)cursor.readUInt();
+            for (UInt dd = 0; dd < directiveCount && !cursor.error; ++dd)
+            {
+                cursor.readUInt();
+                cursor.readUInt();
+                cursor.readInt();
+            }
+
+            if (file.pathIndex >= stringCount || file.contentIndex >= stringCount)
+                return false;
+            files.Add(file);
+        }
+
+        UInt objectCount = 1 + externalObjectCount;
+        UInt moduleCount = (UInt)cursor.readUInt();
+        if (moduleCount > size)
+            return false;
+        for (UInt ii = 0; ii < moduleCount && !cursor.error; ++ii)
+        {
+            ModuleInfo module;
+
+            UInt dependencyCount = (UInt)cursor.readUInt();
+            for (UInt dd = 0; dd < dependencyCount && !cursor.error; ++dd)
+            {
+                UInt dependency = (UInt)cursor.readUInt();
+                if (dependency >= ii)
+                    return false;
+                module.dependencies.Add(dependency);
+            }
+
+            module.firstObject = objectCount;
+            module.objectCount = (UInt)cursor.readUInt();
+            module.rootObject = (UInt)cursor.readUInt();
+            objectCount += module.objectCount;
+
+            if (module.rootObject < module.firstObject || module.rootObject >= objectCount)
+                return false;
+
+            module.tagsOffset = cursor.offset;
+            for (UInt oo = 0; oo < module.objectCount && !cursor.error; ++oo)
+                cursor.readUInt();
+
+            UInt dataSize = (UInt)cursor.readUInt();
+            module.dataOffset = cursor.offset;
+            cursor.skip(dataSize);
+
+            modules.Add(module);
+        }
+
+        if (cursor.error)
+            return false;
+
+        objects.SetSize(objectCount);
+        return true;
+    }
+
+    String SerializedModuleReader::getString(UInt index)
+    {
+        if (index >= strings.Count())
+        {
+            valid = false;
+            return String();
+        }
+
+        if (!stringLoaded[index])
+        {
+            BlobCursor cursor;
+            cursor.data = data;
+            cursor.size = size;
+            cursor.offset = stringOffsets[index];
+
+            UInt length = (UInt)cursor.readUInt();
+            char const* text = (char const*)data + cursor.offset;
+            strings[index] = String(text, text + length);
+            stringLoaded[index] = true;
+        }
+        return strings[index];
+    }
+
+    Name* SerializedModuleReader::getName(UInt index)
+    {
+        if (index >= names.Count())
+        {
+            valid = false;
+            return nullptr;
+        }
+
+        if (!names[index])
+            names[index] = namePool->getName(getString(index));
+        return names[index];
+    }
+
+    SourceFile* SerializedModuleReader::getSourceFile(UInt index)
+    {
+        if (index >= files.Count())
+            return nullptr;
+
+        auto& file = files[index];
+        if (!file.sourceFile)
+        {
+            file.sourceFile = sourceManager->allocateSourceFile(
+                getString(file.pathIndex),
+                getString(file.contentIndex),
+                nullptr);
+
+            BlobCursor cursor;
+            cursor.data = data;
+            cursor.size = size;
+            cursor.offset = file.directivesOffset;
+
+            UInt directiveCount = (UInt)cursor.readUInt();
+            for (UInt ii = 0; ii < directiveCount; ++ii)
+            {
+                SourceFile::LineDirective directive;
+                directive.loc = file.sourceFile->sourceRange.begin + (UInt)cursor.readUInt();
+                directive.path = getString((UInt)cursor.readUInt());
+                directive.lineAdjust = (int)cursor.readInt();
+                file.sourceFile->addLineDirective(directive);
+            }
+        }
+        return file.sourceFile.Ptr();
+    }
+
+    ProgramSyntaxNode* SerializedModuleReader::loadModule(UInt index)
+    {
+        if (!valid || index >= modules.Count())
+            return nullptr;
+
+        auto& module = modules[index];
+        if (!module.loaded)
+        {
+            for (auto dependency : module.dependencies)
+            {
+                if (!loadModule(dependency))
+                    return nullptr;
+            }
+
+            ModuleReadContext context;
+            context.reader = this;
+            context.cursor.data = data;
+            context.cursor.size = size;
+
+            // Create all of the objects up front, so that
+            // references between them can be filled in as
+            // we read their fields.
+            List<SerializedObjectTag> tags;
+            context.cursor.offset = module.tagsOffset;
+            for (UInt ii = 0; ii < module.objectCount; ++ii)
+            {
+                auto tag = (SerializedObjectTag)context.cursor.readUInt();
+                RefObject* obj = createSyntaxObject(tag);
+                if (!obj)
+                {
+                    valid = false;
+                    return nullptr;
+                }
+
+                tags.Add(tag);
+                objects[module.firstObject + ii] = obj;
+            }
+
+            context.cursor.offset = module.dataOffset;
+            for (UInt ii = 0; ii < module.objectCount; ++ii)
+            {
+                serializeObject(context, tags[ii], objects[module.firstObject + ii].Ptr());
+            }
+
+            // The modifier class sets aren't serialized, so rebuild them
+            // now that all of the modifier lists are linked up.
+            for (UInt ii = 0; ii < module.objectCount; ++ii)
+            {
+                if (tags[ii] == SerializedObjectTag::Scope)
+                    continue;
+                auto obj = static_cast<SyntaxObject*>(objects[module.firstObject + ii].Ptr());
+                if (auto modifiable = dynamicCast<ModifiableSyntaxNode>(obj))
+                    modifiable->modifiers.updateClasses();
+            }
+
+            if (context.cursor.error || !valid)
+            {
+                valid = false;
+                return nullptr;
+            }
+
+            module.loaded = true;
+        }
+
+        return static_cast<ProgramSyntaxNode*>(objects[module.rootObject].Ptr());
+    }
+}
@@ -0,0 +1,141 @@
+// syntax-serialize.h
+#ifndef SLANG_SYNTAX_SERIALIZE_H_INCLUDED
+#define SLANG_SYNTAX_SERIALIZE_H_INCLUDED
+
+// This file provides a compact binary form for checked syntax,
+// so that code we compile over and over (the standard library)
+// can be loaded into a new session without being preprocessed,
+// parsed, or checked again.
+//
+// A serialized blob holds a sequence of modules. A module may refer
+// to declarations (and other objects) from modules that come before
+// it in the blob, and loading a module will also load any modules
+// it refers to.
+//
+// The reading and writing code is generated from the same
+// `syntax-defs.h` metadata used to declare the syntax classes,
+// so fields added there are picked up automatically. State that
+// is declared with `RAW(...)` needs to be handled explicitly
+// in `syntax-serialize.cpp`.
+
+#include "syntax.h"
+
+namespace Slang
+{
+    class NamePool;
+
+    // Write `modules` (in order) into `outBlob`.
+    //
+    // The `externalObjects` are owned by whatever loads the blob
+    // (e.g., the language scopes of a session), so references to
+    // them are written as references, and a reader must supply
+    // equivalent objects in the same order.
+    //
+    // Returns `false` if the modules contain something that can't
+    // be serialized, in which case `outBlob` is left empty.
+    bool serializeModules(
+        List<RefPtr<ProgramSyntaxNode>> const&  modules,
+        List<RefObject*> const&                 externalObjects,
+        SourceManager*                          sourceManager,
+        List<unsigned char>&                    outBlob);
+
+    // Append the objects that `serializeModules()` would write for
+    // `modules` to `outObjects`, in the order it would write them.
+    // Code that refers to the modules can then be serialized with
+    // these as its external objects, rather than with copies of them.
+    void collectModuleObjects(
+        List<RefPtr<ProgramSyntaxNode>> const&  modules,
+        List<RefObject*> const&                 externalObjects,
+        SourceManager*                          sourceManager,
+        List<RefObject*>&                       outObjects);
+
+    // Loads the modules in a serialized blob, on demand.
+    //
+    // Any syntax objects get allocated from the current
+    // `SyntaxArenaScope`, and source files are added to the
+    // given `SourceManager` when a location in them is first
+    // loaded. The blob itself must stay alive (and unchanged)
+    // for as long as the reader is in use.
+    class SerializedModuleReader : public RefObject
+    {
+    public:
+        SerializedModuleReader(
+            unsigned char const*    data,
+            UInt                    size,
+            List<RefObject*> const& externalObjects,
+            SourceManager*          sourceManager,
+            NamePool*               namePool);
+
+        // Did the blob look like something we can load?
+        bool isValid() { return valid; }
+
+        UInt getModuleCount() { return modules.Count(); }
+
+        // Load module `index`, along with any modules it depends
+        // on that haven't been loaded yet. Returns null if the
+        // module couldn't be loaded.
+        ProgramSyntaxNode* loadModule(UInt index);
+
+    private:
+        friend struct ModuleReadContext;
+
+        struct FileInfo
+        {
+            UInt        pathIndex;
+            UInt        contentIndex;
+
+            // Offset of the list of `#line` directives for the file
+            UInt        directivesOffset;
+
+            // The file in our source manager, once it has been created
+            RefPtr<SourceFile> sourceFile;
+        };
+
+        struct ModuleInfo
+        {
+            List<UInt>  dependencies;
+            UInt        firstObject;
+            UInt        objectCount;
+            UInt        rootObject;
+
+            // Offsets of the object class tags and field data
+            UInt        tagsOffset;
+            UInt        dataOffset;
+
+            bool        loaded = false;
+        };
+
+        bool readHeader();
+
+        String getString(UInt index);
+        Name* getName(UInt index);
+        SourceFile* getSourceFile(UInt index);
+
+        unsigned char const*    data;
+        UInt                    size;
+
+        SourceManager*          sourceManager;
+        NamePool*               namePool;
+
+        bool                    valid = false;
+
+        UInt                    externalObjectCount = 0;
+
+        // Offset of each entry in the string table, along with
+        // the `String` and `Name` for it once we've needed them.
+        List<UInt>              stringOffsets;
+        List<String>            strings;
+        List<bool>              stringLoaded;
+        List<Name*>             names;
+
+        List<FileInfo>          files;
+        List<ModuleInfo>        modules;
+
+        // Every object we've loaded, indexed the same way as in the
+        // blob: zero is null, then the external objects, then the
+        // objects of each module in order.
+        List<RefPtr<RefObject>> objects;
+    };
+}
+
+#endif
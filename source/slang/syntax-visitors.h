@@ -26,7 +26,7 @@ namespace Slang
     RefPtr<ProgramSyntaxNode> findOrImportModule(
         CompileRequest*     request,
         String const&       name,
-        CodePosition const& loc);
+        SourceLoc const&    loc);
 }
 
 #endif
\ No newline at end of file
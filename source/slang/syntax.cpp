@@ -3,15 +3,522 @@
 #include "visitor.h"
 
 #include <typeinfo>
+#include <type_traits>
 #include <assert.h>
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
 namespace Slang
 {
+    // SyntaxArena
+
+    // The arena that syntax objects created on this thread come from
+    static thread_local SyntaxArena* gCurrentSyntaxArena = nullptr;
+
+    SyntaxArenaScope::SyntaxArenaScope(SyntaxArena* arena)
+        : savedArena(gCurrentSyntaxArena)
+        , sharedScope(arena && arena->isShared)
+    {
+        gCurrentSyntaxArena = arena;
+    }
+
+    SyntaxArenaScope::~SyntaxArenaScope()
+    {
+        gCurrentSyntaxArena = savedArena;
+    }
+
+    // Chunks are aligned to their size, so that we can find the header of
+    // the chunk an object is in (and so its arena) from the address of
+    // the object alone. An allocation that is too large to share a chunk
+    // gets a chunk of its own, which starts with the allocation.
+    static const size_t kSyntaxArenaChunkSize = 64 * 1024;
+    static const size_t kSyntaxArenaAlignment = sizeof(void*) * 2;
+
+    // An object that needs to be destroyed when its arena is freed
+    // is allocated right after one of these, in the same chunk.
+    struct SyntaxObjectDestructorLink
+    {
+        SyntaxObjectDestructorLink* next;
+        SyntaxObject*               object;
+    };
+    static const size_t kSyntaxObjectDestructorLinkSize = kSyntaxArenaAlignment;
+    static_assert(sizeof(SyntaxObjectDestructorLink) <= kSyntaxObjectDestructorLinkSize, "link too large");
+
+    struct SyntaxArenaChunk
+    {
+        SyntaxArena*                arena;
+        SyntaxArenaChunk*           next;
+
+        // The objects in the chunk that need to be destroyed, most recent
+        // first. Only the thread that allocates from the chunk adds to this.
+        SyntaxObjectDestructorLink* destructors;
+    };
+    static const size_t kSyntaxArenaChunkHeaderSize =
+        (sizeof(SyntaxArenaChunk) + kSyntaxArenaAlignment - 1) & ~(kSyntaxArenaAlignment - 1);
+
+    static SyntaxArenaChunk* getSyntaxArenaChunk(void* ptr)
+    {
+        return (SyntaxArenaChunk*)(UInt(ptr) & ~UInt(kSyntaxArenaChunkSize - 1));
+    }
+
+    static char* alignPointer(char* ptr, size_t alignment)
+    {
+        return (char*)((UInt(ptr) + (alignment - 1)) & ~UInt(alignment - 1));
+    }
+
+    static void* allocateChunkMemory(size_t size)
+    {
+#ifdef _WIN32
+        return _aligned_malloc(size, kSyntaxArenaChunkSize);
+#else
+        void* memory = nullptr;
+        if (posix_memalign(&memory, kSyntaxArenaChunkSize, size) != 0)
+            return nullptr;
+        return memory;
+#endif
+    }
+
+    static void freeChunkMemory(void* memory)
+    {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        free(memory);
+#endif
+    }
+
+    // The chunks that the current thread allocates from, for the arenas
+    // it has used most recently. A thread usually works with only a few
+    // arenas at once: those of its request, the session, and any modules
+    // the request imports.
+    struct SyntaxArenaThreadChunk
+    {
+        uint64_t    arenaID = 0;
+        char*       cursor = nullptr;
+        char*       end = nullptr;
+    };
+    static const int kSyntaxArenaThreadChunkCount = 8;
+    static thread_local SyntaxArenaThreadChunk gThreadChunks[kSyntaxArenaThreadChunkCount];
+    static thread_local int gNextThreadChunkToReplace = 0;
+
+    static std::atomic<uint64_t> gNextSyntaxArenaID(1);
+
+    SyntaxArena::SyntaxArena()
+        : id(gNextSyntaxArenaID.fetch_add(1, std::memory_order_relaxed))
+    {
+        // Other threads hold references to arenas that their
+        // syntax refers to, or that interned types are in.
+        markShared();
+    }
+
+    SyntaxArena::~SyntaxArena()
+    {
+        // Objects are destroyed before any memory is freed,
+        // since they may still refer to one another.
+        for (auto chunk = chunks; chunk; chunk = chunk->next)
+        {
+            for (auto link = chunk->destructors; link; link = link->next)
+            {
+                if (link->object)
+                    link->object->~SyntaxObject();
+            }
+        }
+
+        auto chunk = chunks;
+        while (chunk)
+        {
+            auto next = chunk->next;
+            freeChunkMemory(chunk);
+            chunk = next;
+        }
+    }
+
+    void* SyntaxArena::allocate(size_t size, size_t alignment)
+    {
+        for (auto& threadChunk : gThreadChunks)
+        {
+            if (threadChunk.arenaID != id)
+                continue;
+
+            char* result = alignPointer(threadChunk.cursor, alignment);
+            if (result + size <= threadChunk.end)
+            {
+                threadChunk.cursor = result + size;
+                return result;
+            }
+            break;
+        }
+        return allocateSlow(size, alignment);
+    }
+
+    void* SyntaxArena::allocateSlow(size_t size, size_t alignment)
+    {
+        // A large allocation gets a chunk all to itself, and the thread
+        // keeps bumping through its current chunk afterwards, so that
+        // we don't waste the space left in it.
+        size_t paddedSize = kSyntaxArenaChunkHeaderSize + size + alignment;
+        if (paddedSize > kSyntaxArenaChunkSize / 4)
+        {
+            auto chunk = allocateChunk(paddedSize);
+            return alignPointer((char*)chunk + kSyntaxArenaChunkHeaderSize, alignment);
+        }
+
+        // Otherwise the thread starts a new chunk, in place of its
+        // current one for this arena, or of the one for the arena
+        // it used longest ago. Whatever was left in that is wasted.
+        SyntaxArenaThreadChunk* threadChunk = nullptr;
+        for (auto& candidate : gThreadChunks)
+        {
+            if (candidate.arenaID == id)
+            {
+                threadChunk = &candidate;
+                break;
+            }
+        }
+        if (!threadChunk)
+        {
+            threadChunk = &gThreadChunks[gNextThreadChunkToReplace];
+            gNextThreadChunkToReplace = (gNextThreadChunkToReplace + 1) % kSyntaxArenaThreadChunkCount;
+        }
+
+        auto chunk = allocateChunk(kSyntaxArenaChunkSize);
+        threadChunk->arenaID = id;
+        threadChunk->cursor = (char*)chunk + kSyntaxArenaChunkHeaderSize;
+        threadChunk->end = (char*)chunk + kSyntaxArenaChunkSize;
+
+        return allocate(size, alignment);
+    }
+
+    SyntaxArenaChunk* SyntaxArena::allocateChunk(size_t size)
+    {
+        auto chunk = (SyntaxArenaChunk*)allocateChunkMemory(size);
+        if (!chunk)
+            throw std::bad_alloc();
+
+        chunk->arena = this;
+        chunk->destructors = nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        chunk->next = chunks;
+        chunks = chunk;
+        return chunk;
+    }
+
+    static SyntaxArena* createGlobalSyntaxArena()
+    {
+        // The reference is never released
+        SyntaxArena* arena = new SyntaxArena();
+        arena->addReference();
+        return arena;
+    }
+
+    // Get the current arena, or if there is none, an arena that is
+    // shared by the whole process and never freed.
+    static SyntaxArena* getCurrentOrGlobalSyntaxArena()
+    {
+        if (auto arena = gCurrentSyntaxArena)
+            return arena;
+
+        static SyntaxArena* globalArena = createGlobalSyntaxArena();
+        return globalArena;
+    }
+
+    void* allocateSyntaxObject(size_t size, bool needsDestructor)
+    {
+        SyntaxArena* arena = getCurrentOrGlobalSyntaxArena();
+        if (!needsDestructor)
+            return arena->allocate(size, kSyntaxArenaAlignment);
+
+        auto link = (SyntaxObjectDestructorLink*)arena->allocate(
+            kSyntaxObjectDestructorLinkSize + size,
+            kSyntaxArenaAlignment);
+        void* object = (char*)link + kSyntaxObjectDestructorLinkSize;
+
+        // Each syntax class derives from just one base, so
+        // the object starts with its `SyntaxObject`.
+        link->object = (SyntaxObject*)object;
+
+        auto chunk = getSyntaxArenaChunk(link);
+        link->next = chunk->destructors;
+        chunk->destructors = link;
+
+        return object;
+    }
+
+    void freeSyntaxObject(void* ptr)
+    {
+        if (!ptr)
+            return;
+
+        // The object was one of the last allocated from its chunk,
+        // so if it has a link, it will be near the front.
+        auto chunk = getSyntaxArenaChunk(ptr);
+        for (auto link = chunk->destructors; link; link = link->next)
+        {
+            if (link->object == ptr)
+            {
+                link->object = nullptr;
+                break;
+            }
+        }
+    }
+
+    SyntaxArena* getSyntaxObjectArena(SyntaxObject* obj)
+    {
+        return getSyntaxArenaChunk(obj)->arena;
+    }
+
+    UnownedStringSlice allocateSyntaxText(UnownedStringSlice const& text)
+    {
+        UInt length = text.getLength();
+        if (!length)
+            return UnownedStringSlice();
+
+        SyntaxArena* arena = getCurrentOrGlobalSyntaxArena();
+        char* buffer = (char*)arena->allocate(length + 1, 1);
+        memcpy(buffer, text.begin(), length);
+        buffer[length] = 0;
+        return UnownedStringSlice(buffer, buffer + length);
+    }
+
+    void addSyntaxSourceFile(SourceFile* file)
+    {
+        if (!file)
+            return;
+
+        SyntaxArena* arena = getCurrentOrGlobalSyntaxArena();
+        std::lock_guard<std::mutex> lock(arena->mutex);
+        arena->sourceFiles[file] = file;
+    }
+
+    void addSyntaxArenaDependency(SyntaxArena* arena)
+    {
+        SyntaxArena* currentArena = getCurrentOrGlobalSyntaxArena();
+        if (!arena || arena == currentArena)
+            return;
+
+        std::lock_guard<std::mutex> lock(currentArena->mutex);
+        if (!currentArena->dependencies.Contains(arena))
+            currentArena->dependencies.Add(arena);
+    }
+
+    // Syntax class tags
+
+    SyntaxClassRange gSyntaxClassRanges[int(SyntaxClassTag::Count)];
+
+    // The tag of the base class for a syntax class, or
+    // `SyntaxClassTag::Count` for the roots of the hierarchy.
+    template<typename T>
+    static SyntaxClassTag getBaseSyntaxClassTag()
+    {
+        return T::kClassTag;
+    }
+
+    template<>
+    SyntaxClassTag getBaseSyntaxClassTag<SyntaxObject>()
+    {
+        return SyntaxClassTag::Count;
+    }
+
+    // Number `tag` and the classes derived from it, starting at `next`,
+    // and return the next unused number.
+    static uint16_t numberSyntaxClasses(
+        SyntaxClassTag const*   baseTags,
+        SyntaxClassTag          tag,
+        uint16_t                next)
+    {
+        SyntaxClassRange& range = gSyntaxClassRanges[int(tag)];
+        range.begin = next++;
+        for (int cc = 0; cc < int(SyntaxClassTag::Count); ++cc)
+        {
+            if (baseTags[cc] == tag)
+                next = numberSyntaxClasses(baseTags, SyntaxClassTag(cc), next);
+        }
+        range.end = next;
+        return next;
+    }
+
+    static struct SyntaxClassRangeInitializer
+    {
+        SyntaxClassRangeInitializer()
+        {
+            static const SyntaxClassTag baseTags[] =
+            {
+#define SYNTAX_CLASS(NAME, BASE, ...) getBaseSyntaxClassTag<BASE>(),
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+            };
+
+            uint16_t next = 0;
+            for (int cc = 0; cc < int(SyntaxClassTag::Count); ++cc)
+            {
+                if (baseTags[cc] == SyntaxClassTag::Count)
+                    next = numberSyntaxClasses(baseTags, SyntaxClassTag(cc), next);
+            }
+
+            // Every modifier class needs a bit in a `ModifierClassSet`
+            SyntaxClassRange modifierRange = gSyntaxClassRanges[int(SyntaxClassTag::Modifier)];
+            assert(modifierRange.end - modifierRange.begin <= ModifierClassSet::kWordCount * 64);
+            (void)modifierRange;
+        }
+    } gSyntaxClassRangeInitializer;
+
+    // Which syntax classes need destructors
+
+    // Is `T` a syntax class? (This needs to work for classes that
+    // are only declared, such as those in the `RefPtr`s of fields.)
+    template<typename T>
+    struct IsSyntaxClass
+    {
+        static const bool value = false;
+    };
+
+#define SYNTAX_CLASS(NAME, BASE, ...)                                   \
+    template<> struct IsSyntaxClass<NAME> { static const bool value = true; };
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+    // Does a field of type `T` need to be destroyed along with the
+    // object it is in? References to other syntax objects don't,
+    // since releasing them never frees anything (see `SyntaxObject`).
+    template<typename T>
+    struct SyntaxFieldNeedsDestructor
+    {
+        static const bool value = !std::is_trivially_destructible<T>::value;
+    };
+
+    template<typename T>
+    struct SyntaxFieldNeedsDestructor<RefPtr<T>>
+    {
+        static const bool value = !IsSyntaxClass<T>::value;
+    };
+
+    template<typename T>
+    struct SyntaxFieldNeedsDestructor<DeclRef<T>>
+    {
+        static const bool value = false;
+    };
+
+    template<>
+    struct SyntaxFieldNeedsDestructor<TypeExp>
+    {
+        static const bool value = false;
+    };
+
+    template<>
+    struct SyntaxFieldNeedsDestructor<QualType>
+    {
+        static const bool value = false;
+    };
+
+    template<>
+    struct SyntaxFieldNeedsDestructor<Modifiers>
+    {
+        static const bool value = false;
+    };
+
+    // A class needs destructors if its base class does,
+    // or if any of the fields it adds need them.
+    template<typename T>
+    struct SyntaxClassNeedsDestructor;
+
+    template<>
+    struct SyntaxClassNeedsDestructor<SyntaxObject>
+    {
+        static const bool value = false;
+    };
+
+#define SYNTAX_CLASS(NAME, BASE, ...)                                   \
+    template<> struct SyntaxClassNeedsDestructor<NAME>                  \
+    {                                                                   \
+        typedef NAME Class;                                             \
+        static const bool value = SyntaxClassNeedsDestructor<BASE>::value \
+            || NAME::kRawMembersNeedDestructor
+#define FIELD(TYPE, NAME) || SyntaxFieldNeedsDestructor<decltype(Class::NAME)>::value
+#define END_SYNTAX_CLASS() ; };
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+    const bool gSyntaxClassNeedsDestructor[int(SyntaxClassTag::Count)] =
+    {
+#define SYNTAX_CLASS(NAME, BASE, ...) SyntaxClassNeedsDestructor<NAME>::value,
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+    };
+
+    // ModifierClassSet
+
+    static UInt getModifierClassIndex(SyntaxClassTag tag)
+    {
+        return gSyntaxClassRanges[int(tag)].begin - gSyntaxClassRanges[int(SyntaxClassTag::Modifier)].begin;
+    }
+
+    void ModifierClassSet::add(SyntaxClassTag tag)
+    {
+        UInt index = getModifierClassIndex(tag);
+        words[index / 64] |= uint64_t(1) << (index % 64);
+    }
+
+    bool ModifierClassSet::containsDerivedFrom(SyntaxClassTag tag) const
+    {
+        // The classes derived from `tag` have the bits in `[begin, end)`
+        UInt begin = getModifierClassIndex(tag);
+        UInt end = begin + gSyntaxClassRanges[int(tag)].end - gSyntaxClassRanges[int(tag)].begin;
+        for (UInt ww = begin / 64; ww * 64 < end; ++ww)
+        {
+            uint64_t mask = ~uint64_t(0);
+            if (begin > ww * 64)
+                mask &= ~uint64_t(0) << (begin - ww * 64);
+            if (end < (ww + 1) * 64)
+                mask &= ~(~uint64_t(0) << (end - ww * 64));
+            if (words[ww] & mask)
+                return true;
+        }
+        return false;
+    }
+
+    // Modifiers
+
+    void Modifiers::add(Modifier* modifier)
+    {
+        RefPtr<Modifier>* link = &first;
+        while (*link)
+            link = &(*link)->next;
+        *link = modifier;
+
+        for (auto m = modifier; m; m = m->next.Ptr())
+            classes.add(m->getClassTag());
+    }
+
+    void Modifiers::prepend(Modifier* modifier)
+    {
+        modifier->next = first;
+        first = modifier;
+        classes.add(modifier->getClassTag());
+    }
+
+    void Modifiers::updateClasses()
+    {
+        classes = ModifierClassSet();
+        for (auto m = first.Ptr(); m; m = m->next.Ptr())
+            classes.add(m->getClassTag());
+    }
+
     // BasicExpressionType
 
     bool BasicExpressionType::EqualsImpl(ExpressionType * type)
     {
-        auto basicType = dynamic_cast<const BasicExpressionType*>(type);
+        auto basicType = dynamicCast<BasicExpressionType>(type);
         if (basicType == nullptr)
             return false;
         return basicType->BaseType == BaseType;
@@ -23,6 +530,14 @@ namespace Slang
         return this;
     }
 
+    bool BasicExpressionType::ComputeCanonicalHash(int* outHash)
+    {
+        // Basic types are equal when their `BaseType`s are,
+        // regardless of the declaration they refer to.
+        *outHash = (int)BaseType;
+        return true;
+    }
+
     Slang::String BasicExpressionType::ToString()
     {
         Slang::StringBuilder res;
@@ -102,7 +617,14 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
 
     bool ExpressionType::Equals(ExpressionType * type)
     {
-        return GetCanonicalType()->EqualsImpl(type->GetCanonicalType());
+        auto canType = GetCanonicalType();
+        auto otherCanType = type->GetCanonicalType();
+
+        // There is only one interned object for each distinct type
+        if (canType->internedIn && otherCanType->internedIn)
+            return canType == otherCanType;
+
+        return canType->EqualsImpl(otherCanType);
     }
 
     bool ExpressionType::Equals(RefPtr<ExpressionType> type)
@@ -112,14 +634,14 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
 
     bool ExpressionType::EqualsVal(Val* val)
     {
-        if (auto type = dynamic_cast<ExpressionType*>(val))
+        if (auto type = dynamicCast<ExpressionType>(val))
             return const_cast<ExpressionType*>(this)->Equals(type);
         return false;
     }
 
     NamedExpressionType* ExpressionType::AsNamedType()
     {
-        return dynamic_cast<NamedExpressionType*>(this);
+        return dynamicCast<NamedExpressionType>(this);
     }
 
     RefPtr<Val> ExpressionType::SubstituteImpl(Substitutions* subst, int* ioDiff)
@@ -142,13 +664,112 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
     {
         if (!this) return nullptr;
         ExpressionType* et = const_cast<ExpressionType*>(this);
-        if (!et->canonicalType)
+        if (auto canType = et->canonicalType.load(std::memory_order_acquire))
+            return canType;
+
+        // The canonical type is created in the same arena as this type.
+        // Otherwise a type that lives as long as the session (e.g., one
+        // from the standard library) would refer to a type in the arena
+        // of the request that first asked for its canonical type, which
+        // may be freed first. For the same reason, it can only use the
+        // current substitution cache if the type belongs to the current
+        // request.
+        ExpressionType* canType = nullptr;
+        {
+            SyntaxArena* arena = getSyntaxObjectArena(et);
+            SyntaxArenaScope arenaScope(arena);
+            SubstitutionCacheScope substitutionCacheScope(
+                arena == arenaScope.savedArena ? getSubstitutionCache() : nullptr);
+            canType = et->CreateCanonicalType();
+        }
+        assert(canType);
+
+        // A type that we got from another type's `GetCanonicalType()`
+        // is already final, but anything else needs to be interned.
+        if (!canType->canonicalType.load(std::memory_order_acquire))
+        {
+            int hash = 0;
+            ExpressionType* internedType = nullptr;
+            auto types = getSessionTypes();
+            if (types && canType->ComputeCanonicalHash(&hash))
+                internedType = types->internType(canType, hash);
+
+            if (internedType)
+                canType = internedType;
+            else if (canType != et)
+                canType->canonicalType.store(canType, std::memory_order_release);
+        }
+
+        if (canType == et)
+        {
+            et->canonicalType.store(et, std::memory_order_release);
+            return et;
+        }
+
+        // If another thread got here first, we use its result
+        ExpressionType* existing = nullptr;
+        if (!et->canonicalType.compare_exchange_strong(existing, canType, std::memory_order_acq_rel))
+            return existing;
+        return canType;
+    }
+
+    int ExpressionType::GetCanonicalHash()
+    {
+        auto canType = GetCanonicalType();
+        if (canType->internedIn)
+            return canType->canonicalHash;
+
+        int hash = 0;
+        if (!canType->ComputeCanonicalHash(&hash))
+            hash = PointerHash<1>::GetHashCode(canType);
+        return hash;
+    }
+
+    uint64_t ExpressionType::GetCanonicalTypeId()
+    {
+        auto canType = GetCanonicalType();
+        if (!canType->internedIn)
+            return 0;
+        return canType->internId;
+    }
+
+    bool ExpressionType::ComputeCanonicalHash(int* /*outHash*/)
+    {
+        return false;
+    }
+
+    ExpressionType::~ExpressionType()
+    {
+        if (internedIn)
+            internedIn->removeInternedType(this);
+    }
+
+    static int combineHash(int left, int right)
+    {
+        return (left * 16777619) ^ right;
+    }
+
+    // Hash a value in a way that agrees with `EqualsVal()`
+    static int getCanonicalHash(Val* val)
+    {
+        if (auto type = dynamicCast<ExpressionType>(val))
+            return type->GetCanonicalHash();
+        return val->GetHashCode();
+    }
+
+    // Hash a declaration reference in a way that agrees with `Equals()`.
+    // Unlike `GetHashCode()`, this is safe to use for substitutions
+    // with types like `typedef`s as arguments.
+    static int getCanonicalHash(DeclRefBase const& declRef)
+    {
+        int hash = PointerHash<1>::GetHashCode(declRef.decl);
+        for (auto subst = declRef.substitutions.Ptr(); subst; subst = subst->outer.Ptr())
         {
-            // TODO(tfoley): worry about thread safety here?
-            et->canonicalType = et->CreateCanonicalType();
-            assert(et->canonicalType);
+            hash = combineHash(hash, PointerHash<1>::GetHashCode(subst->genericDecl));
+            for (auto& arg : subst->args)
+                hash = combineHash(hash, getCanonicalHash(arg.Ptr()));
         }
-        return et->canonicalType;
+        return hash;
     }
 
     bool ExpressionType::IsTextureOrSampler()
@@ -164,38 +785,492 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         return true;
     }
 
-#if 0
-    RefPtr<ExpressionType> ExpressionType::Bool;
-    RefPtr<ExpressionType> ExpressionType::UInt;
-    RefPtr<ExpressionType> ExpressionType::Int;
-    RefPtr<ExpressionType> ExpressionType::Float;
-    RefPtr<ExpressionType> ExpressionType::Float2;
-    RefPtr<ExpressionType> ExpressionType::Void;
-#endif
-    RefPtr<ExpressionType> ExpressionType::Error;
-    RefPtr<ExpressionType> ExpressionType::initializerListType;
-    RefPtr<ExpressionType> ExpressionType::Overloaded;
+    // SessionTypes
 
-    Dictionary<int, RefPtr<ExpressionType>> ExpressionType::sBuiltinTypes;
-    Dictionary<String, Decl*> ExpressionType::sMagicDecls;
-    List<RefPtr<ExpressionType>> ExpressionType::sCanonicalTypes;
+    static thread_local SessionTypes* gCurrentSessionTypes = nullptr;
 
-    void ExpressionType::Init()
+    SessionTypes::SessionTypes()
     {
-        Error = new ErrorType();
+        errorType = new ErrorType();
         initializerListType = new InitializerListType();
-        Overloaded = new OverloadGroupType();
+        overloadedType = new OverloadGroupType();
+    }
+
+    SessionTypes::~SessionTypes()
+    {
+        // Any types that outlive the session can't remove themselves
+        std::lock_guard<std::mutex> lock(internMutex);
+        for (auto& entry : internedTypes)
+        {
+            for (auto type : entry.Value.types)
+                type->internedIn = nullptr;
+        }
+    }
+
+    ExpressionType* SessionTypes::internType(ExpressionType* type, int hash)
+    {
+        // The arena of the type that will refer to the interned type
+        SyntaxArena* typeArena = getSyntaxObjectArena(type);
+
+        // Set once we have looked for an arena that any code could
+        // use the interned type from, and made a copy there if needed
+        bool triedArenaCopy = false;
+        bool forAllArenas = false;
+
+        for (;;)
+        {
+            // Hold on to the arenas of the types with the same hash, so that
+            // the types can't go away while we compare them, skipping any
+            // whose arena is already being freed.
+            List<ExpressionType*> existingTypes;
+            List<RefPtr<SyntaxArena>> existingArenas;
+            UInt version = 0;
+            {
+                std::lock_guard<std::mutex> lock(internMutex);
+                if (auto bucket = internedTypes.TryGetValue(hash))
+                {
+                    version = bucket->version;
+                    for (auto existingType : bucket->types)
+                    {
+                        SyntaxArena* existingArena = getSyntaxObjectArena(existingType);
+                        if (!existingArena->tryAddReference())
+                            continue;
+                        existingTypes.Add(existingType);
+                        existingArenas.Add(existingArena);
+                        existingArena->releaseReference();
+                    }
+                }
+            }
+
+            // `type` isn't canonical yet, so it must be the one
+            // to do the comparison (otherwise `EqualsImpl()` would
+            // ask for its canonical type, and end up back here).
+            for (auto existingType : existingTypes)
+            {
+                if (!type->EqualsImpl(existingType))
+                    continue;
+
+                // There can only be one interned type for each distinct
+                // type, so if we can't use this one, `type` stays as it is.
+                if (existingType->internedForAllArenas
+                    || getSyntaxObjectArena(existingType) == typeArena)
+                {
+                    return existingType;
+                }
+                return nullptr;
+            }
+
+            // Other requests may end up using the interned type, so if
+            // we can, we add a copy that lives in the arena of the code
+            // it refers to, rather than one in the arena of this request.
+            if (!triedArenaCopy)
+            {
+                triedArenaCopy = true;
+                if (auto sharedArena = findTypeArena(type))
+                {
+                    if (sharedArena == typeArena)
+                    {
+                        forAllArenas = true;
+                    }
+                    else if (auto copy = copyTypeToArena(type, sharedArena))
+                    {
+                        type = copy;
+                        forAllArenas = true;
+                    }
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(internMutex);
+                auto bucket = internedTypes.TryGetValue(hash);
+                if (!bucket)
+                {
+                    internedTypes.Add(hash, InternBucket());
+                    bucket = internedTypes.TryGetValue(hash);
+                }
+
+                // If another type was added while we were comparing,
+                // we need to check against it too.
+                if (bucket->version == version)
+                {
+                    type->canonicalHash = hash;
+                    type->internId = nextInternId++;
+                    type->internedIn = this;
+                    type->internedForAllArenas = forAllArenas;
+                    type->canonicalType.store(type, std::memory_order_release);
+
+                    bucket->types.Add(type);
+                    bucket->version++;
+                    return type;
+                }
+            }
+        }
+    }
+
+    // Finding the arena for an interned type that any code can use
+
+    // Looks for the one arena, other than the session's, that the
+    // objects a type refers to are in. The session's arena outlives
+    // all others, so a type in any arena can refer to objects in it.
+    struct SessionTypes::TypeArenaFinder
+    {
+        SyntaxArena*    sessionArena;
+        SyntaxArena*    arena;
+        bool            failed = false;
+
+        void addObject(SyntaxObject* obj)
+        {
+            if (!obj)
+            {
+                failed = true;
+                return;
+            }
+
+            SyntaxArena* objArena = getSyntaxObjectArena(obj);
+            if (objArena == sessionArena || objArena == arena)
+                return;
+
+            if (arena == sessionArena)
+                arena = objArena;
+            else
+                failed = true;
+        }
+
+        void addDeclRef(DeclRefBase const& declRef);
+
+        // A type can only refer to another canonical type that
+        // any code can use, which is already where it needs to be
+        void addCanonicalType(ExpressionType* type)
+        {
+            auto canType = type->GetCanonicalType();
+            if (!canType->internedForAllArenas)
+                failed = true;
+            else
+                addObject(canType);
+        }
+
+        void addVal(Val* val)
+        {
+            if (auto type = dynamicCast<ExpressionType>(val))
+                addCanonicalType(type);
+            else if (dynamicCast<ConstantIntVal>(val))
+            {}
+            else if (auto paramVal = dynamicCast<GenericParamIntVal>(val))
+                addDeclRef(paramVal->declRef);
+            else
+                failed = true;
+        }
+
+        void addSubstitutions(Substitutions* subst)
+        {
+            for (; subst; subst = subst->outer.Ptr())
+            {
+                addObject(subst->genericDecl);
+                for (auto& arg : subst->args)
+                    addVal(arg.Ptr());
+            }
+        }
+
+        void addType(ExpressionType* type)
+        {
+            if (auto declRefType = dynamicCast<DeclRefType>(type))
+                addDeclRef(declRefType->declRef);
+            else if (auto funcType = dynamicCast<FuncType>(type))
+                addDeclRef(funcType->declRef);
+            else if (auto genericDeclRefType = dynamicCast<GenericDeclRefType>(type))
+                addDeclRef(genericDeclRefType->declRef);
+            else if (auto arrayType = dynamicCast<ArrayExpressionType>(type))
+            {
+                // Array lengths are compared by identity, so we can't copy them
+                addCanonicalType(arrayType->BaseType);
+                if (arrayType->ArrayLength)
+                    addObject(arrayType->ArrayLength.Ptr());
+            }
+            else if (dynamicCast<ErrorType>(type))
+            {}
+            else
+                failed = true;
+        }
+    };
+
+    void SessionTypes::TypeArenaFinder::addDeclRef(DeclRefBase const& declRef)
+    {
+        addObject(declRef.getDecl());
+        addSubstitutions(declRef.substitutions.Ptr());
+    }
+
+    SyntaxArena* SessionTypes::findTypeArena(ExpressionType* type)
+    {
+        TypeArenaFinder finder;
+        finder.sessionArena = arena;
+        finder.arena = arena;
+        finder.addType(type);
+        if (finder.failed)
+            return nullptr;
+        return finder.arena;
     }
-    void ExpressionType::Finalize()
+
+    // Copying canonical types to another arena. The copies are only
+    // made once we know that the whole type can be copied, since
+    // anything we allocate in an arena stays there until it is freed.
+
+    static RefPtr<Substitutions> copySubstitutions(Substitutions* subst);
+
+    static RefPtr<Val> copyVal(Val* val)
+    {
+        if (auto type = dynamicCast<ExpressionType>(val))
+            return type->GetCanonicalType();
+        else if (auto constantVal = dynamicCast<ConstantIntVal>(val))
+            return new ConstantIntVal(constantVal->value);
+
+        auto paramVal = dynamicCast<GenericParamIntVal>(val);
+        auto declRef = paramVal->declRef;
+        declRef.substitutions = copySubstitutions(declRef.substitutions.Ptr());
+        return new GenericParamIntVal(declRef);
+    }
+
+    static RefPtr<Substitutions> copySubstitutions(Substitutions* subst)
+    {
+        if (!subst)
+            return nullptr;
+
+        RefPtr<Substitutions> copy = new Substitutions();
+        copy->genericDecl = subst->genericDecl;
+        for (auto& arg : subst->args)
+            copy->args.Add(copyVal(arg.Ptr()));
+        copy->outer = copySubstitutions(subst->outer.Ptr());
+        return copy;
+    }
+
+    RefPtr<ExpressionType> SessionTypes::copyTypeToArena(ExpressionType* type, SyntaxArena* typeArena)
+    {
+        SyntaxArenaScope arenaScope(typeArena);
+        SubstitutionCacheScope substitutionCacheScope(nullptr);
+
+        RefPtr<ExpressionType> copy;
+        if (auto declRefType = dynamicCast<DeclRefType>(type))
+        {
+            auto declRef = declRefType->declRef;
+            declRef.substitutions = copySubstitutions(declRef.substitutions.Ptr());
+            copy = DeclRefType::Create(declRef);
+        }
+        else if (auto funcType = dynamicCast<FuncType>(type))
+        {
+            RefPtr<FuncType> funcTypeCopy = new FuncType();
+            funcTypeCopy->declRef = funcType->declRef;
+            funcTypeCopy->declRef.substitutions = copySubstitutions(funcType->declRef.substitutions.Ptr());
+            copy = funcTypeCopy;
+        }
+        else if (auto genericDeclRefType = dynamicCast<GenericDeclRefType>(type))
+        {
+            auto declRef = genericDeclRefType->declRef;
+            declRef.substitutions = copySubstitutions(declRef.substitutions.Ptr());
+            copy = new GenericDeclRefType(declRef);
+        }
+        else if (auto arrayType = dynamicCast<ArrayExpressionType>(type))
+        {
+            RefPtr<ArrayExpressionType> arrayTypeCopy = new ArrayExpressionType();
+            arrayTypeCopy->BaseType = arrayType->BaseType->GetCanonicalType();
+            arrayTypeCopy->ArrayLength = arrayType->ArrayLength;
+            copy = arrayTypeCopy;
+        }
+        else
+        {
+            copy = new ErrorType();
+        }
+
+        // `DeclRefType::Create()` picks the class of type from the
+        // declaration, which should agree with the type we started with.
+        if (copy->getClassTag() != type->getClassTag())
+            return nullptr;
+        return copy;
+    }
+
+    void SessionTypes::removeInternedType(ExpressionType* type)
+    {
+        std::lock_guard<std::mutex> lock(internMutex);
+        if (auto bucket = internedTypes.TryGetValue(type->canonicalHash))
+        {
+            auto& types = bucket->types;
+            for (UInt ii = 0; ii < types.Count(); ++ii)
+            {
+                if (types[ii] == type)
+                {
+                    types.FastRemoveAt(ii);
+                    break;
+                }
+            }
+        }
+    }
+
+    SessionTypesScope::SessionTypesScope(SessionTypes* types)
+        : savedTypes(gCurrentSessionTypes)
+    {
+        gCurrentSessionTypes = types;
+    }
+
+    SessionTypesScope::~SessionTypesScope()
+    {
+        gCurrentSessionTypes = savedTypes;
+    }
+
+    SessionTypes* getSessionTypes()
     {
-        Error = nullptr;
-        initializerListType = nullptr;
-        Overloaded = nullptr;
-        // Note(tfoley): This seems to be just about the only way to clear out a List<T>
-        sCanonicalTypes = List<RefPtr<ExpressionType>>();
-		sBuiltinTypes = Dictionary<int, RefPtr<ExpressionType>>();
-		sMagicDecls = Dictionary<String, Decl*>();
+        return gCurrentSessionTypes;
     }
+
+    // SubstitutionCache
+
+    static thread_local SubstitutionCache* gCurrentSubstitutionCache = nullptr;
+
+    SubstitutionCache::~SubstitutionCache()
+    {
+        // Substitutions in shared modules can outlive the request
+        for (auto& entry : internedSubstitutions)
+        {
+            for (auto& subst : entry.Value)
+                subst->internedIn.store(nullptr, std::memory_order_release);
+        }
+    }
+
+    // Get the value that identifies an argument of interned
+    // substitutions, such that equal arguments have the same key.
+    // Returns false for arguments that have no such key.
+    static bool getInternedArgKey(Val* arg, int64_t* outKey)
+    {
+        if (auto type = dynamicCast<ExpressionType>(arg))
+        {
+            // Canonical types are interned by the session, so they can
+            // be identified by address. Anything else (e.g., a `typedef`)
+            // would still compare equal to its canonical type.
+            auto canType = type->GetCanonicalType();
+            if (canType != type || !type->GetCanonicalTypeId())
+                return false;
+            *outKey = (int64_t)(intptr_t)type;
+            return true;
+        }
+        else if (auto constantVal = dynamicCast<ConstantIntVal>(arg))
+        {
+            *outKey = (int64_t)constantVal->value;
+            return true;
+        }
+        else if (auto paramVal = dynamicCast<GenericParamIntVal>(arg))
+        {
+            if (paramVal->declRef.substitutions)
+                return false;
+            *outKey = (int64_t)(intptr_t)paramVal->declRef.getDecl();
+            return true;
+        }
+        return false;
+    }
+
+    RefPtr<Substitutions> SubstitutionCache::intern(Substitutions* subst)
+    {
+        if (!subst || subst->internedIn.load(std::memory_order_acquire) == this)
+            return subst;
+
+        // The outer substitutions must already be interned here, so
+        // that we can identify them by address too.
+        auto outer = subst->outer.Ptr();
+        if (outer && outer->internedIn.load(std::memory_order_acquire) != this)
+            return subst;
+
+        List<int64_t> argKeys;
+        int hash = combineHash(
+            PointerHash<1>::GetHashCode(subst->genericDecl),
+            PointerHash<1>::GetHashCode(outer));
+        for (auto& arg : subst->args)
+        {
+            int64_t key = 0;
+            if (!getInternedArgKey(arg.Ptr(), &key))
+                return subst;
+            argKeys.Add(key);
+            hash = combineHash(hash, (int)key ^ (int)(key >> 32));
+        }
+
+        auto bucket = internedSubstitutions.TryGetValue(hash);
+        if (!bucket)
+        {
+            internedSubstitutions.Add(hash, List<RefPtr<Substitutions>>());
+            bucket = internedSubstitutions.TryGetValue(hash);
+        }
+
+        for (auto& existing : *bucket)
+        {
+            if (existing->genericDecl != subst->genericDecl
+                || existing->outer.Ptr() != outer
+                || existing->args.Count() != argKeys.Count())
+            {
+                continue;
+            }
+
+            bool match = true;
+            for (UInt aa = 0; match && aa < argKeys.Count(); ++aa)
+            {
+                int64_t key = 0;
+                getInternedArgKey(existing->args[aa].Ptr(), &key);
+                match = key == argKeys[aa]
+                    && existing->args[aa]->getClassTag() == subst->args[aa]->getClassTag();
+            }
+            if (match)
+                return existing;
+        }
+
+        subst->hashCode = subst->ComputeHashCode();
+        subst->internedIn.store(this, std::memory_order_release);
+        bucket->Add(subst);
+        return subst;
+    }
+
+    bool SubstitutionCache::tryGetSubstitutedType(
+        ExpressionType*         type,
+        Substitutions*          subst,
+        RefPtr<ExpressionType>* outResult)
+    {
+        SubstitutedTypeKey key = { type, subst };
+        if (auto entry = substitutedTypes.TryGetValue(key))
+        {
+            *outResult = entry->result;
+            return true;
+        }
+        return false;
+    }
+
+    void SubstitutionCache::addSubstitutedType(
+        ExpressionType*         type,
+        Substitutions*          subst,
+        ExpressionType*         result)
+    {
+        SubstitutedTypeKey key = { type, subst };
+        SubstitutedType entry;
+        entry.type = type;
+        entry.result = result;
+        substitutedTypes[key] = entry;
+    }
+
+    SubstitutionCacheScope::SubstitutionCacheScope(SubstitutionCache* cache)
+        : savedCache(gCurrentSubstitutionCache)
+    {
+        gCurrentSubstitutionCache = cache;
+    }
+
+    SubstitutionCacheScope::~SubstitutionCacheScope()
+    {
+        gCurrentSubstitutionCache = savedCache;
+    }
+
+    SubstitutionCache* getSubstitutionCache()
+    {
+        return gCurrentSubstitutionCache;
+    }
+
+    RefPtr<Substitutions> internSubstitutions(Substitutions* subst)
+    {
+        if (auto cache = gCurrentSubstitutionCache)
+            return cache->intern(subst);
+        return subst;
+    }
+
     bool ArrayExpressionType::EqualsImpl(ExpressionType * type)
     {
         auto arrType = type->AsArrayType();
@@ -207,11 +1282,16 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
     {
         auto canonicalBaseType = BaseType->GetCanonicalType();
         auto canonicalArrayType = new ArrayExpressionType();
-        sCanonicalTypes.Add(canonicalArrayType);
         canonicalArrayType->BaseType = canonicalBaseType;
         canonicalArrayType->ArrayLength = ArrayLength;
         return canonicalArrayType;
     }
+    bool ArrayExpressionType::ComputeCanonicalHash(int* outHash)
+    {
+        // Array lengths are compared by identity in `EqualsImpl()`
+        *outHash = combineHash(BaseType->GetCanonicalHash(), PointerHash<1>::GetHashCode(ArrayLength.Ptr()));
+        return true;
+    }
     int ArrayExpressionType::GetHashCode()
     {
         if (ArrayLength)
@@ -254,13 +1334,19 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         return this;
     }
 
+    bool DeclRefType::ComputeCanonicalHash(int* outHash)
+    {
+        *outHash = getCanonicalHash(declRef);
+        return true;
+    }
+
     RefPtr<Val> DeclRefType::SubstituteImpl(Substitutions* subst, int* ioDiff)
     {
         if (!subst) return this;
 
         // the case we especially care about is when this type references a declaration
         // of a generic parameter, since that is what we might be substituting...
-        if (auto genericTypeParamDecl = dynamic_cast<GenericTypeParamDecl*>(declRef.getDecl()))
+        if (auto genericTypeParamDecl = dynamicCast<GenericTypeParamDecl>(declRef.getDecl()))
         {
             // search for a substitution that might apply to us
             for (auto s = subst; s; s = s->outer.Ptr())
@@ -532,6 +1618,13 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         return (int)(int64_t)(void*)this;
     }
 
+    bool ErrorType::ComputeCanonicalHash(int* outHash)
+    {
+        // All error types are equal
+        *outHash = 0;
+        return true;
+    }
+
 
     // NamedExpressionType
 
@@ -587,6 +1680,12 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         return declRef.GetHashCode();
     }
 
+    bool FuncType::ComputeCanonicalHash(int* outHash)
+    {
+        *outHash = getCanonicalHash(declRef);
+        return true;
+    }
+
     // TypeType
 
     String TypeType::ToString()
@@ -608,7 +1707,6 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
     ExpressionType* TypeType::CreateCanonicalType()
     {
         auto canType = new TypeType(type->GetCanonicalType());
-        sCanonicalTypes.Add(canType);
         return canType;
     }
 
@@ -645,6 +1743,12 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         return this;
     }
 
+    bool GenericDeclRefType::ComputeCanonicalHash(int* outHash)
+    {
+        *outHash = getCanonicalHash(declRef);
+        return true;
+    }
+
     // ArithmeticExpressionType
 
     // VectorExpressionType
@@ -694,7 +1798,7 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
 
     bool GenericParamIntVal::EqualsVal(Val* val)
     {
-        if (auto genericParamVal = dynamic_cast<GenericParamIntVal*>(val))
+        if (auto genericParamVal = dynamicCast<GenericParamIntVal>(val))
         {
             return declRef.Equals(genericParamVal->declRef);
         }
@@ -767,10 +1871,22 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         if (!diff) return this;
 
         (*ioDiff)++;
-        auto substSubst = new Substitutions();
+        RefPtr<Substitutions> substSubst = new Substitutions();
         substSubst->genericDecl = genericDecl;
         substSubst->args = substArgs;
-        return substSubst;
+        substSubst->outer = outerSubst;
+        return internSubstitutions(substSubst);
+    }
+
+    int Substitutions::ComputeHashCode() const
+    {
+        int rs = 0;
+        for (auto && v : args)
+        {
+            rs ^= v->GetHashCode();
+            rs *= 16777619;
+        }
+        return rs;
     }
 
     bool Substitutions::Equals(Substitutions* subst)
@@ -779,6 +1895,15 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         if (!this || !subst)
             return !this && !subst;
 
+        if (this == subst)
+            return true;
+
+        // There is only one object for each distinct set of
+        // substitutions interned in a cache.
+        auto cache = internedIn.load(std::memory_order_acquire);
+        if (cache && cache == subst->internedIn.load(std::memory_order_acquire))
+            return false;
+
         if (genericDecl != subst->genericDecl)
             return false;
 
@@ -805,10 +1930,24 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         if (!substitutions)
             return type;
 
+        // Substituting the same interned substitutions into the same
+        // type always gives the same result, so we only do it once.
+        auto cache = getSubstitutionCache();
+        if (!type || !cache || substitutions->internedIn.load(std::memory_order_acquire) != cache)
+        {
+            return type->Substitute(substitutions.Ptr()).As<ExpressionType>();
+        }
+
+        RefPtr<ExpressionType> result;
+        if (cache->tryGetSubstitutedType(type.Ptr(), substitutions.Ptr(), &result))
+            return result;
+
         // Otherwise we need to recurse on the type structure
         // and apply substitutions where it makes sense
 
-        return type->Substitute(substitutions.Ptr()).As<ExpressionType>();
+        result = type->Substitute(substitutions.Ptr()).As<ExpressionType>();
+        cache->addSubstitutedType(type.Ptr(), substitutions.Ptr(), result.Ptr());
+        return result;
     }
 
     DeclRefBase DeclRefBase::Substitute(DeclRefBase declRef) const
@@ -866,13 +2005,18 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
     // Convenience accessors for common properties of declarations
     String const& DeclRefBase::GetName() const
     {
-        return decl->Name.Content;
+        return decl->getName();
+    }
+
+    Name* DeclRefBase::getInternedName() const
+    {
+        return decl->getInternedName();
     }
 
     DeclRefBase DeclRefBase::GetParent() const
     {
         auto parentDecl = decl->ParentDecl;
-        if (auto parentGeneric = dynamic_cast<GenericDecl*>(parentDecl))
+        if (auto parentGeneric = dynamicCast<GenericDecl>(parentDecl))
         {
             if (substitutions && substitutions->genericDecl == parentDecl)
             {
@@ -941,7 +2085,7 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
 
     bool ConstantIntVal::EqualsVal(Val* val)
     {
-        if (auto intVal = dynamic_cast<ConstantIntVal*>(val))
+        if (auto intVal = dynamicCast<ConstantIntVal>(val))
             return value == intVal->value;
         return false;
     }
@@ -963,60 +2107,91 @@ void ExpressionType::accept(IValVisitor* visitor, void* extra)
         RefPtr<BuiltinTypeModifier> modifier)
     {
         auto type = DeclRefType::Create(DeclRef<Decl>(decl.Ptr(), nullptr));
-        ExpressionType::sBuiltinTypes[(int)modifier->tag] = type;
+        getSessionTypes()->builtinTypes[(int)modifier->tag] = type;
     }
 
     void RegisterMagicDecl(
         RefPtr<Decl>                decl,
         RefPtr<MagicTypeModifier>   modifier)
     {
-        ExpressionType::sMagicDecls[modifier->name] = decl.Ptr();
+        auto types = getSessionTypes();
+        std::lock_guard<std::mutex> lock(types->magicDeclMutex);
+        types->magicDecls[modifier->name] = decl.Ptr();
+    }
+
+    void registerBuiltinDecls(
+        ProgramSyntaxNode*  programNode)
+    {
+        for (auto decl : programNode->Members)
+        {
+            auto inner = decl;
+            if (auto genericDecl = decl.As<GenericDecl>())
+            {
+                inner = genericDecl->inner;
+            }
+
+            if (auto builtinMod = inner->FindModifier<BuiltinTypeModifier>())
+            {
+                RegisterBuiltinDecl(decl, builtinMod);
+            }
+            if (auto magicMod = inner->FindModifier<MagicTypeModifier>())
+            {
+                RegisterMagicDecl(decl, magicMod);
+            }
+        }
     }
 
     RefPtr<Decl> findMagicDecl(
         String const& name)
     {
-        return ExpressionType::sMagicDecls[name].GetValue();
+        auto types = getSessionTypes();
+        std::lock_guard<std::mutex> lock(types->magicDeclMutex);
+        return types->magicDecls[name].GetValue();
     }
 
     ExpressionType* ExpressionType::GetBool()
     {
-        return sBuiltinTypes[(int)BaseType::Bool].GetValue().Ptr();
+        return getSessionTypes()->builtinTypes[(int)BaseType::Bool].Ptr();
     }
 
     ExpressionType* ExpressionType::GetFloat()
     {
-        return sBuiltinTypes[(int)BaseType::Float].GetValue().Ptr();
+        return getSessionTypes()->builtinTypes[(int)BaseType::Float].Ptr();
     }
 
     ExpressionType* ExpressionType::getDoubleType()
     {
-        return sBuiltinTypes[(int)BaseType::Double].GetValue().Ptr();
+        return getSessionTypes()->builtinTypes[(int)BaseType::Double].Ptr();
     }
 
     ExpressionType* ExpressionType::GetInt()
     {
-        return sBuiltinTypes[(int)BaseType::Int].GetValue().Ptr();
+        return getSessionTypes()->builtinTypes[(int)BaseType::Int].Ptr();
     }
 
     ExpressionType* ExpressionType::GetUInt()
     {
-        return sBuiltinTypes[(int)BaseType::UInt].GetValue().Ptr();
+        return getSessionTypes()->builtinTypes[(int)BaseType::UInt].Ptr();
     }
 
     ExpressionType* ExpressionType::GetVoid()
     {
-        return sBuiltinTypes[(int)BaseType::Void].GetValue().Ptr();
+        return getSessionTypes()->builtinTypes[(int)BaseType::Void].Ptr();
     }
 
     ExpressionType* ExpressionType::getInitializerListType()
     {
-        return initializerListType.Ptr();
+        return getSessionTypes()->initializerListType.Ptr();
     }
 
     ExpressionType* ExpressionType::GetError()
     {
-        return ExpressionType::Error.Ptr();
+        return getSessionTypes()->errorType.Ptr();
+    }
+
+    ExpressionType* ExpressionType::getOverloadedType()
+    {
+        return getSessionTypes()->overloadedType.Ptr();
     }
 
     //
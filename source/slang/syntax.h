@@ -8,13 +8,128 @@
 #include "../../Slang.h"
 
 #include <assert.h>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
 
 namespace Slang
 {
     class Substitutions;
+    class SyntaxObject;
     class SyntaxVisitor;
     class FunctionSyntaxNode;
     class Layout;
+    class SessionTypes;
+    class SubstitutionCache;
+
+    struct SyntaxArenaChunk;
+
+    // Storage for syntax nodes, types, substitutions, and the
+    // other objects that make up an AST.
+    //
+    // While a `SyntaxArenaScope` is active, syntax objects are
+    // allocated from its arena, so that allocating a node is just
+    // a pointer bump. Each thread bumps through a chunk of its own,
+    // so requests on several threads can allocate from the same
+    // arena (e.g., the session's) without taking a lock.
+    //
+    // Objects are never freed one at a time: references to them
+    // aren't counted (see `RefObject::markImmortal()`), and they all
+    // go away when the arena does. Only the objects of classes that own memory outside the
+    // arena (e.g., a `List` of members) get their destructors run at
+    // that point, so freeing an arena costs about one operation per
+    // chunk, rather than one per object.
+    //
+    // Whatever allocates syntax from an arena holds a reference to it
+    // for as long as it needs the syntax: a compile request, an imported
+    // module (see `LoadedModule::syntaxArena`), or the session (for the
+    // standard library and other session-lifetime objects). Syntax in
+    // one arena may refer to syntax in another only if the second arena
+    // outlives the first, as the session's arena does, or as the arena
+    // of an imported module does (see `addSyntaxArenaDependency()`).
+    //
+    // Arenas themselves are always shared between threads (see
+    // `RefObject::markShared()`), and so are the other objects created
+    // while a shared arena is in use, e.g., the strings in its syntax.
+    class SyntaxArena : public RefObject
+    {
+    public:
+        SyntaxArena();
+        ~SyntaxArena();
+
+        // Allocate `size` bytes with the given alignment (which
+        // must be a power of two), which stay valid until the
+        // arena is freed.
+        void* allocate(size_t size, size_t alignment);
+
+        // Identifies the arena to the chunks that threads allocate
+        // from, since the address of a freed arena may be reused.
+        uint64_t id;
+
+        // All of the chunks allocated for the arena, along with the
+        // other state that threads share, which is guarded by `mutex`.
+        SyntaxArenaChunk* chunks = nullptr;
+        std::mutex mutex;
+
+        // The source files that syntax in the arena was lexed from,
+        // which must live as long as it does, since its locations
+        // and token text refer to them (see `addSyntaxSourceFile()`).
+        Dictionary<SourceFile*, RefPtr<SourceFile>> sourceFiles;
+
+        // Other arenas that syntax in this one refers to, which are
+        // only released once all of the syntax here has been destroyed.
+        List<RefPtr<SyntaxArena>> dependencies;
+
+        // Can other threads use the syntax in the arena (e.g., because
+        // it belongs to the session, or to a module that gets shared)?
+        // Set before the arena is first used.
+        bool isShared = false;
+
+    private:
+        void* allocateSlow(size_t size, size_t alignment);
+        SyntaxArenaChunk* allocateChunk(size_t size);
+    };
+
+    // Use `arena` to allocate syntax objects created on the
+    // current thread, for the lifetime of the scope object.
+    struct SyntaxArenaScope
+    {
+        SyntaxArenaScope(SyntaxArena* arena);
+        ~SyntaxArenaScope();
+
+        SyntaxArena* savedArena;
+        SharedRefObjectScope sharedScope;
+    };
+
+    // Allocation functions used by the syntax classes. When there
+    // is no arena active, objects come from an arena that is never
+    // freed. `needsDestructor` says whether the object must be
+    // destroyed when its arena is freed.
+    void* allocateSyntaxObject(size_t size, bool needsDestructor);
+
+    // Called if the constructor of an object from `allocateSyntaxObject()`
+    // throws, so that the arena doesn't try to destroy it later. The
+    // memory itself is only reclaimed with the arena.
+    void freeSyntaxObject(void* ptr);
+
+    // Get the arena that a syntax object was allocated from
+    SyntaxArena* getSyntaxObjectArena(SyntaxObject* obj);
+
+    // Copy `text` into the current arena, for the text of a token
+    // that isn't just a span of some source file (see `Token::setContent`).
+    // The copy lives as long as the objects allocated from the arena.
+    // When there is no arena active, the text is never freed.
+    UnownedStringSlice allocateSyntaxText(UnownedStringSlice const& text);
+
+    // Keep `file` alive for as long as the current arena, because
+    // syntax allocated from the arena may refer to it. This lets
+    // the file's locations be reused once the syntax is gone.
+    void addSyntaxSourceFile(SourceFile* file);
+
+    // Keep `arena` alive for as long as the current arena, because
+    // syntax allocated from the current arena refers to syntax in
+    // `arena` (e.g., code that imports a module).
+    void addSyntaxArenaDependency(SyntaxArena* arena);
 
     struct IExprVisitor;
     struct IDeclVisitor;
@@ -29,6 +144,109 @@ namespace Slang
 #include "syntax-defs.h"
 #include "object-meta-end.h"
 
+    // Identifies each of the syntax classes, so that code can
+    // `switch` on the class of an object.
+    enum class SyntaxClassTag : uint16_t
+    {
+#define SYNTAX_CLASS(NAME, BASE, ...) NAME,
+#include "object-meta-begin.h"
+#include "syntax-defs.h"
+#include "object-meta-end.h"
+
+        Count,
+    };
+
+    // The classes are also numbered by a depth-first walk of the
+    // class hierarchy, so that a class and all of the classes derived
+    // from it get the numbers in `[begin, end)`. This lets us test
+    // whether an object is an instance of a class with a range check.
+    struct SyntaxClassRange
+    {
+        uint16_t begin;
+        uint16_t end;
+    };
+    extern SyntaxClassRange gSyntaxClassRanges[int(SyntaxClassTag::Count)];
+
+    // Base class for the roots of the syntax class hierarchy
+    //
+    // Syntax objects live as long as the arena they were allocated from,
+    // which holds a reference to each of them, so the references that
+    // other objects hold never free them.
+    class SyntaxObject : public RefObject
+    {
+    public:
+        SyntaxObject()
+        {
+            markImmortal();
+        }
+
+        SyntaxObject(SyntaxObject const& other)
+            : RefObject(other)
+        {
+            markImmortal();
+        }
+
+        virtual SyntaxClassTag getClassTag() const = 0;
+
+        // Only the types of fields are checked to see if a class needs
+        // its objects destroyed along with their arena, so a class with
+        // `RAW` members that own memory (e.g., a `Dictionary`) sets this.
+        static const bool kRawMembersNeedDestructor = false;
+    };
+
+    // Do objects of each syntax class need to be destroyed when
+    // their arena is freed? (see `SyntaxArena`)
+    extern const bool gSyntaxClassNeedsDestructor[int(SyntaxClassTag::Count)];
+
+    // Test whether the class with tag `tag` is `T`, or derived from it
+    template<typename T>
+    bool isSyntaxClassDerivedFrom(SyntaxClassTag tag)
+    {
+        SyntaxClassRange range = gSyntaxClassRanges[int(T::kClassTag)];
+        return UInt(gSyntaxClassRanges[int(tag)].begin - range.begin) < UInt(range.end - range.begin);
+    }
+
+    // Classes that are defined outside of `syntax-defs.h` (like the
+    // pseudo-syntax used during lowering) don't get a tag of their
+    // own, so for those we have to fall back to `dynamic_cast`.
+    template<typename T, bool kHasClassTag = std::is_same<typename T::TaggedClass, T>::value>
+    struct SyntaxCast
+    {
+        static T* cast(SyntaxObject* obj)
+        {
+            if (obj && isSyntaxClassDerivedFrom<T>(obj->getClassTag()))
+                return static_cast<T*>(obj);
+            return nullptr;
+        }
+    };
+
+    template<typename T>
+    struct SyntaxCast<T, false>
+    {
+        static T* cast(SyntaxObject* obj)
+        {
+            return dynamic_cast<T*>(obj);
+        }
+    };
+
+    // Cast a syntax object to a `T*`, or return null if it isn't a `T`
+    template<typename T>
+    T* dynamicCast(SyntaxObject* obj)
+    {
+        return SyntaxCast<T>::cast(obj);
+    }
+
+    // Make `RefPtr<T>::As<U>()` use the class tags too
+    template<typename T>
+    struct DynamicCastTraits<T, typename std::enable_if<std::is_base_of<SyntaxObject, T>::value>::type>
+    {
+        template<typename U>
+        static U* cast(T* obj)
+        {
+            return dynamicCast<U>(obj);
+        }
+    };
+
     enum class IntrinsicOp
     {
         Unknown = 0,
@@ -135,7 +353,7 @@ namespace Slang
             for (;;)
             {
                 if (!m) return m;
-                if (dynamic_cast<T*>(m)) return m;
+                if (dynamicCast<T>(m)) return m;
                 m = m->next.Ptr();
             }
         }
@@ -143,14 +361,47 @@ namespace Slang
         Modifier* modifiers;
     };
 
+    // A set of modifier classes, with one bit for each class
+    // (numbered by its position in `gSyntaxClassRanges`).
+    struct ModifierClassSet
+    {
+        enum { kWordCount = 2 };
+        uint64_t words[kWordCount] = {};
+
+        void add(SyntaxClassTag tag);
+
+        // Does the set contain the class `tag`, or any class derived from it?
+        bool containsDerivedFrom(SyntaxClassTag tag) const;
+    };
+
     // A set of modifiers attached to a syntax node
     struct Modifiers
     {
         // The first modifier in the linked list of heap-allocated modifiers
         RefPtr<Modifier> first;
 
+        // The classes of the modifiers in the list, so that we can
+        // tell that a modifier isn't present without walking the list.
+        // Code that changes the list needs to keep this up to date,
+        // which `add()` and `prepend()` do.
+        ModifierClassSet classes;
+
+        // Could the list contain a modifier of type `T`? Modifier classes
+        // without a class tag of their own always answer `true`.
         template<typename T>
-        FilteredModifierList<T> getModifiersOfType() { return FilteredModifierList<T>(first.Ptr()); }
+        bool mayHaveModifierOfType() const
+        {
+            return !std::is_same<typename T::TaggedClass, T>::value
+                || classes.containsDerivedFrom(T::kClassTag);
+        }
+
+        template<typename T>
+        FilteredModifierList<T> getModifiersOfType()
+        {
+            if (!mayHaveModifierOfType<T>())
+                return FilteredModifierList<T>();
+            return FilteredModifierList<T>(first.Ptr());
+        }
 
         // Find the first modifier of a given type, or return `nullptr` if none is found.
         template<typename T>
@@ -162,6 +413,15 @@ namespace Slang
         template<typename T>
         bool hasModifier() { return findModifier<T>() != nullptr; }
 
+        // Add `modifier`, and any modifiers linked after it, to the end of the list
+        void add(Modifier* modifier);
+
+        // Add `modifier` to the start of the list
+        void prepend(Modifier* modifier);
+
+        // Recompute `classes` after the list has been changed directly
+        void updateClasses();
+
         FilteredModifierList<Modifier>::Iterator begin() { return FilteredModifierList<Modifier>::Iterator(first.Ptr()); }
         FilteredModifierList<Modifier>::Iterator end() { return FilteredModifierList<Modifier>::Iterator(nullptr); }
     };
@@ -180,6 +440,7 @@ namespace Slang
         Float,
         Double,
     };
+    enum { kBaseTypeCount = int(BaseType::Double) + 1 };
 
     class NamedExpressionType;
     class GenericDecl;
@@ -273,6 +534,7 @@ namespace Slang
 
         // Convenience accessors for common properties of declarations
         String const& GetName() const;
+        Name* getInternedName() const;
         DeclRefBase GetParent() const;
 
         int GetHashCode() const;
@@ -302,7 +564,7 @@ namespace Slang
         DeclRef<T> As() const
         {
             DeclRef<T> result;
-            result.decl = dynamic_cast<T*>(decl);
+            result.decl = dynamicCast<T>(decl);
             result.substitutions = substitutions;
             return result;
         }
@@ -411,7 +673,7 @@ namespace Slang
         {
             while (cursor != end)
             {
-                if ((*cursor).As<T>())
+                if (dynamicCast<T>(cursor->Ptr()))
                     return cursor;
                 cursor++;
             }
@@ -452,6 +714,172 @@ namespace Slang
         Decl*	decl;
     };
 
+    // An index over an "overload group": the callable declarations
+    // that share a name in one container (like all the `operator+`
+    // overloads in the standard library). Overload resolution uses
+    // it to skip candidates that can't possibly apply to a call, based
+    // on the number of arguments and the rough "shape" of their types,
+    // without running the full checks on every candidate.
+    //
+    // These are only built for code that has already been checked
+    // and is shared between compile requests (see
+    // `buildOverloadGroupIndicesRec()`), and don't change after that.
+    class OverloadGroupIndex : public RefObject
+    {
+    public:
+        // What the index knows about the type of a parameter or argument
+        struct TypeShape
+        {
+            enum class Kind : uint8_t
+            {
+                // Might be anything. This is used for an argument with an
+                // error type, and for a parameter of any type not covered
+                // below (e.g., a generic type parameter or an interface).
+                Any,
+
+                Scalar,
+                Vector,
+                Matrix,
+
+                // An argument of some other type
+                Other,
+            };
+            Kind kind = Kind::Any;
+
+            // The element type of a matrix, or `Void` if not known
+            BaseType elementType = BaseType::Void;
+
+            // The element count of a vector, or the row and column
+            // counts of a matrix. Zero if not known.
+            int rowCount = 0;
+            int columnCount = 0;
+        };
+
+        struct Candidate
+        {
+            Decl*   decl;
+
+            // The range of argument counts the candidate accepts
+            UInt    minArgCount;
+            UInt    maxArgCount;
+
+            // Where the shapes of its parameters start in `paramShapes`
+            UInt    firstParamShape;
+        };
+
+        // Find the candidates that might apply to a call with arguments
+        // of the given shapes, as positions in `candidates`, in order.
+        void findCandidates(
+            List<TypeShape> const&  argShapes,
+            List<UInt>&             outPositions);
+
+        // The declarations in the group, in the order lookup finds them
+        List<Candidate> candidates;
+
+        List<TypeShape> paramShapes;
+
+        // The positions of the candidates that might apply, keyed on
+        // the argument count and the shape of the first argument
+        // (see `getCandidateKey()`)
+        Dictionary<UInt, List<UInt>> candidatesByKey;
+
+        // Whether any candidate has a parameter of interface type.
+        // Whether a type converts to an interface can depend on the
+        // code being checked, so we don't remember resolved calls
+        // for such a group.
+        bool hasInterfaceParams = false;
+
+        // A call to the group with arguments of builtin scalar,
+        // vector and matrix types, identified by the interned IDs
+        // of those types.
+        struct ResolvedCallKey
+        {
+            enum { kMaxArgCount = 4 };
+
+            // Whether the call was a prefix or postfix operator, since
+            // that affects which candidates apply
+            enum class Fixity : uint8_t
+            {
+                None,
+                Prefix,
+                Postfix,
+            };
+
+            Fixity      fixity;
+            UInt        argCount;
+            uint64_t    argTypeIds[kMaxArgCount];
+
+            int GetHashCode() const
+            {
+                int hash = (int)fixity * 16777619 ^ (int)argCount;
+                for (UInt ii = 0; ii < argCount; ++ii)
+                    hash = hash * 16777619 ^ (int)argTypeIds[ii];
+                return hash;
+            }
+            bool operator==(ResolvedCallKey const& other) const
+            {
+                if (fixity != other.fixity || argCount != other.argCount)
+                    return false;
+                for (UInt ii = 0; ii < argCount; ++ii)
+                {
+                    if (argTypeIds[ii] != other.argTypeIds[ii])
+                        return false;
+                }
+                return true;
+            }
+        };
+
+        // Look up the position of the candidate that overload
+        // resolution chose the last time it saw the same call.
+        bool tryGetResolvedCall(
+            ResolvedCallKey const&  key,
+            UInt*                   outPosition);
+
+        // Remember that overload resolution chose the candidate at
+        // `position` (as the single best one) for a call.
+        void addResolvedCall(
+            ResolvedCallKey const&  key,
+            UInt                    position);
+
+    private:
+        // The index is shared between compile requests, which
+        // may be resolving calls on different threads.
+        Dictionary<ResolvedCallKey, UInt>   resolvedCalls;
+        std::shared_timed_mutex             resolvedCallsMutex;
+    };
+
+    // The extensions that apply to a type, with their members merged
+    // into one dictionary, so that member lookup through the type
+    // doesn't have to try applying every candidate extension again.
+    //
+    // Which extensions are visible depends on the code being compiled,
+    // so these belong to a compile request (see `getExtensionMemberTable()`).
+    class ExtensionMemberTable : public RefObject
+    {
+    public:
+        // The extensions that apply to the type, in the order
+        // that lookup considers them
+        List<DeclRef<ExtensionDecl>> extensions;
+
+        // A member of one of the extensions
+        struct Member
+        {
+            Decl*   decl;
+
+            // The position of its extension in `extensions`
+            UInt    extensionIndex;
+        };
+
+        // The members of all the extensions, by name, in the
+        // order that lookup finds them
+        Dictionary<Name*, List<Member>> membersByName;
+
+        // Does any of the extensions have a transparent member? Lookup
+        // then goes through the extensions one at a time, so that the
+        // results come out in the same order.
+        bool hasTransparentMembers = false;
+    };
+
     template<typename T>
     struct FilteredMemberRefList
     {
@@ -520,8 +948,7 @@ namespace Slang
         {
             while (ptr != end)
             {
-                DeclRef<Decl> declRef(ptr->Ptr(), substitutions);
-                if (declRef.As<T>())
+                if (dynamicCast<T>(ptr->Ptr()))
                     return ptr;
                 ptr++;
             }
@@ -697,7 +1124,14 @@ namespace Slang
 #define FIELD_INIT(TYPE, NAME, INIT) TYPE NAME = INIT;
 #define RAW(...) __VA_ARGS__
 #define END_SYNTAX_CLASS() };
-#define SYNTAX_CLASS(NAME, BASE, ...) class NAME : public BASE {public:
+#define SYNTAX_CLASS_TAG(NAME)                                          \
+    static const SyntaxClassTag kClassTag = SyntaxClassTag::NAME;       \
+    typedef NAME TaggedClass;                                           \
+    virtual SyntaxClassTag getClassTag() const override { return kClassTag; } \
+    void* operator new(size_t size)                                     \
+    { return allocateSyntaxObject(size, gSyntaxClassNeedsDestructor[int(kClassTag)]); } \
+    void operator delete(void* ptr) { freeSyntaxObject(ptr); }
+#define SYNTAX_CLASS(NAME, BASE, ...) class NAME : public BASE {public: SYNTAX_CLASS_TAG(NAME)
 #include "object-meta-begin.h"
 
 #include "syntax-base-defs.h"
@@ -706,11 +1140,11 @@ namespace Slang
 #undef ABSTRACT_SYNTAX_CLASS
 #define ABSTRACT_SYNTAX_CLASS(NAME, BASE, ...)                          \
     class NAME : public BASE {                                          \
-    public: /* ... */
+    public: SYNTAX_CLASS_TAG(NAME) /* ... */
 #define SYNTAX_CLASS(NAME, BASE, ...)                                   \
     class NAME : public BASE {                                          \
     virtual void accept(NAME::Visitor* visitor, void* extra) override;  \
-    public: /* ... */
+    public: SYNTAX_CLASS_TAG(NAME) /* ... */
 #include "expr-defs.h"
 #include "decl-defs.h"
 #include "modifier-defs.h"
@@ -719,6 +1153,7 @@ namespace Slang
 #include "val-defs.h"
 
 #include "object-meta-end.h"
+#undef SYNTAX_CLASS_TAG
 
     inline RefPtr<ExpressionType> GetSub(DeclRef<GenericTypeConstraintDecl> const& declRef)
     {
@@ -1010,11 +1445,178 @@ namespace Slang
 
 #endif
 
+    // The builtin types of a session, along with a few special
+    // types that don't come from any declaration.
+    //
+    // Each session has its own set, and a thread finds the one for
+    // the session it is working on via `SessionTypesScope` (in the
+    // same way that `SyntaxArenaScope` picks the arena to allocate
+    // syntax from), which is what the static accessors like
+    // `ExpressionType::GetFloat()` use.
+    class SessionTypes : public RefObject
+    {
+    public:
+        SessionTypes();
+
+        // The arena for syntax that lives as long as the session
+        // (see `Session::syntaxArena`). Canonical types that only
+        // refer to code in this arena get interned in it.
+        SyntaxArena* arena = nullptr;
+
+        RefPtr<ExpressionType> errorType;
+        RefPtr<ExpressionType> initializerListType;
+        RefPtr<ExpressionType> overloadedType;
+
+        // Types declared with `__builtin_type`, indexed by `BaseType`.
+        // These all come from the core library module, so they are
+        // set before any other code can ask for them.
+        RefPtr<ExpressionType> builtinTypes[kBaseTypeCount];
+
+        // Declarations marked with `__magic_type`, by name. A library
+        // module may add to these while other threads are checking
+        // code, so any access needs to hold `magicDeclMutex`.
+        Dictionary<String, Decl*>   magicDecls;
+        std::mutex                  magicDeclMutex;
+
+        ~SessionTypes();
+
+        // Get the interned type that is equal to the canonical type
+        // `type`, with the given hash. If there is none yet, `type` (or a
+        // copy of it) becomes the interned type. Returns null if the equal
+        // type that is already interned can't be used from the arena of
+        // `type` (see `ExpressionType::internedForAllArenas`), in which
+        // case `type` can't be interned either.
+        ExpressionType* internType(ExpressionType* type, int hash);
+
+        // Called when an interned type is destroyed
+        void removeInternedType(ExpressionType* type);
+
+    private:
+        // Find the arena that an interned copy of the canonical type `type`
+        // should live in, so that code in any arena can use it: the arena of
+        // the code it refers to, or this session's arena. Returns null if
+        // there is no such arena (e.g., for a type that refers to code in
+        // two different modules).
+        SyntaxArena* findTypeArena(ExpressionType* type);
+
+        struct TypeArenaFinder;
+
+        // Make a copy of the canonical type `type` in `typeArena`
+        RefPtr<ExpressionType> copyTypeToArena(ExpressionType* type, SyntaxArena* typeArena);
+
+        struct InternBucket
+        {
+            List<ExpressionType*>   types;
+
+            // Incremented whenever a type is added
+            UInt                    version = 0;
+        };
+
+        // The interned types, by hash. Comparing types can end up
+        // interning other types, so we compare outside of the lock,
+        // and only check that nothing was added meanwhile before we
+        // add a new type.
+        Dictionary<int, InternBucket>   internedTypes;
+        std::mutex                      internMutex;
+        uint64_t                        nextInternId = 1;
+    };
+
+    // Use `types` for the builtin types on the current
+    // thread, for the lifetime of the scope object.
+    struct SessionTypesScope
+    {
+        SessionTypesScope(SessionTypes* types);
+        ~SessionTypesScope();
+
+        SessionTypes* savedTypes;
+    };
+
+    SessionTypes* getSessionTypes();
+
+    // Interned substitutions, and the types we got by applying them,
+    // for one compile request.
+    //
+    // Equal substitutions that are interned in the same cache are the
+    // same object, so they can be compared by pointer, and the result
+    // of substituting them into a given type only has to be computed
+    // once. The cache keeps what it holds alive, so it belongs to the
+    // request (whose syntax it refers to) rather than the session.
+    //
+    // Only the thread working on the request uses its cache, so there
+    // is no locking here.
+    class SubstitutionCache : public RefObject
+    {
+    public:
+        ~SubstitutionCache();
+
+        // Get the interned substitutions equal to `subst`. If there are
+        // none yet, `subst` becomes the interned one. Substitutions
+        // that can't be compared by identity (because an argument isn't
+        // a canonical type or a simple integer value) are returned as-is.
+        RefPtr<Substitutions> intern(Substitutions* subst);
+
+        // Look up, or remember, the result of applying the interned
+        // substitutions `subst` to `type`
+        bool tryGetSubstitutedType(
+            ExpressionType*         type,
+            Substitutions*          subst,
+            RefPtr<ExpressionType>* outResult);
+        void addSubstitutedType(
+            ExpressionType*         type,
+            Substitutions*          subst,
+            ExpressionType*         result);
+
+    private:
+        // The interned substitutions, by a hash of their generic,
+        // outer substitutions, and arguments.
+        Dictionary<int, List<RefPtr<Substitutions>>> internedSubstitutions;
+
+        struct SubstitutedTypeKey
+        {
+            ExpressionType* type;
+            Substitutions*  subst;
+
+            int GetHashCode() const
+            {
+                return (PointerHash<1>::GetHashCode(type) * 16777619) ^ PointerHash<1>::GetHashCode(subst);
+            }
+            bool operator==(SubstitutedTypeKey const& other) const
+            {
+                return type == other.type && subst == other.subst;
+            }
+        };
+
+        struct SubstitutedType
+        {
+            // Keeps the type in the key alive, so that its
+            // address can't be reused by another type.
+            RefPtr<ExpressionType>  type;
+            RefPtr<ExpressionType>  result;
+        };
+
+        Dictionary<SubstitutedTypeKey, SubstitutedType> substitutedTypes;
+    };
+
+    // Intern substitutions in `cache`, on the current thread,
+    // for the lifetime of the scope object. With a null `cache`,
+    // nothing gets interned.
+    struct SubstitutionCacheScope
+    {
+        SubstitutionCacheScope(SubstitutionCache* cache);
+        ~SubstitutionCacheScope();
+
+        SubstitutionCache* savedCache;
+    };
+
+    SubstitutionCache* getSubstitutionCache();
+
+    // Get the interned substitutions equal to `subst`, from the current
+    // thread's cache, or `subst` itself if there is no cache.
+    RefPtr<Substitutions> internSubstitutions(Substitutions* subst);
+
     // Note(tfoley): These logically belong to `ExpressionType`,
     // but order-of-declaration stuff makes that tricky
     //
-    // TODO(tfoley): These should really belong to the compilation context!
-    //
     void RegisterBuiltinDecl(
         RefPtr<Decl>                decl,
         RefPtr<BuiltinTypeModifier> modifier);
@@ -1022,6 +1624,11 @@ namespace Slang
         RefPtr<Decl>                decl,
         RefPtr<MagicTypeModifier>   modifier);
 
+    // Register any builtin or magic declarations at the top
+    // level of a module.
+    void registerBuiltinDecls(
+        ProgramSyntaxNode*  programNode);
+
     // Look up a magic declaration by its name
     RefPtr<Decl> findMagicDecl(
         String const& name);
@@ -1075,11 +1682,6 @@ namespace Slang
         return declRef.Substitute(declRef.getDecl()->targetType.Ptr());
     }
 
-    inline ExtensionDecl* GetCandidateExtensions(DeclRef<AggTypeDecl> const& declRef)
-    {
-        return declRef.getDecl()->candidateExtensions;
-    }
-
     inline FilteredMemberRefList<StructField> GetFields(DeclRef<StructSyntaxNode> const& declRef)
     {
         return getMembersOfType<StructField>(declRef);
@@ -4,6 +4,7 @@
 
 #include "../core/basic.h"
 
+#include "name.h"
 #include "source-loc.h"
 
 namespace Slang {
@@ -27,17 +28,58 @@ class Token
 {
 public:
 	TokenType Type = TokenType::Unknown;
-	String Content;
-	CodePosition Position;
+	SourceLoc Position;
     TokenFlags flags = 0;
 	Token() = default;
-	Token(TokenType type, const String & content, int line, int col, int pos, String fileName, TokenFlags flags = 0)
+	Token(TokenType type, UnownedStringSlice const& content, SourceLoc loc, TokenFlags flags = 0)
         : flags(flags)
 	{
 		Type = type;
-		Content = content;
-		Position = CodePosition(line, col, pos, fileName);
+		setContent(content);
+		Position = loc;
 	}
+
+    // Get the text of the token.
+    //
+    // A token doesn't own its text: for tokens produced by the
+    // lexer this is a view into the text of the source file, so
+    // that lexing (and copying tokens around) doesn't need to
+    // allocate or touch any reference counts.
+    UnownedStringSlice getContent() const { return content; }
+
+    // Get the interned name of the token.
+    //
+    // The lexer fills this in for identifiers, so that
+    // later lookup can key on the `Name*` instead of
+    // the text. It is null for other tokens.
+    Name* getName() const { return name; }
+
+    // Set the token to have the given name (and use the
+    // text of the name as its content).
+    void setName(Name* inName)
+    {
+        content = inName ? inName->text.getUnownedSlice() : UnownedStringSlice();
+        name = inName;
+    }
+
+    // Set the text of the token, and clear any interned name it had.
+    //
+    // The caller is responsible for keeping the text alive for as
+    // long as the token is in use: the text of a source file is kept
+    // by its `SourceFile`, and text that is synthesized (e.g., by the
+    // parser) should come from `allocateSyntaxText()`.
+    void setContent(UnownedStringSlice const& text)
+    {
+        content = text;
+        name = nullptr;
+    }
+
+private:
+    // The characters of the token.
+    UnownedStringSlice content;
+
+    // The interned name, for identifier tokens.
+    Name* name = nullptr;
 };
 
 
@@ -38,6 +38,7 @@ protected:
     virtual bool EqualsImpl(ExpressionType * type) override;
     virtual ExpressionType* CreateCanonicalType() override;
     virtual int GetHashCode() override;
+    virtual bool ComputeCanonicalHash(int* outHash) override;
 )
 END_SYNTAX_CLASS()
 
@@ -51,15 +52,17 @@ RAW(
 
     static DeclRefType* Create(DeclRef<Decl> declRef);
 
-protected:
     DeclRefType()
     {}
+
+protected:
     DeclRefType(DeclRef<Decl> declRef)
         : declRef(declRef)
     {}
     virtual int GetHashCode() override;
     virtual bool EqualsImpl(ExpressionType * type) override;
     virtual ExpressionType* CreateCanonicalType() override;
+    virtual bool ComputeCanonicalHash(int* outHash) override;
 )
 END_SYNTAX_CLASS()
 
@@ -88,6 +91,7 @@ protected:
     virtual BasicExpressionType* GetScalarType() override;
     virtual bool EqualsImpl(ExpressionType * type) override;
     virtual ExpressionType* CreateCanonicalType() override;
+    virtual bool ComputeCanonicalHash(int* outHash) override;
 )
 END_SYNTAX_CLASS()
 
@@ -142,6 +146,8 @@ RAW(
     SlangResourceShape getShape() const { return flavor & 0xFF; }
     SlangResourceAccess getAccess() const { return (flavor >> 8) & 0xFF; }
 
+    TextureTypeBase()
+    {}
     TextureTypeBase(
         Flavor flavor,
         RefPtr<ExpressionType> elementType)
@@ -153,6 +159,8 @@ END_SYNTAX_CLASS()
 
 SYNTAX_CLASS(TextureType, TextureTypeBase)
 RAW(
+    TextureType()
+    {}
     TextureType(
         Flavor flavor,
         RefPtr<ExpressionType> elementType)
@@ -165,6 +173,8 @@ END_SYNTAX_CLASS()
 // as they exist in, e.g., GLSL
 SYNTAX_CLASS(TextureSamplerType, TextureTypeBase)
 RAW(
+    TextureSamplerType()
+    {}
     TextureSamplerType(
         Flavor flavor,
         RefPtr<ExpressionType> elementType)
@@ -176,6 +186,8 @@ END_SYNTAX_CLASS()
 // This is a base type for `image*` types, as they exist in GLSL
 SYNTAX_CLASS(GLSLImageType, TextureTypeBase)
 RAW(
+    GLSLImageType()
+    {}
     GLSLImageType(
         Flavor flavor,
         RefPtr<ExpressionType> elementType)
@@ -277,6 +289,7 @@ protected:
     virtual bool EqualsImpl(ExpressionType * type) override;
     virtual ExpressionType* CreateCanonicalType() override;
     virtual int GetHashCode() override;
+    virtual bool ComputeCanonicalHash(int* outHash) override;
 )
 END_SYNTAX_CLASS()
 
@@ -289,6 +302,8 @@ SYNTAX_CLASS(TypeType, ExpressionType)
 
 RAW(
 public:
+    TypeType()
+    {}
     TypeType(RefPtr<ExpressionType> type)
         : type(type)
     {}
@@ -340,6 +355,8 @@ SYNTAX_CLASS(NamedExpressionType, ExpressionType)
     DECL_FIELD(DeclRef<TypeDefDecl>, declRef)
 
 RAW(
+    NamedExpressionType()
+    {}
     NamedExpressionType(DeclRef<TypeDefDecl> declRef)
         : declRef(declRef)
     {}
@@ -367,6 +384,7 @@ protected:
     virtual bool EqualsImpl(ExpressionType * type) override;
     virtual ExpressionType* CreateCanonicalType() override;
     virtual int GetHashCode() override;
+    virtual bool ComputeCanonicalHash(int* outHash) override;
 )
 END_SYNTAX_CLASS()
 
@@ -376,6 +394,8 @@ SYNTAX_CLASS(GenericDeclRefType, ExpressionType)
     DECL_FIELD(DeclRef<GenericDecl>, declRef)
 
     RAW(
+    GenericDeclRefType()
+    {}
     GenericDeclRefType(DeclRef<GenericDecl> declRef)
         : declRef(declRef)
     {}
@@ -389,6 +409,7 @@ protected:
     virtual bool EqualsImpl(ExpressionType * type) override;
     virtual int GetHashCode() override;
     virtual ExpressionType* CreateCanonicalType() override;
+    virtual bool ComputeCanonicalHash(int* outHash) override;
 )
 END_SYNTAX_CLASS()
 
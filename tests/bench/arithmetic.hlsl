@@ -0,0 +1,221 @@
+//TEST(smoke):STRESS:-threads 4 -iterations 2 -target hlsl -profile ps_5_0 -entry main
+
+// Input for `slang-benchmark -shader`: a shader that is mostly
+// arithmetic on scalars, vectors and matrices of several types, so
+// that checking it is dominated by overload resolution for operators
+// and intrinsic functions.
+
+cbuffer Constants
+{
+    float4x4 world;
+    float4x4 viewProjection;
+    float3x3 normalMatrix;
+    float4 tint;
+    float3 lightDirection;
+    float3 cameraPosition;
+    float2 uvScale;
+    float time;
+    int frame;
+    uint seed;
+};
+
+float hash11(float p)
+{
+    p = frac(p * 0.1031);
+    p *= p + 33.33;
+    p *= p + p;
+    return frac(p);
+}
+
+float2 hash22(float2 p)
+{
+    float3 p3 = frac(float3(p.xyx) * float3(0.1031, 0.1030, 0.0973));
+    p3 += dot(p3, p3.yzx + 33.33);
+    return frac((p3.xx + p3.yz) * p3.zy);
+}
+
+uint wangHash(uint x)
+{
+    x = (x ^ 61u) ^ (x >> 16);
+    x *= 9u;
+    x = x ^ (x >> 4);
+    x *= 0x27d4eb2du;
+    x = x ^ (x >> 15);
+    return x;
+}
+
+int3 wrapCoords(int3 coords, int3 size)
+{
+    int3 wrapped = coords % size;
+    return wrapped + size * int3(wrapped.x < 0, wrapped.y < 0, wrapped.z < 0);
+}
+
+float valueNoise(float2 p)
+{
+    float2 i = floor(p);
+    float2 f = frac(p);
+    float2 u = f * f * (3.0 - 2.0 * f);
+
+    float a = hash11(dot(i, float2(1.0, 57.0)));
+    float b = hash11(dot(i + float2(1.0, 0.0), float2(1.0, 57.0)));
+    float c = hash11(dot(i + float2(0.0, 1.0), float2(1.0, 57.0)));
+    float d = hash11(dot(i + float2(1.0, 1.0), float2(1.0, 57.0)));
+
+    return lerp(lerp(a, b, u.x), lerp(c, d, u.x), u.y);
+}
+
+float fbm(float2 p)
+{
+    float sum = 0.0;
+    float amplitude = 0.5;
+    for (int ii = 0; ii < 5; ii++)
+    {
+        sum += amplitude * valueNoise(p);
+        p = p * 2.02 + float2(1.7, 9.2);
+        amplitude *= 0.5;
+    }
+    return sum;
+}
+
+float3 rotateY(float3 v, float angle)
+{
+    float s = sin(angle);
+    float c = cos(angle);
+    float3x3 rotation = float3x3(
+        c, 0.0, s,
+        0.0, 1.0, 0.0,
+        -s, 0.0, c);
+    return mul(rotation, v);
+}
+
+float4 transformPosition(float3 position)
+{
+    float4 worldPosition = mul(world, float4(position, 1.0));
+    return mul(viewProjection, worldPosition);
+}
+
+float3 transformNormal(float3 normal)
+{
+    return normalize(mul(normalMatrix, normal));
+}
+
+float3 fresnelSchlick(float cosTheta, float3 f0)
+{
+    return f0 + (1.0 - f0) * pow(1.0 - saturate(cosTheta), 5.0);
+}
+
+float distributionGGX(float3 n, float3 h, float roughness)
+{
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float nDotH = max(dot(n, h), 0.0);
+    float denom = nDotH * nDotH * (a2 - 1.0) + 1.0;
+    return a2 / (3.14159265 * denom * denom);
+}
+
+float geometrySchlickGGX(float nDotV, float roughness)
+{
+    float r = roughness + 1.0;
+    float k = (r * r) / 8.0;
+    return nDotV / (nDotV * (1.0 - k) + k);
+}
+
+float geometrySmith(float3 n, float3 v, float3 l, float roughness)
+{
+    float nDotV = max(dot(n, v), 0.0);
+    float nDotL = max(dot(n, l), 0.0);
+    return geometrySchlickGGX(nDotV, roughness) * geometrySchlickGGX(nDotL, roughness);
+}
+
+float3 shade(float3 position, float3 normal, float3 albedo, float metallic, float roughness)
+{
+    float3 v = normalize(cameraPosition - position);
+    float3 l = normalize(-lightDirection);
+    float3 h = normalize(v + l);
+
+    float3 f0 = lerp(float3(0.04, 0.04, 0.04), albedo, metallic);
+    float3 f = fresnelSchlick(max(dot(h, v), 0.0), f0);
+    float d = distributionGGX(normal, h, roughness);
+    float g = geometrySmith(normal, v, l, roughness);
+
+    float3 specular = (d * g * f) / (4.0 * max(dot(normal, v), 0.0) * max(dot(normal, l), 0.0) + 0.0001);
+    float3 kD = (float3(1.0, 1.0, 1.0) - f) * (1.0 - metallic);
+
+    float nDotL = max(dot(normal, l), 0.0);
+    return (kD * albedo / 3.14159265 + specular) * nDotL;
+}
+
+float3 toneMap(float3 color)
+{
+    color *= 0.6;
+    float3 x = max(float3(0.0, 0.0, 0.0), color - 0.004);
+    return (x * (6.2 * x + 0.5)) / (x * (6.2 * x + 1.7) + 0.06);
+}
+
+float3 hueShift(float3 color, float shift)
+{
+    float3 k = float3(0.57735, 0.57735, 0.57735);
+    float c = cos(shift);
+    return color * c + cross(k, color) * sin(shift) + k * dot(k, color) * (1.0 - c);
+}
+
+uint packColor(float4 color)
+{
+    uint4 bytes = uint4(saturate(color) * 255.0 + 0.5);
+    return bytes.x | (bytes.y << 8) | (bytes.z << 16) | (bytes.w << 24);
+}
+
+float4 unpackColor(uint packed)
+{
+    uint4 bytes = uint4(packed, packed >> 8, packed >> 16, packed >> 24) & 0xffu;
+    return float4(bytes) / 255.0;
+}
+
+float2 parallax(float2 uv, float3 viewDirection, float height)
+{
+    float2 offset = viewDirection.xy / viewDirection.z * (height * 0.05 - 0.025);
+    return uv - offset;
+}
+
+float3x3 buildTangentFrame(float3 normal)
+{
+    float3 up = abs(normal.y) < 0.999 ? float3(0.0, 1.0, 0.0) : float3(1.0, 0.0, 0.0);
+    float3 tangent = normalize(cross(up, normal));
+    float3 bitangent = cross(normal, tangent);
+    return float3x3(tangent, bitangent, normal);
+}
+
+float4 main(float4 screenPosition : SV_Position, float2 uv : TEXCOORD0) : SV_Target
+{
+    float2 scaledUV = uv * uvScale + float2(time * 0.1, 0.0);
+    float height = fbm(scaledUV * 4.0);
+    float2 jitter = hash22(screenPosition.xy + float(frame)) - 0.5;
+
+    float3 position = float3(scaledUV.x, height, scaledUV.y) * 10.0;
+    position = rotateY(position, time * 0.25);
+    float4 clipPosition = transformPosition(position);
+
+    float3 normal = normalize(float3(
+        fbm(scaledUV + float2(0.01, 0.0)) - height,
+        0.01,
+        fbm(scaledUV + float2(0.0, 0.01)) - height));
+    normal = transformNormal(normal);
+    float3x3 tangentFrame = buildTangentFrame(normal);
+
+    float3 viewDirection = mul(tangentFrame, normalize(cameraPosition - position));
+    float2 shiftedUV = parallax(scaledUV, viewDirection, height) + jitter * 0.001;
+
+    uint randomBits = wangHash(seed ^ uint(frame) ^ uint(screenPosition.x) * 1973u ^ uint(screenPosition.y) * 9277u);
+    int3 cell = wrapCoords(int3(floor(float3(shiftedUV, height) * 16.0)), int3(16, 16, 16));
+
+    float3 albedo = tint.rgb * (0.75 + 0.25 * valueNoise(shiftedUV * 8.0));
+    albedo *= float3(cell) / 16.0 * 0.5 + 0.5;
+    float metallic = saturate(height * 2.0 - 0.5);
+    float roughness = clamp(0.3 + 0.4 * hash11(float(randomBits & 0xffffu)), 0.05, 1.0);
+
+    float3 color = shade(position, normal, albedo, metallic, roughness);
+    color = hueShift(toneMap(color), time * 0.05);
+
+    float4 result = float4(color, clipPosition.z / clipPosition.w);
+    return unpackColor(packColor(result)) * tint.a;
+}
@@ -0,0 +1,51 @@
+//TEST(smoke):STRESS:-threads 4 -iterations 2 -target hlsl -profile ps_5_0 -entry main
+
+// Input for `slang-benchmark -shader`: a shader written with small
+// utility macros nested several levels deep, so that preprocessing
+// it is dominated by the expansion of function-like macros and
+// their arguments.
+
+#define CONCAT(a, b) a##b
+#define SQUARE(x) ((x) * (x))
+#define LERP(a, b, t) ((a) + ((b) - (a)) * (t))
+#define SAT_SQUARE(x) saturate(SQUARE(x))
+#define DOT3(a, b) ((a).x * (b).x + (a).y * (b).y + (a).z * (b).z)
+
+#define FOREACH_4(M, x) M(x, 0) M(x, 1) M(x, 2) M(x, 3)
+#define FOREACH_16(M, x) FOREACH_4(M, x) FOREACH_4(M, x) FOREACH_4(M, x) FOREACH_4(M, x)
+#define FOREACH_64(M, x) FOREACH_16(M, x) FOREACH_16(M, x) FOREACH_16(M, x) FOREACH_16(M, x)
+
+#define ACCUMULATE(v, i) acc += LERP(SQUARE(v.x), SAT_SQUARE(v.y), CONCAT(w, i));
+#define ACCUMULATE_DOT(v, i) acc += DOT3(v, CONCAT(p, i)) * CONCAT(w, i);
+
+#define DEFINE_BLEND(name, op) float name(float a, float b) { return op(a, b); }
+#define MULTIPLY(a, b) ((a) * (b))
+#define AVERAGE(a, b) LERP(a, b, 0.5)
+
+DEFINE_BLEND(blendMultiply, MULTIPLY)
+DEFINE_BLEND(blendAverage, AVERAGE)
+
+float4 main(
+    float4 position : SV_Position,
+    float4 p0 : TEXCOORD0,
+    float4 p1 : TEXCOORD1,
+    float4 p2 : TEXCOORD2,
+    float4 p3 : TEXCOORD3) : SV_Target
+{
+    float w0 = p0.w;
+    float w1 = p1.w;
+    float w2 = SQUARE(p2.w);
+    float w3 = SAT_SQUARE(p3.w);
+
+    float acc = 0;
+    FOREACH_64(ACCUMULATE, p0)
+    FOREACH_64(ACCUMULATE, p1)
+    FOREACH_64(ACCUMULATE_DOT, p2)
+    FOREACH_64(ACCUMULATE_DOT, position)
+
+    return float4(
+        blendMultiply(acc, w0),
+        blendAverage(acc, w1),
+        DOT3(p0, p1),
+        1);
+}
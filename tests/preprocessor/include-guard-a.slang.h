@@ -0,0 +1,11 @@
+// Include guards and `#pragma once`
+
+#ifndef INCLUDE_GUARD_A
+#define INCLUDE_GUARD_A
+
+#include "include-guard-c.slang.h"
+#include "include-guard-d.slang.h"
+
+int a() { return c() + d(); }
+
+#endif
@@ -0,0 +1,12 @@
+// Include guards and `#pragma once`
+
+#if !defined(INCLUDE_GUARD_B)
+#define INCLUDE_GUARD_B
+
+#include "include-guard-a.slang.h"
+#include "include-guard-d.slang.h"
+#include "include-guard-c.slang.h"
+
+int b() { return a(); }
+
+#endif
@@ -0,0 +1,6 @@
+// Include guards and `#pragma once`
+#pragma once
+
+#include "include-guard-d.slang.h"
+
+int c() { return d(); }
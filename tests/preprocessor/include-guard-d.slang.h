@@ -0,0 +1,12 @@
+// Include guards and `#pragma once`
+
+#ifndef INCLUDE_GUARD_D
+#define INCLUDE_GUARD_D
+
+#ifdef INCLUDE_GUARD_A
+#else
+#endif
+
+int d() { return 0; }
+
+#endif
@@ -0,0 +1,7 @@
+// line-include.slang.h
+#ifdef SECOND_PASS
+#line 200 "second.h"
+#else
+#line 100 "first.h"
+#endif
+int NAME() { return undefinedName; }
@@ -0,0 +1,13 @@
+// Included by `include-graph.slang`
+
+#ifndef INCLUDE_GRAPH_A
+#define INCLUDE_GRAPH_A
+
+#include "include-graph-b.slang.h"
+#include "include-graph-c.slang.h"
+#include "include-graph-d.slang.h"
+#include "include-graph-e.slang.h"
+
+int a() { return b() + c() + d() + e(); }
+
+#endif
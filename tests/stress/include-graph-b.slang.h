@@ -0,0 +1,12 @@
+// Included by `include-graph.slang`
+
+#ifndef INCLUDE_GRAPH_B
+#define INCLUDE_GRAPH_B
+
+#include "include-graph-c.slang.h"
+#include "include-graph-d.slang.h"
+#include "include-graph-e.slang.h"
+
+int b() { return c() + d() + e(); }
+
+#endif
@@ -0,0 +1,11 @@
+// Included by `include-graph.slang`
+
+#if !defined(INCLUDE_GRAPH_C)
+#define INCLUDE_GRAPH_C
+
+#include "include-graph-d.slang.h"
+#include "include-graph-e.slang.h"
+
+int c() { return d() + e(); }
+
+#endif
@@ -0,0 +1,6 @@
+// Included by `include-graph.slang`
+#pragma once
+
+#include "include-graph-e.slang.h"
+
+int d() { return e() + 1; }
@@ -0,0 +1,8 @@
+// Included by `include-graph.slang`
+
+#ifndef INCLUDE_GRAPH_E
+#define INCLUDE_GRAPH_E
+
+int e() { return 1; }
+
+#endif
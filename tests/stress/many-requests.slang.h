@@ -0,0 +1,10 @@
+// Included by `many-requests.slang`
+
+#pragma once
+
+#warning "reported with the path and line of the header"
+
+float4 scale(float4 value)
+{
+	return value * 0.5;
+}
@@ -0,0 +1,18 @@
+#version 450
+//TEST(smoke):STRESS:-threads 8 -iterations 50 -target glsl -profile glsl_fragment -entry main
+// Like `shared-session.slang`, but for GLSL input, so that the
+// threads also race to load the GLSL standard library.
+
+layout(binding = 0) uniform PerMaterial
+{
+	vec4 tint;
+	float roughness;
+} material;
+
+layout(location = 0) in vec2 uv;
+layout(location = 0) out vec4 color;
+
+void main()
+{
+	color = vec4(uv, material.roughness, material.tint.w);
+}
@@ -0,0 +1,348 @@
+// main.cpp
+
+// A small tool for measuring how long it takes to get the
+// compiler up and running.
+//
+// The standard library is loaded on demand, so we compile a trivial
+// shader with each session we create. The first session in a process
+// has to preprocess, parse, and check the library code, while later
+// sessions load the checked library from the serialized form that
+// the first one produced. We time each of these separately, and
+// report what each part of the library cost.
+//
+// With `-cache`, sessions are created with the given cache directory,
+// where the first session to compile the library also saves it. With
+// `-cold-processes`, we run the benchmark that many times in new
+// processes sharing the cache directory, so that each one (after the
+// first, if the directory starts out empty) has to load the library
+// from the cache rather than from memory, as a new process would.
+//
+// With `-shader`, we instead time how long it takes to compile the
+// given HLSL file (which must have a `main` pixel shader entry point)
+// over and over in one session, once the library is loaded. The
+// shaders under `tests/bench` are meant for this.
+//
+// Usage: slang-benchmark [-sessions <count>] [-glsl] [-cache <dir>]
+//        slang-benchmark -cache <dir> -cold-processes <count> [-glsl]
+//        slang-benchmark -shader <file> [-compiles <count>]
+
+#include "../../slang.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char const* kHLSLSource =
+    "float4 main(float4 p : SV_Position) : SV_Target { return normalize(p); }\n";
+
+static char const* kGLSLSource =
+    "#version 450\n"
+    "layout(location = 0) out vec4 color;\n"
+    "void main() { color = vec4(1.0); }\n";
+
+static char const* const kStdlibModuleNames[] = { "core", "hlsl", "glsl" };
+enum { kStdlibModuleCount = 3 };
+
+struct Options
+{
+    int     sessionCount = 20;
+
+    // Compile GLSL (rather than HLSL), so that the
+    // GLSL library gets loaded as well
+    bool    glsl = false;
+
+    // A shader to compile, and how many times to compile it
+    char const* shaderPath = nullptr;
+    int         compileCount = 20;
+
+    // The cache directory to create sessions with, if any
+    char const* cacheDir = nullptr;
+
+    // How many new processes to time
+    int         coldProcessCount = 0;
+};
+
+struct SessionTimes
+{
+    double  total = 0;
+    double  modules[kStdlibModuleCount] = {};
+
+    // Whether each module was loaded from the serialized library
+    int     deserialized[kStdlibModuleCount] = {};
+};
+
+static double getSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(high_resolution_clock::now().time_since_epoch()).count();
+}
+
+static bool compileTrivialShader(Options const& options, SlangSession* session)
+{
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+
+    int translationUnit;
+    if (options.glsl)
+    {
+        spSetCodeGenTarget(request, SLANG_GLSL);
+        translationUnit = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_GLSL, nullptr);
+        spAddTranslationUnitSourceString(request, translationUnit, "benchmark.glsl", kGLSLSource);
+        spAddEntryPoint(request, translationUnit, "main", spFindProfile(session, "glsl_fragment"));
+    }
+    else
+    {
+        spSetCodeGenTarget(request, SLANG_HLSL);
+        translationUnit = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_HLSL, nullptr);
+        spAddTranslationUnitSourceString(request, translationUnit, "benchmark.hlsl", kHLSLSource);
+        spAddEntryPoint(request, translationUnit, "main", spFindProfile(session, "ps_5_0"));
+    }
+
+    int result = spCompile(request);
+    if (result != 0)
+    {
+        fprintf(stderr, "%s", spGetDiagnosticOutput(request));
+    }
+
+    spDestroyCompileRequest(request);
+    return result == 0;
+}
+
+struct LookupStats
+{
+    unsigned int lookupCount = 0;
+    unsigned int hitCount = 0;
+};
+
+static bool compileShaderFile(Options const& options, SlangSession* session, LookupStats* outLookupStats = nullptr)
+{
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+
+    spSetCodeGenTarget(request, SLANG_HLSL);
+    int translationUnit = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_HLSL, nullptr);
+    spAddTranslationUnitSourceFile(request, translationUnit, options.shaderPath);
+    spAddEntryPoint(request, translationUnit, "main", spFindProfile(session, "ps_5_0"));
+
+    int result = spCompile(request);
+    if (result != 0)
+    {
+        fprintf(stderr, "%s", spGetDiagnosticOutput(request));
+    }
+
+    if (outLookupStats)
+    {
+        spGetLookupCacheStats(request, &outLookupStats->lookupCount, &outLookupStats->hitCount);
+    }
+
+    spDestroyCompileRequest(request);
+    return result == 0;
+}
+
+// Compile the shader over and over in one session, and report how
+// long each compile took.
+static bool timeShaderCompiles(Options const& options)
+{
+    SlangSession* session = spCreateSession(nullptr);
+
+    // The first compile loads the standard library, so we
+    // don't count it.
+    bool ok = compileShaderFile(options, session);
+
+    double totalTime = 0;
+    double minTime = 0;
+    double maxTime = 0;
+    LookupStats lookupStats;
+    for (int ii = 0; ii < options.compileCount; ++ii)
+    {
+        double startTime = getSeconds();
+        if (!compileShaderFile(options, session, &lookupStats))
+            ok = false;
+        double time = getSeconds() - startTime;
+
+        totalTime += time;
+        if (ii == 0 || time < minTime) minTime = time;
+        if (ii == 0 || time > maxTime) maxTime = time;
+    }
+
+    size_t includeBytesSaved = 0;
+    size_t includeTokensSaved = 0;
+    size_t includesSkipped = 0;
+    spGetIncludeCacheStats(session, &includeBytesSaved, &includeTokensSaved, &includesSkipped);
+
+    spDestroySession(session);
+
+    char label[64];
+    snprintf(label, sizeof(label), "compiles (%d):", options.compileCount);
+    printf("%-24s %8.2f ms average\n", label, totalTime * 1000.0 / options.compileCount);
+    printf("%-24s %8.2f ms min, %.2f ms max\n", "", minTime * 1000.0, maxTime * 1000.0);
+    printf("%-24s %8u per compile, %u from cache\n", "name lookups:", lookupStats.lookupCount, lookupStats.hitCount);
+    printf("%-24s %8zu bytes not read, %zu tokens not lexed, %zu includes skipped\n", "include cache:", includeBytesSaved, includeTokensSaved, includesSkipped);
+
+    return ok;
+}
+
+// Create and use one session, and return how long it took.
+static SessionTimes timeSession(Options const& options, bool* ioOk)
+{
+    SessionTimes times;
+
+    double startTime = getSeconds();
+
+    SlangSession* session = spCreateSession(options.cacheDir);
+    if (!compileTrivialShader(options, session))
+        *ioOk = false;
+
+    for (int ii = 0; ii < kStdlibModuleCount; ++ii)
+    {
+        times.modules[ii] = spGetStdlibModuleInitTime(session, kStdlibModuleNames[ii], &times.deserialized[ii]);
+    }
+
+    spDestroySession(session);
+
+    times.total = getSeconds() - startTime;
+    return times;
+}
+
+static void printTimes(char const* label, SessionTimes const& times)
+{
+    printf("%-24s %8.2f ms total", label, times.total * 1000.0);
+    for (int ii = 0; ii < kStdlibModuleCount; ++ii)
+    {
+        if (times.modules[ii] < 0)
+            printf(", %s not loaded", kStdlibModuleNames[ii]);
+        else
+            printf(", %s %.2f ms (%s)", kStdlibModuleNames[ii], times.modules[ii] * 1000.0,
+                times.deserialized[ii] ? "loaded" : "compiled");
+    }
+    printf("\n");
+}
+
+// Run the benchmark for one session in each of a number of new
+// processes, and report how long each process took from start to
+// finish, as well as the times it reports for its session.
+static bool timeColdProcesses(Options const& options, char const* programPath)
+{
+    bool ok = true;
+    for (int ii = 0; ii < options.coldProcessCount; ++ii)
+    {
+        // On Windows, `system()` strips the outermost quotes
+        char command[4096];
+        snprintf(command, sizeof(command),
+#ifdef _WIN32
+            "\"\"%s\" -sessions 0 -cache \"%s\"%s\"",
+#else
+            "\"%s\" -sessions 0 -cache \"%s\"%s",
+#endif
+            programPath, options.cacheDir, options.glsl ? " -glsl" : "");
+
+        printf("cold process %d:\n", ii + 1);
+        fflush(stdout);
+
+        double startTime = getSeconds();
+        if (system(command) != 0)
+            ok = false;
+        double time = getSeconds() - startTime;
+
+        printf("%-24s %8.2f ms including process startup\n", "", time * 1000.0);
+    }
+    return ok;
+}
+
+static void printUsage(char const* programPath)
+{
+    fprintf(stderr,
+        "usage: %s [-sessions <count>] [-glsl] [-cache <dir>]\n"
+        "       %s -cache <dir> -cold-processes <count> [-glsl]\n"
+        "       %s -shader <file> [-compiles <count>]\n",
+        programPath, programPath, programPath);
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int ii = 1; ii < argc; ++ii)
+    {
+        char const* arg = argv[ii];
+        if (strcmp(arg, "-sessions") == 0 && ii + 1 < argc)
+        {
+            options.sessionCount = atoi(argv[++ii]);
+        }
+        else if (strcmp(arg, "-glsl") == 0)
+        {
+            options.glsl = true;
+        }
+        else if (strcmp(arg, "-shader") == 0 && ii + 1 < argc)
+        {
+            options.shaderPath = argv[++ii];
+        }
+        else if (strcmp(arg, "-compiles") == 0 && ii + 1 < argc)
+        {
+            options.compileCount = atoi(argv[++ii]);
+        }
+        else if (strcmp(arg, "-cache") == 0 && ii + 1 < argc)
+        {
+            options.cacheDir = argv[++ii];
+        }
+        else if (strcmp(arg, "-cold-processes") == 0 && ii + 1 < argc)
+        {
+            options.coldProcessCount = atoi(argv[++ii]);
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // New processes can only share the library through a cache directory
+    if (options.coldProcessCount > 0 && !options.cacheDir)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.shaderPath)
+    {
+        if (options.compileCount <= 0)
+            options.compileCount = 1;
+        return timeShaderCompiles(options) ? 0 : 1;
+    }
+
+    if (options.coldProcessCount > 0)
+    {
+        return timeColdProcesses(options, argv[0]) ? 0 : 1;
+    }
+
+    bool ok = true;
+
+    SessionTimes firstTimes = timeSession(options, &ok);
+    printTimes("first session:", firstTimes);
+
+    if (options.sessionCount > 0)
+    {
+        SessionTimes averageTimes;
+        double minTime = 0;
+        double maxTime = 0;
+        for (int ii = 0; ii < options.sessionCount; ++ii)
+        {
+            SessionTimes times = timeSession(options, &ok);
+
+            averageTimes.total += times.total / options.sessionCount;
+            for (int mm = 0; mm < kStdlibModuleCount; ++mm)
+                averageTimes.modules[mm] += times.modules[mm] / options.sessionCount;
+
+            if (ii == 0 || times.total < minTime) minTime = times.total;
+            if (ii == 0 || times.total > maxTime) maxTime = times.total;
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "later sessions (%d):", options.sessionCount);
+        printTimes(label, averageTimes);
+        printf("%-24s %8.2f ms min, %.2f ms max\n", "", minTime * 1000.0, maxTime * 1000.0);
+        if (averageTimes.total > 0)
+            printf("%-24s %8.2fx\n", "speedup:", firstTimes.total / averageTimes.total);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+// main.cpp
+
+// A tool for checking that a single session can be used to run
+// many compile requests at once.
+//
+// We first compile the input on its own, in a session of its own,
+// to get the output we expect. Then we create a fresh session and
+// compile the same input over and over from several threads (so
+// that the threads also race to load the standard library), and
+// check that every compile produced exactly the expected output.
+//
+// Each `-permutation <name>=<value>` adds a permutation (see
+// `spAddPermutation()`) that defines one macro. With
+// `-expect-compiled <count>`, the test also checks how many of the
+// permutations actually had to be compiled, rather than reusing
+// the compile of an earlier permutation. Similarly, with
+// `-expect-skipped-includes <count>` it checks how many `#include`s
+// a single compile skipped because of include guards or `#pragma once`.
+// With `-expect-reused-locations`, it checks that the source locations
+// of each compile are given back when its request is destroyed, so that
+// running many requests on one session doesn't use up its locations.
+//
+// Usage: slang-stress-test [-threads <count>] [-iterations <count>]
+//     [-permutation <name>=<value>]... [-expect-compiled <count>]
+//     [-expect-skipped-includes <count>] [-expect-reused-locations]
+//     <slangc arguments...>
+
+#include "../../slang.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Options
+{
+    int threadCount = 8;
+    int iterationCount = 20;
+
+    // The macro that each permutation defines, as `<name>=<value>`
+    std::vector<std::string> permutations;
+
+    // How many permutations should need to be compiled, or -1
+    // if we don't care
+    int expectedCompiledCount = -1;
+
+    // How many includes a compile should skip, or -1 if we don't care
+    int expectedSkippedIncludeCount = -1;
+
+    // Should we check that source locations get reused?
+    bool expectReusedLocations = false;
+
+    // The arguments to pass along to each compile request
+    std::vector<char const*> compileArgs;
+};
+
+static bool parseOptions(Options& options, int argc, char** argv)
+{
+    int ii = 1;
+    while (ii < argc)
+    {
+        char const* arg = argv[ii];
+        if (strcmp(arg, "-threads") == 0 && ii + 1 < argc)
+        {
+            options.threadCount = atoi(argv[ii + 1]);
+            ii += 2;
+        }
+        else if (strcmp(arg, "-iterations") == 0 && ii + 1 < argc)
+        {
+            options.iterationCount = atoi(argv[ii + 1]);
+            ii += 2;
+        }
+        else if (strcmp(arg, "-permutation") == 0 && ii + 1 < argc)
+        {
+            options.permutations.push_back(argv[ii + 1]);
+            ii += 2;
+        }
+        else if (strcmp(arg, "-expect-compiled") == 0 && ii + 1 < argc)
+        {
+            options.expectedCompiledCount = atoi(argv[ii + 1]);
+            ii += 2;
+        }
+        else if (strcmp(arg, "-expect-skipped-includes") == 0 && ii + 1 < argc)
+        {
+            options.expectedSkippedIncludeCount = atoi(argv[ii + 1]);
+            ii += 2;
+        }
+        else if (strcmp(arg, "-expect-reused-locations") == 0)
+        {
+            options.expectReusedLocations = true;
+            ii += 1;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    for (; ii < argc; ++ii)
+    {
+        options.compileArgs.push_back(argv[ii]);
+    }
+
+    return options.threadCount > 0
+        && options.iterationCount > 0
+        && options.compileArgs.size() != 0;
+}
+
+// Compile the input once with the given session, and capture
+// everything about the result that a user could observe. If
+// `outLocationSpaceUsed` isn't null, it receives how much of the
+// session's location space was used while the request was alive.
+static std::string compile(Options const& options, SlangSession* session, size_t* outLocationSpaceUsed = nullptr)
+{
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+
+    std::string output;
+    if (spProcessCommandLineArguments(request, options.compileArgs.data(), (int)options.compileArgs.size()) != 0)
+    {
+        output = "invalid arguments\n";
+    }
+    else
+    {
+        for (auto const& permutation : options.permutations)
+        {
+            size_t equals = permutation.find('=');
+            std::string name = permutation.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : permutation.substr(equals + 1);
+
+            int permutationIndex = spAddPermutation(request);
+            spPermutation_addPreprocessorDefine(request, permutationIndex, name.c_str(), value.c_str());
+        }
+
+        int result = spCompile(request);
+
+        output += "result code = " + std::to_string(result) + "\n";
+        output += "diagnostics = {\n";
+        output += spGetDiagnosticOutput(request);
+        output += "}\n";
+
+        if (result == 0)
+        {
+            int translationUnitCount = spGetTranslationUnitCount(request);
+            for (int tt = 0; tt < translationUnitCount; ++tt)
+            {
+                output += "output = {\n";
+                output += spGetTranslationUnitSource(request, tt);
+                output += "}\n";
+            }
+
+            // Permutations that were compiled together share
+            // their reflection data.
+            int permutationCount = spGetPermutationCount(request);
+            std::vector<SlangReflection*> compiled;
+            for (int pp = 0; pp < permutationCount; ++pp)
+            {
+                SlangReflection* reflection = spGetPermutationReflection(request, pp);
+                if (std::find(compiled.begin(), compiled.end(), reflection) == compiled.end())
+                    compiled.push_back(reflection);
+
+                for (int tt = 0; tt < translationUnitCount; ++tt)
+                {
+                    output += "permutation " + std::to_string(pp) + " output = {\n";
+                    output += spGetPermutationTranslationUnitSource(request, pp, tt);
+                    output += "}\n";
+                }
+            }
+            if (permutationCount)
+                output += "compiled permutations = " + std::to_string(compiled.size()) + "\n";
+        }
+    }
+
+    if (outLocationSpaceUsed)
+        spGetSourceLocationStats(session, nullptr, outLocationSpaceUsed);
+
+    spDestroyCompileRequest(request);
+    return output;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(options, argc, argv))
+    {
+        fprintf(stderr, "usage: %s [-threads <count>] [-iterations <count>] [-permutation <name>=<value>]... [-expect-compiled <count>] [-expect-skipped-includes <count>] [-expect-reused-locations] <slangc arguments...>\n", argv[0]);
+        return 1;
+    }
+
+    std::string expectedOutput;
+    size_t skippedIncludeCount = 0;
+
+    // The locations held by the session itself (e.g., for the standard
+    // library), and the extra locations that one request uses
+    size_t sessionLocationCount = 0;
+    size_t requestLocationCount = 0;
+    {
+        SlangSession* session = spCreateSession(nullptr);
+        size_t locationSpaceUsed = 0;
+        expectedOutput = compile(options, session, &locationSpaceUsed);
+        spGetIncludeCacheStats(session, nullptr, nullptr, &skippedIncludeCount);
+        spGetSourceLocationStats(session, &sessionLocationCount, nullptr);
+        requestLocationCount = locationSpaceUsed - sessionLocationCount;
+        spDestroySession(session);
+    }
+
+    if (options.expectedSkippedIncludeCount >= 0
+        && skippedIncludeCount != (size_t)options.expectedSkippedIncludeCount)
+    {
+        fprintf(stderr, "expected %d includes to be skipped, but %d were\n",
+            options.expectedSkippedIncludeCount,
+            (int)skippedIncludeCount);
+        return 1;
+    }
+
+    if (options.expectedCompiledCount >= 0)
+    {
+        std::string expectedLine = "compiled permutations = " + std::to_string(options.expectedCompiledCount) + "\n";
+        if (expectedOutput.find(expectedLine) == std::string::npos)
+        {
+            fprintf(stderr,
+                "expected %d permutations to be compiled\n"
+                "OUTPUT{{{\n%s}}}\n",
+                options.expectedCompiledCount,
+                expectedOutput.c_str());
+            return 1;
+        }
+    }
+
+    SlangSession* session = spCreateSession(nullptr);
+
+    std::atomic<int> failureCount(0);
+    std::vector<std::thread> threads;
+    for (int tt = 0; tt < options.threadCount; ++tt)
+    {
+        threads.emplace_back([&, tt]()
+        {
+            for (int ii = 0; ii < options.iterationCount; ++ii)
+            {
+                std::string output = compile(options, session);
+                if (output == expectedOutput)
+                    continue;
+
+                // Only report the first mismatch, since the
+                // others are probably much the same.
+                if (failureCount++ == 0)
+                {
+                    fprintf(stderr,
+                        "thread %d, iteration %d: output doesn't match\n"
+                        "EXPECTED{{{\n%s}}}\n"
+                        "ACTUAL{{{\n%s}}}\n",
+                        tt, ii,
+                        expectedOutput.c_str(),
+                        output.c_str());
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    unsigned int moduleHitCount = 0;
+    unsigned int moduleMissCount = 0;
+    spGetModuleCacheStats(session, &moduleHitCount, &moduleMissCount);
+
+    unsigned int coercionHitCount = 0;
+    unsigned int coercionMissCount = 0;
+    spGetCoercionCacheStats(session, &coercionHitCount, &coercionMissCount);
+
+    size_t locationsInUse = 0;
+    size_t locationSpaceUsed = 0;
+    spGetSourceLocationStats(session, &locationsInUse, &locationSpaceUsed);
+
+    spDestroySession(session);
+
+    // Once every request is gone, only the session should hold any
+    // locations, and the space used should only have grown by what
+    // the requests that were alive at the same time needed (with some
+    // slack for ranges that were left too small to reuse). If locations
+    // weren't reused, it would grow with the number of compiles instead.
+    if (options.expectReusedLocations)
+    {
+        size_t maxLocationSpaceUsed = sessionLocationCount
+            + 2 * options.threadCount * requestLocationCount;
+        if (locationsInUse > sessionLocationCount || locationSpaceUsed > maxLocationSpaceUsed)
+        {
+            fprintf(stderr,
+                "expected locations to be reused: %d in use (expected at most %d), %d used in all (expected at most %d)\n",
+                (int)locationsInUse,
+                (int)sessionLocationCount,
+                (int)locationSpaceUsed,
+                (int)maxLocationSpaceUsed);
+            return 1;
+        }
+    }
+
+    int compileCount = options.threadCount * options.iterationCount;
+    if (failureCount != 0)
+    {
+        fprintf(stderr, "%d of %d compiles failed\n", (int)failureCount, compileCount);
+        return 1;
+    }
+
+    printf("%d compiles on %d threads matched (%u imports reused a module, %u did not)\n",
+        compileCount, options.threadCount, moduleHitCount, moduleMissCount);
+    printf("type conversion checks: %u cached, %u computed\n",
+        coercionHitCount, coercionMissCount);
+    return 0;
+}
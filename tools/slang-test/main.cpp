@@ -671,6 +671,50 @@ TestResult runSimpleTest(TestInput& input)
     return result;
 }
 
+TestResult runStressTest(TestInput& input)
+{
+    // Compile the file many times over on several threads that
+    // share a session; the stress test tool checks the outputs
+    // against each other, so we only need its result code.
+
+    auto filePath999 = input.filePath;
+    auto outputStem = input.outputStem;
+
+    OSProcessSpawner spawner;
+
+    spawner.pushExecutablePath(String(options.binDir) + "slang-stress-test.exe");
+
+    for( auto arg : input.testOptions->args )
+    {
+        spawner.pushArgument(arg);
+    }
+
+    spawner.pushArgument(filePath999);
+
+    if (spawnAndWait(outputStem, spawner) != kOSError_None)
+    {
+        return kTestResult_Fail;
+    }
+
+    if (spawner.getResultCode() != 0)
+    {
+        String actualOutput = getOutput(spawner);
+
+        String actualOutputPath = outputStem + ".actual";
+        Slang::File::WriteAllText(actualOutputPath, actualOutput);
+
+        if (options.outputMode == kOutputMode_AppVeyor)
+        {
+            fprintf(stderr, "ERROR:\n%s", actualOutput.Buffer());
+            fflush(stderr);
+        }
+
+        return kTestResult_Fail;
+    }
+
+    return kTestResult_Pass;
+}
+
 #ifdef SLANG_TEST_SUPPORT_HLSL
 TestResult generateHLSLBaseline(TestInput& input)
 {
@@ -1071,6 +1115,7 @@ TestResult runTest(
         TestCallback    callback;
     } kTestCommands[] = {
         { "SIMPLE", &runSimpleTest },
+        { "STRESS", &runStressTest },
         { "COMPARE_HLSL", &runHLSLComparisonTest },
         { "COMPARE_HLSL_RENDER", &runHLSLRenderComparisonTest },
         { "COMPARE_HLSL_CROSS_COMPILE_RENDER", &runHLSLCrossCompileRenderComparisonTest},